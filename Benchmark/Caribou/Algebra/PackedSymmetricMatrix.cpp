@@ -0,0 +1,82 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <Eigen/Dense>
+#include <Caribou/Algebra/PackedSymmetricMatrix.h>
+
+// Symmetric matrix-vector products of the elementary stiffness matrices of 20 000 hexahedra (24x24 matrices).
+// The "Distinct" cases read a different matrix for every element, which is the case of an unstructured mesh: the
+// matrices are read from the main memory. The "Shared" cases read the same matrix for every element, which is the case
+// of a regular grid when the stiffness matrices are shared: the matrix stays in cache.
+
+namespace {
+constexpr int N = 24;
+constexpr std::size_t NumberOfElements = 20000;
+using Dense = Eigen::Matrix<double, N, N, Eigen::RowMajor>;
+using Packed = caribou::algebra::PackedSymmetricMatrix<N, double>;
+using Vector = Eigen::Matrix<double, N, 1>;
+
+struct Elements {
+    Elements() : dense(NumberOfElements), packed(NumberOfElements), u(NumberOfElements), f(NumberOfElements) {
+        for (std::size_t e = 0; e < NumberOfElements; ++e) {
+            const Dense a = Dense::Random();
+            dense[e] = a + a.transpose();
+            packed[e] = Packed(dense[e]);
+            u[e] = Vector::Random();
+        }
+    }
+    std::vector<Dense> dense;
+    std::vector<Packed> packed;
+    std::vector<Vector> u;
+    std::vector<Vector> f;
+};
+
+auto elements() -> Elements & {
+    static Elements e;
+    return e;
+}
+
+template <typename Product>
+void run(benchmark::State & state, Product && product) {
+    auto & e = elements();
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < NumberOfElements; ++i) {
+            e.f[i] = product(e, i);
+        }
+        benchmark::DoNotOptimize(e.f.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * NumberOfElements));
+}
+} // namespace
+
+static void Distinct_DenseUpper(benchmark::State & state) {
+    run(state, [](const Elements & e, std::size_t i) -> Vector { return e.dense[i].selfadjointView<Eigen::Upper>() * e.u[i]; });
+}
+
+static void Distinct_DenseFull(benchmark::State & state) {
+    run(state, [](const Elements & e, std::size_t i) -> Vector { return e.dense[i] * e.u[i]; });
+}
+
+static void Distinct_Packed(benchmark::State & state) {
+    run(state, [](const Elements & e, std::size_t i) -> Vector { return e.packed[i] * e.u[i]; });
+}
+
+static void Shared_DenseUpper(benchmark::State & state) {
+    run(state, [](const Elements & e, std::size_t i) -> Vector { return e.dense[0].selfadjointView<Eigen::Upper>() * e.u[i]; });
+}
+
+static void Shared_DenseFull(benchmark::State & state) {
+    run(state, [](const Elements & e, std::size_t i) -> Vector { return e.dense[0] * e.u[i]; });
+}
+
+static void Shared_Packed(benchmark::State & state) {
+    run(state, [](const Elements & e, std::size_t i) -> Vector { return e.packed[0] * e.u[i]; });
+}
+
+BENCHMARK(Distinct_DenseUpper);
+BENCHMARK(Distinct_DenseFull);
+BENCHMARK(Distinct_Packed);
+BENCHMARK(Shared_DenseUpper);
+BENCHMARK(Shared_DenseFull);
+BENCHMARK(Shared_Packed);
@@ -0,0 +1,81 @@
+#!/usr/bin/python3
+
+"""
+Compare the time spent in the CaribouBarycentricMapping with and without multithreading when a dense point cloud is
+embedded into the linear hexahedral beam (beam_q1).
+
+The serial mapping interpolates the parent positions element by element and scatters the mapped forces with the
+transposed mapping matrix, while the multithreaded one gathers every mapped (resp. parent) node independently from
+the sparse mapping matrix (resp. its transpose). The mapped nodes are pulled by a constant force, such that apply,
+applyJ and applyJT are all called at every Newton iteration.
+
+Use the environment variable OMP_NUM_THREADS=N to set the number of threads.
+"""
+
+import time
+import meshio
+import numpy as np
+from pathlib import Path
+import Sofa
+import Sofa.Simulation
+import SofaCaribou
+
+# Mesh files
+current_dir = Path(__file__).parent
+meshes_dir = (current_dir / '..' / '..' / '..' / 'Validation' / 'meshes').resolve()
+beam_q1 = meshio.read(meshes_dir / 'beam_q1.vtu')
+
+number_of_steps = 10
+number_of_mapped_nodes = 200000
+young_modulus = 10000
+poisson_ratio = 0.45
+
+# Random point cloud strictly inside the beam
+rng = np.random.default_rng(0)
+mapped_nodes = rng.uniform(low=[-7.4, -7.4, 0.1], high=[7.4, 7.4, 79.9], size=(number_of_mapped_nodes, 3))
+
+methods = [
+    {'name': 'Serial', 'enable_multithreading': False},
+    {'name': 'Multithreaded', 'enable_multithreading': True},
+]
+
+
+def createScene(root, method):
+    root.addObject('APIVersion', level='21.06')
+    root.addObject('RequiredPlugin', pluginName='SofaBoundaryCondition SofaEngine')
+
+    root.addObject('StaticODESolver', newton_iterations=5, residual_tolerance_threshold=1e-8)
+    root.addObject('LDLTSolver', backend='Eigen')
+
+    root.addObject('MechanicalObject', name='mo', position=beam_q1.points.tolist())
+    root.addObject('CaribouTopology', name='volumetric_topology', template='Hexahedron', indices=beam_q1.cells_dict['hexahedron'].tolist())
+    root.addObject('SaintVenantKirchhoffMaterial', young_modulus=young_modulus, poisson_ratio=poisson_ratio)
+    root.addObject('HyperelasticForcefield', topology='@volumetric_topology')
+    root.addObject('BoxROI', name='fixed_roi', box=[-7.5, -7.5, -0.9, 7.5, 7.5, 0.1])
+    root.addObject('FixedConstraint', indices='@fixed_roi.indices')
+
+    root.addChild('cloud')
+    root.cloud.addObject('MechanicalObject', name='mo', position=mapped_nodes.tolist())
+    root.cloud.addObject('ConstantForceField', totalForce=[0, -10, 0])
+    root.cloud.addObject('CaribouBarycentricMapping', topology='@../volumetric_topology', enable_multithreading=method['enable_multithreading'])
+
+
+if __name__ == "__main__":
+    print("{: <14} | {: >10} | {: >12}".format('Method', 'Time (s)', 'Steps/s'))
+    positions = {}
+    for method in methods:
+        root = Sofa.Core.Node()
+        createScene(root, method)
+        Sofa.Simulation.init(root)
+
+        start = time.perf_counter()
+        for _ in range(number_of_steps):
+            Sofa.Simulation.animate(root, root.dt.value)
+        elapsed = time.perf_counter() - start
+
+        positions[method['name']] = np.array(root.cloud.mo.position.value)
+        print("{: <14} | {: >10.3f} | {: >12.2f}".format(method['name'], elapsed, number_of_steps / elapsed))
+
+    # Both methods must give the same mapped positions, up to round-off errors
+    print("Maximum difference of the mapped positions: {:.3e}".format(
+        np.abs(positions['Serial'] - positions['Multithreaded']).max()))
@@ -0,0 +1,71 @@
+#!/usr/bin/python3
+
+"""
+Compare the wall time of the BackwardEulerODESolver using the fixed time step of the scene against its adaptive time
+stepping mode on the linear hexahedral beam (beam_q1).
+
+For the adaptive mode, the number of accepted and rejected internal steps are also reported.
+"""
+
+import time
+import meshio
+from pathlib import Path
+import Sofa
+import Sofa.Simulation
+import SofaCaribou
+
+# Mesh files
+current_dir = Path(__file__).parent
+meshes_dir = (current_dir / '..' / '..' / '..' / 'Validation' / 'meshes').resolve()
+beam_q1 = meshio.read(meshes_dir / 'beam_q1.vtu')
+
+duration = 1.
+density = 1000
+young_modulus = 30000
+poisson_ratio = 0.3
+
+methods = [
+    {'name': 'Fixed (dt=1e-2)', 'dt': 1e-2, 'ode': {}},
+    {'name': 'Fixed (dt=1e-3)', 'dt': 1e-3, 'ode': {}},
+    {'name': 'Adaptive', 'dt': 1e-1, 'ode': {'adaptive_time_stepping': True, 'absolute_error_tolerance': 1e-3, 'relative_error_tolerance': 1e-2}},
+]
+
+
+def createScene(root, method):
+    root.dt = method['dt']
+    root.gravity = [0, -9.81, 0]
+    root.addObject('APIVersion', level='21.06')
+    root.addObject('RequiredPlugin', pluginName='SofaBoundaryCondition SofaEngine')
+
+    root.addObject('BackwardEulerODESolver', name='ode', newton_iterations=10, residual_tolerance_threshold=1e-8, printLog=False, **method['ode'])
+    root.addObject('LDLTSolver', backend='Eigen')
+    root.addObject('MechanicalObject', name='mo', position=beam_q1.points.tolist())
+    root.addObject('CaribouTopology', name='volumetric_topology', template='Hexahedron', indices=beam_q1.cells_dict['hexahedron'].tolist())
+    root.addObject('CaribouMass', density=density, lumped=False, topology='@volumetric_topology')
+    root.addObject('SaintVenantKirchhoffMaterial', young_modulus=young_modulus, poisson_ratio=poisson_ratio)
+    root.addObject('HyperelasticForcefield', topology='@volumetric_topology')
+    root.addObject('BoxROI', name='fixed_roi', box=[-7.5, -7.5, -0.9, 7.5, 7.5, 0.1])
+    root.addObject('FixedConstraint', indices='@fixed_roi.indices')
+
+
+if __name__ == "__main__":
+    print("{: <16} | {: >10} | {: >10} | {: >10} | {: >14}".format('Method', 'Time (s)', 'Accepted', 'Rejected', 'Tip y'))
+    for method in methods:
+        root = Sofa.Core.Node()
+        createScene(root, method)
+        Sofa.Simulation.init(root)
+
+        number_of_steps = int(round(duration / method['dt']))
+        start = time.perf_counter()
+        for _ in range(number_of_steps):
+            Sofa.Simulation.animate(root, root.dt.value)
+        elapsed = time.perf_counter() - start
+
+        if method['ode'].get('adaptive_time_stepping', False):
+            accepted = root.ode.number_of_accepted_steps.value
+            rejected = root.ode.number_of_rejected_steps.value
+        else:
+            accepted, rejected = number_of_steps, 0
+
+        tip_y = max(root.mo.position.value, key=lambda p: p[2])[1]
+        print("{: <16} | {: >10.3f} | {: >10d} | {: >10d} | {: >14.6e}".format(method['name'], elapsed, accepted, rejected, tip_y))
@@ -0,0 +1,79 @@
+#!/usr/bin/python3
+
+"""
+Compare the number of time steps per second of the explicit CentralDifferenceODESolver (lumped mass, no matrix
+assembly) against the implicit BackwardEulerODESolver (consistent mass, LDLT factorization) on the linear
+hexahedral beam (beam_q1).
+
+Since the explicit solver subdivides the time step when it is larger than its critical time step, both the number
+of time steps and the number of explicit sub-steps per second are reported.
+"""
+
+import time
+import meshio
+from pathlib import Path
+import Sofa
+import Sofa.Simulation
+import SofaCaribou
+
+# Mesh files
+current_dir = Path(__file__).parent
+meshes_dir = (current_dir / '..' / '..' / '..' / 'Validation' / 'meshes').resolve()
+beam_q1 = meshio.read(meshes_dir / 'beam_q1.vtu')
+
+number_of_steps = 100
+dt = 1e-3
+density = 1000
+young_modulus = 30000
+poisson_ratio = 0.3
+
+methods = [
+    {'name': 'Explicit', 'ode': ('CentralDifferenceODESolver', {'safety_factor': 0.9, 'subcycling': True}),
+     'linear_solver': None, 'lumped': True},
+    {'name': 'Explicit MT', 'ode': ('CentralDifferenceODESolver', {'safety_factor': 0.9, 'subcycling': True, 'enable_multithreading': True}),
+     'linear_solver': None, 'lumped': True},
+    {'name': 'Implicit', 'ode': ('BackwardEulerODESolver', {'newton_iterations': 10, 'residual_tolerance_threshold': 1e-8}),
+     'linear_solver': ('LDLTSolver', {'backend': 'Eigen'}), 'lumped': False},
+]
+
+
+def createScene(root, method):
+    root.dt = dt
+    root.gravity = [0, -9.81, 0]
+    root.addObject('APIVersion', level='21.06')
+    root.addObject('RequiredPlugin', pluginName='SofaBoundaryCondition SofaEngine')
+
+    ode_name, ode_arguments = method['ode']
+    root.addObject(ode_name, name='ode', printLog=False, **ode_arguments)
+    if method['linear_solver'] is not None:
+        linear_solver_name, linear_solver_arguments = method['linear_solver']
+        root.addObject(linear_solver_name, **linear_solver_arguments)
+
+    root.addObject('MechanicalObject', name='mo', position=beam_q1.points.tolist())
+    root.addObject('CaribouTopology', name='volumetric_topology', template='Hexahedron', indices=beam_q1.cells_dict['hexahedron'].tolist())
+    root.addObject('CaribouMass', density=density, lumped=method['lumped'], topology='@volumetric_topology')
+    root.addObject('SaintVenantKirchhoffMaterial', young_modulus=young_modulus, poisson_ratio=poisson_ratio)
+    root.addObject('HyperelasticForcefield', topology='@volumetric_topology')
+    root.addObject('BoxROI', name='fixed_roi', box=[-7.5, -7.5, -0.9, 7.5, 7.5, 0.1])
+    root.addObject('FixedConstraint', indices='@fixed_roi.indices')
+
+
+if __name__ == "__main__":
+    print("{: <12} | {: >10} | {: >12} | {: >12} | {: >12}".format('Method', 'Time (s)', 'Steps/s', 'Substeps/s', 'Critical dt'))
+    for method in methods:
+        root = Sofa.Core.Node()
+        createScene(root, method)
+        Sofa.Simulation.init(root)
+
+        number_of_substeps = 0
+        start = time.perf_counter()
+        for _ in range(number_of_steps):
+            Sofa.Simulation.animate(root, root.dt.value)
+            substeps = root.ode.getData('number_of_substeps')
+            number_of_substeps += substeps.value if substeps is not None else 1
+        elapsed = time.perf_counter() - start
+
+        critical_dt = root.ode.getData('critical_time_step')
+        critical_dt = critical_dt.value if critical_dt is not None else float('nan')
+        print("{: <12} | {: >10.3f} | {: >12.1f} | {: >12.1f} | {: >12.3e}".format(
+            method['name'], elapsed, number_of_steps / elapsed, number_of_substeps / elapsed, critical_dt))
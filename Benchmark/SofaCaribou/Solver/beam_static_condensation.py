@@ -0,0 +1,107 @@
+#!/usr/bin/python3
+
+"""
+Compare the Newton steps timings of the StaticODESolver with and without the static condensation of the
+edge-midpoint nodes, on the quadratic tetrahedral (beam_p2) and hexahedral (beam_q2) beams.
+"""
+
+import re
+import meshio
+import numpy as np
+from pathlib import Path
+import Sofa
+from SofaRuntime import Timer
+import SofaCaribou
+
+# Mesh files
+current_dir = Path(__file__).parent
+meshes_dir = (current_dir / '..' / '..' / '..' / 'Validation' / 'meshes').resolve()
+beam_p2 = meshio.read(meshes_dir / 'beam_p2.vtu')
+beam_q2 = meshio.read(meshes_dir / 'beam_q2.vtu')
+
+number_of_newton_iterations = 10
+young_modulus = 100000
+poisson_ratio = 0.49
+
+meshes = [
+    {'name': 'p2', 'mesh': beam_p2, 'volume': 'Tetrahedron10', 'cells': 'tetra10',      'surface': 'Triangle6', 'faces': 'triangle6'},
+    {'name': 'q2', 'mesh': beam_q2, 'volume': 'Hexahedron20',  'cells': 'hexahedron20', 'surface': 'Quad8',     'faces': 'quad8'},
+]
+
+methods = [
+    {'name': 'Full',      'arguments': {'static_condensation': False}},
+    {'name': 'Condensed', 'arguments': {'static_condensation': True, 'condensation_patch_size': 1}},
+]
+
+
+def extract_newton_steps(record):
+    if 'StaticODESolver::Solve' not in record:
+        return []
+    newton_steps = []
+    for newton_record in record['StaticODESolver::Solve']['NewtonStep']:
+        if 'MBKBuild' not in newton_record or 'MBKSolve' not in newton_record:
+            continue
+        newton_steps.append({
+            'Total': newton_record['total_time'],
+            'Build': newton_record['MBKBuild']['total_time'],
+            'Factorize': newton_record['MBKFactorize']['total_time'] if 'MBKFactorize' in newton_record else 0,
+            'Solve': newton_record['MBKSolve']['total_time'],
+        })
+    return newton_steps
+
+
+class Controller(Sofa.Core.Controller):
+    def __init__(self):
+        super().__init__(self)
+
+    def onAnimateBeginEvent(self, e):
+        Timer.setEnabled("timer", True)
+        Timer.begin("timer")
+
+    def onAnimateEndEvent(self, e):
+        records = Timer.getRecords("timer")
+        Timer.end("timer")
+        if "AnimateVisitor" not in records:
+            return
+
+        print("{: <14} | {: >10} | {: >10} | {: >10} | {: >10} | {: >6}".format('Method', 'Total', 'Build', 'Factorize', 'Solve', '# it.'))
+        for k, v in zip(records['AnimateVisitor'].keys(), records['AnimateVisitor'].values()):
+            match = re.search(r'Mechanical \((.*)\)', k)
+            if match is None:
+                continue
+            steps = extract_newton_steps(v)
+            if len(steps) == 0:
+                continue
+            total = {key: sum(step[key] for step in steps) for key in steps[0].keys()}
+            print("{: <14} | {: >10.3f} | {: >10.3f} | {: >10.3f} | {: >10.3f} | {: >6}".format(
+                match.group(1), total['Total'], total['Build'], total['Factorize'], total['Solve'], len(steps)))
+
+
+def createScene(root):
+    root.addObject(Controller())
+    root.addObject('APIVersion', level='21.06')
+    root.addObject('RequiredPlugin', pluginName='SofaBoundaryCondition SofaEngine')
+
+    for m in meshes:
+        mesh = m['mesh']
+        for method in methods:
+            node = root.addChild(m['name'] + '_' + method['name'])
+            node.addObject('StaticODESolver', newton_iterations=number_of_newton_iterations, residual_tolerance_threshold=1e-8, printLog=False, **method['arguments'])
+            node.addObject('LDLTSolver', backend="Eigen")
+            node.addObject('MechanicalObject', name='mo', position=mesh.points.tolist())
+            node.addObject('CaribouTopology', name='volumetric_topology', template=m['volume'], indices=mesh.cells_dict[m['cells']].tolist())
+            node.addObject('SaintVenantKirchhoffMaterial', young_modulus=young_modulus, poisson_ratio=poisson_ratio)
+            node.addObject('HyperelasticForcefield', topology='@volumetric_topology')
+            node.addObject('BoxROI', name='fixed_roi', box=[-7.5, -7.5, -0.9, 7.5, 7.5, 0.1])
+            node.addObject('FixedConstraint', indices='@fixed_roi.indices')
+            node.addObject('CaribouTopology', name='surface_topology', template=m['surface'], indices=mesh.cells_dict[m['faces']][np.array(np.ma.masked_equal(mesh.cell_data['gmsh:physical'][0], 2).mask)].tolist())
+            node.addObject('TractionForcefield', traction=[0, 600, 0], slope=1, topology='@surface_topology')
+
+
+if __name__ == "__main__":
+    import Sofa.Simulation
+    root = Sofa.Core.Node()
+    createScene(root)
+    Sofa.Simulation.init(root)
+    print("Computing... (this may take a while)")
+    Sofa.Simulation.animate(root, 1)
@@ -0,0 +1,164 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/miniconda/lib/cmake/GTest/GTestConfig.cmake"
+  "/root/miniconda/lib/cmake/GTest/GTestConfigVersion.cmake"
+  "/root/miniconda/lib/cmake/GTest/GTestTargets-release.cmake"
+  "/root/miniconda/lib/cmake/GTest/GTestTargets.cmake"
+  "/root/repo/Benchmark/CMakeLists.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/cmake/FindEigen3.cmake"
+  "/root/repo/cmake/FindMKL.cmake"
+  "/root/repo/cmake/FindSOFA.cmake"
+  "/root/repo/cmake/caribouTools.cmake"
+  "/root/repo/src/Caribou/Algebra/AlgebraConfig.cmake.in"
+  "/root/repo/src/Caribou/Algebra/CMakeLists.txt"
+  "/root/repo/src/Caribou/CMakeLists.txt"
+  "/root/repo/src/Caribou/CaribouConfig.cmake.in"
+  "/root/repo/src/Caribou/Config/CMakeLists.txt"
+  "/root/repo/src/Caribou/Config/ConfigConfig.cmake.in"
+  "/root/repo/src/Caribou/Config/config.h.in"
+  "/root/repo/src/Caribou/Config/constants.h.in"
+  "/root/repo/src/Caribou/Config/macros.h.in"
+  "/root/repo/src/Caribou/Config/traits.h.in"
+  "/root/repo/src/Caribou/Config/version.h.in"
+  "/root/repo/src/Caribou/Geometry/CMakeLists.txt"
+  "/root/repo/src/Caribou/Geometry/GeometryConfig.cmake.in"
+  "/root/repo/src/Caribou/Mechanics/CMakeLists.txt"
+  "/root/repo/src/Caribou/Mechanics/MechanicsConfig.cmake.in"
+  "/root/repo/src/Caribou/Topology/CMakeLists.txt"
+  "/root/repo/src/Caribou/Topology/TopologyConfig.cmake.in"
+  "/root/repo/src/Caribou/Topology/config.h.in"
+  "/root/repo/unittest/CMakeLists.txt"
+  "/root/repo/unittest/Caribou/Geometry/CMakeLists.txt"
+  "/root/repo/unittest/Caribou/Mechanics/CMakeLists.txt"
+  "/root/repo/unittest/Caribou/Topology/CMakeLists.txt"
+  "/root/repo/unittest/Caribou/Topology/meshes/1D_linear.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/1D_quadratic.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/2D_quad_linear.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/2D_quad_quadratic.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/2D_triangle_linear.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/2D_triangle_quadratic.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_hexahedron_linear.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_hexahedron_quadratic.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_quad_linear.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_quad_quadratic.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_tetrahedron_linear.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_tetrahedron_quadratic.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_triangle_linear.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/3D_triangle_quadratic.vtk"
+  "/root/repo/unittest/Caribou/Topology/meshes/deformed_liver_surface.stl"
+  "/root/repo/unittest/Caribou/Topology/meshes/deformed_liver_volume_hexahedrons.vtu"
+  "/root/repo/unittest/Caribou/Topology/meshes/deformed_liver_volume_tetrahedrons.vtu"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-ExactVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCheckCompilerFlagCommonPatterns.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDependentOption.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFindDependencyMacro.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseImplicitLinkInfo.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindOpenMP.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPython.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPython/Support.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckFlagCommonConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "cmake/Caribou/CaribouConfig.cmake"
+  "cmake/Caribou/CaribouConfigVersion.cmake"
+  "src/Caribou/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "cmake/Caribou/AlgebraConfig.cmake"
+  "cmake/Caribou/AlgebraConfigVersion.cmake"
+  "src/Caribou/Algebra/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "include/Caribou/config.h"
+  "include/Caribou/constants.h"
+  "include/Caribou/macros.h"
+  "include/Caribou/traits.h"
+  "include/Caribou/version.h"
+  "cmake/Caribou/ConfigConfig.cmake"
+  "cmake/Caribou/ConfigConfigVersion.cmake"
+  "src/Caribou/Config/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "cmake/Caribou/GeometryConfig.cmake"
+  "cmake/Caribou/GeometryConfigVersion.cmake"
+  "src/Caribou/Geometry/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "cmake/Caribou/MechanicsConfig.cmake"
+  "cmake/Caribou/MechanicsConfigVersion.cmake"
+  "src/Caribou/Mechanics/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "include/Caribou/Topology/config.h"
+  "cmake/Caribou/TopologyConfig.cmake"
+  "cmake/Caribou/TopologyConfigVersion.cmake"
+  "src/Caribou/Topology/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "unittest/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "unittest/Caribou/Geometry/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "unittest/Caribou/Mechanics/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "bin/meshes/1D_linear.vtk"
+  "bin/meshes/1D_quadratic.vtk"
+  "bin/meshes/2D_quad_linear.vtk"
+  "bin/meshes/2D_quad_quadratic.vtk"
+  "bin/meshes/2D_triangle_linear.vtk"
+  "bin/meshes/2D_triangle_quadratic.vtk"
+  "bin/meshes/3D_hexahedron_linear.vtk"
+  "bin/meshes/3D_hexahedron_quadratic.vtk"
+  "bin/meshes/3D_quad_linear.vtk"
+  "bin/meshes/3D_quad_quadratic.vtk"
+  "bin/meshes/3D_tetrahedron_linear.vtk"
+  "bin/meshes/3D_tetrahedron_quadratic.vtk"
+  "bin/meshes/3D_triangle_linear.vtk"
+  "bin/meshes/3D_triangle_quadratic.vtk"
+  "bin/meshes/deformed_liver_surface.stl"
+  "bin/meshes/deformed_liver_volume_hexahedrons.vtu"
+  "bin/meshes/deformed_liver_volume_tetrahedrons.vtu"
+  "unittest/Caribou/Topology/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Benchmark/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "unittest/Caribou/Geometry/CMakeFiles/Caribou.unittests.Geometry.dir/DependInfo.cmake"
+  "unittest/Caribou/Mechanics/CMakeFiles/Caribou.unittests.Mechanics.dir/DependInfo.cmake"
+  "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/DependInfo.cmake"
+  )
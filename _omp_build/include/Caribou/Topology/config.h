@@ -0,0 +1,3 @@
+#pragma once
+
+/* #undef CARIBOU_WITH_VTK */
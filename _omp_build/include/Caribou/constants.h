@@ -0,0 +1,17 @@
+#ifndef CARIBOU_CONSTANTS_H
+#define CARIBOU_CONSTANTS_H
+
+namespace caribou {
+    const int Dynamic = -1;
+
+    const int Constant = 0;
+    const int Linear = 1;
+    const int Quadratic = 2;
+    const int Cubic = 3;
+
+    const int _1D = 1;
+    const int _2D = 2;
+    const int _3D = 3;
+}
+
+#endif //CARIBOU_CONSTANTS_H
@@ -0,0 +1,7 @@
+#ifndef CARIBOU_MACROS_H
+#define CARIBOU_MACROS_H
+
+#define IN_CLOSED_INTERVAL(a,x,b) (((x)-(a)) * ((x)-(b)) <= 0)
+#define IN_OPEN_INTERVAL(a,x,b) (((x)-(a)) * ((x)-(b)) < 0)
+
+#endif //CARIBOU_MACROS_H
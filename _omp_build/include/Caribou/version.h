@@ -0,0 +1,9 @@
+#pragma once
+
+#define CARIBOU_VERSION_STR "21.6.0"
+
+// We use version numbers based on the date: yy.mm.pp (year, month, patch).
+// - CARIBOU_VERSION / 10000 is the year number
+// - CARIBOU_VERSION / 100 % 100 is the month number
+// - CARIBOU_VERSION % 100 is the patch number
+#define CARIBOU_VERSION 2160
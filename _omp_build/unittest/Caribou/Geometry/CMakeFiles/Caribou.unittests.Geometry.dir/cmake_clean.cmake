@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../bin/Caribou.unittests.Geometry"
+  "../../../bin/Caribou.unittests.Geometry.pdb"
+  "CMakeFiles/Caribou.unittests.Geometry.dir/main.cpp.o"
+  "CMakeFiles/Caribou.unittests.Geometry.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Caribou.unittests.Geometry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
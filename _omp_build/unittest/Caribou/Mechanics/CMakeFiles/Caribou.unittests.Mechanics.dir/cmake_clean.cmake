@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../bin/Caribou.unittests.Mechanics"
+  "../../../bin/Caribou.unittests.Mechanics.pdb"
+  "CMakeFiles/Caribou.unittests.Mechanics.dir/main.cpp.o"
+  "CMakeFiles/Caribou.unittests.Mechanics.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Caribou.unittests.Mechanics.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
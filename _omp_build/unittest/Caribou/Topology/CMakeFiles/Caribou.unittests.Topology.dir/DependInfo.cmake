@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/unittest/Caribou/Topology/Grid/Grid.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/Grid/Grid.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/Grid/Grid.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/main.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/main.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/main.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/test_barycentric_container.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_barycentric_container.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_barycentric_container.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/test_bounding_volume_hierarchy.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_bounding_volume_hierarchy.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_bounding_volume_hierarchy.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/test_domain.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_domain.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_domain.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/test_element_coloring.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_element_coloring.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_element_coloring.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/test_hashgrid.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_hashgrid.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_hashgrid.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/test_mesh.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_mesh.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_mesh.cpp.o.d"
+  "/root/repo/unittest/Caribou/Topology/test_reordering.cpp" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_reordering.cpp.o" "gcc" "unittest/Caribou/Topology/CMakeFiles/Caribou.unittests.Topology.dir/test_reordering.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,27 @@
+file(REMOVE_RECURSE
+  "../../../bin/Caribou.unittests.Topology"
+  "../../../bin/Caribou.unittests.Topology.pdb"
+  "CMakeFiles/Caribou.unittests.Topology.dir/Grid/Grid.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/Grid/Grid.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/main.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/main.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_barycentric_container.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_barycentric_container.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_bounding_volume_hierarchy.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_bounding_volume_hierarchy.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_domain.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_domain.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_element_coloring.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_element_coloring.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_hashgrid.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_hashgrid.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_mesh.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_mesh.cpp.o.d"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_reordering.cpp.o"
+  "CMakeFiles/Caribou.unittests.Topology.dir/test_reordering.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Caribou.unittests.Topology.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <Eigen/Core>
+
+namespace caribou::algebra {
+
+/**
+ * Symmetric N x N matrix of which only the upper triangle (including the diagonal) is stored.
+ *
+ * The N(N+1)/2 entries of the upper triangle are packed row by row into a contiguous vector, which halves the memory
+ * footprint of a dense symmetric matrix and the amount of memory read by a matrix-vector product.
+ *
+ * Example:
+ * \code{.cpp}
+ * Eigen::Matrix<double, 24, 24> K = ...; // Only its upper triangle is read
+ * PackedSymmetricMatrix<24, double> packed (K);
+ * Eigen::Matrix<double, 24, 1> f = packed * u; // Same as K.selfadjointView<Eigen::Upper>() * u
+ * \endcode
+ */
+template <int N, typename Real>
+class PackedSymmetricMatrix {
+public:
+    static constexpr Eigen::Index Size = N;
+    static constexpr Eigen::Index NumberOfEntries = N*(N+1)/2;
+
+    using Vector = Eigen::Matrix<Real, N, 1>;
+    using Matrix = Eigen::Matrix<Real, N, N, Eigen::RowMajor>;
+
+    PackedSymmetricMatrix() : p_entries(Eigen::Matrix<Real, NumberOfEntries, 1>::Zero()) {}
+
+    /** Packs the upper triangle of the given matrix. Its lower triangle is never read. */
+    template <typename Derived>
+    explicit PackedSymmetricMatrix(const Eigen::MatrixBase<Derived> & m) {
+        for (Eigen::Index i = 0; i < N; ++i) {
+            for (Eigen::Index j = i; j < N; ++j) {
+                p_entries[index(i, j)] = m(i, j);
+            }
+        }
+    }
+
+    /** Position of the entry (i, j), i <= j, inside the packed vector of entries. */
+    static constexpr auto index(const Eigen::Index & i, const Eigen::Index & j) -> Eigen::Index {
+        return i*N - (i*(i-1))/2 + (j-i);
+    }
+
+    /** Entry (i, j) of the matrix. Since the matrix is symmetric, (i, j) and (j, i) are the same entry. */
+    inline auto operator()(const Eigen::Index & i, const Eigen::Index & j) const -> const Real & {
+        return (i <= j) ? p_entries[index(i, j)] : p_entries[index(j, i)];
+    }
+
+    /** Entry (i, j) of the matrix. Since the matrix is symmetric, (i, j) and (j, i) are the same entry. */
+    inline auto operator()(const Eigen::Index & i, const Eigen::Index & j) -> Real & {
+        return (i <= j) ? p_entries[index(i, j)] : p_entries[index(j, i)];
+    }
+
+    /**
+     * Dense R x C block of the matrix starting at the entry (i, j). Its entries are read directly from the packed
+     * vector, hence the full matrix is never unpacked.
+     */
+    template <int R, int C>
+    auto block(const Eigen::Index & i, const Eigen::Index & j) const -> Eigen::Matrix<Real, R, C> {
+        Eigen::Matrix<Real, R, C> b;
+        for (Eigen::Index m = 0; m < R; ++m) {
+            for (Eigen::Index n = 0; n < C; ++n) {
+                b(m, n) = (*this)(i+m, j+n);
+            }
+        }
+        return b;
+    }
+
+    /** Dense matrix containing the upper triangle of this matrix. Its strictly lower triangle is filled with zeros. */
+    auto upper_triangle() const -> Matrix {
+        Matrix m = Matrix::Zero();
+        for (Eigen::Index i = 0; i < N; ++i) {
+            for (Eigen::Index j = i; j < N; ++j) {
+                m(i, j) = p_entries[index(i, j)];
+            }
+        }
+        return m;
+    }
+
+    /** Dense symmetric matrix, both of its triangles being filled. */
+    auto matrix() const -> Matrix {
+        Matrix m;
+        for (Eigen::Index i = 0; i < N; ++i) {
+            for (Eigen::Index j = i; j < N; ++j) {
+                m(i, j) = m(j, i) = p_entries[index(i, j)];
+            }
+        }
+        return m;
+    }
+
+    /** Packed entries of the upper triangle, row by row. */
+    auto entries() const -> const Eigen::Matrix<Real, NumberOfEntries, 1> & {
+        return p_entries;
+    }
+
+    /** Symmetric matrix-vector product. Every stored entry is read once, and contributes twice when off-diagonal. */
+    template <typename Derived>
+    auto operator*(const Eigen::MatrixBase<Derived> & u) const -> Vector {
+        Vector f = Vector::Zero();
+        const Real * a = p_entries.data();
+        for (Eigen::Index i = 0; i < N; ++i) {
+            const Real ui = u[i];
+            Real fi = f[i] + (*a++)*ui;
+            for (Eigen::Index j = i+1; j < N; ++j) {
+                const Real aij = *a++;
+                fi   += aij*u[j];
+                f[j] += aij*ui;
+            }
+            f[i] = fi;
+        }
+        return f;
+    }
+
+private:
+    Eigen::Matrix<Real, NumberOfEntries, 1> p_entries;
+};
+
+} // namespace caribou::algebra
@@ -29,6 +29,12 @@ void declare_barycentric_container(py::class_<BarycentricContainer<Domain>> & c)
 
     }, py::arg("container_field_values"));
 
+    c.def("update_embedded_points", [](BarycentricContainer<Domain> & container,
+                                       const Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic> & embedded_points,
+                                       const UNSIGNED_INTEGER_TYPE & maximum_number_of_steps) {
+        container.update_embedded_points(embedded_points, maximum_number_of_steps);
+    }, py::arg("embedded_points"), py::arg("maximum_number_of_steps") = 16);
+
     c.def_property_readonly("outside_nodes", [](const BarycentricContainer<Domain> & container){
         return container.outside_nodes();
     });
@@ -24,6 +24,17 @@ void declare_domain(pybind11::module & m, const std::string & name) {
     c.def("element_indices", &D::element_indices, py::arg("index"));
     c.def("mesh", &D::mesh, py::return_value_policy::reference);
 
+    c.def("node_elements", [](const D & domain, const UNSIGNED_INTEGER_TYPE & node_id) {
+        return Eigen::Matrix<UNSIGNED_INTEGER_TYPE, Eigen::Dynamic, 1>(domain.node_elements(node_id));
+    }, py::arg("node_id"));
+
+    if constexpr (geometry::element_has_boundaries_v<Element>) {
+        c.def("face_neighbors", [](const D & domain, const UNSIGNED_INTEGER_TYPE & element_id) {
+            return Eigen::Matrix<INTEGER_TYPE, Eigen::Dynamic, 1>(domain.face_neighbors(element_id));
+        }, py::arg("element_id"));
+        c.def("boundary_faces", &D::boundary_faces);
+    }
+
     // Mesh's add_domain binding for Domain<Element, NodeIndex> type
     m.def("add_domain", [](BaseMesh & mesh, const std::string & domain_name, const Element &, const Eigen::Matrix<NodeIndex, Eigen::Dynamic, geometry::traits<Element>::NumberOfNodesAtCompileTime> & node_indices) {
         auto d = new Domain<Element, NodeIndex>(nullptr, node_indices);
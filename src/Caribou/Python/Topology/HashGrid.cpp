@@ -25,8 +25,15 @@ auto grid(py::module & m, const std::string & name) {
     py::class_<HashGrid<Element>> o(m, name.c_str());
     o.def(py::init<FLOATING_POINT_TYPE>(), py::arg("cell_size"));
     o.def(py::init<FLOATING_POINT_TYPE, UNSIGNED_INTEGER_TYPE>(), py::arg("cell_size"), py::arg("number_of_elements"));
-    o.def("add", &HashGrid<Element>::add);
-    o.def("get", &HashGrid<Element>::get, py::arg("p"));
+    o.def("add", [](HashGrid<Element> & self, const Element & e, const UNSIGNED_INTEGER_TYPE & id) {
+        self.add(e, id);
+    }, py::arg("e"), py::arg("id"));
+    o.def("build", &HashGrid<Element>::build);
+    o.def("get", [](const HashGrid<Element> & self, const typename HashGrid<Element>::WorldCoordinates & p) {
+        return self.get(p);
+    }, py::arg("p"));
+    o.def("cell_size", &HashGrid<Element>::cell_size);
+    o.def("number_of_cells", &HashGrid<Element>::number_of_cells);
     return o;
 }
 
@@ -118,6 +118,34 @@ class TestDomain(unittest.TestCase):
         analytic_solution = 100
         self.assertAlmostEqual(numerical_solution, analytic_solution, delta=1e-10)
 
+    def test_adjacency(self):
+        m = meshio.read(os.path.join(meshfolder, '3D_tetrahedron_linear.vtk'))
+        mesh = Mesh(m.points)
+
+        if type(m.cells) == dict:
+            cells = m.cells['tetra']
+        else:
+            cells = m.cells_dict['tetra']
+
+        domain = mesh.add_domain("tetrahedrons", Tetrahedron(), cells)
+
+        # Node to elements
+        for element_id in [0, len(cells)-1]:
+            for node_id in cells[element_id]:
+                self.assertIn(element_id, domain.node_elements(node_id))
+
+        # Each face is either shared by two elements, or on the boundary
+        boundary_faces = domain.boundary_faces()
+        number_of_shared_faces = 0
+        for element_id in range(domain.number_of_elements()):
+            for face_id, neighbor_id in enumerate(domain.face_neighbors(element_id)):
+                if neighbor_id < 0:
+                    self.assertTrue(((boundary_faces[:, 0] == element_id) & (boundary_faces[:, 1] == face_id)).any())
+                else:
+                    self.assertIn(element_id, domain.face_neighbors(neighbor_id))
+                    number_of_shared_faces += 1
+        self.assertEqual(number_of_shared_faces + len(boundary_faces), 4*domain.number_of_elements())
+
     def test_barycentric_mapping(self):
         m = meshio.read(os.path.join(meshfolder, '3D_tetrahedron_quadratic.vtk'))
         mesh = Mesh(m.points)
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
@@ -8,6 +11,8 @@
 #include <Caribou/macros.h>
 #include <Caribou/constants.h>
 #include <Caribou/Topology/Domain.h>
+#include <Caribou/Topology/BoundingVolumeHierarchy.h>
+#include <Caribou/Topology/ElementLocator.h>
 #include <Caribou/Topology/HashGrid.h>
 
 namespace caribou::topology {
@@ -34,6 +39,7 @@ public:
     using LocalCoordinates = typename ContainerElement::LocalCoordinates;
     using WorldCoordinates = typename ContainerElement::WorldCoordinates;
     using HashGridT = HashGrid<ContainerElement>;
+    using BoundingVolumeHierarchyT = BoundingVolumeHierarchy<ContainerElement>;
 
     /**
      * A barycentric point is a structure that contains the element index and
@@ -65,10 +71,12 @@ public:
      * @param container_domain The mesh domain that will contain the embedded meshes.
      * @param embedded_points The positions (in world coordinates) embedded in the container mesh for which the barycentric
      *                        points have to be found.
+     * @param locator The spatial index used to find the elements containing the embedded points.
      */
     template <typename Derived>
-    BarycentricContainer(const Domain * container_domain, const Eigen::MatrixBase<Derived> & embedded_points)
-    : BarycentricContainer(container_domain) {
+    BarycentricContainer(const Domain * container_domain, const Eigen::MatrixBase<Derived> & embedded_points,
+                         const ElementLocator & locator = ElementLocator::HashGrid)
+    : BarycentricContainer(container_domain, locator) {
         // Set the embedded points
         set_embedded_points(embedded_points);
     }
@@ -79,31 +87,19 @@ public:
      * be set to the mean size of the container elements.
      *
      * @param container_domain The mesh domain that will contain the embedded nodes.
+     * @param locator The spatial index used to find the elements containing the embedded points.
      */
-    explicit BarycentricContainer(const Domain * container_domain)
+    explicit BarycentricContainer(const Domain * container_domain, const ElementLocator & locator = ElementLocator::HashGrid)
         : p_container_domain(container_domain) {
         if (container_domain->number_of_elements() == 0) {
             throw std::runtime_error("Trying to create a barycentric container from an empty domain.");
         }
 
-        // Get the mean size of the elements
-        using Scalar = typename WorldCoordinates::Scalar;
-        WorldCoordinates H_mean = WorldCoordinates::Zero();
-        const auto number_of_elements = container_domain->number_of_elements();
-        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
-            const ContainerElement element = container_domain->element(element_id);
-            const auto element_nodes = element.nodes();
-            const auto min = element_nodes.colwise().minCoeff();
-            const auto max = element_nodes.colwise().maxCoeff();
-            H_mean += (max - min);
-        }
-        H_mean /= static_cast<Scalar>(container_domain->number_of_elements());
-
-        // Create the Hash grid
-        p_hash_grid = std::make_unique<HashGridT>(H_mean.maxCoeff(), container_domain->number_of_elements());
-
-        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < container_domain->number_of_elements(); ++element_id) {
-            p_hash_grid->add(container_domain->element(element_id), element_id);
+        if (locator == ElementLocator::BoundingVolumeHierarchy) {
+            p_bounding_volume_hierarchy = std::make_unique<BoundingVolumeHierarchyT>(container_domain);
+        } else {
+            // Create the Hash grid, its cells having the mean size of the elements
+            p_hash_grid = std::make_unique<HashGridT>(container_domain);
         }
     }
 
@@ -119,9 +115,19 @@ public:
      *          an edge or a node of the domain), the first element found containing the point will be return.
      */
     auto barycentric_point(const WorldCoordinates & p) const -> BarycentricPoint {
-        // List of candidate elements that could contain the point
-        const auto candidate_element_indices = p_hash_grid->get(p);
+        std::vector<UNSIGNED_INTEGER_TYPE> candidate_element_indices;
+        return barycentric_point(p, candidate_element_indices);
+    }
 
+    /**
+     * Get an element that contains the given point (in world coordinates) and its local coordinates within this element.
+     *
+     * Same as BarycentricContainer::barycentric_point(const WorldCoordinates &), but the candidate elements that could
+     * contain the point are written into the given buffer, which can be reused between queries to avoid allocations.
+     */
+    auto barycentric_point(const WorldCoordinates & p, std::vector<UNSIGNED_INTEGER_TYPE> & candidate_element_indices) const -> BarycentricPoint {
+        // List of candidate elements that could contain the point
+        candidate_elements(p, candidate_element_indices);
 
         for (const auto & element_index : candidate_element_indices) {
             const ContainerElement e = p_container_domain->element(element_index);
@@ -141,7 +147,8 @@ public:
      */
     auto closest_elements(const WorldCoordinates & p) const -> std::vector<BarycentricPoint> {
         // List of candidate elements that could contain the point
-        const auto candidate_element_indices = p_hash_grid->get(p);
+        std::vector<UNSIGNED_INTEGER_TYPE> candidate_element_indices;
+        candidate_elements(p, candidate_element_indices);
 
         std::vector<BarycentricPoint> closest_elements;
         closest_elements.reserve(candidate_element_indices.size());
@@ -154,6 +161,74 @@ public:
         return closest_elements;
     }
 
+    /**
+     * Update the barycentric points of the embedded nodes after they moved.
+     *
+     * Instead of locating every node from scratch, each node walks from the element that contained it toward its new
+     * position, crossing at each step the face of the current element behind which the node lies the furthest (in
+     * the local coordinates of the element), until an element containing the node is reached. The global locator
+     * (hash grid or bounding volume hierarchy) is only used for nodes that were outside of the domain, that walked out
+     * of the domain or that were not found after visiting maximum_number_of_steps elements. For small displacements,
+     * the update is therefore linear in the number of embedded nodes.
+     *
+     * @param embedded_points The new positions (in world coordinates) of the embedded nodes, in the same order as the
+     *                        ones given when constructing the container.
+     * @param maximum_number_of_steps The maximum number of elements visited by the walk of a node.
+     *
+     * \note The walk requires the face adjacency of the container domain (see Domain::face_neighbors), which is
+     *       computed on the first update. For elements having no boundary elements, or when the dimension of the
+     *       elements is lower than the dimension of the world (e.g. triangles in 3D), the nodes are located from
+     *       scratch.
+     * \note When a node lies on a face shared by two elements, the element found by the walk can differ from the one
+     *       that would have been found by the global locator (both containing the node).
+     */
+    template <typename Derived>
+    void update_embedded_points(const Eigen::MatrixBase<Derived> & embedded_points, const UNSIGNED_INTEGER_TYPE & maximum_number_of_steps = 16) {
+        if (static_cast<std::size_t>(embedded_points.rows()) != p_barycentric_points.size()) {
+            throw std::runtime_error("Trying to update the " + std::to_string(p_barycentric_points.size()) +
+                                     " embedded points of a barycentric container with " +
+                                     std::to_string(embedded_points.rows()) + " points.");
+        }
+
+        if constexpr (not geometry::element_has_boundaries_v<ContainerElement> or ContainerElement::CanonicalDimension != Dimension) {
+            set_embedded_points(embedded_points);
+        } else {
+            if (Eigen::MatrixBase<Derived>::ColsAtCompileTime == Eigen::Dynamic and embedded_points.cols() != Dimension) {
+                throw std::runtime_error("Trying to get the barycentric coordinates of " +
+                                         std::to_string(embedded_points.cols()) + "D points from a " +
+                                         std::to_string(Dimension) + "D domain");
+            }
+
+            const auto number_of_embedded_points = static_cast<std::ptrdiff_t>(p_barycentric_points.size());
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp parallel
+#endif
+            {
+                std::vector<UNSIGNED_INTEGER_TYPE> candidate_element_indices;
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp for schedule(dynamic, 1024)
+#endif
+                for (std::ptrdiff_t node_id = 0; node_id < number_of_embedded_points; ++node_id) {
+                    const WorldCoordinates p = embedded_points.row(node_id).template cast<typename WorldCoordinates::Scalar>().transpose();
+                    auto & bp = p_barycentric_points[static_cast<std::size_t>(node_id)];
+                    if (bp.element_index >= 0) {
+                        bp = walk(p, bp.element_index, maximum_number_of_steps);
+                    }
+                    if (bp.element_index < 0) {
+                        bp = barycentric_point(p, candidate_element_indices);
+                    }
+                }
+            }
+
+            p_outside_nodes.resize(0);
+            for (std::size_t node_id = 0; node_id < p_barycentric_points.size(); ++node_id) {
+                if (p_barycentric_points[node_id].element_index < 0) {
+                    p_outside_nodes.emplace_back(node_id);
+                }
+            }
+        }
+    }
+
     /**
      * Interpolate a field (scalar or vector field) from the container domain to the embedded nodes.
      *
@@ -247,6 +322,15 @@ public:
     }
 
 private:
+    /** Write the (sorted) indices of the elements that could contain the point p into the given buffer. */
+    inline void candidate_elements(const WorldCoordinates & p, std::vector<UNSIGNED_INTEGER_TYPE> & elements) const {
+        if (p_bounding_volume_hierarchy) {
+            p_bounding_volume_hierarchy->get(p, elements);
+        } else {
+            p_hash_grid->get(p, elements);
+        }
+    }
+
     /**
      * Set the barycentric points from a set of positions embedded inside the container domain.
      * @tparam Derived NXD Eigen matrix representing the D dimensional coordinates of the N embedded positions.
@@ -255,6 +339,8 @@ private:
      * \note When an embedded position lie completely outside the container mesh (i.e. it is not contained inside any
      *       container element), its index will be added to the list of outside nodes and it will be ignored by future
      *       interpolation calls.
+     * \note The points are located in parallel (when compiled with OpenMP), in the order of the Morton code of their
+     *       cell. The result is the same as the one of a serial loop over barycentric_point.
      */
     template <typename Derived>
     void set_embedded_points(const Eigen::MatrixBase<Derived> & embedded_points) {
@@ -266,21 +352,118 @@ private:
                                      std::to_string(Dimension) + "D domain");
         }
 
+        const auto number_of_embedded_points = static_cast<std::size_t>(embedded_points.rows());
+        p_barycentric_points.resize(number_of_embedded_points);
+
+        // Visit the points sorted by the Morton code of their cell, such that consecutive queries (and threads) hit
+        // the same elements of the container while their nodes are still in cache
+        const auto cell_size = sorting_cell_size();
+        std::vector<std::pair<typename HashGridT::Key, UNSIGNED_INTEGER_TYPE>> order (number_of_embedded_points);
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(number_of_embedded_points); ++i) {
+            const WorldCoordinates p = embedded_points.row(i).template cast<typename WorldCoordinates::Scalar>().transpose();
+            const typename HashGridT::GridCoordinates cell = (p / cell_size).unaryExpr(CwiseFloor()).template cast<INTEGER_TYPE>();
+            order[static_cast<std::size_t>(i)] = {HashGridT::cell_key(cell), static_cast<UNSIGNED_INTEGER_TYPE>(i)};
+        }
+        std::sort(order.begin(), order.end());
+
+        // Each point is located independently of the others: the candidates are sorted by element index and the first
+        // one containing the point wins, hence the result does not depend on the number of threads
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp parallel
+#endif
+        {
+            std::vector<UNSIGNED_INTEGER_TYPE> candidate_element_indices;
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp for schedule(dynamic, 1024)
+#endif
+            for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(number_of_embedded_points); ++i) {
+                const auto & node_id = order[static_cast<std::size_t>(i)].second;
+                p_barycentric_points[node_id] = barycentric_point(embedded_points.row(static_cast<Eigen::Index>(node_id)).template cast<typename WorldCoordinates::Scalar>(), candidate_element_indices);
+            }
+        }
+
         p_outside_nodes.resize(0);
-        p_outside_nodes.reserve(static_cast<std::size_t>(std::floor(embedded_points.rows() / 10.))); // Reserve 10% of the mesh size for outside nodes
+        for (std::size_t node_id = 0; node_id < number_of_embedded_points; ++node_id) {
+            if (p_barycentric_points[node_id].element_index < 0) {
+                p_outside_nodes.emplace_back(node_id);
+            }
+        }
+    }
 
-        p_barycentric_points.resize(0);
-        p_barycentric_points.reserve(embedded_points.rows());
+    /**
+     * Walk from the given element toward the point p through the face neighbors of the container domain.
+     * Returns an element index of -1 if the walk left the domain or did not reach p in maximum_number_of_steps.
+     */
+    auto walk(const WorldCoordinates & p, ElementIndex element_index, const UNSIGNED_INTEGER_TYPE & maximum_number_of_steps) const -> BarycentricPoint {
+        const auto & faces = reference_faces();
+        for (UNSIGNED_INTEGER_TYPE step = 0; step < maximum_number_of_steps and element_index >= 0; ++step) {
+            const ContainerElement e = p_container_domain->element(static_cast<UNSIGNED_INTEGER_TYPE>(element_index));
+            const LocalCoordinates local_coordinates = e.local_coordinates(p);
+            if (e.contains_local(local_coordinates)) {
+                return {element_index, local_coordinates};
+            }
 
-        const auto number_of_embedded_points = embedded_points.rows();
-        for (Eigen::Index node_id = 0; node_id < number_of_embedded_points; ++node_id) {
-            const BarycentricPoint bp = barycentric_point(embedded_points.row(node_id).template cast<typename WorldCoordinates::Scalar>());
-            if (bp.element_index < 0) {
-                p_outside_nodes.emplace_back(node_id);
+            // Cross the face behind which the point lies the furthest
+            std::size_t exit_face = 0;
+            FLOATING_POINT_TYPE exit_distance = std::numeric_limits<FLOATING_POINT_TYPE>::lowest();
+            for (std::size_t face_id = 0; face_id < faces.size(); ++face_id) {
+                const FLOATING_POINT_TYPE distance = faces[face_id].first.dot(local_coordinates) - faces[face_id].second;
+                if (distance > exit_distance) {
+                    exit_distance = distance;
+                    exit_face = face_id;
+                }
             }
 
-            p_barycentric_points.emplace_back(bp);
+            element_index = p_container_domain->face_neighbors(static_cast<UNSIGNED_INTEGER_TYPE>(element_index))[static_cast<Eigen::Index>(exit_face)];
         }
+
+        return {-1, LocalCoordinates::Zero()};
+    }
+
+    /**
+     * Planes of the faces of the reference (canonical) element, in local coordinates. For each face, the pair
+     * (n, d) is such that n.dot(xi) - d is the distance of the local coordinates xi to the face, positive outside.
+     */
+    static auto reference_faces() -> const std::vector<std::pair<LocalCoordinates, FLOATING_POINT_TYPE>> & {
+        static const auto faces = [] {
+            const ContainerElement reference;
+            const LocalCoordinates center = reference.nodes().colwise().mean().transpose();
+            std::vector<std::pair<LocalCoordinates, FLOATING_POINT_TYPE>> planes;
+            for (const auto & face_nodes : reference.boundary_elements_node_indices()) {
+                // The first nodes of a face are corners of the reference element
+                const LocalCoordinates p0 = reference.nodes().row(face_nodes[0]).transpose();
+                const LocalCoordinates e1 = reference.nodes().row(face_nodes[1]).transpose() - p0;
+                LocalCoordinates n;
+                if constexpr (Dimension == 3) {
+                    const LocalCoordinates e2 = reference.nodes().row(face_nodes[2]).transpose() - p0;
+                    n = e1.cross(e2);
+                } else {
+                    n << e1[1], -e1[0];
+                }
+                n.normalize();
+                if (n.dot(center - p0) > 0) {
+                    n = -n;
+                }
+                planes.emplace_back(n, n.dot(p0));
+            }
+            return planes;
+        }();
+        return faces;
+    }
+
+    /** Size of the cells used to sort the embedded points by locality. */
+    inline auto sorting_cell_size() const -> FLOATING_POINT_TYPE {
+        if (p_hash_grid) {
+            return p_hash_grid->cell_size();
+        }
+
+        // Split the bounding box of the domain in (at most) 1024 cells per axis
+        const auto & nodes = p_bounding_volume_hierarchy->nodes();
+        const FLOATING_POINT_TYPE extent = nodes.empty() ? 0 : nodes.front().bounding_box.sizes().maxCoeff();
+        return (extent > 0) ? extent / 1024 : 1;
     }
 
 
@@ -288,6 +471,7 @@ private:
     std::vector<BarycentricPoint> p_barycentric_points;
     std::vector<UNSIGNED_INTEGER_TYPE> p_outside_nodes;
     std::unique_ptr<HashGridT> p_hash_grid;
+    std::unique_ptr<BoundingVolumeHierarchyT> p_bounding_volume_hierarchy;
 };
 
 } // namespace caribou::topology
\ No newline at end of file
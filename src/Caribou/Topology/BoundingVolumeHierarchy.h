@@ -0,0 +1,390 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <Caribou/constants.h>
+#include <Caribou/Geometry/Element.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+namespace caribou::topology {
+
+/**
+ * Bounding volume hierarchy (axis-aligned bounding box tree) of the elements of a domain.
+ *
+ * Contrary to the HashGrid, which uses cells of a single size, the tree adapts to the local size of the elements. It
+ * hence stays efficient on meshes having strongly graded element sizes, where the cells of a hash grid would contain
+ * many small elements or overlap many large ones.
+ *
+ * The nodes of the tree are stored in a flat array where the children of a node are always stored after it, and the
+ * leaves hold at most MaximumNumberOfElementsPerLeaf elements. The bounding boxes can be refitted after the nodes of
+ * the domain moved, without rebuilding the tree.
+ *
+ * Example:
+ * \code{.cpp}
+ * BoundingVolumeHierarchy<Tetrahedron> bvh (domain);
+ * std::vector<UNSIGNED_INTEGER_TYPE> candidates;
+ * bvh.get(p, candidates); // Elements whose bounding box contains p
+ * ...
+ * bvh.refit(domain, deformed_positions);
+ * \endcode
+ */
+template <typename Element>
+class BoundingVolumeHierarchy {
+public:
+    static constexpr UNSIGNED_INTEGER_TYPE Dimension = caribou::geometry::traits<Element>::Dimension;
+    static constexpr UNSIGNED_INTEGER_TYPE MaximumNumberOfElementsPerLeaf = 4;
+
+    using Index = UNSIGNED_INTEGER_TYPE;
+    using WorldCoordinates = Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1>;
+    using BoundingBox = Eigen::AlignedBox<FLOATING_POINT_TYPE, static_cast<int>(Dimension)>;
+
+    /** Method used to split the elements of a node between its two children. */
+    enum class SplitMethod : unsigned int {
+        /** Split at the median of the element centers along the largest axis of the node. */
+        Median = 0,
+
+        /**
+         * Split along the plane minimizing the surface area heuristic (sum over both children of their bounding box
+         * area times their number of elements), found among a fixed number of bins on each axis.
+         */
+        SAH = 1
+    };
+
+    struct Node {
+        BoundingBox bounding_box;
+        Index first; ///< Index of the first child (internal node), or of the first element in p_element_indices (leaf)
+        Index number_of_elements; ///< 0 for internal nodes
+    };
+
+    /**
+     * Build the hierarchy of all the elements of a domain, using their index within the domain as identifier.
+     *
+     * The bounding boxes of the elements are computed in parallel, and the large sub-trees are built concurrently
+     * (when compiled with OpenMP).
+     */
+    template <typename Domain>
+    explicit BoundingVolumeHierarchy(const Domain * domain, const SplitMethod & split_method = SplitMethod::SAH)
+    : p_split_method(split_method) {
+        static_assert(std::is_same_v<typename Domain::ElementType, Element>,
+                      "The elements of the domain must have the same type as the elements of the hierarchy.");
+        build([domain](const Index & element_id) {
+            return domain->element(element_id);
+        }, domain->number_of_elements());
+    }
+
+    /**
+     * Recompute the bounding boxes of the hierarchy from the current positions of the domain nodes, without changing
+     * its structure. The domain must be the one used to build the hierarchy.
+     */
+    template <typename Domain>
+    void refit(const Domain * domain) {
+        refit_bounding_boxes([domain](const Index & element_id) {
+            return domain->element(element_id);
+        });
+    }
+
+    /**
+     * Recompute the bounding boxes of the hierarchy from the given positions of the domain nodes (one node per row),
+     * without changing its structure. The domain must be the one used to build the hierarchy.
+     */
+    template <typename Domain, typename EigenMatrix>
+    void refit(const Domain * domain, const Eigen::DenseBase<EigenMatrix> & positions) {
+        refit_bounding_boxes([domain, &positions](const Index & element_id) {
+            return domain->element(element_id, positions);
+        });
+    }
+
+    /**
+     * Get the elements whose bounding box contains the point p (sorted). Note that the returned elements do not
+     * ensure that the point p resides inside of them. One has to further check each ones of them with an
+     * intersection test.
+     *
+     * The candidate elements are written in the given buffer, which is cleared first. Its memory is reused, such that
+     * no allocation is done once the buffer is large enough.
+     */
+    inline
+    void get(const WorldCoordinates & p, std::vector<Index> & elements) const {
+        elements.clear();
+        if (not p_nodes.empty()) {
+            collect(0, p, elements);
+        }
+        std::sort(elements.begin(), elements.end());
+    }
+
+    /**
+     * Get the elements whose bounding box contains the point p (sorted).
+     * See BoundingVolumeHierarchy::get(const WorldCoordinates &, std::vector<Index> &).
+     */
+    inline
+    auto get(const WorldCoordinates & p) const -> std::vector<Index> {
+        std::vector<Index> elements;
+        get(p, elements);
+        return elements;
+    }
+
+    /**
+     * Get the candidate elements of a batch of points (one point per row), the points being located in parallel
+     * (when compiled with OpenMP).
+     */
+    template <typename Derived>
+    auto get_batch(const Eigen::MatrixBase<Derived> & points) const -> std::vector<std::vector<Index>> {
+        const auto number_of_points = static_cast<std::ptrdiff_t>(points.rows());
+        std::vector<std::vector<Index>> elements (static_cast<std::size_t>(number_of_points));
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t i = 0; i < number_of_points; ++i) {
+            get(points.row(i).transpose().template cast<FLOATING_POINT_TYPE>(), elements[static_cast<std::size_t>(i)]);
+        }
+        return elements;
+    }
+
+    /** Nodes of the hierarchy, the root node being the first one. */
+    [[nodiscard]]
+    inline auto nodes() const -> const std::vector<Node> & {
+        return p_nodes;
+    }
+
+private:
+    static constexpr UNSIGNED_INTEGER_TYPE NumberOfBins = 12;
+
+    // Sub-trees having more elements than this are built in a separate task
+    static constexpr Index MinimumNumberOfElementsPerTask = 1024;
+
+    template <typename ElementAt>
+    void build(ElementAt && element_at, const Index & number_of_elements) {
+        p_nodes.clear();
+        p_element_indices.resize(number_of_elements);
+        if (number_of_elements == 0) {
+            return;
+        }
+
+        // Bounding boxes and centers of the elements
+        const auto n = static_cast<std::ptrdiff_t>(number_of_elements);
+        p_element_bounding_boxes.resize(number_of_elements);
+        std::vector<WorldCoordinates> centers (number_of_elements);
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t i = 0; i < n; ++i) {
+            const auto element_id = static_cast<Index>(i);
+            p_element_bounding_boxes[element_id] = bounding_box_of(element_at(element_id));
+            centers[element_id] = p_element_bounding_boxes[element_id].center();
+            p_element_indices[element_id] = element_id;
+        }
+
+        // A binary tree with at least one element per leaf has at most 2n-1 nodes. The children of a node are
+        // allocated together, after their parent.
+        p_nodes.resize(2*number_of_elements - 1);
+        std::atomic<Index> number_of_nodes {1};
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel
+        #pragma omp single
+#endif
+        build_node(0, 0, number_of_elements, centers, number_of_nodes);
+
+        p_nodes.resize(number_of_nodes.load());
+    }
+
+    void build_node(const Index & node_id, const Index & begin, const Index & end,
+                    const std::vector<WorldCoordinates> & centers, std::atomic<Index> & number_of_nodes) {
+        auto & node = p_nodes[node_id];
+        node.bounding_box.setEmpty();
+        BoundingBox centers_bounding_box;
+        for (Index i = begin; i < end; ++i) {
+            node.bounding_box.extend(p_element_bounding_boxes[p_element_indices[i]]);
+            centers_bounding_box.extend(centers[p_element_indices[i]]);
+        }
+
+        const Index count = end - begin;
+        if (count <= MaximumNumberOfElementsPerLeaf) {
+            node.first = begin;
+            node.number_of_elements = count;
+            return;
+        }
+
+        const Index middle = split(begin, end, centers, centers_bounding_box);
+
+        const Index left = number_of_nodes.fetch_add(2);
+        node.first = left;
+        node.number_of_elements = 0;
+
+        if (count > MinimumNumberOfElementsPerTask) {
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp task firstprivate(left, begin, middle) shared(centers, number_of_nodes)
+#endif
+            build_node(left, begin, middle, centers, number_of_nodes);
+            build_node(left+1, middle, end, centers, number_of_nodes);
+#ifdef CARIBOU_WITH_OPENMP
+            #pragma omp taskwait
+#endif
+        } else {
+            build_node(left, begin, middle, centers, number_of_nodes);
+            build_node(left+1, middle, end, centers, number_of_nodes);
+        }
+    }
+
+    /**
+     * Partition the elements [begin, end) of a node and return the index of the first element of its second child.
+     * Both children always have at least one element.
+     */
+    auto split(const Index & begin, const Index & end,
+               const std::vector<WorldCoordinates> & centers, const BoundingBox & centers_bounding_box) -> Index {
+        const auto first = p_element_indices.begin() + static_cast<std::ptrdiff_t>(begin);
+        const auto last = p_element_indices.begin() + static_cast<std::ptrdiff_t>(end);
+
+        Eigen::Index axis;
+        const WorldCoordinates extent = centers_bounding_box.sizes();
+        extent.maxCoeff(&axis);
+
+        if (p_split_method == SplitMethod::SAH and extent[axis] > 0) {
+            const auto & lower = centers_bounding_box.min();
+            const auto bin_of = [&](const Index & element_id, const Eigen::Index & a) {
+                const auto b = static_cast<Index>(NumberOfBins * (centers[element_id][a] - lower[a]) / extent[a]);
+                return std::min(b, NumberOfBins - 1);
+            };
+
+            // Find the bin boundary minimizing the surface area heuristic over all axes
+            FLOATING_POINT_TYPE best_cost = std::numeric_limits<FLOATING_POINT_TYPE>::max();
+            Eigen::Index best_axis = -1;
+            Index best_bin = 0;
+            for (Eigen::Index a = 0; a < static_cast<Eigen::Index>(Dimension); ++a) {
+                if (extent[a] <= 0) {
+                    continue;
+                }
+
+                std::array<BoundingBox, NumberOfBins> bins;
+                std::array<Index, NumberOfBins> counts {};
+                for (auto & bin : bins) {
+                    bin.setEmpty();
+                }
+                for (auto it = first; it != last; ++it) {
+                    const auto b = bin_of(*it, a);
+                    bins[b].extend(p_element_bounding_boxes[*it]);
+                    ++counts[b];
+                }
+
+                // Area and number of elements on the right side of each bin boundary
+                std::array<FLOATING_POINT_TYPE, NumberOfBins> right_costs {};
+                BoundingBox right;
+                right.setEmpty();
+                Index right_count = 0;
+                for (Index b = NumberOfBins - 1; b > 0; --b) {
+                    right.extend(bins[b]);
+                    right_count += counts[b];
+                    right_costs[b] = (right_count > 0) ? area(right) * static_cast<FLOATING_POINT_TYPE>(right_count) : 0;
+                }
+
+                BoundingBox left;
+                left.setEmpty();
+                Index left_count = 0;
+                for (Index b = 1; b < NumberOfBins; ++b) {
+                    left.extend(bins[b-1]);
+                    left_count += counts[b-1];
+                    if (left_count == 0 or left_count == end - begin) {
+                        continue;
+                    }
+                    const auto cost = area(left) * static_cast<FLOATING_POINT_TYPE>(left_count) + right_costs[b];
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = a;
+                        best_bin = b;
+                    }
+                }
+            }
+
+            if (best_axis >= 0) {
+                const auto middle = std::partition(first, last, [&](const Index & element_id) {
+                    return bin_of(element_id, best_axis) < best_bin;
+                });
+                return begin + static_cast<Index>(middle - first);
+            }
+        }
+
+        // Median split along the largest axis (also used when the centers cannot be separated by the SAH)
+        const auto middle = first + (last - first) / 2;
+        std::nth_element(first, middle, last, [&centers, &axis](const Index & lhs, const Index & rhs) {
+            return centers[lhs][axis] < centers[rhs][axis];
+        });
+        return begin + static_cast<Index>(middle - first);
+    }
+
+    template <typename ElementAt>
+    void refit_bounding_boxes(ElementAt && element_at) {
+        const auto n = static_cast<std::ptrdiff_t>(p_element_bounding_boxes.size());
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t i = 0; i < n; ++i) {
+            p_element_bounding_boxes[static_cast<std::size_t>(i)] = bounding_box_of(element_at(static_cast<Index>(i)));
+        }
+
+        // Children are stored after their parent, hence a reverse traversal updates the children first
+        for (auto node = p_nodes.rbegin(); node != p_nodes.rend(); ++node) {
+            node->bounding_box.setEmpty();
+            if (node->number_of_elements > 0) {
+                for (Index i = node->first; i < node->first + node->number_of_elements; ++i) {
+                    node->bounding_box.extend(p_element_bounding_boxes[p_element_indices[i]]);
+                }
+            } else {
+                node->bounding_box.extend(p_nodes[node->first].bounding_box);
+                node->bounding_box.extend(p_nodes[node->first+1].bounding_box);
+            }
+        }
+    }
+
+    void collect(const Index & node_id, const WorldCoordinates & p, std::vector<Index> & elements) const {
+        const auto & node = p_nodes[node_id];
+        if (not contains(node.bounding_box, p)) {
+            return;
+        }
+
+        if (node.number_of_elements > 0) {
+            for (Index i = node.first; i < node.first + node.number_of_elements; ++i) {
+                const auto & element_id = p_element_indices[i];
+                if (contains(p_element_bounding_boxes[element_id], p)) {
+                    elements.emplace_back(element_id);
+                }
+            }
+        } else {
+            collect(node.first, p, elements);
+            collect(node.first+1, p, elements);
+        }
+    }
+
+    /** Bounding box containment test, with a tolerance of EPSILON such that points on the boundary are found. */
+    static inline auto contains(const BoundingBox & box, const WorldCoordinates & p) -> bool {
+        return ((p.array() >= box.min().array() - EPSILON).all() and (p.array() <= box.max().array() + EPSILON).all());
+    }
+
+    static inline auto bounding_box_of(const Element & e) -> BoundingBox {
+        const auto nodes = e.nodes();
+        return BoundingBox(nodes.colwise().minCoeff().transpose(), nodes.colwise().maxCoeff().transpose());
+    }
+
+    /** Surface area (3D), perimeter (2D) or length (1D) of a box, up to a constant factor. */
+    static inline auto area(const BoundingBox & box) -> FLOATING_POINT_TYPE {
+        const WorldCoordinates d = box.sizes();
+        if constexpr (Dimension == 1) {
+            return d[0];
+        } else if constexpr (Dimension == 2) {
+            return d[0] + d[1];
+        } else {
+            return d[0]*d[1] + d[1]*d[2] + d[2]*d[0];
+        }
+    }
+
+    SplitMethod p_split_method;
+    std::vector<Node> p_nodes;
+    std::vector<Index> p_element_indices; ///< Elements of the leaves, each leaf having a contiguous range
+    std::vector<BoundingBox> p_element_bounding_boxes;
+};
+
+} // namespace caribou::topology
@@ -5,9 +5,16 @@
 #include <Caribou/constants.h>
 #include <Caribou/Topology/BaseDomain.h>
 #include <Caribou/Topology/BarycentricContainer.h>
+#include <Caribou/Topology/ElementLocator.h>
 #include <Caribou/Geometry/Element.h>
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
+#include <utility>
 #include <vector>
 #include <array>
 
@@ -92,6 +99,24 @@ namespace caribou::topology {
          */
         using ElementIndices = Eigen::Matrix<NodeIndex, geometry::traits<Element>::NumberOfNodesAtCompileTime, 1>;
 
+        /*!
+         * The type of container that stores the indices of the face neighbors of a single element (one entry per
+         * boundary element of the element).
+         */
+        using ElementNeighbors = Eigen::Map<const Eigen::Matrix<INTEGER_TYPE, Eigen::Dynamic, 1>>;
+
+        /*!
+         * The type of container that stores the indices of the elements around a single node.
+         */
+        using NodeElements = Eigen::Map<const Eigen::Matrix<UNSIGNED_INTEGER_TYPE, Eigen::Dynamic, 1>>;
+
+        /*!
+         * The type of container that stores the boundary faces of the domain. Each row is a pair (element index,
+         * face index), the face index being the index of a boundary element of the element (see
+         * caribou::geometry::Element::boundary_elements_node_indices).
+         */
+        using BoundaryFaces = Eigen::Matrix<UNSIGNED_INTEGER_TYPE, Eigen::Dynamic, 2, Eigen::RowMajor>;
+
         /*! Empty constructor is prohibited */
         Domain() = delete;
 
@@ -164,16 +189,52 @@ namespace caribou::topology {
          */
         inline auto element_indices(const UNSIGNED_INTEGER_TYPE & index) const;
 
+        /*!
+         * Get the indices of the elements sharing a face with the given element.
+         *
+         * The i-th entry is the index of the element on the other side of the i-th boundary element (face) of the
+         * element (see caribou::geometry::Element::boundary_elements_node_indices), or -1 if this face is on the
+         * boundary of the domain. Two faces are shared when they have the same set of nodes. On a non-manifold
+         * domain (a face shared by more than two elements), only the first two elements are linked together.
+         *
+         * The face adjacency of the whole domain is computed on the first call, and cached for the next ones.
+         *
+         * \warning When the domain is constructed from an external buffer of indices, the cached adjacency is not
+         *          updated if this buffer is modified.
+         */
+        inline auto face_neighbors(const UNSIGNED_INTEGER_TYPE & element_id) const -> ElementNeighbors;
+
+        /*!
+         * Get the indices (in increasing order) of the elements containing the given node.
+         *
+         * The node to elements table of the whole domain is computed on the first call, and cached for the next ones.
+         * The returned vector is empty for a node that isn't used by any elements of the domain.
+         *
+         * \warning When the domain is constructed from an external buffer of indices, the cached table is not
+         *          updated if this buffer is modified.
+         */
+        inline auto node_elements(const UNSIGNED_INTEGER_TYPE & node_id) const -> NodeElements;
+
+        /*!
+         * Get the faces of the elements that are not shared with another element of the domain, ordered by element
+         * index, then by face index. See Domain::BoundaryFaces.
+         *
+         * The boundary faces are computed with the face neighbors (see Domain::face_neighbors) on the first call, and
+         * cached for the next ones.
+         */
+        inline auto boundary_faces() const -> const BoundaryFaces &;
+
         /**
          * Embed a set of nodes (in world coordinates) inside this domain. This will return a BarycentricContainer that
          * can be used to interpolate field values on these embedded nodes.
          * @tparam Derived NXD Eigen matrix representing the D dimensional coordinates of the N embedded points.
          * @param points The positions (in world coordinates) of the nodes embedded in this domain.
+         * @param locator The spatial index used to find the elements containing the embedded nodes.
          * @return A BarycentricContainer instance.
          */
         template <typename Derived>
-        inline auto embed(const Eigen::MatrixBase<Derived> & points) const -> BarycentricContainer<Domain> {
-            return {this, points};
+        inline auto embed(const Eigen::MatrixBase<Derived> & points, const ElementLocator & locator = ElementLocator::HashGrid) const -> BarycentricContainer<Domain> {
+            return {this, points, locator};
         }
 
         /*!
@@ -250,8 +311,45 @@ namespace caribou::topology {
             MapType temp (first.p_elements.data(), first.p_elements.rows(), first.p_elements.cols(), {first.p_elements.outerStride(), first.p_elements.innerStride()});
             new (&first.p_elements) MapType (second.p_elements.data(), second.p_elements.rows(), second.p_elements.cols(), {second.p_elements.outerStride(), second.p_elements.innerStride()});
             new (&second.p_elements) MapType (temp.data(), temp.rows(), temp.cols(), {temp.outerStride(), temp.innerStride()});
+
+            swap(first.p_node_elements_offsets, second.p_node_elements_offsets);
+            swap(first.p_node_elements, second.p_node_elements);
+            swap(first.p_face_neighbors, second.p_face_neighbors);
+            swap(first.p_boundary_faces, second.p_boundary_faces);
+            const bool node_elements_are_built = first.p_node_elements_are_built.load();
+            first.p_node_elements_are_built.store(second.p_node_elements_are_built.load());
+            second.p_node_elements_are_built.store(node_elements_are_built);
+            const bool faces_are_built = first.p_faces_are_built.load();
+            first.p_faces_are_built.store(second.p_faces_are_built.load());
+            second.p_faces_are_built.store(faces_are_built);
         }
 
+        /*!
+         * Call compute() once, the first time this is called with the given flag. Other threads asking for the same
+         * table wait until it has been computed.
+         */
+        template <typename Function>
+        inline void compute_once(std::atomic<bool> & is_computed, Function && compute) const {
+            if (not is_computed.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lock (p_adjacency_mutex);
+                if (not is_computed.load(std::memory_order_relaxed)) {
+                    compute();
+                    is_computed.store(true, std::memory_order_release);
+                }
+            }
+        }
+
+        /*!
+         * Compute the node to elements table (see Domain::node_elements).
+         */
+        void compute_node_elements() const;
+
+        /*!
+         * Compute the face neighbors of every elements and the boundary faces (see Domain::face_neighbors and
+         * Domain::boundary_faces).
+         */
+        void compute_faces() const;
+
         /// Pointer to the associated Mesh. This Domain instance should be part of one Mesh, where the latter could
         /// contains many Domain instances of different or same element types.
         const BaseMesh * p_mesh;
@@ -264,6 +362,23 @@ namespace caribou::topology {
         /// Actual pointer to the element indices. When the domain is constructed by copying an array of element
         /// indices, this map points to p_buffer. Else, it points to an external buffer.
         Eigen::Map<const ElementsIndices, Eigen::Unaligned, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>> p_elements;
+
+        /// Elements around the nodes (see Domain::node_elements) in a compressed row storage: the elements of the
+        /// node i are stored in p_node_elements, between the offsets p_node_elements_offsets[i] and
+        /// p_node_elements_offsets[i+1]. Computed on the first access.
+        mutable std::vector<UNSIGNED_INTEGER_TYPE> p_node_elements_offsets;
+        mutable std::vector<UNSIGNED_INTEGER_TYPE> p_node_elements;
+        mutable std::atomic<bool> p_node_elements_are_built {false};
+
+        /// Face neighbors of the elements (see Domain::face_neighbors), stored element by element (the offsets of
+        /// an element are implicit since every element has the same number of faces), and the boundary faces (see
+        /// Domain::boundary_faces). Computed on the first access.
+        mutable std::vector<INTEGER_TYPE> p_face_neighbors;
+        mutable BoundaryFaces p_boundary_faces;
+        mutable std::atomic<bool> p_faces_are_built {false};
+
+        /// Protects the computation of the cached adjacency tables
+        mutable std::mutex p_adjacency_mutex;
     };
 
     // -------------------------------------------------------------------------------------
@@ -291,6 +406,172 @@ namespace caribou::topology {
         );
     }
 
+    template <typename Element, typename NodeIndex>
+    inline auto Domain<Element, NodeIndex>::face_neighbors(const UNSIGNED_INTEGER_TYPE & element_id) const -> ElementNeighbors {
+        static_assert(geometry::element_has_boundaries_v<Element>, "This element type has no boundary elements defined.");
+        caribou_assert(element_id < number_of_elements() and "Trying to get an element that does not exists.");
+
+        compute_once(p_faces_are_built, [this]() {compute_faces();});
+
+        constexpr auto number_of_faces = static_cast<UNSIGNED_INTEGER_TYPE>(geometry::traits<Element>::NumberOfBoundaryElementsAtCompileTime);
+        return ElementNeighbors(p_face_neighbors.data() + element_id*number_of_faces, number_of_faces);
+    }
+
+    template <typename Element, typename NodeIndex>
+    inline auto Domain<Element, NodeIndex>::node_elements(const UNSIGNED_INTEGER_TYPE & node_id) const -> NodeElements {
+        compute_once(p_node_elements_are_built, [this]() {compute_node_elements();});
+
+        if (node_id + 1 >= p_node_elements_offsets.size()) {
+            return NodeElements(p_node_elements.data(), 0);
+        }
+
+        const auto & begin = p_node_elements_offsets[node_id];
+        const auto & end = p_node_elements_offsets[node_id+1];
+        return NodeElements(p_node_elements.data() + begin, static_cast<Eigen::Index>(end - begin));
+    }
+
+    template <typename Element, typename NodeIndex>
+    inline auto Domain<Element, NodeIndex>::boundary_faces() const -> const BoundaryFaces & {
+        static_assert(geometry::element_has_boundaries_v<Element>, "This element type has no boundary elements defined.");
+
+        compute_once(p_faces_are_built, [this]() {compute_faces();});
+
+        return p_boundary_faces;
+    }
+
+    template <typename Element, typename NodeIndex>
+    void Domain<Element, NodeIndex>::compute_node_elements() const {
+        const auto n = number_of_elements();
+
+        UNSIGNED_INTEGER_TYPE number_of_nodes = 0;
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < n; ++element_id) {
+            for (const auto & node_id : element_indices(element_id)) {
+                number_of_nodes = std::max(number_of_nodes, static_cast<UNSIGNED_INTEGER_TYPE>(node_id) + 1);
+            }
+        }
+
+        // Count the elements of every nodes, and fill them in the element order (the elements of a node are sorted)
+        p_node_elements_offsets.assign(number_of_nodes + 1, 0);
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < n; ++element_id) {
+            for (const auto & node_id : element_indices(element_id)) {
+                ++p_node_elements_offsets[static_cast<UNSIGNED_INTEGER_TYPE>(node_id) + 1];
+            }
+        }
+        std::partial_sum(p_node_elements_offsets.begin(), p_node_elements_offsets.end(), p_node_elements_offsets.begin());
+
+        p_node_elements.resize(p_node_elements_offsets.back());
+        std::vector<UNSIGNED_INTEGER_TYPE> positions (p_node_elements_offsets.begin(), p_node_elements_offsets.end() - 1);
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < n; ++element_id) {
+            for (const auto & node_id : element_indices(element_id)) {
+                p_node_elements[positions[static_cast<UNSIGNED_INTEGER_TYPE>(node_id)]++] = element_id;
+            }
+        }
+    }
+
+    template <typename Element, typename NodeIndex>
+    void Domain<Element, NodeIndex>::compute_faces() const {
+        using BoundaryElement = typename geometry::traits<Element>::BoundaryElementType;
+        constexpr auto number_of_faces = static_cast<UNSIGNED_INTEGER_TYPE>(geometry::traits<Element>::NumberOfBoundaryElementsAtCompileTime);
+        constexpr auto number_of_face_nodes = static_cast<std::size_t>(geometry::traits<BoundaryElement>::NumberOfNodesAtCompileTime);
+        using FaceNodes = std::array<NodeIndex, number_of_face_nodes>;
+
+        const auto & faces = Element().boundary_elements_node_indices();
+        const auto n = number_of_elements();
+        const auto number_of_element_faces = static_cast<std::size_t>(n*number_of_faces);
+
+        // Sorted node indices of every face, and their hash
+        std::vector<FaceNodes> face_nodes (number_of_element_faces);
+        std::vector<std::uint64_t> face_hashes (number_of_element_faces);
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (std::ptrdiff_t element_id = 0; element_id < static_cast<std::ptrdiff_t>(n); ++element_id) {
+            const auto node_indices = element_indices(static_cast<UNSIGNED_INTEGER_TYPE>(element_id));
+            for (UNSIGNED_INTEGER_TYPE face_id = 0; face_id < number_of_faces; ++face_id) {
+                const auto f = static_cast<std::size_t>(element_id)*number_of_faces + face_id;
+                for (std::size_t i = 0; i < number_of_face_nodes; ++i) {
+                    face_nodes[f][i] = node_indices[faces[face_id][i]];
+                }
+                std::sort(face_nodes[f].begin(), face_nodes[f].end());
+
+                std::uint64_t h = 0;
+                for (const auto & node_id : face_nodes[f]) {
+                    // splitmix64 finalizer of the combined node indices
+                    h = (h ^ static_cast<std::uint64_t>(node_id)) + 0x9e3779b97f4a7c15ULL;
+                    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+                    h = h ^ (h >> 31);
+                }
+                face_hashes[f] = h;
+            }
+        }
+
+        // Group the faces in buckets by hash. Two faces having the same nodes are in the same bucket, and the faces
+        // of a bucket are in increasing order.
+        std::size_t number_of_buckets = 1;
+        while (2*number_of_buckets < number_of_element_faces) {
+            number_of_buckets *= 2;
+        }
+        const std::uint64_t mask = number_of_buckets - 1;
+
+        std::vector<std::size_t> bucket_offsets (number_of_buckets + 1, 0);
+        for (std::size_t f = 0; f < number_of_element_faces; ++f) {
+            ++bucket_offsets[(face_hashes[f] & mask) + 1];
+        }
+        std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+
+        std::vector<std::size_t> bucket_faces (number_of_element_faces);
+        {
+            std::vector<std::size_t> positions (bucket_offsets.begin(), bucket_offsets.end() - 1);
+            for (std::size_t f = 0; f < number_of_element_faces; ++f) {
+                bucket_faces[positions[face_hashes[f] & mask]++] = f;
+            }
+        }
+
+        // Link each face to the first following face of its bucket having the same nodes. On a non-manifold domain,
+        // the next faces having these nodes are left alone (neither linked, nor on the boundary).
+        p_face_neighbors.assign(number_of_element_faces, -1);
+        std::vector<char> is_shared (number_of_element_faces, 0);
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp parallel for schedule(dynamic, 256)
+#endif
+        for (std::ptrdiff_t bucket_id = 0; bucket_id < static_cast<std::ptrdiff_t>(number_of_buckets); ++bucket_id) {
+            const auto begin = bucket_offsets[static_cast<std::size_t>(bucket_id)];
+            const auto end = bucket_offsets[static_cast<std::size_t>(bucket_id) + 1];
+            for (auto i = begin; i < end; ++i) {
+                const auto & first = bucket_faces[i];
+                if (is_shared[first]) {
+                    continue;
+                }
+                for (auto j = i + 1; j < end; ++j) {
+                    const auto & second = bucket_faces[j];
+                    if (is_shared[second] or face_hashes[first] != face_hashes[second] or face_nodes[first] != face_nodes[second]) {
+                        continue;
+                    }
+
+                    if (not is_shared[first]) {
+                        p_face_neighbors[first] = static_cast<INTEGER_TYPE>(second / number_of_faces);
+                        p_face_neighbors[second] = static_cast<INTEGER_TYPE>(first / number_of_faces);
+                        is_shared[first] = 1;
+                    }
+                    is_shared[second] = 1;
+                }
+            }
+        }
+
+        std::vector<std::size_t> boundary_faces;
+        for (std::size_t f = 0; f < number_of_element_faces; ++f) {
+            if (not is_shared[f]) {
+                boundary_faces.emplace_back(f);
+            }
+        }
+
+        p_boundary_faces.resize(static_cast<Eigen::Index>(boundary_faces.size()), 2);
+        for (std::size_t i = 0; i < boundary_faces.size(); ++i) {
+            p_boundary_faces.row(static_cast<Eigen::Index>(i)) << boundary_faces[i] / number_of_faces, boundary_faces[i] % number_of_faces;
+        }
+    }
+
     template <typename Element, typename NodeIndex>
     template<typename EigenMatrix>
     inline auto Domain<Element, NodeIndex>::element(const UNSIGNED_INTEGER_TYPE & element_id, const Eigen::DenseBase<EigenMatrix> & positions) const -> Element {
@@ -306,8 +587,8 @@ namespace caribou::topology {
         }
 
         const auto node_indices = element_indices(element_id);
-        for (std::size_t i = 0; i < node_indices.size(); ++i) {
-            node_positions.row(i) = positions.row(node_indices[i]);
+        for (Eigen::Index i = 0; i < node_indices.size(); ++i) {
+            node_positions.row(i) = positions.row(static_cast<Eigen::Index>(node_indices[i]));
         }
 
         return Element(node_positions);
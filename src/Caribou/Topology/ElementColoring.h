@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <vector>
+
+namespace caribou::topology {
+
+/**
+ * Greedy coloring of the elements of a mesh such that two elements sharing a node never have the same color.
+ *
+ * The elements of a same color can therefore be processed concurrently, each of them scattering its contribution into
+ * its nodes without any race condition. Elements are visited in order, and each one gets the first color not already
+ * used by an element around one of its nodes.
+ *
+ * Example:
+ * \code{.cpp}
+ * const auto colors = color_elements(domain.number_of_elements(), mesh.number_of_nodes(), [&](const auto & element_id) {
+ *     return domain.element_indices(element_id);
+ * });
+ * for (const auto & elements : colors) {
+ *     #pragma omp parallel for
+ *     for (std::size_t i = 0; i < elements.size(); ++i) {
+ *         // Accumulate the contribution of the element elements[i] into its nodes
+ *     }
+ * }
+ * \endcode
+ *
+ * @param number_of_elements Number of elements to color.
+ * @param number_of_nodes Number of nodes of the mesh (the node indices of the elements must be lower than this number).
+ * @param element_nodes Callable returning the node indices of the element given as argument. The returned container
+ *                      must be iterable in a range-based for loop.
+ * @return The element indices grouped by color.
+ */
+template <typename ElementNodes>
+auto color_elements(const UNSIGNED_INTEGER_TYPE & number_of_elements,
+                    const UNSIGNED_INTEGER_TYPE & number_of_nodes,
+                    ElementNodes && element_nodes) -> std::vector<std::vector<UNSIGNED_INTEGER_TYPE>> {
+    std::vector<std::vector<UNSIGNED_INTEGER_TYPE>> colors;
+
+    // Colors of the elements around each node
+    std::vector<std::vector<UNSIGNED_INTEGER_TYPE>> node_colors (number_of_nodes);
+
+    // Colors already used by an element sharing a node with the current element
+    std::vector<bool> used;
+
+    for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+        const auto nodes = element_nodes(element_id);
+
+        used.assign(colors.size(), false);
+        for (const auto & node_id : nodes) {
+            for (const auto & color : node_colors[static_cast<UNSIGNED_INTEGER_TYPE>(node_id)]) {
+                used[color] = true;
+            }
+        }
+
+        UNSIGNED_INTEGER_TYPE color = 0;
+        while (color < used.size() and used[color]) {
+            ++color;
+        }
+
+        if (color == colors.size()) {
+            colors.emplace_back();
+        }
+        colors[color].emplace_back(element_id);
+
+        for (const auto & node_id : nodes) {
+            node_colors[static_cast<UNSIGNED_INTEGER_TYPE>(node_id)].emplace_back(color);
+        }
+    }
+
+    return colors;
+}
+
+} // namespace caribou::topology
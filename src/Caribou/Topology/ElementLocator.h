@@ -0,0 +1,19 @@
+#pragma once
+
+namespace caribou::topology {
+
+/**
+ * Spatial index used by a BarycentricContainer to find the candidate elements containing an embedded point.
+ */
+enum class ElementLocator : unsigned int {
+    /** Regular grid of cells having the mean size of the elements (see HashGrid). */
+    HashGrid = 0,
+
+    /**
+     * Bounding volume hierarchy of the elements (see BoundingVolumeHierarchy). Prefer it when the sizes of the
+     * elements vary a lot within the domain.
+     */
+    BoundingVolumeHierarchy = 1
+};
+
+} // namespace caribou::topology
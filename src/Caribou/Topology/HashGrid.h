@@ -2,11 +2,17 @@
 
 #include <Caribou/config.h>
 #include <Caribou/Geometry/Element.h>
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <set>
 #include <Eigen/Core>
-#include <bitset>
 
 namespace caribou::topology {
 
@@ -17,6 +23,28 @@ struct CwiseFloor {
     auto operator()(const FLOATING_POINT_TYPE& x) const -> FLOATING_POINT_TYPE { return std::floor(x); }
 };
 
+/**
+ * Spatial hash of elements on a regular grid of cubic cells.
+ *
+ * Each element is added to every cell overlapped by its bounding box. The (cell, element) pairs are stored in a
+ * compressed sparse row layout sorted by the Morton code of the cells (cells close in space are close in memory), and
+ * the cells are found with an open-addressing hash table of their Morton codes (integer comparisons only, no
+ * allocation per query).
+ *
+ * Example:
+ * \code{.cpp}
+ * HashGrid<Tetrahedron> grid (domain); // Bulk (parallel) build, the cell size is the mean size of the elements
+ * std::vector<UNSIGNED_INTEGER_TYPE> candidates;
+ * for (const auto & p : points) {
+ *     grid.get(p, candidates); // Reuses the memory of the candidates buffer
+ *     ...
+ * }
+ * \endcode
+ *
+ * \note Elements added one at a time with add(element, id) are indexed on the next call to build(), or on the next
+ *       query if build() wasn't called. This lazy build is done only once, even when the first queries are made
+ *       concurrently. Adding elements while the grid is being queried is not thread safe.
+ */
 template <typename Element>
 class HashGrid {
 public:
@@ -27,11 +55,80 @@ public:
     using GridCoordinates = Eigen::Matrix<INTEGER_TYPE, Dimension, 1>;
     using WorldCoordinates = Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1>;
     using VecFloat = Eigen::Matrix<FLOATING_POINT_TYPE, Dimension, 1>;
+    using Key = std::uint64_t;
 
     HashGrid (const FLOATING_POINT_TYPE & cell_size) : p_cell_size(cell_size) {}
 
     HashGrid (const FLOATING_POINT_TYPE & cell_size, const UNSIGNED_INTEGER_TYPE & number_of_elements) : p_cell_size(cell_size) {
-        p_hash_table.reserve(2*number_of_elements);
+        p_entries.reserve(2*number_of_elements);
+    }
+
+    /** Copy constructor */
+    HashGrid (const HashGrid & other)
+    : p_cell_size(other.p_cell_size)
+    , p_entries(other.p_entries)
+    , p_cell_keys(other.p_cell_keys)
+    , p_cell_offsets(other.p_cell_offsets)
+    , p_element_indices(other.p_element_indices)
+    , p_table(other.p_table)
+    , p_is_built(other.p_is_built.load()) {}
+
+    /** Move constructor */
+    HashGrid (HashGrid && other) noexcept : p_cell_size(0) {
+        swap(*this, other);
+    }
+
+    /** Copy and move assignment */
+    HashGrid & operator=(HashGrid other) noexcept {
+        swap(*this, other);
+        return *this;
+    }
+
+    friend void swap(HashGrid & first, HashGrid & second) noexcept {
+        using std::swap;
+        swap(first.p_cell_size, second.p_cell_size);
+        swap(first.p_entries, second.p_entries);
+        swap(first.p_cell_keys, second.p_cell_keys);
+        swap(first.p_cell_offsets, second.p_cell_offsets);
+        swap(first.p_element_indices, second.p_element_indices);
+        swap(first.p_table, second.p_table);
+        const bool is_built = first.p_is_built.load();
+        first.p_is_built.store(second.p_is_built.load());
+        second.p_is_built.store(is_built);
+    }
+
+    /**
+     * Build the hash grid of all the elements of a domain. The size of the cells is set to the mean size of the
+     * elements. See HashGrid::add(const Domain *).
+     */
+    template <typename Domain>
+    explicit HashGrid (const Domain * domain) : p_cell_size(mean_element_size(domain)) {
+        add(domain);
+    }
+
+    /**
+     * Build the hash grid of all the elements of a domain, with the given cell size.
+     * See HashGrid::add(const Domain *).
+     */
+    template <typename Domain>
+    HashGrid (const FLOATING_POINT_TYPE & cell_size, const Domain * domain) : p_cell_size(cell_size) {
+        add(domain);
+    }
+
+    /**
+     * Mean size of the elements of a domain, i.e. the mean of the largest side of their bounding boxes.
+     */
+    template <typename Domain>
+    static auto mean_element_size(const Domain * domain) -> FLOATING_POINT_TYPE {
+        VecFloat H_mean = VecFloat::Zero();
+        const auto number_of_elements = domain->number_of_elements();
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+            const Element element = domain->element(element_id);
+            const auto element_nodes = element.nodes();
+            H_mean += (element_nodes.colwise().maxCoeff() - element_nodes.colwise().minCoeff()).transpose();
+        }
+        H_mean /= static_cast<FLOATING_POINT_TYPE>(number_of_elements);
+        return H_mean.maxCoeff();
     }
 
     /**
@@ -41,22 +138,71 @@ public:
      */
     inline
     void add(const Element & e, const Index & id) {
-        const auto min = (e.nodes().colwise().minCoeff() * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
-        const auto max = (e.nodes().colwise().maxCoeff() * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
+        unpack();
+        const auto cells = bounding_cells(e);
+        for_each_cell(cells.first, cells.second, [this, &id](const GridCoordinates & cell) {
+            p_entries.emplace_back(cell_key(cell), id);
+        });
+        p_is_built.store(false, std::memory_order_relaxed);
+    }
 
-        for (INTEGER_TYPE i = static_cast<INTEGER_TYPE>(min[0]); i <= static_cast<INTEGER_TYPE>(max[0]); ++i) {
-            if constexpr (Dimension == 1) {
-                p_hash_table[GridCoordinates {i}].emplace_back(id);
-            } else {
-                for (INTEGER_TYPE j = static_cast<INTEGER_TYPE>(min[1]); j <= static_cast<INTEGER_TYPE>(max[1]); ++j) {
-                    if constexpr (Dimension == 2) {
-                        p_hash_table[GridCoordinates {i, j}].emplace_back(id);
-                    } else {
-                        for (INTEGER_TYPE k = static_cast<INTEGER_TYPE>(min[2]); k <= static_cast<INTEGER_TYPE>(max[2]); ++k) {
-                            p_hash_table[GridCoordinates {i, j, k}].emplace_back(id);
-                        }
-                    }
-                }
+    /**
+     * Add every element of a domain to the hash grid, using their index within the domain as identifier, and build
+     * the grid.
+     *
+     * The cells overlapped by each element are first counted, and then written, in parallel (when compiled with
+     * OpenMP). The (cell, element) pairs are finally sorted by cell.
+     */
+    template <typename Domain>
+    void add(const Domain * domain) {
+        static_assert(std::is_same_v<typename Domain::ElementType, Element>,
+                      "The elements of the domain must have the same type as the elements of the hash grid.");
+        unpack();
+
+        const auto number_of_elements = static_cast<std::ptrdiff_t>(domain->number_of_elements());
+        std::vector<std::pair<GridCoordinates, GridCoordinates>> cells (static_cast<std::size_t>(number_of_elements));
+        std::vector<std::size_t> offsets (static_cast<std::size_t>(number_of_elements+1), 0);
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            const auto i = static_cast<std::size_t>(element_id);
+            cells[i] = bounding_cells(domain->element(static_cast<UNSIGNED_INTEGER_TYPE>(element_id)));
+            offsets[i+1] = static_cast<std::size_t>(((cells[i].second - cells[i].first).array() + 1).prod());
+        }
+
+        offsets[0] = p_entries.size();
+        for (std::size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i-1];
+        }
+        p_entries.resize(offsets.back());
+
+#ifdef CARIBOU_WITH_OPENMP
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            const auto i = static_cast<std::size_t>(element_id);
+            auto * entry = &p_entries[offsets[i]];
+            for_each_cell(cells[i].first, cells[i].second, [&entry, &element_id](const GridCoordinates & cell) {
+                *entry++ = {cell_key(cell), static_cast<Index>(element_id)};
+            });
+        }
+
+        p_is_built.store(false, std::memory_order_relaxed);
+        build();
+    }
+
+    /**
+     * Index the elements added since the last build. This is done automatically on the first query following an
+     * addition. Other threads querying the grid at the same time wait until the elements have been indexed.
+     */
+    void build() const {
+        if (not p_is_built.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock (p_build_mutex);
+            if (not p_is_built.load(std::memory_order_relaxed)) {
+                index_entries();
+                p_is_built.store(true, std::memory_order_release);
             }
         }
     }
@@ -65,103 +211,264 @@ public:
      * Get all the data of all elements that are very close to the point p. Note that the returned elements do not
      * ensure that the point p resides inside of them. One has to further check each ones of them with an
      * intersection test.
+     *
+     * The candidate elements are written in the given buffer (sorted and without duplicates), which is cleared first.
+     * Its memory is reused, such that no allocation is done once the buffer is large enough.
      */
     inline
-    auto get(const WorldCoordinates & p) const -> std::set<Index> {
+    void get(const WorldCoordinates & p, std::vector<Index> & elements) const {
+        build();
+        elements.clear();
+
         const VecFloat absolute = p / p_cell_size;
         const VecFloat rounded = absolute.unaryExpr(CwiseRound());
         const VecFloat distance = absolute - rounded;
 
-        auto close_to_axis = std::bitset<Dimension>();
+        // When the point is very close to the boundary between two cells along an axis, both cells are visited
+        std::array<std::array<INTEGER_TYPE, 2>, Dimension> axis_indices;
+        std::array<UNSIGNED_INTEGER_TYPE, Dimension> number_of_axis_indices;
+        for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+            if (distance[axis]*distance[axis] < EPSILON*EPSILON) {
+                axis_indices[axis] = {static_cast<INTEGER_TYPE>(rounded[axis]) - 1, static_cast<INTEGER_TYPE>(rounded[axis])};
+                number_of_axis_indices[axis] = 2;
+            } else {
+                axis_indices[axis][0] = static_cast<INTEGER_TYPE>(std::floor(absolute[axis]));
+                number_of_axis_indices[axis] = 1;
+            }
+        }
+
+        UNSIGNED_INTEGER_TYPE number_of_cells = 1;
+        for (const auto & n : number_of_axis_indices) {
+            number_of_cells *= n;
+        }
+
+        for (UNSIGNED_INTEGER_TYPE c = 0; c < number_of_cells; ++c) {
+            GridCoordinates cell;
+            UNSIGNED_INTEGER_TYPE remainder = c;
+            for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
+                cell[axis] = axis_indices[axis][remainder % number_of_axis_indices[axis]];
+                remainder /= number_of_axis_indices[axis];
+            }
+
+            const auto range = find(cell_key(cell));
+            elements.insert(elements.end(), range.first, range.second);
+        }
+
+        if (number_of_cells > 1) {
+            std::sort(elements.begin(), elements.end());
+            elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+        }
+    }
 
-        std::vector<GridCoordinates> cells;
-        cells.reserve((unsigned) 1<<Dimension);
+    /**
+     * Get all the data of all elements that are very close to the point p (sorted and without duplicates).
+     * See HashGrid::get(const WorldCoordinates &, std::vector<Index> &).
+     */
+    inline
+    auto get(const WorldCoordinates & p) const -> std::vector<Index> {
+        std::vector<Index> elements;
+        get(p, elements);
+        return elements;
+    }
 
-        // Let's find the axis for which our coordinate is very close to
+    /**
+     * Morton code of a cell, such that cells close in space have close codes. Grid coordinates beyond the
+     * representable range are clamped, which can only add candidates to a query (never remove any).
+     */
+    static inline auto cell_key(const GridCoordinates & cell) -> Key {
+        Key k = 0;
         for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
-            if (distance[axis]*distance[axis] < EPSILON*EPSILON )
-                close_to_axis[axis] = true;
+            const auto c = std::clamp<std::int64_t>(static_cast<std::int64_t>(cell[axis]) + CoordinatesOffset, 0, MaximumCoordinates);
+            k |= spread(static_cast<Key>(c)) << axis;
         }
+        return k;
+    }
 
-        if (close_to_axis.none()) {
-            // We are not near any axis, which means we are well inside a cell's boundaries
-            cells.emplace_back(absolute.unaryExpr(CwiseFloor()). template cast<INTEGER_TYPE>());
-        } else {
-            const VecFloat d = VecFloat::Constant(1 / 2.);
+    /** Grid coordinates of the cell containing the point p. */
+    inline auto cell_coordinates(const WorldCoordinates & p) const -> GridCoordinates {
+        return (p / p_cell_size).unaryExpr(CwiseFloor()).template cast<INTEGER_TYPE>();
+    }
 
-            std::array<std::vector<INTEGER_TYPE>, Dimension> axis_indices;
-            for (auto & indices  : axis_indices) {
-                indices.reserve(Dimension);
-            }
+    /** Size of the cells. */
+    [[nodiscard]]
+    inline auto cell_size() const -> const FLOATING_POINT_TYPE & {
+        return p_cell_size;
+    }
 
-            for (UNSIGNED_INTEGER_TYPE axis = 0; axis < Dimension; ++axis) {
-                if (close_to_axis[axis]) {
-                    axis_indices[axis].emplace_back(static_cast<INTEGER_TYPE>(floor(rounded[axis]-d[axis])));
-                    axis_indices[axis].emplace_back(static_cast<INTEGER_TYPE>(floor(rounded[axis]+d[axis])));
-                } else {
-                    axis_indices[axis].emplace_back(static_cast<INTEGER_TYPE>(floor(absolute[axis])));
-                }
-            }
+    /** Number of non-empty cells. */
+    [[nodiscard]]
+    inline auto number_of_cells() const -> std::size_t {
+        build();
+        return p_cell_keys.size();
+    }
+
+private:
+    static constexpr auto Empty = std::numeric_limits<std::size_t>::max();
+
+    // Number of bits of the Morton code used by each axis, and offset applied to the (signed) grid coordinates
+    static constexpr UNSIGNED_INTEGER_TYPE BitsPerAxis = (Dimension == 1) ? 63 : ((Dimension == 2) ? 32 : 21);
+    static constexpr std::int64_t CoordinatesOffset = std::int64_t(1) << (BitsPerAxis - 1);
+    static constexpr std::int64_t MaximumCoordinates = (std::int64_t(1) << BitsPerAxis) - 1;
+
+    /** First and last cells (inclusively) overlapped by the bounding box of the element. */
+    inline auto bounding_cells(const Element & e) const -> std::pair<GridCoordinates, GridCoordinates> {
+        const auto min = (e.nodes().colwise().minCoeff() * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
+        const auto max = (e.nodes().colwise().maxCoeff() * 1/p_cell_size).unaryExpr(CwiseFloor()).eval();
+        return {min.transpose().template cast<INTEGER_TYPE>(), max.transpose().template cast<INTEGER_TYPE>()};
+    }
 
-            for (const INTEGER_TYPE & i : axis_indices[0]) {
-                if constexpr (Dimension == 1) {
-                    cells.emplace_back(GridCoordinates{i});
-                } else {
-                    for (const INTEGER_TYPE & j : axis_indices[1]) {
-                        if constexpr (Dimension == 2) {
-                            cells.emplace_back(GridCoordinates{i, j});
-                        } else {
-                            for (const INTEGER_TYPE & k : axis_indices[2]) {
-                                cells.emplace_back(GridCoordinates{i, j, k});
-                            }
+    template <typename Function>
+    static inline void for_each_cell(const GridCoordinates & min, const GridCoordinates & max, Function && f) {
+        for (INTEGER_TYPE i = min[0]; i <= max[0]; ++i) {
+            if constexpr (Dimension == 1) {
+                f(GridCoordinates {i});
+            } else {
+                for (INTEGER_TYPE j = min[1]; j <= max[1]; ++j) {
+                    if constexpr (Dimension == 2) {
+                        f(GridCoordinates {i, j});
+                    } else {
+                        for (INTEGER_TYPE k = min[2]; k <= max[2]; ++k) {
+                            f(GridCoordinates {i, j, k});
                         }
                     }
                 }
             }
         }
+    }
+
+    /** Spread the bits of x such that Dimension-1 zero bits are inserted between them. */
+    static constexpr auto spread(Key x) -> Key {
+        if constexpr (Dimension == 1) {
+            return x;
+        } else if constexpr (Dimension == 2) {
+            x &= 0x00000000FFFFFFFF;
+            x = (x | (x << 16)) & 0x0000FFFF0000FFFF;
+            x = (x | (x <<  8)) & 0x00FF00FF00FF00FF;
+            x = (x | (x <<  4)) & 0x0F0F0F0F0F0F0F0F;
+            x = (x | (x <<  2)) & 0x3333333333333333;
+            x = (x | (x <<  1)) & 0x5555555555555555;
+            return x;
+        } else {
+            x &= 0x00000000001FFFFF;
+            x = (x | (x << 32)) & 0x001F00000000FFFF;
+            x = (x | (x << 16)) & 0x001F0000FF0000FF;
+            x = (x | (x <<  8)) & 0x100F00F00F00F00F;
+            x = (x | (x <<  4)) & 0x10C30C30C30C30C3;
+            x = (x | (x <<  2)) & 0x1249249249249249;
+            return x;
+        }
+    }
 
-        std::set<Index> elements;
-        for (const auto & cell_coordinates : cells) {
-            const auto & iter = p_hash_table.find(cell_coordinates);
-            if (iter != p_hash_table.end()) {
-                for (const auto &element_data : iter->second) {
-                    elements.emplace(element_data);
-                }
+    /** Hash of a Morton code (finalizer of the splitmix64 generator). */
+    static inline auto hash(Key k) -> std::size_t {
+        k ^= k >> 30;
+        k *= 0xBF58476D1CE4E5B9;
+        k ^= k >> 27;
+        k *= 0x94D049BB133111EB;
+        k ^= k >> 31;
+        return static_cast<std::size_t>(k);
+    }
+
+    /** Range of the elements of the cell having the given Morton code. */
+    inline auto find(const Key & k) const -> std::pair<const Index *, const Index *> {
+        if (p_table.empty()) {
+            return {nullptr, nullptr};
+        }
+
+        const auto mask = p_table.size() - 1;
+        auto slot = hash(k) & mask;
+        while (p_table[slot] != Empty) {
+            const auto & cell_id = p_table[slot];
+            if (p_cell_keys[cell_id] == k) {
+                const auto * elements = p_element_indices.data();
+                return {elements + p_cell_offsets[cell_id], elements + p_cell_offsets[cell_id+1]};
             }
+            slot = (slot + 1) & mask;
         }
 
-        return elements;
+        return {nullptr, nullptr};
     }
 
-private:
+    /** Index the (cell, element) pairs added since the last build. */
+    void index_entries() const {
+        if (p_entries.empty()) {
+            return;
+        }
 
-    struct HashFunction
-    {
-        auto operator()(const GridCoordinates & coordinates) const -> std::size_t
-        {
-            // We use the large prime numbers proposed in paper:
-            // M.Teschner et al "Optimized Spatial Hashing for Collision Detection of Deformable Objects" (2003)
-            INTEGER_TYPE h = 73856093 * coordinates[0] ;
-            if constexpr (Dimension > 1)
-                h ^= 19349663*coordinates[1];
-            if constexpr (Dimension > 2)
-                h ^= 83492791*coordinates[2];
+        // Sort the (cell, element) pairs by cell, and then by element, such that the candidates of a cell are sorted
+        std::sort(p_entries.begin(), p_entries.end());
 
-            return h;
+        // Compressed sparse row layout of the elements of each cell
+        p_cell_keys.clear();
+        p_cell_offsets.assign(1, 0);
+        p_element_indices.resize(p_entries.size());
+        for (std::size_t i = 0; i < p_entries.size(); ++i) {
+            if (i == 0 or p_entries[i].first != p_entries[i-1].first) {
+                if (i > 0) {
+                    p_cell_offsets.emplace_back(i);
+                }
+                p_cell_keys.emplace_back(p_entries[i].first);
+            }
+            p_element_indices[i] = p_entries[i].second;
         }
-    };
+        p_cell_offsets.emplace_back(p_entries.size());
+
+        p_entries.clear();
+        p_entries.shrink_to_fit();
 
-    struct HashEqual
-    {
-        auto operator()(const GridCoordinates &a, const GridCoordinates &b) const -> bool
-        {
-            return ((a - b).norm() == 0);
+        // Open-addressing (linear probing) table of the cells, filled at most at half its capacity
+        std::size_t capacity = 2;
+        while (capacity < 2*p_cell_keys.size()) {
+            capacity *= 2;
+        }
+        p_table.assign(capacity, Empty);
+        const auto mask = capacity - 1;
+        for (std::size_t cell_id = 0; cell_id < p_cell_keys.size(); ++cell_id) {
+            auto slot = hash(p_cell_keys[cell_id]) & mask;
+            while (p_table[slot] != Empty) {
+                slot = (slot + 1) & mask;
+            }
+            p_table[slot] = cell_id;
+        }
+    }
+
+    /** Move back the indexed (cell, element) pairs into the list of pairs to be indexed on the next build. */
+    inline void unpack() {
+        if (p_cell_keys.empty()) {
+            return;
+        }
+
+        p_entries.reserve(p_entries.size() + p_element_indices.size());
+        for (std::size_t cell_id = 0; cell_id < p_cell_keys.size(); ++cell_id) {
+            for (auto i = p_cell_offsets[cell_id]; i < p_cell_offsets[cell_id+1]; ++i) {
+                p_entries.emplace_back(p_cell_keys[cell_id], p_element_indices[i]);
+            }
         }
-    };
 
+        p_cell_keys.clear();
+        p_cell_offsets.clear();
+        p_element_indices.clear();
+        p_table.clear();
+    }
 
     FLOATING_POINT_TYPE p_cell_size;
-    std::unordered_map<GridCoordinates, std::vector<Index>, HashFunction, HashEqual> p_hash_table;
+
+    ///< (cell, element) pairs added since the last build
+    mutable std::vector<std::pair<Key, Index>> p_entries;
+
+    ///< Morton code of the non-empty cells, sorted
+    mutable std::vector<Key> p_cell_keys;
+
+    ///< The elements of the cell i are p_element_indices[p_cell_offsets[i]] to p_element_indices[p_cell_offsets[i+1]-1]
+    mutable std::vector<std::size_t> p_cell_offsets;
+    mutable std::vector<Index> p_element_indices;
+
+    ///< Open-addressing table of the cells (index of the cell in p_cell_keys, or Empty)
+    mutable std::vector<std::size_t> p_table;
+
+    ///< Whether the pairs added since the last build have been indexed, and the mutex protecting the lazy build
+    mutable std::atomic<bool> p_is_built {true};
+    mutable std::mutex p_build_mutex;
 };
 
-} // namespace caribou::topology
\ No newline at end of file
+} // namespace caribou::topology
@@ -0,0 +1,394 @@
+#pragma once
+
+#include <Caribou/config.h>
+#include <Caribou/Topology/Domain.h>
+#include <Caribou/Topology/Mesh.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace caribou::topology {
+
+/**
+ * Ordering of the nodes of a mesh.
+ */
+enum class NodeOrdering : unsigned int {
+    /** Keep the original ordering */
+    None = 0,
+
+    /**
+     * Reverse Cuthill-McKee: breadth-first traversal of the node graph (two nodes are connected when they share an
+     * element), starting from a pseudo-peripheral node. Minimizes the bandwidth of the system matrix.
+     */
+    ReverseCuthillMcKee = 1,
+
+    /** Nodes sorted along a Morton (Z-order) space-filling curve of their positions. */
+    Morton = 2
+};
+
+/**
+ * Permutation of the nodes and elements of a mesh.
+ *
+ * The i-th node (resp. element) of the reordered mesh is the node node_order[i] (resp. the element element_order[i])
+ * of the original mesh. Hence, a field computed on the reordered nodes is mapped back to the original nodes with
+ * original[node_order[i]] = reordered[i].
+ */
+struct Reordering {
+    std::vector<UNSIGNED_INTEGER_TYPE> node_order;
+    std::vector<UNSIGNED_INTEGER_TYPE> element_order;
+};
+
+/**
+ * Inverse of a permutation, i.e. the new index of every old index.
+ */
+inline auto inverse_permutation(const std::vector<UNSIGNED_INTEGER_TYPE> & order) -> std::vector<UNSIGNED_INTEGER_TYPE> {
+    std::vector<UNSIGNED_INTEGER_TYPE> inverse (order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        inverse[order[i]] = static_cast<UNSIGNED_INTEGER_TYPE>(i);
+    }
+    return inverse;
+}
+
+/**
+ * Reverse Cuthill-McKee ordering of the nodes of a mesh.
+ *
+ * Every connected component of the node graph is traversed breadth first from a pseudo-peripheral node (found by
+ * repeated traversals from a node of minimum degree), the neighbors of a node being visited by increasing degree.
+ * The concatenated traversals are then reversed.
+ *
+ * @param number_of_elements Number of elements of the mesh.
+ * @param number_of_nodes Number of nodes of the mesh (the node indices of the elements must be lower than this number).
+ * @param element_nodes Callable returning the node indices of the element given as argument. The returned container
+ *                      must be iterable in a range-based for loop.
+ * @return The old index of every node (see Reordering::node_order).
+ */
+template <typename ElementNodes>
+auto reverse_cuthill_mckee_order(const UNSIGNED_INTEGER_TYPE & number_of_elements,
+                                 const UNSIGNED_INTEGER_TYPE & number_of_nodes,
+                                 ElementNodes && element_nodes) -> std::vector<UNSIGNED_INTEGER_TYPE> {
+    using Index = UNSIGNED_INTEGER_TYPE;
+
+    // Elements around each node (compressed row storage)
+    std::vector<Index> node_elements_offsets (number_of_nodes + 1, 0);
+    for (Index element_id = 0; element_id < number_of_elements; ++element_id) {
+        for (const auto & node_id : element_nodes(element_id)) {
+            ++node_elements_offsets[static_cast<Index>(node_id) + 1];
+        }
+    }
+    std::partial_sum(node_elements_offsets.begin(), node_elements_offsets.end(), node_elements_offsets.begin());
+
+    std::vector<Index> node_elements (node_elements_offsets.back());
+    {
+        std::vector<Index> positions (node_elements_offsets.begin(), node_elements_offsets.end() - 1);
+        for (Index element_id = 0; element_id < number_of_elements; ++element_id) {
+            for (const auto & node_id : element_nodes(element_id)) {
+                node_elements[positions[static_cast<Index>(node_id)]++] = element_id;
+            }
+        }
+    }
+
+    // Neighbors of each node (compressed row storage)
+    std::vector<Index> adjacency_offsets (number_of_nodes + 1, 0);
+    std::vector<Index> adjacency;
+    std::vector<Index> neighbors;
+    for (Index node_id = 0; node_id < number_of_nodes; ++node_id) {
+        neighbors.clear();
+        for (auto i = node_elements_offsets[node_id]; i < node_elements_offsets[node_id+1]; ++i) {
+            for (const auto & neighbor_id : element_nodes(node_elements[i])) {
+                if (static_cast<Index>(neighbor_id) != node_id) {
+                    neighbors.emplace_back(static_cast<Index>(neighbor_id));
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        adjacency.insert(adjacency.end(), neighbors.begin(), neighbors.end());
+        adjacency_offsets[node_id+1] = adjacency.size();
+    }
+
+    const auto degree = [&adjacency_offsets](const Index & node_id) {
+        return adjacency_offsets[node_id+1] - adjacency_offsets[node_id];
+    };
+
+    // Breadth first traversal from the given node, the neighbors being visited by increasing degree. The traversed
+    // nodes are appended to the given vector, and their level (distance to the start node) is written in levels.
+    constexpr auto NotVisited = std::numeric_limits<Index>::max();
+    std::vector<Index> levels (number_of_nodes, NotVisited);
+    const auto traverse = [&](const Index & start, std::vector<Index> & traversed) {
+        const auto begin = traversed.size();
+        traversed.emplace_back(start);
+        levels[start] = 0;
+        for (auto i = begin; i < traversed.size(); ++i) {
+            const auto node_id = traversed[i];
+            const auto first_neighbor = traversed.size();
+            for (auto j = adjacency_offsets[node_id]; j < adjacency_offsets[node_id+1]; ++j) {
+                const auto & neighbor_id = adjacency[j];
+                if (levels[neighbor_id] == NotVisited) {
+                    levels[neighbor_id] = levels[node_id] + 1;
+                    traversed.emplace_back(neighbor_id);
+                }
+            }
+            std::stable_sort(traversed.begin() + static_cast<std::ptrdiff_t>(first_neighbor), traversed.end(), [&degree](const Index & a, const Index & b) {
+                return degree(a) < degree(b);
+            });
+        }
+    };
+
+    // Nodes by increasing degree, the first one not yet ordered is the start of the next connected component
+    std::vector<Index> nodes_by_degree (number_of_nodes);
+    std::iota(nodes_by_degree.begin(), nodes_by_degree.end(), 0);
+    std::stable_sort(nodes_by_degree.begin(), nodes_by_degree.end(), [&degree](const Index & a, const Index & b) {
+        return degree(a) < degree(b);
+    });
+
+    std::vector<Index> order;
+    order.reserve(number_of_nodes);
+    std::vector<bool> is_ordered (number_of_nodes, false);
+    std::vector<Index> component;
+    std::vector<Index> candidate_component;
+    for (const auto & start : nodes_by_degree) {
+        if (is_ordered[start]) {
+            continue;
+        }
+
+        // Find a pseudo-peripheral node: restart from the node of minimum degree of the last level as long as the
+        // number of levels increases
+        Index root = start;
+        component.clear();
+        traverse(root, component);
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            const auto depth = levels[component.back()];
+            Index candidate = component.back();
+            for (auto it = component.rbegin(); it != component.rend() and levels[*it] == depth; ++it) {
+                if (degree(*it) < degree(candidate)) {
+                    candidate = *it;
+                }
+            }
+
+            for (const auto & node_id : component) {
+                levels[node_id] = NotVisited;
+            }
+            candidate_component.clear();
+            traverse(candidate, candidate_component);
+            if (levels[candidate_component.back()] > depth) {
+                root = candidate;
+                std::swap(component, candidate_component);
+                continue;
+            }
+
+            // No improvement, keep the traversal from the current root
+            for (const auto & node_id : candidate_component) {
+                levels[node_id] = NotVisited;
+            }
+            component.clear();
+            traverse(root, component);
+            break;
+        }
+
+        for (const auto & node_id : component) {
+            is_ordered[node_id] = true;
+        }
+        order.insert(order.end(), component.begin(), component.end());
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/**
+ * Ordering of a set of points along a Morton (Z-order) space-filling curve.
+ *
+ * The points are quantized on a regular grid covering their bounding box (with the same cell size along every axis),
+ * and sorted by the Morton code of their grid cell (ties are broken by their index).
+ *
+ * @param positions NxD matrix of the positions of the N points.
+ * @return The old index of every point (see Reordering::node_order).
+ */
+template <typename Derived>
+auto morton_order(const Eigen::MatrixBase<Derived> & positions) -> std::vector<UNSIGNED_INTEGER_TYPE> {
+    const auto number_of_points = static_cast<std::size_t>(positions.rows());
+    const auto dimension = static_cast<unsigned int>(positions.cols());
+    if (number_of_points == 0 or dimension == 0) {
+        return {};
+    }
+
+    const auto min = positions.colwise().minCoeff().template cast<double>().eval();
+    const auto max = positions.colwise().maxCoeff().template cast<double>().eval();
+    const double extent = (max - min).maxCoeff();
+
+    // Number of bits of the code per axis, and scaling from the world coordinates to the grid coordinates
+    const unsigned int bits = 63 / dimension;
+    const double scale = (extent > 0) ? static_cast<double>((std::uint64_t(1) << bits) - 1) / extent : 0.;
+
+    std::vector<std::pair<std::uint64_t, UNSIGNED_INTEGER_TYPE>> codes (number_of_points);
+#ifdef CARIBOU_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(number_of_points); ++i) {
+        std::uint64_t code = 0;
+        for (unsigned int axis = 0; axis < dimension; ++axis) {
+            const auto q = static_cast<std::uint64_t>((static_cast<double>(positions(i, axis)) - min[axis]) * scale);
+            for (unsigned int b = 0; b < bits; ++b) {
+                code |= ((q >> b) & 1u) << (b*dimension + axis);
+            }
+        }
+        codes[static_cast<std::size_t>(i)] = {code, static_cast<UNSIGNED_INTEGER_TYPE>(i)};
+    }
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<UNSIGNED_INTEGER_TYPE> order (number_of_points);
+    for (std::size_t i = 0; i < number_of_points; ++i) {
+        order[i] = codes[i].second;
+    }
+    return order;
+}
+
+/**
+ * Ordering of the elements of a mesh by their minimum (reordered) node index, such that the elements are visited in
+ * the same order as their nodes. Ties are broken by the original element index.
+ *
+ * @param number_of_elements Number of elements of the mesh.
+ * @param element_nodes Callable returning the (original) node indices of the element given as argument.
+ * @param node_order The old index of every node (see Reordering::node_order).
+ * @return The old index of every element (see Reordering::element_order).
+ */
+template <typename ElementNodes>
+auto elements_order(const UNSIGNED_INTEGER_TYPE & number_of_elements,
+                    ElementNodes && element_nodes,
+                    const std::vector<UNSIGNED_INTEGER_TYPE> & node_order) -> std::vector<UNSIGNED_INTEGER_TYPE> {
+    const auto new_node_indices = inverse_permutation(node_order);
+
+    std::vector<std::pair<UNSIGNED_INTEGER_TYPE, UNSIGNED_INTEGER_TYPE>> first_nodes (number_of_elements);
+    for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+        auto first_node = std::numeric_limits<UNSIGNED_INTEGER_TYPE>::max();
+        for (const auto & node_id : element_nodes(element_id)) {
+            first_node = std::min(first_node, new_node_indices[static_cast<UNSIGNED_INTEGER_TYPE>(node_id)]);
+        }
+        first_nodes[element_id] = {first_node, element_id};
+    }
+    std::sort(first_nodes.begin(), first_nodes.end());
+
+    std::vector<UNSIGNED_INTEGER_TYPE> order (number_of_elements);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = first_nodes[i].second;
+    }
+    return order;
+}
+
+/**
+ * Compute a reordering of the nodes and the elements of a mesh that improves the memory locality of the nodes of
+ * an element, and of the elements around a node.
+ *
+ * @param positions NxD matrix of the positions of the N nodes of the mesh.
+ * @param number_of_elements Number of elements of the mesh.
+ * @param element_nodes Callable returning the node indices of the element given as argument.
+ * @param node_ordering Ordering of the nodes.
+ * @param reorder_elements If true, the elements are sorted by their minimum node (see elements_order).
+ */
+template <typename Derived, typename ElementNodes>
+auto compute_reordering(const Eigen::MatrixBase<Derived> & positions,
+                        const UNSIGNED_INTEGER_TYPE & number_of_elements,
+                        ElementNodes && element_nodes,
+                        const NodeOrdering & node_ordering,
+                        const bool & reorder_elements) -> Reordering {
+    const auto number_of_nodes = static_cast<UNSIGNED_INTEGER_TYPE>(positions.rows());
+
+    Reordering reordering;
+    if (node_ordering == NodeOrdering::ReverseCuthillMcKee) {
+        reordering.node_order = reverse_cuthill_mckee_order(number_of_elements, number_of_nodes, element_nodes);
+    } else if (node_ordering == NodeOrdering::Morton) {
+        reordering.node_order = morton_order(positions);
+    } else {
+        reordering.node_order.resize(number_of_nodes);
+        std::iota(reordering.node_order.begin(), reordering.node_order.end(), 0);
+    }
+
+    if (reorder_elements) {
+        reordering.element_order = elements_order(number_of_elements, element_nodes, reordering.node_order);
+    } else {
+        reordering.element_order.resize(number_of_elements);
+        std::iota(reordering.element_order.begin(), reordering.element_order.end(), 0);
+    }
+
+    return reordering;
+}
+
+/**
+ * Create a reordered copy of a mesh domain (see compute_reordering).
+ *
+ * Example:
+ * \code{.cpp}
+ * auto [reordered_mesh, reordering] = reorder(mesh, *domain, NodeOrdering::ReverseCuthillMcKee);
+ * const auto * reordered_domain = reordered_mesh->domain(0);
+ * // ...solve on the reordered mesh, then map the nodal results back to the original node indices
+ * for (std::size_t i = 0; i < reordering.node_order.size(); ++i) {
+ *     u.row(reordering.node_order[i]) = reordered_u.row(i);
+ * }
+ * \endcode
+ *
+ * @param mesh The mesh containing the nodes of the domain.
+ * @param domain The domain to reorder.
+ * @param node_ordering Ordering of the nodes.
+ * @param reorder_elements If true, the elements are sorted by their minimum node (see elements_order).
+ * @return A new mesh containing the reordered nodes and a single domain (the reordered domain, having the same name
+ *         as the given one), and the permutation of the nodes and elements.
+ */
+template <unsigned int WorldDimension, typename NodeContainer, typename Element, typename NodeIndex>
+auto reorder(const Mesh<WorldDimension, NodeContainer> & mesh,
+             const Domain<Element, NodeIndex> & domain,
+             const NodeOrdering & node_ordering,
+             const bool & reorder_elements = true) -> std::pair<std::unique_ptr<Mesh<WorldDimension, NodeContainer>>, Reordering> {
+    using MeshType = Mesh<WorldDimension, NodeContainer>;
+    using Positions = Eigen::Matrix<typename MeshType::Real, Eigen::Dynamic, WorldDimension, (WorldDimension > 1 ? Eigen::RowMajor : Eigen::ColMajor)>;
+    using ElementsIndices = typename Domain<Element, NodeIndex>::ElementsIndices;
+
+    const auto number_of_nodes = mesh.number_of_nodes();
+    Positions positions (number_of_nodes, WorldDimension);
+    for (UNSIGNED_INTEGER_TYPE node_id = 0; node_id < number_of_nodes; ++node_id) {
+        positions.row(static_cast<Eigen::Index>(node_id)) = mesh.position(node_id);
+    }
+
+    const auto element_nodes = [&domain](const UNSIGNED_INTEGER_TYPE & element_id) {
+        return domain.element_indices(element_id);
+    };
+    auto reordering = compute_reordering(positions, domain.number_of_elements(), element_nodes, node_ordering, reorder_elements);
+
+    Positions reordered_positions (number_of_nodes, WorldDimension);
+    for (UNSIGNED_INTEGER_TYPE node_id = 0; node_id < number_of_nodes; ++node_id) {
+        reordered_positions.row(static_cast<Eigen::Index>(node_id)) = positions.row(static_cast<Eigen::Index>(reordering.node_order[node_id]));
+    }
+
+    const auto new_node_indices = inverse_permutation(reordering.node_order);
+    ElementsIndices reordered_indices (domain.number_of_elements(), domain.number_of_nodes_per_elements());
+    for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < domain.number_of_elements(); ++element_id) {
+        const auto node_indices = domain.element_indices(reordering.element_order[element_id]);
+        for (Eigen::Index i = 0; i < node_indices.size(); ++i) {
+            reordered_indices(static_cast<Eigen::Index>(element_id), i) = static_cast<NodeIndex>(new_node_indices[static_cast<UNSIGNED_INTEGER_TYPE>(node_indices[i])]);
+        }
+    }
+
+    std::string domain_name;
+    for (const auto & [name, d] : mesh.domains()) {
+        if (d == &domain) {
+            domain_name = name;
+        }
+    }
+
+    auto reordered_mesh = std::make_unique<MeshType>(reordered_positions);
+    if (domain_name.empty()) {
+        reordered_mesh->template add_domain<Element, NodeIndex>(reordered_indices);
+    } else {
+        reordered_mesh->template add_domain<Element, NodeIndex>(domain_name, reordered_indices);
+    }
+
+    return {std::move(reordered_mesh), std::move(reordering)};
+}
+
+} // namespace caribou::topology
@@ -1,5 +1,6 @@
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Algebra/BaseVectorOperations.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
@@ -10,6 +11,9 @@ DISABLE_ALL_WARNINGS_BEGIN
 #endif // #if (defined(SOFA_VERSION) && SOFA_VERSION < 211299)
 DISABLE_ALL_WARNINGS_END
 
+#include <cmath>
+#include <cstddef>
+
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
 namespace sofa {
 using Size = sofa::defaulttype::BaseVector::Index;
@@ -26,102 +30,175 @@ using namespace sofa::component::linearsolver;
 using namespace sofa::linearalgebra;
 #endif
 
+// Below this number of coefficients, the kernels are not worth being multithreaded
+constexpr std::ptrdiff_t parallel_threshold = 1 << 16;
+
+// Contiguous storage of the coefficients of a vector
+template <typename Real>
+struct Span {
+    Real * data = nullptr;
+    std::ptrdiff_t size = 0;
+};
+
+// Get the contiguous storage of a vector of the given scalar type, or an empty span if it has none
+template <typename Real>
+auto span_of(const BaseVector * v) -> Span<const Real> {
+    using EigenDenseVector = Eigen::Matrix<Real, Eigen::Dynamic, 1>;
+    if (const auto * full = dynamic_cast<const FullVector<Real> *>(v)) {
+        return {full->ptr(), static_cast<std::ptrdiff_t>(full->size())};
+    }
+    if (const auto * eigen = dynamic_cast<const EigenVector<EigenDenseVector> *>(v)) {
+        return {eigen->vector().data(), static_cast<std::ptrdiff_t>(eigen->vector().size())};
+    }
+    if (const auto * mapped = dynamic_cast<const EigenVector<Eigen::Map<EigenDenseVector>> *>(v)) {
+        return {mapped->vector().data(), static_cast<std::ptrdiff_t>(mapped->vector().size())};
+    }
+    return {};
+}
+
 template <typename Real>
-auto to_full_vector(const BaseVector* v) -> const FullVector<Real> * {
-    return dynamic_cast<const FullVector<Real> *>(v);
+auto span_of(BaseVector * v) -> Span<Real> {
+    const auto span = span_of<Real>(static_cast<const BaseVector *>(v));
+    return {const_cast<Real *>(span.data), span.size};
 }
 
-// Dot product between a SOFA full vector and any BaseVector
-template <typename ReturnValue, typename Real>
-ReturnValue dot(const FullVector<Real> * v1, const BaseVector * v2) {
-    const auto n = static_cast<sofa::Size>(v1->size());
-    auto value = static_cast<ReturnValue>(0);
-    for (sofa::Index i = 0; i < n; ++i) {
-        value +=  ( v1->element(i) * v2->element(i) );
+// Call f with the typed contiguous storage of v (either float or double).
+// Returns false if the vector has no contiguous storage.
+template <typename Vector, typename Function>
+bool with_span(Vector * v, Function && f) {
+    if (const auto span = span_of<double>(v); span.data) {
+        f(span);
+        return true;
     }
+    if (const auto span = span_of<float>(v); span.data) {
+        f(span);
+        return true;
+    }
+    return false;
+}
+
+// Call f with the typed contiguous storages of v1 and v2.
+// Returns false if one of the two vectors has no contiguous storage.
+template <typename Vector1, typename Vector2, typename Function>
+bool with_spans(Vector1 * v1, Vector2 * v2, Function && f) {
+    bool found = false;
+    with_span(v1, [&](auto s1) {
+        found = with_span(v2, [&](auto s2) {
+            f(s1, s2);
+        });
+    });
+    return found;
+}
 
+// Kernels
+template <typename Real1, typename Real2>
+double dot_kernel(const Real1 * x, const Real2 * y, std::ptrdiff_t n) {
+    double value = 0;
+    #pragma omp parallel for simd reduction(+:value) if (n > parallel_threshold)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+        value += static_cast<double>(x[i]) * static_cast<double>(y[i]);
+    }
     return value;
 }
 
-// Dot product between a two SOFA full vectors
-template <typename ReturnValue, typename Real1, typename Real2>
-ReturnValue dot(const FullVector<Real1> * v1, const FullVector<Real2> * v2) {
-    const auto n = static_cast<sofa::Size>(v1->size());
-    auto value = static_cast<ReturnValue>(0);
-    for (sofa::Index i = 0; i < n; ++i) {
-        value +=  ( v1->element(i) * v2->element(i) );
+template <typename Real1, typename Real2>
+void axpby_kernel(double a, const Real1 * x, double b, Real2 * y, std::ptrdiff_t n) {
+    #pragma omp parallel for simd if (n > parallel_threshold)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+        y[i] = static_cast<Real2>(a * x[i] + b * y[i]);
     }
+}
 
-    return value;
+template <typename Real1, typename Real2>
+void axpy_kernel(double a, const Real1 * x, Real2 * y, std::ptrdiff_t n) {
+    #pragma omp parallel for simd if (n > parallel_threshold)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+        y[i] += static_cast<Real2>(a * x[i]);
+    }
 }
+
+template <typename Real1, typename Real2>
+double axpy_dot_kernel(double a, const Real1 * x, Real2 * y, std::ptrdiff_t n) {
+    double value = 0;
+    #pragma omp parallel for simd reduction(+:value) if (n > parallel_threshold)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+        y[i] += static_cast<Real2>(a * x[i]);
+        value += static_cast<double>(y[i]) * static_cast<double>(y[i]);
+    }
+    return value;
 }
+} // namespace
 
 /** Compute the dot product between two BaseVector, i.e. scalar = v1.dot(v2) */
- double dot(const BaseVector * v1, const BaseVector * v2) {
+double dot(const BaseVector * v1, const BaseVector * v2) {
     caribou_assert(v1->size() == v2->size());
 
-    // todo(jnbrunet2000@gmail.com): This function is awful. I'm sure there is a much much cleaner and faster way
-    //                               to do this. But I'm running out of time.
+    double value = 0;
+    if (with_spans(v1, v2, [&value](auto s1, auto s2) { value = dot_kernel(s1.data, s2.data, s1.size); })) {
+        return value;
+    }
 
-    // Most common case first FullVector<SReal> - FullVector<SReal> :
-    {
-        const auto * full_v1 = to_full_vector<SReal >(v1);
-        const auto * full_v2 = to_full_vector<SReal >(v2);
-        if (full_v1 && full_v2) {
-            return full_v1->dot(*full_v2);
-        }
+    // Generic case (unoptimized!)
+    const auto n = static_cast<sofa::Size>(v1->size());
+    for (sofa::Index i = 0; i < n; ++i) {
+        value += static_cast<double>(v1->element(i)) * static_cast<double>(v2->element(i));
     }
 
-    // Next, we need to find the good virtual type....
+    return value;
+}
+
+/** Compute the euclidean norm of a BaseVector, i.e. scalar = |v| */
+double norm(const BaseVector * v) {
+    return std::sqrt(dot(v, v));
+}
+
+/** Compute y := a*x + y */
+void axpy(double a, const BaseVector * x, BaseVector * y) {
+    caribou_assert(x->size() == y->size());
 
-    // FullVector<double> - *
-    if (const auto * full_v1 = to_full_vector<double>(v1)) {
-        if (const auto * full_v2 = to_full_vector<double>(v2)) {
-            // FullVector<double> - FullVector<double>
-            return full_v1->dot(*full_v2);
-        } else if (const auto * full_v2 = to_full_vector<float>(v2)) {
-            // FullVector<double> - FullVector<float>
-            return dot<double>(full_v1, full_v2);
-        } else {
-            // FullVector<double> - BaseVector
-            return dot<double>(full_v1, v2);
-        }
+    if (with_spans(x, y, [a](auto sx, auto sy) { axpy_kernel(a, sx.data, sy.data, sx.size); })) {
+        return;
     }
 
-    // FullVector<float> - *
-    if (const auto * full_v1 = to_full_vector<float>(v1)) {
-        if (const auto * full_v2 = to_full_vector<float>(v2)) {
-            // FullVector<float> - FullVector<float>
-            return full_v1->dot(*full_v2);
-        } else if (const auto * full_v2 = to_full_vector<double>(v2)) {
-            // FullVector<float> - FullVector<double>
-            return dot<double>(full_v1, full_v2);
-        } else {
-            // FullVector<float> - BaseVector
-            return dot<double>(full_v1, v2);
-        }
+    // Generic case (unoptimized!)
+    const auto n = static_cast<sofa::Size>(x->size());
+    for (sofa::Index i = 0; i < n; ++i) {
+        y->add(i, static_cast<SReal>(a * x->element(i)));
     }
+}
+
+/** Compute y := a*x + b*y */
+void axpby(double a, const BaseVector * x, double b, BaseVector * y) {
+    caribou_assert(x->size() == y->size());
 
-    // v1 isn't a full vector... Maybe v2 is?
-    // * - FullVector<double>
-    if (const auto * full_v2 = to_full_vector<double>(v2)) {
-        return dot<double>(full_v2, v1);
+    if (with_spans(x, y, [a, b](auto sx, auto sy) { axpby_kernel(a, sx.data, b, sy.data, sx.size); })) {
+        return;
     }
 
-    // * - FullVector<float>
-    if (const auto * full_v2 = to_full_vector<float>(v2)) {
-        return dot<double>(full_v2, v1);
+    // Generic case (unoptimized!)
+    const auto n = static_cast<sofa::Size>(x->size());
+    for (sofa::Index i = 0; i < n; ++i) {
+        y->set(i, static_cast<SReal>(a * x->element(i) + b * y->element(i)));
+    }
+}
+
+/** Compute y := a*x + y, and return y.dot(y) */
+double axpy_dot(double a, const BaseVector * x, BaseVector * y) {
+    caribou_assert(x->size() == y->size());
+
+    double value = 0;
+    if (with_spans(x, y, [a, &value](auto sx, auto sy) { value = axpy_dot_kernel(a, sx.data, sy.data, sx.size); })) {
+        return value;
     }
 
     // Generic case (unoptimized!)
-    // * - *
-    const auto n = static_cast<sofa::Size>(v1->size());
-    auto value = static_cast<SReal>(0);
+    const auto n = static_cast<sofa::Size>(x->size());
     for (sofa::Index i = 0; i < n; ++i) {
-        value +=  ( v1->element(i) * v2->element(i) );
+        y->add(i, static_cast<SReal>(a * x->element(i)));
+        value += static_cast<double>(y->element(i)) * static_cast<double>(y->element(i));
     }
 
-    return static_cast<double> (value);
+    return value;
 }
 
 } // namespace SofaCaribou::Algebra
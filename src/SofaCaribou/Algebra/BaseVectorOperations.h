@@ -23,14 +23,34 @@ using BaseVector = sofa::defaulttype::BaseVector;
 using BaseVector = sofa::linearalgebra::BaseVector;
 #endif
 
+// All the following operations dispatch on the concrete storage of the vectors. When both vectors store their
+// coefficients contiguously (FullVector<float>, FullVector<double>, or an EigenVector of a dense or mapped Eigen
+// vector of float or double), a typed SIMD kernel is used, multithreaded for large vectors. Otherwise, the operation
+// falls back to the (slow) element-by-element virtual access of the BaseVector.
+
 /**
- * Compute the dot product between two BaseVector, i.e. scalar = v1.dot(v2) *
- *
- * @todo (jnbrunet2000@gmail.com) : this could be much more optimal using delegate functions. For example, we could first
- *                                  get a callback to an optimal dot function for these types of v1 and v2, and later
- *                                  simply reuse this callback. Hence we avoid the need to do multiple virtual checks
- *                                  each time this function is called
+ * Compute the dot product between two BaseVector, i.e. scalar = v1.dot(v2)
  */
  double dot(const BaseVector * v1, const BaseVector * v2);
 
+/**
+ * Compute the euclidean norm of a BaseVector, i.e. scalar = |v|
+ */
+ double norm(const BaseVector * v);
+
+/**
+ * Compute y := a*x + y
+ */
+ void axpy(double a, const BaseVector * x, BaseVector * y);
+
+/**
+ * Compute y := a*x + b*y
+ */
+ void axpby(double a, const BaseVector * x, double b, BaseVector * y);
+
+/**
+ * Compute y := a*x + y, and return the squared norm y.dot(y) of the updated vector y computed during the same pass.
+ */
+ double axpy_dot(double a, const BaseVector * x, BaseVector * y);
+
 } // namespace SofaCaribou::Algebra
@@ -27,6 +27,9 @@ using Mat = ::sofa::defaulttype::Mat<N, M, Real>;
 #include <Eigen/Core>
 #include <Eigen/Sparse>
 
+#include <utility>
+#include <vector>
+
 namespace SofaCaribou::Algebra {
 
 /**
@@ -212,6 +215,32 @@ public:
      */
     inline void set_symmetric(bool is_symmetric) { p_is_symmetric = is_symmetric; }
 
+    /** States if only the upper triangular part of the (symmetric) matrix is stored. */
+    inline bool symmetric_storage() const {return p_symmetric_storage;}
+
+    /**
+     * Explicitly states if only the upper triangular part of this matrix is stored, which implies that the matrix is
+     * symmetric. In this mode:
+     *   1. Contributions added to an off-diagonal entry (i, j) are folded to the upper entry (min(i,j), max(i,j)) with
+     *      a weight of one half. Since the assembly of a symmetric matrix adds the same contribution to (i, j) and
+     *      (j, i), the upper entry receives the complete value. More generally, the stored matrix is the symmetric
+     *      part (A + At) / 2 of the assembled matrix A.
+     *   2. Entries set or read at (i, j) with i > j are folded to the entry (j, i).
+     *   3. The row i and the column i share the same stored coefficients, hence clearing one of them clears both.
+     *      The coefficients of the column i of a row major matrix (or of the row i of a column major matrix) are
+     *      found with an index of the inner vectors, built on the first clear following a change of the sparsity
+     *      pattern. Clearing a row and column is then linear in the number of its coefficients.
+     *
+     * This halves the number of coefficients assembled, sorted and stored. The matrix should then be consumed as a
+     * self-adjoint view, e.g. A.selfadjointView<Eigen::Upper>() or by a Cholesky solver using Eigen::Upper.
+     */
+    inline void set_symmetric_storage(bool symmetric_storage) {
+        p_symmetric_storage = symmetric_storage;
+        if (symmetric_storage) {
+            p_is_symmetric = true;
+        }
+    }
+
     /**
      * @brief Return the matrix entry (i,j).
      * \warning If the matrix hasn't been initialized by calling compress() or set(), this
@@ -219,6 +248,9 @@ public:
      */
     inline Real  element(Index i, Index j) const final {
         caribou_assert(p_initialized && "Accessing an element on an uninitialized matrix.");
+        if (p_symmetric_storage and i > j) {
+            std::swap(i, j);
+        }
         return this->p_eigen_matrix.coeff(i,j);
     }
 
@@ -227,6 +259,7 @@ public:
         p_triplets.clear();
         this->p_eigen_matrix.resize(nbRow, nbCol);
         p_initialized = false;
+        p_inner_index_is_built = false;
     }
 
     /** Set all entries to zero. Keeps the current matrix dimensions. */
@@ -234,6 +267,7 @@ public:
         p_triplets.clear();
         this->p_eigen_matrix.setZero();
         p_initialized = false;
+        p_inner_index_is_built = false;
     }
 
     /**
@@ -249,6 +283,10 @@ public:
             initialize();
         }
 
+        if (p_symmetric_storage and i > j) {
+            std::swap(i, j);
+        }
+
         this->p_eigen_matrix.coeffRef(i, j) = static_cast<Scalar>(v);
     }
 
@@ -259,6 +297,14 @@ public:
      *          become uncompressed.
      */
     inline void  add(Index i, Index j, double v) final {
+        if (p_symmetric_storage and i != j) {
+            // The contributions added to (i, j) and (j, i) are both folded to the upper entry
+            if (i > j) {
+                std::swap(i, j);
+            }
+            v *= 0.5;
+        }
+
         // Note: this "if" condition should't slow down that much the addition of multiple entries
         //       because of branch predictions (the conditional branch will be same for the next
         //       X calls to add until compress is called).
@@ -295,6 +341,11 @@ public:
             initialize();
         }
 
+        if (p_symmetric_storage) {
+            clearRowCol(row_id);
+            return;
+        }
+
         using StorageIndex = typename EigenType::StorageIndex;
 
         if constexpr (EigenType::IsRowMajor) {
@@ -319,6 +370,13 @@ public:
             initialize();
         }
 
+        if (p_symmetric_storage) {
+            for (Index i = imin; i <= imax; ++i) {
+                clearRowCol(i);
+            }
+            return;
+        }
+
         using StorageIndex = typename EigenType::StorageIndex;
 
         if constexpr (EigenType::IsRowMajor) {
@@ -347,6 +405,11 @@ public:
             initialize();
         }
 
+        if (p_symmetric_storage) {
+            clearRowCol(col_id);
+            return;
+        }
+
         using StorageIndex = typename EigenType::StorageIndex;
 
         if constexpr (not EigenType::IsRowMajor) {
@@ -371,6 +434,13 @@ public:
             initialize();
         }
 
+        if (p_symmetric_storage) {
+            for (Index i = imin; i <= imax; ++i) {
+                clearRowCol(i);
+            }
+            return;
+        }
+
         using StorageIndex = typename EigenType::StorageIndex;
 
         if constexpr (not EigenType::IsRowMajor) {
@@ -407,7 +477,18 @@ public:
         std::memset(&(p_eigen_matrix.data().valuePtr()[start]), static_cast<int>(0), (end-start)*sizeof(Scalar));
 
         // Next, to clear the ith inner coefficients of each row in row-major (each column in column-major)
-        if (symmetric() and p_eigen_matrix.rows() == p_eigen_matrix.cols()) {
+        if (p_symmetric_storage) {
+            // Only the upper triangular part is stored. The remaining coefficients are the entries (k, i), k < i, of a
+            // row major matrix, or the entries (i, k), k > i, of a column major matrix. These are the coefficients of
+            // inner index i, which are given by the inner index without searching every outer vector.
+            if (not inner_index_is_up_to_date()) {
+                build_inner_index();
+            }
+            const auto inner_id = static_cast<std::size_t>(i);
+            for (auto k = p_inner_index_start[inner_id]; k < p_inner_index_start[inner_id+1]; ++k) {
+                p_eigen_matrix.data().value(p_inner_index_positions[k]) = static_cast<const Scalar &>(0);
+            }
+        } else if (symmetric() and p_eigen_matrix.rows() == p_eigen_matrix.cols()) {
             // When the sparse matrix is symmetric, we can avoid doing the binary search on each inner vectors. Instead,
             // We loop on each inner coefficient of the ith outer vector (eg each (i,j) of the ith row in row major)
             // and do the binary search only on the jth outer vector
@@ -444,11 +525,19 @@ private:
         using StorageIndex = typename Eigen::SparseMatrix<typename EigenType::Scalar>::StorageIndex;
         for (unsigned int k=0;k<N;++k) {
             for (unsigned int l=0;l<C;++l) {
-                const auto value = static_cast<typename EigenType::Scalar>(m[k][l]);
+                auto row = i+k, col = j+l;
+                auto value = static_cast<typename EigenType::Scalar>(m[k][l]);
+                if (p_symmetric_storage and row != col) {
+                    // The contributions added to (row, col) and (col, row) are both folded to the upper entry
+                    if (row > col) {
+                        std::swap(row, col);
+                    }
+                    value *= 0.5;
+                }
                 if (not p_initialized) {
-                    p_triplets.emplace_back(static_cast<StorageIndex>(i+k), static_cast<StorageIndex>(j+l), value);
+                    p_triplets.emplace_back(static_cast<StorageIndex>(row), static_cast<StorageIndex>(col), value);
                 } else {
-                    p_eigen_matrix.coeffRef(i+k, j+l) += value;
+                    p_eigen_matrix.coeffRef(row, col) += value;
                 }
             }
         }
@@ -463,6 +552,42 @@ private:
         p_eigen_matrix.setFromTriplets(p_triplets.begin(), p_triplets.end());
         p_triplets.clear();
         p_initialized = true;
+        p_inner_index_is_built = false;
+    }
+
+    /**
+     * The inner index is up to date if the sparsity pattern didn't change since it was built. Adding a new coefficient
+     * to an initialized matrix uncompresses it, and changes its number of non-zeros once it is compressed again.
+     */
+    bool inner_index_is_up_to_date() const {
+        return p_inner_index_is_built
+           and p_eigen_matrix.isCompressed()
+           and static_cast<std::size_t>(p_eigen_matrix.nonZeros()) == p_inner_index_positions.size();
+    }
+
+    /**
+     * Build the positions (in the value array) of the coefficients of each inner index, such that the coefficients of
+     * inner index i are at p_inner_index_positions[p_inner_index_start[i]:p_inner_index_start[i+1]].
+     */
+    void build_inner_index() {
+        p_eigen_matrix.makeCompressed();
+        const auto number_of_coefficients = static_cast<std::size_t>(p_eigen_matrix.nonZeros());
+        const auto * inner_indices = p_eigen_matrix.innerIndexPtr();
+
+        p_inner_index_start.assign(static_cast<std::size_t>(p_eigen_matrix.innerSize()+1), 0);
+        for (std::size_t k = 0; k < number_of_coefficients; ++k) {
+            ++p_inner_index_start[static_cast<std::size_t>(inner_indices[k])+1];
+        }
+        for (std::size_t i = 1; i < p_inner_index_start.size(); ++i) {
+            p_inner_index_start[i] += p_inner_index_start[i-1];
+        }
+
+        std::vector<std::size_t> next (p_inner_index_start.begin(), p_inner_index_start.end()-1);
+        p_inner_index_positions.resize(number_of_coefficients);
+        for (std::size_t k = 0; k < number_of_coefficients; ++k) {
+            p_inner_index_positions[next[static_cast<std::size_t>(inner_indices[k])]++] = k;
+        }
+        p_inner_index_is_built = true;
     }
 
     ///< Triplets are used to store matrix entries before the call to 'compress'.
@@ -480,6 +605,18 @@ private:
     ///< States if the matrix is symmetric. Note that this value isn't set automatically, the user must
     ///< explicitly specify it using set_symmetric(true). When it is true, some optimizations will be enabled.
     bool p_is_symmetric = false;
+
+    ///< States if only the upper triangular part of the matrix is stored (see set_symmetric_storage).
+    bool p_symmetric_storage = false;
+
+    ///< Positions of the coefficients of each inner index, grouped by inner index (see build_inner_index).
+    std::vector<std::size_t> p_inner_index_positions;
+
+    ///< Start of the coefficients of each inner index in p_inner_index_positions.
+    std::vector<std::size_t> p_inner_index_start;
+
+    ///< Whether or not the inner index has been built since the last initialization of the matrix.
+    bool p_inner_index_is_built = false;
 };
 
 } // namespace SofaCaribou::Algebra
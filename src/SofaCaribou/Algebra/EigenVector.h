@@ -11,6 +11,8 @@ DISABLE_ALL_WARNINGS_END
 
 #include <Eigen/Dense>
 
+#include <stdexcept>
+
 namespace SofaCaribou::Algebra {
 
 /**
@@ -102,4 +104,37 @@ private:
     Derived p_eigen_vector;
 };
 
+/**
+ * Get a mapping over the coefficients of a BaseVector that is either an EigenVector<Vector> holding its own
+ * coefficients, or an EigenVector<Eigen::Map<Vector>> viewing an external buffer (for example, the buffer of a
+ * mechanical object). This allows the linear solvers to work on both types of vectors without copying them.
+ *
+ * @throws std::runtime_error if the vector isn't one of these two types.
+ */
+template <typename Vector>
+auto eigen_vector_map(BaseVector * v) -> Eigen::Map<Vector> {
+    if (auto * owned = dynamic_cast<EigenVector<Vector> *>(v)) {
+        return Eigen::Map<Vector>(owned->vector().data(), owned->vector().size());
+    }
+    if (auto * mapped = dynamic_cast<EigenVector<Eigen::Map<Vector>> *>(v)) {
+        return Eigen::Map<Vector>(mapped->vector().data(), mapped->vector().size());
+    }
+    throw std::runtime_error("The vector isn't an Eigen vector of the expected type.");
+}
+
+/**
+ * Get a read-only mapping over the coefficients of a BaseVector.
+ * @see eigen_vector_map(BaseVector *)
+ */
+template <typename Vector>
+auto eigen_vector_map(const BaseVector * v) -> Eigen::Map<const Vector> {
+    if (const auto * owned = dynamic_cast<const EigenVector<Vector> *>(v)) {
+        return Eigen::Map<const Vector>(owned->vector().data(), owned->vector().size());
+    }
+    if (const auto * mapped = dynamic_cast<const EigenVector<Eigen::Map<Vector>> *>(v)) {
+        return Eigen::Map<const Vector>(mapped->vector().data(), mapped->vector().size());
+    }
+    throw std::runtime_error("The vector isn't an Eigen vector of the expected type.");
+}
+
 } // namespace SofaCaribou::Algebra
@@ -0,0 +1,183 @@
+#include <SofaCaribou/Algebra/MappedMatrices.h>
+
+#include <set>
+#include <vector>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/core/BaseMapping.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#else
+#include <sofa/linearalgebra/CompressedRowSparseMatrix.h>
+#endif
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::Algebra {
+
+namespace {
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+using CompressedRowSparseMatrix = sofa::component::linearsolver::CompressedRowSparseMatrix<SReal>;
+#else
+using CompressedRowSparseMatrix = sofa::linearalgebra::CompressedRowSparseMatrix<SReal>;
+#endif
+
+using Triplets = std::vector<Eigen::Triplet<SReal>>;
+
+/**
+ * Gather the non-zero entries of K when it wraps an Eigen sparse matrix of type EigenSparseMatrix. Returns false if K
+ * is of another type.
+ */
+template <typename EigenSparseMatrix>
+bool gather_eigen_entries(BaseMatrix & K, Triplets & entries) {
+    auto * matrix = dynamic_cast<EigenMatrix<EigenSparseMatrix> *>(&K);
+    if (not matrix) {
+        return false;
+    }
+
+    matrix->compress();
+    const auto & m = matrix->matrix();
+    for (Eigen::Index i = 0; i < m.outerSize(); ++i) {
+        for (typename EigenSparseMatrix::InnerIterator it(m, i); it; ++it) {
+            entries.emplace_back(it.row(), it.col(), it.value());
+
+            // Only the upper triangle of a symmetric storage is kept
+            if (matrix->symmetric_storage() and it.row() != it.col()) {
+                entries.emplace_back(it.col(), it.row(), it.value());
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Gather the non-zero entries of K when it is a compressed row sparse matrix, which is the type of the matrices created
+ * by the DefaultMultiMatrixAccessor for the mapped states. Returns false if K is of another type.
+ */
+bool gather_compressed_row_entries(BaseMatrix & K, Triplets & entries) {
+    auto * matrix = dynamic_cast<CompressedRowSparseMatrix *>(&K);
+    if (not matrix) {
+        return false;
+    }
+
+    matrix->compress();
+    for (std::size_t r = 0; r < matrix->rowIndex.size(); ++r) {
+        const auto i = matrix->rowIndex[r];
+        for (auto k = matrix->rowBegin[r]; k < matrix->rowBegin[r+1]; ++k) {
+            entries.emplace_back(i, matrix->colsIndex[k], matrix->colsValue[k]);
+        }
+    }
+    return true;
+}
+
+/** Gather the non-zero entries of the matrix K. */
+void gather_entries(BaseMatrix & K, Triplets & entries) {
+    using Index = BaseMatrix::Index;
+
+    entries.clear();
+    if (gather_compressed_row_entries(K, entries)
+        or gather_eigen_entries<Eigen::SparseMatrix<SReal, Eigen::RowMajor>>(K, entries)
+        or gather_eigen_entries<Eigen::SparseMatrix<SReal, Eigen::ColMajor>>(K, entries)) {
+        return;
+    }
+
+    // Other matrix types are read entry by entry
+    const auto n = K.rowSize();
+    for (Index i = 0; i < n; ++i) {
+        for (Index j = 0; j < n; ++j) {
+            const auto v = K.element(i, j);
+            if (v != 0) {
+                entries.emplace_back(i, j, v);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void add_mapped_matrices(sofa::component::linearsolver::DefaultMultiMatrixAccessor & accessor,
+                         sofa::core::objectmodel::BaseContext * context) {
+    using sofa::core::BaseMapping;
+    using sofa::core::behavior::BaseMechanicalState;
+    using sofa::core::objectmodel::BaseContext;
+    using Index = BaseMatrix::Index;
+    using SparseMatrix = SparseJacobian::EigenType;
+
+    struct MappedMatrix {
+        const SparseMatrix * J; ///< Jacobian of the mapping
+        BaseMatrix * K; ///< Matrix of the mapped state
+        BaseMatrix * A; ///< Matrix of the parent state
+        Index offset; ///< Position of the parent state inside the matrix A
+    };
+
+    const auto mappings = context->getObjects<BaseMapping>(BaseContext::SearchDown);
+
+    // States that are the output of a mechanical mapping
+    std::set<const BaseMechanicalState *> mapped_states;
+    for (auto * mapping : mappings) {
+        if (mapping->isMechanical()) {
+            for (const auto * state : mapping->getMechTo()) {
+                mapped_states.insert(state);
+            }
+        }
+    }
+
+    std::vector<MappedMatrix> mapped_matrices;
+    for (auto * mapping : mappings) {
+        if (not mapping->isMechanical() or not mapping->areMatricesMapped()) {
+            continue;
+        }
+
+        const auto from = mapping->getMechFrom();
+        const auto to = mapping->getMechTo();
+        if (to.size() != 1) {
+            accessor.computeGlobalMatrix();
+            return;
+        }
+
+        const auto K = accessor.getMatrix(to[0]);
+        if (not K.matrix) {
+            continue; // Nothing was assembled on the mapped state
+        }
+
+        // Mappings of mappings must be projected from the bottom up, leave them to SOFA
+        const auto * J = (from.size() == 1 and mapped_states.find(from[0]) == mapped_states.end())
+                         ? dynamic_cast<const SparseJacobian *>(mapping->getJ())
+                         : nullptr;
+        const auto A = (J) ? accessor.getMatrix(from[0]) : decltype(K) {};
+        if (not J or not A.matrix
+            or J->rowSize() != K.matrix->rowSize()
+            or J->colSize() != static_cast<Index>(from[0]->getMatrixSize())) {
+            accessor.computeGlobalMatrix();
+            return;
+        }
+
+        mapped_matrices.push_back({&J->matrix(), K.matrix, A.matrix, static_cast<Index>(A.offset)});
+    }
+
+    Triplets entries;
+    for (const auto & mapped_matrix : mapped_matrices) {
+        const auto & J = *mapped_matrix.J;
+
+        // Gather the non-zero entries of the mapped matrix
+        gather_entries(*mapped_matrix.K, entries);
+
+        SparseMatrix Ks (J.rows(), J.rows());
+        Ks.setFromTriplets(entries.begin(), entries.end());
+
+        // Jt K J only has non-zero entries between parent nodes sharing a mapped node
+        const SparseMatrix JtKJ = SparseMatrix(J.transpose()) * (Ks * J);
+
+        auto & A = *mapped_matrix.A;
+        const auto & offset = mapped_matrix.offset;
+        for (Eigen::Index i = 0; i < JtKJ.outerSize(); ++i) {
+            for (SparseMatrix::InnerIterator it(JtKJ, i); it; ++it) {
+                A.add(offset + static_cast<Index>(it.row()), offset + static_cast<Index>(it.col()), it.value());
+            }
+        }
+    }
+}
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Algebra/EigenMatrix.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <Eigen/Sparse>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Jacobian matrix of a mechanical mapping stored as a compressed row major Eigen sparse matrix (one row per mapped
+ * degree of freedom, one column per parent degree of freedom).
+ *
+ * A mapping returning this type from BaseMapping::getJ() (for example, the CaribouBarycentricMapping) has its mapped
+ * matrices projected with sparse matrix products by add_mapped_matrices.
+ */
+using SparseJacobian = EigenMatrix<Eigen::SparseMatrix<SReal, Eigen::RowMajor>>;
+
+/**
+ * Accumulate the matrices of the mapped mechanical states found in the given context sub-graph into the matrices of
+ * their parent states, i.e. A += Jt K J where K is the matrix of a mapped state, A the matrix of its parent state and
+ * J the Jacobian of the mapping between them.
+ *
+ * When every mechanical mapping having matrices to project maps a single top level (non-mapped) state, and gives its
+ * Jacobian as a SparseJacobian, the product Jt K J is computed with sparse matrix products, and only its non-zero
+ * entries are added to the global matrix. The non-zero entries of K are read directly from its storage when it is a
+ * CompressedRowSparseMatrix (the type created by the accessor for the mapped states) or a sparse EigenMatrix, and
+ * entry by entry for other matrix types. Otherwise, this is the same as accessor.computeGlobalMatrix(), which
+ * projects the mapped matrices entry by entry.
+ *
+ * @param accessor The matrix accessor on which the matrices have been assembled. Its global matrix must be set.
+ * @param context The context of the sub-graph on which the matrices have been assembled.
+ */
+void add_mapped_matrices(sofa::component::linearsolver::DefaultMultiMatrixAccessor & accessor,
+                         sofa::core::objectmodel::BaseContext * context);
+
+} // namespace SofaCaribou::Algebra
@@ -0,0 +1,75 @@
+#include <SofaCaribou/Algebra/MechanicalStateBuffer.h>
+
+#include <type_traits>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/behavior/MechanicalState.h>
+#include <sofa/defaulttype/VecTypes.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::Algebra {
+
+namespace { // Anonymous
+using Buffer = std::pair<FLOATING_POINT_TYPE *, std::size_t>;
+
+template <typename DataTypes>
+auto buffer_of(sofa::core::behavior::BaseMechanicalState * state, const sofa::core::MultiVecDerivId & id) -> Buffer {
+    if constexpr (std::is_same_v<typename DataTypes::Real, FLOATING_POINT_TYPE>) {
+        auto * typed_state = dynamic_cast<sofa::core::behavior::MechanicalState<DataTypes> *>(state);
+        if (not typed_state) {
+            return {nullptr, 0};
+        }
+
+        auto * data = typed_state->write(id.getId(typed_state));
+        if (not data) {
+            return {nullptr, 0};
+        }
+
+        Buffer buffer {nullptr, 0};
+        auto & vector = *data->beginEdit();
+        if (not vector.empty()) {
+            buffer = {vector[0].ptr(), vector.size() * DataTypes::deriv_total_size};
+        }
+        data->endEdit();
+
+        return buffer;
+    } else {
+        return {nullptr, 0};
+    }
+}
+} // namespace
+
+auto mechanical_state_buffer(sofa::core::objectmodel::BaseContext * context, const sofa::core::MultiVecDerivId & id)
+    -> std::pair<FLOATING_POINT_TYPE *, std::size_t> {
+    using sofa::core::objectmodel::BaseContext;
+    using sofa::core::behavior::BaseMechanicalState;
+
+    // More than one mechanical state means either multiple top level states, or mapped states. In both cases, the
+    // global system vector is not a single contiguous buffer.
+    const auto states = context->getObjects<BaseMechanicalState>(BaseContext::SearchDown);
+    if (states.size() != 1) {
+        return {nullptr, 0};
+    }
+
+    return mechanical_state_buffer(states[0], id);
+}
+
+auto mechanical_state_buffer(sofa::core::behavior::BaseMechanicalState * state, const sofa::core::MultiVecDerivId & id)
+    -> std::pair<FLOATING_POINT_TYPE *, std::size_t> {
+    if (not state) {
+        return {nullptr, 0};
+    }
+
+    if (auto buffer = buffer_of<sofa::defaulttype::Vec3Types>(state, id); buffer.first) {
+        return buffer;
+    }
+
+    if (auto buffer = buffer_of<sofa::defaulttype::Vec2Types>(state, id); buffer.first) {
+        return buffer;
+    }
+
+    return buffer_of<sofa::defaulttype::Vec1Types>(state, id);
+}
+
+} // namespace SofaCaribou::Algebra
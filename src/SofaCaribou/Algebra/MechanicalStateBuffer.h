@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+#include <cstddef>
+#include <utility>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/core/MultiVecId.h>
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Get the contiguous buffer holding the coefficients of the vector id of the mechanical state found in the given
+ * context sub-graph.
+ *
+ * A buffer is only returned when the sub-graph contains a single mechanical state (hence, no mapped mechanical
+ * objects), and when this state stores its coefficients as an array of FLOATING_POINT_TYPE (Vec3, Vec2 or Vec1
+ * types). In this case, the global system vector of the sub-graph is exactly this buffer, and it can be used in
+ * place (for example, by mapping an Eigen vector over it) instead of being copied back and forth with the
+ * MechanicalMultiVectorToBaseVectorVisitor and MechanicalMultiVectorFromBaseVectorVisitor.
+ *
+ * @return A pair (pointer, size). The pointer is null when no such buffer exists.
+ *
+ * @note The buffer is only valid until the mechanical state is resized.
+ */
+auto mechanical_state_buffer(sofa::core::objectmodel::BaseContext * context, const sofa::core::MultiVecDerivId & id)
+    -> std::pair<FLOATING_POINT_TYPE *, std::size_t>;
+
+/**
+ * Get the contiguous buffer holding the coefficients of the vector id of the given mechanical state, if it stores
+ * them as an array of FLOATING_POINT_TYPE (Vec3, Vec2 or Vec1 types). Unlike the context version, the caller is
+ * responsible to make sure that this state is the only one of its sub-graph. This version does not allocate.
+ *
+ * @return A pair (pointer, size). The pointer is null when no such buffer exists.
+ */
+auto mechanical_state_buffer(sofa::core::behavior::BaseMechanicalState * state, const sofa::core::MultiVecDerivId & id)
+    -> std::pair<FLOATING_POINT_TYPE *, std::size_t>;
+
+} // namespace SofaCaribou::Algebra
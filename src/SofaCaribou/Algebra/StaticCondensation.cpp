@@ -0,0 +1,270 @@
+#include <SofaCaribou/Algebra/StaticCondensation.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace SofaCaribou::Algebra {
+
+void StaticCondensation::analyze_pattern(const SparseMatrix & A, const std::vector<bool> & candidates,
+                                         Eigen::Index block_size, Eigen::Index maximum_patch_size) {
+    const auto n = A.cols();
+    block_size = std::max<Eigen::Index>(block_size, 1);
+    maximum_patch_size = std::max<Eigen::Index>(maximum_patch_size, 1);
+    const auto number_of_nodes = (n + block_size - 1) / block_size;
+
+    // Node adjacency from the (possibly unsymmetric) pattern of A
+    std::vector<std::vector<Eigen::Index>> adjacency (static_cast<std::size_t>(number_of_nodes));
+    for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+        const auto node_j = j / block_size;
+        for (SparseMatrix::InnerIterator it(A, j); it; ++it) {
+            const auto node_i = it.row() / block_size;
+            if (node_i != node_j) {
+                adjacency[static_cast<std::size_t>(node_i)].emplace_back(node_j);
+                adjacency[static_cast<std::size_t>(node_j)].emplace_back(node_i);
+            }
+        }
+    }
+    for (auto & neighbors : adjacency) {
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+    // A node can only be condensed if all of its dofs are candidates
+    enum class State : unsigned char {Kept, Free, Condensed};
+    std::vector<State> state (static_cast<std::size_t>(number_of_nodes), State::Kept);
+    for (Eigen::Index node = 0; node < number_of_nodes; ++node) {
+        bool candidate = true;
+        for (Eigen::Index i = node*block_size; i < std::min((node+1)*block_size, n); ++i) {
+            candidate = candidate and candidates[static_cast<std::size_t>(i)];
+        }
+        if (candidate) {
+            state[static_cast<std::size_t>(node)] = State::Free;
+        }
+    }
+
+    // Grow the patches. Once a patch is closed, its free neighbors are kept: they become the separators that
+    // guarantee that two patches are never directly coupled.
+    std::vector<std::vector<Eigen::Index>> patches_nodes;
+    for (Eigen::Index seed = 0; seed < number_of_nodes; ++seed) {
+        if (state[static_cast<std::size_t>(seed)] != State::Free) {
+            continue;
+        }
+
+        std::vector<Eigen::Index> patch {seed};
+        state[static_cast<std::size_t>(seed)] = State::Condensed;
+        std::deque<Eigen::Index> queue {seed};
+        while (not queue.empty() and static_cast<Eigen::Index>(patch.size()) < maximum_patch_size) {
+            const auto node = queue.front();
+            queue.pop_front();
+            for (const auto & neighbor : adjacency[static_cast<std::size_t>(node)]) {
+                if (static_cast<Eigen::Index>(patch.size()) >= maximum_patch_size) {
+                    break;
+                }
+                if (state[static_cast<std::size_t>(neighbor)] == State::Free) {
+                    state[static_cast<std::size_t>(neighbor)] = State::Condensed;
+                    patch.emplace_back(neighbor);
+                    queue.emplace_back(neighbor);
+                }
+            }
+        }
+
+        for (const auto & node : patch) {
+            for (const auto & neighbor : adjacency[static_cast<std::size_t>(node)]) {
+                if (state[static_cast<std::size_t>(neighbor)] == State::Free) {
+                    state[static_cast<std::size_t>(neighbor)] = State::Kept;
+                }
+            }
+        }
+
+        patches_nodes.emplace_back(std::move(patch));
+    }
+
+    // Number the dofs
+    p_kept.clear();
+    p_patches.clear();
+    p_reduced_index.assign(static_cast<std::size_t>(n), -1);
+    p_patch_of.assign(static_cast<std::size_t>(n), -1);
+    p_local_index.assign(static_cast<std::size_t>(n), -1);
+
+    p_patches.resize(patches_nodes.size());
+    for (std::size_t patch_id = 0; patch_id < patches_nodes.size(); ++patch_id) {
+        auto & patch = p_patches[patch_id];
+        auto & nodes = patches_nodes[patch_id];
+        std::sort(nodes.begin(), nodes.end());
+        for (const auto & node : nodes) {
+            for (Eigen::Index i = node*block_size; i < std::min((node+1)*block_size, n); ++i) {
+                p_patch_of[static_cast<std::size_t>(i)] = static_cast<int>(patch_id);
+                p_local_index[static_cast<std::size_t>(i)] = static_cast<int>(patch.dofs.size());
+                patch.dofs.emplace_back(static_cast<int>(i));
+            }
+        }
+    }
+
+    for (Eigen::Index i = 0; i < n; ++i) {
+        if (p_patch_of[static_cast<std::size_t>(i)] < 0) {
+            p_reduced_index[static_cast<std::size_t>(i)] = static_cast<int>(p_kept.size());
+            p_kept.emplace_back(static_cast<int>(i));
+        }
+    }
+
+    // Kept dofs coupled to each patch
+    for (std::size_t patch_id = 0; patch_id < patches_nodes.size(); ++patch_id) {
+        auto & patch = p_patches[patch_id];
+        for (const auto & node : patches_nodes[patch_id]) {
+            for (const auto & neighbor : adjacency[static_cast<std::size_t>(node)]) {
+                for (Eigen::Index i = neighbor*block_size; i < std::min((neighbor+1)*block_size, n); ++i) {
+                    const auto & reduced_index = p_reduced_index[static_cast<std::size_t>(i)];
+                    if (reduced_index >= 0) {
+                        patch.neighbors.emplace_back(reduced_index);
+                    }
+                }
+            }
+        }
+        std::sort(patch.neighbors.begin(), patch.neighbors.end());
+        patch.neighbors.erase(std::unique(patch.neighbors.begin(), patch.neighbors.end()), patch.neighbors.end());
+    }
+}
+
+bool StaticCondensation::condense(const SparseMatrix & A) {
+    const auto number_of_patches = static_cast<int>(p_patches.size());
+    const auto number_of_kept = static_cast<int>(p_kept.size());
+
+    const SparseMatrix At = A.transpose(); // Column j of At is the row j of A
+
+    std::vector<Eigen::Triplet<Real>> triplets;
+    triplets.reserve(static_cast<std::size_t>(A.nonZeros()));
+
+    // Block A_kk
+    for (const auto & j : p_kept) {
+        const auto reduced_j = p_reduced_index[static_cast<std::size_t>(j)];
+        for (SparseMatrix::InnerIterator it(A, j); it; ++it) {
+            const auto reduced_i = p_reduced_index[static_cast<std::size_t>(it.row())];
+            if (reduced_i >= 0) {
+                triplets.emplace_back(reduced_i, reduced_j, it.value());
+            }
+        }
+    }
+
+    // Contribution -A_kp A_pp^-1 A_pk of each patch
+    std::vector<DenseMatrix> contributions (static_cast<std::size_t>(number_of_patches));
+    bool success = true;
+
+#pragma omp parallel for reduction(&& : success)
+    for (int patch_id = 0; patch_id < number_of_patches; ++patch_id) {
+        auto & patch = p_patches[static_cast<std::size_t>(patch_id)];
+        const auto m = static_cast<Eigen::Index>(patch.dofs.size());
+        const auto nn = static_cast<Eigen::Index>(patch.neighbors.size());
+
+        auto neighbor_index = [&patch](int reduced_index) -> Eigen::Index {
+            const auto it = std::lower_bound(patch.neighbors.begin(), patch.neighbors.end(), reduced_index);
+            return static_cast<Eigen::Index>(std::distance(patch.neighbors.begin(), it));
+        };
+
+        DenseMatrix A_pp = DenseMatrix::Zero(m, m);
+        patch.A_kp.setZero(nn, m);
+        patch.A_pk.setZero(m, nn);
+
+        for (Eigen::Index l = 0; l < m; ++l) {
+            const auto & dof = patch.dofs[static_cast<std::size_t>(l)];
+
+            // Column "dof" of A gives A_pp and A_kp
+            for (SparseMatrix::InnerIterator it(A, dof); it; ++it) {
+                const auto row = static_cast<std::size_t>(it.row());
+                if (p_patch_of[row] == patch_id) {
+                    A_pp(p_local_index[row], l) = it.value();
+                } else if (p_reduced_index[row] >= 0) {
+                    patch.A_kp(neighbor_index(p_reduced_index[row]), l) = it.value();
+                }
+            }
+
+            // Row "dof" of A gives A_pk
+            for (SparseMatrix::InnerIterator it(At, dof); it; ++it) {
+                const auto col = static_cast<std::size_t>(it.row());
+                if (p_reduced_index[col] >= 0) {
+                    patch.A_pk(l, neighbor_index(p_reduced_index[col])) = it.value();
+                }
+            }
+        }
+
+        patch.A_pp.compute(A_pp);
+        if (not (patch.A_pp.rcond() > std::numeric_limits<Real>::epsilon())) {
+            success = false;
+            continue;
+        }
+
+        contributions[static_cast<std::size_t>(patch_id)].noalias() = - patch.A_kp * patch.A_pp.solve(patch.A_pk);
+    }
+
+    if (not success) {
+        return false;
+    }
+
+    for (std::size_t patch_id = 0; patch_id < p_patches.size(); ++patch_id) {
+        const auto & neighbors = p_patches[patch_id].neighbors;
+        const auto & contribution = contributions[patch_id];
+        for (Eigen::Index j = 0; j < contribution.cols(); ++j) {
+            for (Eigen::Index i = 0; i < contribution.rows(); ++i) {
+                triplets.emplace_back(neighbors[static_cast<std::size_t>(i)], neighbors[static_cast<std::size_t>(j)], contribution(i, j));
+            }
+        }
+    }
+
+    p_S.resize(number_of_kept, number_of_kept);
+    p_S.setFromTriplets(triplets.begin(), triplets.end());
+    p_S.makeCompressed();
+
+    return true;
+}
+
+void StaticCondensation::condense_rhs(const Vector & F, Vector & F_kept) const {
+    F_kept.resize(static_cast<Eigen::Index>(p_kept.size()));
+    for (std::size_t i = 0; i < p_kept.size(); ++i) {
+        F_kept[static_cast<Eigen::Index>(i)] = F[p_kept[i]];
+    }
+
+    for (const auto & patch : p_patches) {
+        Vector F_p (static_cast<Eigen::Index>(patch.dofs.size()));
+        for (std::size_t l = 0; l < patch.dofs.size(); ++l) {
+            F_p[static_cast<Eigen::Index>(l)] = F[patch.dofs[l]];
+        }
+
+        const Vector F_k = patch.A_kp * patch.A_pp.solve(F_p);
+        for (std::size_t i = 0; i < patch.neighbors.size(); ++i) {
+            F_kept[patch.neighbors[i]] -= F_k[static_cast<Eigen::Index>(i)];
+        }
+    }
+}
+
+void StaticCondensation::recover(const Vector & F, const Vector & X_kept, Vector & X) const {
+    X.resize(static_cast<Eigen::Index>(p_reduced_index.size()));
+    for (std::size_t i = 0; i < p_kept.size(); ++i) {
+        X[p_kept[i]] = X_kept[static_cast<Eigen::Index>(i)];
+    }
+
+    const auto number_of_patches = static_cast<int>(p_patches.size());
+#pragma omp parallel for
+    for (int patch_id = 0; patch_id < number_of_patches; ++patch_id) {
+        const auto & patch = p_patches[static_cast<std::size_t>(patch_id)];
+        Vector F_p (static_cast<Eigen::Index>(patch.dofs.size()));
+        for (std::size_t l = 0; l < patch.dofs.size(); ++l) {
+            F_p[static_cast<Eigen::Index>(l)] = F[patch.dofs[l]];
+        }
+
+        Vector X_k (static_cast<Eigen::Index>(patch.neighbors.size()));
+        for (std::size_t i = 0; i < patch.neighbors.size(); ++i) {
+            X_k[static_cast<Eigen::Index>(i)] = X_kept[patch.neighbors[i]];
+        }
+
+        const Vector X_p = patch.A_pp.solve(F_p - patch.A_pk * X_k);
+        for (std::size_t l = 0; l < patch.dofs.size(); ++l) {
+            X[patch.dofs[l]] = X_p[static_cast<Eigen::Index>(l)];
+        }
+    }
+}
+
+} // namespace SofaCaribou::Algebra
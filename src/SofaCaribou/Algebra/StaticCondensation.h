@@ -0,0 +1,113 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <vector>
+
+namespace SofaCaribou::Algebra {
+
+/**
+ * Static condensation of locally coupled degrees of freedom (dofs) of a sparse system A x = F.
+ *
+ * A set of candidate dofs (for example, the edge-midpoint nodes of quadratic elements) is split into small patches
+ * that are never coupled to each other. The block A_cc of the condensed dofs is then block-diagonal, and each patch
+ * can be eliminated independently with a dense factorization. The remaining (kept) dofs are solved using the Schur
+ * complement
+ *
+ * \f{eqnarray*}{
+ *     \mat{S} = \mat{A}_{kk} - \mat{A}_{kc} \mat{A}_{cc}^{-1} \mat{A}_{ck}
+ * \f}
+ *
+ * with the condensed right-hand side \f$ \vect{F}_k - \mat{A}_{kc} \mat{A}_{cc}^{-1} \vect{F}_c \f$. The condensed dofs
+ * are finally recovered with \f$ \vect{x}_c = \mat{A}_{cc}^{-1} (\vect{F}_c - \mat{A}_{ck} \vect{x}_k) \f$.
+ *
+ * Since edge nodes are shared between neighbouring elements, candidates adjacent to an existing patch are kept in the
+ * reduced system. These act as separators between the patches, which keeps the elimination exact.
+ */
+class StaticCondensation {
+public:
+    using Real = FLOATING_POINT_TYPE;
+    using SparseMatrix = Eigen::SparseMatrix<Real, Eigen::ColMajor, int>;
+    using DenseMatrix = Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic>;
+    using Vector = Eigen::Matrix<Real, Eigen::Dynamic, 1>;
+
+    /**
+     * Split the candidate dofs into independent patches using the sparsity pattern of A.
+     *
+     * @param A The (square) system matrix. Only its pattern is used.
+     * @param candidates Flag for each dof of the system stating if it can be condensed.
+     * @param block_size Number of consecutive dofs of a node. A node is only condensed if all of its dofs are candidates.
+     * @param maximum_patch_size Maximum number of nodes per patch.
+     */
+    void analyze_pattern(const SparseMatrix & A, const std::vector<bool> & candidates,
+                         Eigen::Index block_size, Eigen::Index maximum_patch_size);
+
+    /**
+     * Factorize the patches of condensed dofs and compute the Schur complement S on the kept dofs.
+     * @return False if one of the patch blocks is singular, true otherwise.
+     */
+    bool condense(const SparseMatrix & A);
+
+    /** Compute the condensed right-hand side F_k - A_kc A_cc^-1 F_c from the complete right-hand side F. */
+    void condense_rhs(const Vector & F, Vector & F_kept) const;
+
+    /** Recover the complete solution X from the complete right-hand side F and the solution of the kept dofs. */
+    void recover(const Vector & F, const Vector & X_kept, Vector & X) const;
+
+    /** The Schur complement S (number_of_kept_dofs x number_of_kept_dofs). */
+    inline auto S() const -> const SparseMatrix & { return p_S; }
+
+    /** Total number of dofs of the complete system. */
+    inline auto number_of_dofs() const -> Eigen::Index { return static_cast<Eigen::Index>(p_reduced_index.size()); }
+
+    /** Number of dofs remaining in the condensed system S. */
+    inline auto number_of_kept_dofs() const -> Eigen::Index { return static_cast<Eigen::Index>(p_kept.size()); }
+
+    /** Number of dofs eliminated by the condensation. */
+    inline auto number_of_condensed_dofs() const -> Eigen::Index { return number_of_dofs() - number_of_kept_dofs(); }
+
+    /** Number of independent patches of condensed dofs. */
+    inline auto number_of_patches() const -> Eigen::Index { return static_cast<Eigen::Index>(p_patches.size()); }
+
+private:
+    struct Patch {
+        /// Global indices of the condensed dofs of this patch
+        std::vector<int> dofs;
+
+        /// Reduced indices (in S) of the kept dofs coupled to this patch
+        std::vector<int> neighbors;
+
+        /// Factorization of the patch block A_pp
+        Eigen::PartialPivLU<DenseMatrix> A_pp;
+
+        /// Coupling A_pk (patch dofs x neighbors)
+        DenseMatrix A_pk;
+
+        /// Coupling A_kp (neighbors x patch dofs)
+        DenseMatrix A_kp;
+    };
+
+    /// Global indices of the kept dofs
+    std::vector<int> p_kept;
+
+    /// Index of each dof in the reduced system, or -1 if the dof is condensed
+    std::vector<int> p_reduced_index;
+
+    /// Patch of each dof, or -1 if the dof is kept
+    std::vector<int> p_patch_of;
+
+    /// Index of each condensed dof inside its patch
+    std::vector<int> p_local_index;
+
+    /// Independent patches of condensed dofs
+    std::vector<Patch> p_patches;
+
+    /// Schur complement on the kept dofs
+    SparseMatrix p_S;
+};
+
+} // namespace SofaCaribou::Algebra
@@ -1,6 +1,9 @@
 #include <numeric>
 #include <queue>
 #include <array>
+#include <map>
+#include <cmath>
+#include <limits>
 
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Forcefield/HexahedronElasticForce.h>
@@ -36,6 +39,11 @@ using TBoundingBox = ::sofa::defaulttype::TBoundingBox<Real> ;
 
 #include <Caribou/Geometry/Hexahedron.h>
 #include <Caribou/Mechanics/Elasticity/Strain.h>
+#include <Caribou/Topology/ElementColoring.h>
+
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
 
 #if !EIGEN_VERSION_AT_LEAST(3,3,0)
 namespace Eigen {
@@ -75,6 +83,19 @@ HexahedronElasticForce::HexahedronElasticForce()
                   OnePointGauss: One gauss point integration at the center of the hexahedron
                 )",
         true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_enable_multithreading(initData(&d_enable_multithreading,
+        false, "enable_multithreading",
+        "Compute the rotations, the stiffness matrices and the forces of the elements in parallel. Hexahedra sharing a "
+        "node are never processed at the same time. When enabled, use the environment variable OMP_NUM_THREADS=N to use "
+        "N threads.",
+        true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_share_stiffness_matrices(initData(&d_share_stiffness_matrices,
+        false, "share_stiffness_matrices",
+        "Compute and store only once the stiffness matrix of hexahedra having the same rest shape up to a translation "
+        "(for example, the elements of a regular grid). Node positions are compared up to 1e-6 times the size of "
+        "the smallest element. This greatly reduces the memory used by the stiffness matrices of large structured "
+        "meshes.",
+        true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
 , d_topology_container(initLink(
         "topology_container", "Topology that contains the elements on which this force will be computed."))
 {
@@ -194,7 +215,52 @@ void HexahedronElasticForce::reinit()
     msg_info() << "Total volume is " << v;
 
     // Initialize the stiffness matrix of every hexahedrons
-    p_stiffness_matrices.resize(topology->getNbHexahedra());
+    p_stiffness_indices.resize(topology->getNbHexahedra());
+    p_stiffness_representatives.clear();
+    if (d_share_stiffness_matrices.getValue()) {
+        // Two hexahedra share their stiffness matrix if the positions of their nodes relative to their first node
+        // are the same. These relative positions are rounded to the nearest multiple of a step equal to
+        // relative_tolerance times the size of the smallest hexahedron (the largest distance between its first node and
+        // its other nodes). The rounded values are kept as floating point numbers, so they can't overflow. Congruent
+        // hexahedra whose positions fall on both sides of a rounding boundary only get distinct (but still exact)
+        // stiffness matrices.
+        constexpr Real relative_tolerance = 1e-6;
+        Real smallest_size = std::numeric_limits<Real>::max();
+        for (std::size_t hexa_id = 0; hexa_id < topology->getNbHexahedra(); ++hexa_id) {
+            const auto & node_indices = topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id));
+            Real size = 0;
+            for (sofa::Index j = 1; j < NumberOfNodes; ++j) {
+                size = std::max(size, static_cast<Real>((X[node_indices[j]] - X[node_indices[0]]).norm()));
+            }
+            smallest_size = std::min(smallest_size, size);
+        }
+        const Real step = relative_tolerance * ((smallest_size > 0) ? smallest_size : Real(1));
+
+        std::map<std::array<Real, NumberOfNodes*3>, UNSIGNED_INTEGER_TYPE> stiffness_of_shape;
+        for (std::size_t hexa_id = 0; hexa_id < topology->getNbHexahedra(); ++hexa_id) {
+            const auto & node_indices = topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id));
+            std::array<Real, NumberOfNodes*3> shape {};
+            for (sofa::Index j = 0; j < NumberOfNodes; ++j) {
+                for (sofa::Size i = 0; i < 3; ++i) {
+                    shape[j*3+i] = std::round((X[node_indices[j]][i] - X[node_indices[0]][i]) / step);
+                }
+            }
+
+            const auto inserted = stiffness_of_shape.emplace(shape, p_stiffness_representatives.size());
+            if (inserted.second) {
+                p_stiffness_representatives.emplace_back(hexa_id);
+            }
+            p_stiffness_indices[hexa_id] = inserted.first->second;
+        }
+        msg_info() << p_stiffness_representatives.size() << " distinct stiffness matrices are shared by the "
+                   << topology->getNbHexahedra() << " hexahedra.";
+    } else {
+        for (std::size_t hexa_id = 0; hexa_id < topology->getNbHexahedra(); ++hexa_id) {
+            p_stiffness_representatives.emplace_back(hexa_id);
+            p_stiffness_indices[hexa_id] = hexa_id;
+        }
+    }
+    p_stiffness_matrices.resize(p_stiffness_representatives.size());
     p_initial_rotation.resize(topology->getNbHexahedra(), Mat33::Identity());
     p_current_rotation.resize(topology->getNbHexahedra(), Mat33::Identity());
 
@@ -206,6 +272,11 @@ void HexahedronElasticForce::reinit()
         }
     }
 
+    // Group the hexahedra that do not share any node, in order to accumulate their forces concurrently
+    p_element_colors = caribou::topology::color_elements(topology->getNbHexahedra(), X.size(), [topology](const UNSIGNED_INTEGER_TYPE & hexa_id) {
+        return topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id));
+    });
+
     // Compute the initial tangent stiffness matrix
     compute_K();
 }
@@ -225,7 +296,7 @@ void HexahedronElasticForce::addForce(
     if (!topology or !state)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbHexahedra())
+    if (p_stiffness_indices.size() != topology->getNbHexahedra())
         return;
 
     sofa::helper::ReadAccessor<Data<VecCoord>> x = d_x;
@@ -236,27 +307,36 @@ void HexahedronElasticForce::addForce(
     std::vector<Rotation> & current_rotation = p_current_rotation;
 
     bool corotated = d_corotated.getValue();
+    const bool enable_multithreading = d_enable_multithreading.getValue();
+
+    // The hexahedra are read concurrently, make sure they are built by the topology beforehand
+    const auto & hexahedra = topology->getHexahedra();
 
     sofa::helper::AdvancedTimer::stepBegin("HexahedronElasticForce::addForce");
-    const auto number_of_elements = topology->getNbHexahedra();
-    for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
-        Hexahedron hexa = hexahedron(hexa_id, x);
+    const auto number_of_elements = static_cast<std::size_t>(topology->getNbHexahedra());
 
-        const Rotation & R0 = initial_rotation[hexa_id];
-        const Rotation R0t = R0.transpose();
+    // Extract the hexahedra's frames
+    if (corotated) {
+        #pragma omp parallel for if (enable_multithreading)
+        for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+            current_rotation[hexa_id] = hexahedron(hexa_id, x).frame({0, 0, 0});
+        }
 
-        Rotation & R = current_rotation[hexa_id];
+        // The rotations of the elements, and hence their stiffness matrices, changed
+        ++p_stiffness_revision;
+    }
 
-        // Extract the hexahedron's frame
-        if (corotated)
-            R = hexa.frame({0, 0, 0});
+    const auto add_element_force = [&](std::size_t hexa_id) {
+        const Rotation & R0 = initial_rotation[hexa_id];
+        const Rotation R0t = R0.transpose();
 
+        const Rotation & R = current_rotation[hexa_id];
         const Rotation Rt = R.transpose();
 
         // Gather the displacement vector
         Vec24 U;
         Eigen::Index i = 0;
-        for (const auto &node_id : topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id))) {
+        for (const auto &node_id : hexahedra[static_cast<Topology::HexaID>(hexa_id)]) {
             const Vec3 r0 {x0[node_id][0], x0[node_id][1],  x0[node_id][2]};
             const Vec3 r  {x [node_id][0],  x [node_id][1], x [node_id][2]};
 
@@ -268,12 +348,17 @@ void HexahedronElasticForce::addForce(
         }
 
         // Compute the force vector
-        const auto &K = p_stiffness_matrices[hexa_id];
-        Vec24 F = K.template selfadjointView<Eigen::Upper>() * U;
+        const auto & stiffness_id = p_stiffness_indices[hexa_id];
+        Vec24 F;
+        if (p_dense_stiffness_matrices.empty()) {
+            F = p_stiffness_matrices[stiffness_id] * U;
+        } else {
+            F = p_dense_stiffness_matrices[stiffness_id] * U;
+        }
 
         // Write the forces into the output vector
         i = 0;
-        for (const auto &node_id : topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id))) {
+        for (const auto &node_id : hexahedra[static_cast<Topology::HexaID>(hexa_id)]) {
             Vec3 force {F[i*3+0], F[i*3+1], F[i*3+2]};
             force = R*force;
 
@@ -282,7 +367,22 @@ void HexahedronElasticForce::addForce(
             f[node_id][2] -= force[2];
             ++i;
         }
+    };
+
+    if (enable_multithreading) {
+        // Hexahedra of the same color do not share any node, their forces can be accumulated concurrently
+        for (const auto & elements : p_element_colors) {
+            #pragma omp parallel for
+            for (std::size_t i = 0; i < elements.size(); ++i) {
+                add_element_force(elements[i]);
+            }
+        }
+    } else {
+        for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+            add_element_force(hexa_id);
+        }
     }
+
     sofa::helper::AdvancedTimer::stepEnd("HexahedronElasticForce::addForce");
 }
 
@@ -297,25 +397,29 @@ void HexahedronElasticForce::addDForce(
     if (!topology or !state)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbHexahedra())
+    if (p_stiffness_indices.size() != topology->getNbHexahedra())
         return;
 
     auto kFactor = static_cast<Real>(mparams->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue()));
     sofa::helper::ReadAccessor<Data<VecDeriv>> dx = d_dx;
     sofa::helper::WriteAccessor<Data<VecDeriv>> df = d_df;
-    std::vector<Rotation> & current_rotation = p_current_rotation;
+    const std::vector<Rotation> & current_rotation = p_current_rotation;
+    const bool enable_multithreading = d_enable_multithreading.getValue();
+
+    // The hexahedra are read concurrently, make sure they are built by the topology beforehand
+    const auto & hexahedra = topology->getHexahedra();
 
     sofa::helper::AdvancedTimer::stepBegin("HexahedronElasticForce::addDForce");
-    const auto number_of_elements = topology->getNbHexahedra();
-    for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+    const auto number_of_elements = static_cast<std::size_t>(topology->getNbHexahedra());
 
+    const auto add_element_dforce = [&](std::size_t hexa_id) {
         const Rotation & R  = current_rotation[hexa_id];
         const Rotation   Rt = R.transpose();
 
         // Gather the displacement vector
         Vec24 U;
         Eigen::Index i = 0;
-        for (const auto & node_id : topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id))) {
+        for (const auto & node_id : hexahedra[static_cast<Topology::HexaID>(hexa_id)]) {
             const Vec3 v = {dx[node_id][0], dx[node_id][1], dx[node_id][2]};
             const Vec3 u = Rt*v;
 
@@ -325,12 +429,17 @@ void HexahedronElasticForce::addDForce(
         }
 
         // Compute the force vector
-        const auto & K = p_stiffness_matrices[hexa_id];
-        Vec24 F = K.template selfadjointView<Eigen::Upper>()*U*kFactor;
+        const auto & stiffness_id = p_stiffness_indices[hexa_id];
+        Vec24 F;
+        if (p_dense_stiffness_matrices.empty()) {
+            F = p_stiffness_matrices[stiffness_id]*U*kFactor;
+        } else {
+            F = p_dense_stiffness_matrices[stiffness_id]*U*kFactor;
+        }
 
         // Write the forces into the output vector
         i = 0;
-        for (const auto & node_id : topology->getHexahedron(static_cast<Topology::HexaID>(hexa_id))) {
+        for (const auto & node_id : hexahedra[static_cast<Topology::HexaID>(hexa_id)]) {
             Vec3 force {F[i*3+0], F[i*3+1], F[i*3+2]};
             force = R*force;
 
@@ -340,6 +449,20 @@ void HexahedronElasticForce::addDForce(
 
             ++i;
         }
+    };
+
+    if (enable_multithreading) {
+        // Hexahedra of the same color do not share any node, their forces can be accumulated concurrently
+        for (const auto & elements : p_element_colors) {
+            #pragma omp parallel for
+            for (std::size_t i = 0; i < elements.size(); ++i) {
+                add_element_dforce(elements[i]);
+            }
+        }
+    } else {
+        for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
+            add_element_dforce(hexa_id);
+        }
     }
     sofa::helper::AdvancedTimer::stepEnd("HexahedronElasticForce::addDForce");
 }
@@ -368,15 +491,16 @@ void HexahedronElasticForce::addKToMatrix(SofaCaribou::Algebra::BaseMatrix * mat
 
         // Since the matrix K is block symmetric, we only kept the DxD blocks on the upper-triangle the matrix.
         // Here we need to accumulate the full matrix into Sofa's BaseMatrix.
-        const auto & K = p_stiffness_matrices[hexa_id];
+        const auto & K = packed_stiffness_matrix_of(hexa_id);
 
         // Blocks on the diagonal
         for (sofa::Index i = 0; i < NumberOfNodes; ++i) {
             const auto x = static_cast<Eigen::Index>(i*3);
+            const Mat33 Ke = K.block<3,3>(x, x);
             sofa::type::Mat<3, 3, Real> Kii;
             for (Eigen::Index m = 0; m < 3; ++m) {
                 for (Eigen::Index n = 0; n < 3; ++n) {
-                    Kii(static_cast<sofa::Index>(m), static_cast<sofa::Index>(n)) = K(x+m, x+n);
+                    Kii(static_cast<sofa::Index>(m), static_cast<sofa::Index>(n)) = Ke(m, n);
                 }
             }
 
@@ -391,10 +515,11 @@ void HexahedronElasticForce::addKToMatrix(SofaCaribou::Algebra::BaseMatrix * mat
                 const auto x = static_cast<Eigen::Index>(i*3);
                 const auto y = static_cast<Eigen::Index>(j*3);
 
+                const Mat33 Ke = K.block<3,3>(x, y);
                 sofa::type::Mat<3, 3, Real> Kij;
-                for (size_t m = 0; m < 3; ++m) {
-                    for (size_t n = 0; n < 3; ++n) {
-                        Kij(static_cast<sofa::Index>(m), static_cast<sofa::Index>(n)) = K(x+m, y+n);
+                for (Eigen::Index m = 0; m < 3; ++m) {
+                    for (Eigen::Index n = 0; n < 3; ++n) {
+                        Kij(static_cast<sofa::Index>(m), static_cast<sofa::Index>(n)) = Ke(m, n);
                     }
                 }
 
@@ -415,7 +540,7 @@ void HexahedronElasticForce::compute_K()
     if (!topology)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbHexahedra())
+    if (p_stiffness_indices.size() != topology->getNbHexahedra())
         return;
 
     const Real youngModulus = d_youngModulus.getValue();
@@ -434,10 +559,13 @@ void HexahedronElasticForce::compute_K()
         0,         0,          0,       0,  0, mu;
     sofa::helper::AdvancedTimer::stepBegin("HexahedronElasticForce::compute_k");
 
-    const auto number_of_elements = topology->getNbHexahedra();
-    for (std::size_t hexa_id = 0; hexa_id < number_of_elements; ++hexa_id) {
-        auto & K = p_stiffness_matrices[hexa_id];
-        K.fill(0.);
+    // Hexahedra sharing the same stiffness matrix are only computed once
+    const auto number_of_stiffness_matrices = p_stiffness_matrices.size();
+    const bool enable_multithreading = d_enable_multithreading.getValue();
+    #pragma omp parallel for if (enable_multithreading)
+    for (std::size_t stiffness_id = 0; stiffness_id < number_of_stiffness_matrices; ++stiffness_id) {
+        const auto & hexa_id = p_stiffness_representatives[stiffness_id];
+        Mat2424 K = Mat2424::Zero();
 
         for (GaussNode &gauss_node : p_quadrature_nodes[hexa_id]) {
             // Jacobian of the gauss node's transformation mapping from the elementary space to the world space
@@ -478,9 +606,23 @@ void HexahedronElasticForce::compute_K()
                 }
             }
         }
+
+        p_stiffness_matrices[stiffness_id] = StiffnessMatrix(K);
+    }
+
+    // The few shared matrices stay in cache, where Eigen's dense product is several times faster than the packed one.
+    // The packed product only pays off when the matrices are read from memory (see the PackedSymmetricMatrix
+    // benchmark).
+    p_dense_stiffness_matrices.clear();
+    if (d_share_stiffness_matrices.getValue()) {
+        p_dense_stiffness_matrices.reserve(p_stiffness_matrices.size());
+        for (const auto & K : p_stiffness_matrices) {
+            p_dense_stiffness_matrices.emplace_back(K.matrix());
+        }
     }
     K_is_up_to_date = false;
     eigenvalues_are_up_to_date = false;
+    ++p_stiffness_revision;
     sofa::helper::AdvancedTimer::stepEnd("HexahedronElasticForce::compute_k");
 }
 
@@ -510,12 +652,12 @@ const Eigen::SparseMatrix<HexahedronElasticForce::Real> & HexahedronElasticForce
 
                 // Since the matrix K is block symmetric, we only kept the DxD blocks on the upper-triangle the matrix.
                 // Here we need to accumulate the full matrix into Sofa's BaseMatrix.
-                const auto &Ke = p_stiffness_matrices[hexa_id];
+                const auto & Ke = packed_stiffness_matrix_of(hexa_id);
 
                 // Blocks on the diagonal
                 for (Eigen::Index i = 0; i < NumberOfNodes; ++i) {
                     const auto x = static_cast<int>(node_indices[static_cast<sofa::Index>(i)]*3);
-                    const Mat33 Kii = -1 * R * Ke.block<3,3>(i,i) * Rt;
+                    const Mat33 Kii = -1 * R * Ke.block<3,3>(i*3, i*3) * Rt;
                     for (int m = 0; m < 3; ++m) {
                         for (int n = 0; n < 3; ++n) {
                             triplets.emplace_back(x+m, x+n, Kii(m,n));
@@ -529,7 +671,7 @@ const Eigen::SparseMatrix<HexahedronElasticForce::Real> & HexahedronElasticForce
                         const auto x = static_cast<int>(node_indices[i]*3);
                         const auto y = static_cast<int>(node_indices[j]*3);
 
-                        const Mat33 Kij = -1 * R * Ke.block<3,3>(i,j) * Rt;
+                        const Mat33 Kij = -1 * R * Ke.block<3,3>(static_cast<Eigen::Index>(i*3), static_cast<Eigen::Index>(j*3)) * Rt;
 
                         for (int m = 0; m < 3; ++m) {
                             for (int n = 0; n < 3; ++n) {
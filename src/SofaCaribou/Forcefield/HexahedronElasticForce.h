@@ -14,6 +14,7 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/helper/OptionsGroup.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <Caribou/Algebra/PackedSymmetricMatrix.h>
 #include <Caribou/Geometry/Hexahedron.h>
 
 #include <Eigen/Sparse>
@@ -67,6 +68,7 @@ public:
     using Vec3   = Vector<3>;
     using Mat2424 = Matrix<24, 24, Eigen::RowMajor>;
     using Vec24   = Vector<24>;
+    using StiffnessMatrix = caribou::algebra::PackedSymmetricMatrix<24, Real>;
 
     template <typename ObjectType>
     using Link = SingleLink<HexahedronElasticForce, ObjectType, BaseLink::FLAG_STRONGLINK>;
@@ -171,8 +173,25 @@ public:
         return p_quadrature_nodes[hexahedron_id];
     }
 
-    const Matrix<24, 24> & stiffness_matrix_of(std::size_t hexahedron_id) const {
-        return p_stiffness_matrices[hexahedron_id];
+    /**
+     * Get a dense copy of the upper triangle of the elementary stiffness matrix of a hexahedron (its lower triangle is
+     * zero). This is meant for inspection, use packed_stiffness_matrix_of to read the entries without copying them.
+     */
+    Matrix<24, 24> stiffness_matrix_of(std::size_t hexahedron_id) const {
+        return p_stiffness_matrices[p_stiffness_indices[hexahedron_id]].upper_triangle();
+    }
+
+    /** Get the packed elementary stiffness matrix of a hexahedron */
+    const StiffnessMatrix & packed_stiffness_matrix_of(std::size_t hexahedron_id) const {
+        return p_stiffness_matrices[p_stiffness_indices[hexahedron_id]];
+    }
+
+    /**
+     * Get the number of elementary stiffness matrices stored. This is the number of hexahedra, unless congruent
+     * hexahedra share their stiffness matrix (see the share_stiffness_matrices option).
+     */
+    std::size_t number_of_stiffness_matrices() const {
+        return p_stiffness_matrices.size();
     }
 
     /** Get the complete tangent stiffness matrix */
@@ -187,6 +206,15 @@ public:
 
     Real cond();
 
+    /**
+     * Revision number of the tangent stiffness matrix added by addKToMatrix. It is incremented every time this matrix
+     * may have changed, i.e. when the elementary stiffness matrices are recomputed, or when the rotations of corotated
+     * elements are updated.
+     */
+    UNSIGNED_INTEGER_TYPE stiffness_revision() const {
+        return p_stiffness_revision;
+    }
+
 private:
     /** (Re)Compute the tangent stiffness matrix */
     virtual void compute_K();
@@ -196,17 +224,24 @@ protected:
     Data< Real > d_poissonRatio;
     Data< bool > d_corotated;
     Data< sofa::helper::OptionsGroup > d_integration_method;
+    Data< bool > d_enable_multithreading;
+    Data< bool > d_share_stiffness_matrices;
     Link<BaseMeshTopology>   d_topology_container;
 
 private:
-    std::vector<Matrix<24, 24>> p_stiffness_matrices;
+    std::vector<StiffnessMatrix> p_stiffness_matrices; ///< Upper triangles of the distinct elementary stiffness matrices
+    std::vector<StiffnessMatrix::Matrix> p_dense_stiffness_matrices; ///< Dense copies of the shared stiffness matrices (empty when not shared)
+    std::vector<UNSIGNED_INTEGER_TYPE> p_stiffness_indices; ///< Index of the stiffness matrix of each hexahedron
+    std::vector<UNSIGNED_INTEGER_TYPE> p_stiffness_representatives; ///< Hexahedron from which each stiffness matrix is computed
     std::vector<std::vector<GaussNode>> p_quadrature_nodes;
     std::vector<Rotation> p_initial_rotation;
     std::vector<Rotation> p_current_rotation;
+    std::vector<std::vector<UNSIGNED_INTEGER_TYPE>> p_element_colors; ///< Hexahedra grouped such that two hexahedra of a same group never share a node
     Eigen::SparseMatrix<Real> p_K;
     Vector<Eigen::Dynamic> p_eigenvalues;
     bool K_is_up_to_date = false;
     bool eigenvalues_are_up_to_date = false;
+    UNSIGNED_INTEGER_TYPE p_stiffness_revision = 0;
 
 };
 
@@ -108,6 +108,11 @@ public:
         return p_elements_quadrature_nodes[element_id];
     }
 
+    /** Get the hyperelastic material of this force field, or a null pointer if none is linked */
+    inline auto material() const -> const material::HyperelasticMaterial<DataTypes> * {
+        return d_material.get();
+    }
+
     /**
      * Get the complete tangent stiffness matrix as a compressed sparse matrix.
      *
@@ -1,3 +1,8 @@
+#include <array>
+#include <map>
+#include <cmath>
+#include <limits>
+
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Forcefield/TetrahedronElasticForce.h>
 
@@ -30,6 +35,11 @@ using TBoundingBox = ::sofa::defaulttype::TBoundingBox<Real> ;
 
 #include <Caribou/Geometry/Tetrahedron.h>
 #include <Caribou/Mechanics/Elasticity/Strain.h>
+#include <Caribou/Topology/ElementColoring.h>
+
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
 
 namespace SofaCaribou::forcefield {
 using namespace caribou::mechanics;
@@ -47,6 +57,19 @@ TetrahedronElasticForce::TetrahedronElasticForce()
     bool(true), "corotated",
     "Whether or not to use corotated elements for the strain computation.",
     true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_enable_multithreading(initData(&d_enable_multithreading,
+    false, "enable_multithreading",
+    "Compute the rotations, the stiffness matrices and the forces of the elements in parallel. Tetrahedra sharing a "
+    "node are never processed at the same time. When enabled, use the environment variable OMP_NUM_THREADS=N to use "
+    "N threads.",
+    true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_share_stiffness_matrices(initData(&d_share_stiffness_matrices,
+    false, "share_stiffness_matrices",
+    "Compute and store only once the stiffness matrix of tetrahedra having the same rest shape up to a translation "
+    "(for example, the elements of a regular grid). Node positions are compared up to 1e-6 times the size of "
+    "the smallest element. This greatly reduces the memory used by the stiffness matrices of large structured "
+    "meshes.",
+    true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
 , d_topology_container(initLink(
     "topology_container", "Topology that contains the elements on which this force will be computed."))
 {
@@ -95,6 +118,8 @@ void TetrahedronElasticForce::reinit()
     const sofa::helper::ReadAccessor<Data<VecCoord>> X = state->readRestPositions();
 
     p_stiffness_matrices.resize(0);
+    p_dense_stiffness_matrices.resize(0);
+    p_stiffness_indices.resize(0);
     p_quadrature_nodes.resize(0);
 
     // Make sure every node of the tetrahedron have its coordinates inside the mechanical state vector
@@ -122,6 +147,11 @@ void TetrahedronElasticForce::reinit()
         }
     }
 
+    // Group the tetrahedra that do not share any node, in order to accumulate their forces concurrently
+    p_element_colors = caribou::topology::color_elements(topology->getNbTetrahedra(), X.size(), [topology](const UNSIGNED_INTEGER_TYPE & tetrahedron_id) {
+        return topology->getTetrahedron(static_cast<sofa::Index>(tetrahedron_id));
+    });
+
     // Gather the integration points for each tetrahedron
     p_quadrature_nodes.resize(topology->getNbTetrahedra());
     for (std::size_t tetrahedron_id = 0; tetrahedron_id < topology->getNbTetrahedra(); ++tetrahedron_id) {
@@ -140,7 +170,52 @@ void TetrahedronElasticForce::reinit()
     }
 
     // Initialize the stiffness matrix of every tetrahedrons
-    p_stiffness_matrices.resize(topology->getNbTetrahedra());
+    p_stiffness_indices.resize(topology->getNbTetrahedra());
+    p_stiffness_representatives.clear();
+    if (d_share_stiffness_matrices.getValue()) {
+        // Two tetrahedra share their stiffness matrix if the positions of their nodes relative to their first node
+        // are the same. These relative positions are rounded to the nearest multiple of a step equal to
+        // relative_tolerance times the size of the smallest tetrahedron (the largest distance between its first node
+        // and its other nodes). The rounded values are kept as floating point numbers, so they can't overflow. Congruent
+        // tetrahedra whose positions fall on both sides of a rounding boundary only get distinct (but still exact)
+        // stiffness matrices.
+        constexpr Real relative_tolerance = 1e-6;
+        Real smallest_size = std::numeric_limits<Real>::max();
+        for (std::size_t tetrahedron_id = 0; tetrahedron_id < topology->getNbTetrahedra(); ++tetrahedron_id) {
+            const auto & node_indices = topology->getTetrahedron(static_cast<sofa::Index>(tetrahedron_id));
+            Real size = 0;
+            for (sofa::Index j = 1; j < NumberOfNodes; ++j) {
+                size = std::max(size, static_cast<Real>((X[node_indices[j]] - X[node_indices[0]]).norm()));
+            }
+            smallest_size = std::min(smallest_size, size);
+        }
+        const Real step = relative_tolerance * ((smallest_size > 0) ? smallest_size : Real(1));
+
+        std::map<std::array<Real, NumberOfNodes*3>, UNSIGNED_INTEGER_TYPE> stiffness_of_shape;
+        for (std::size_t tetrahedron_id = 0; tetrahedron_id < topology->getNbTetrahedra(); ++tetrahedron_id) {
+            const auto & node_indices = topology->getTetrahedron(static_cast<sofa::Index>(tetrahedron_id));
+            std::array<Real, NumberOfNodes*3> shape {};
+            for (sofa::Index j = 0; j < NumberOfNodes; ++j) {
+                for (sofa::Size i = 0; i < 3; ++i) {
+                    shape[j*3+i] = std::round((X[node_indices[j]][i] - X[node_indices[0]][i]) / step);
+                }
+            }
+
+            const auto inserted = stiffness_of_shape.emplace(shape, p_stiffness_representatives.size());
+            if (inserted.second) {
+                p_stiffness_representatives.emplace_back(tetrahedron_id);
+            }
+            p_stiffness_indices[tetrahedron_id] = inserted.first->second;
+        }
+        msg_info() << p_stiffness_representatives.size() << " distinct stiffness matrices are shared by the "
+                   << topology->getNbTetrahedra() << " tetrahedra.";
+    } else {
+        for (std::size_t tetrahedron_id = 0; tetrahedron_id < topology->getNbTetrahedra(); ++tetrahedron_id) {
+            p_stiffness_representatives.emplace_back(tetrahedron_id);
+            p_stiffness_indices[tetrahedron_id] = tetrahedron_id;
+        }
+    }
+    p_stiffness_matrices.resize(p_stiffness_representatives.size());
 
     // Compute the initial tangent stiffness matrix
     compute_K();
@@ -161,7 +236,7 @@ void TetrahedronElasticForce::addForce(
     if (!topology or !state)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbTetrahedra())
+    if (p_stiffness_indices.size() != topology->getNbTetrahedra())
         return;
 
     sofa::helper::ReadAccessor<Data<VecCoord>> x = d_x;
@@ -172,28 +247,36 @@ void TetrahedronElasticForce::addForce(
     std::vector<Rotation> & current_rotation = p_current_rotation;
 
     bool corotated = d_corotated.getValue();
+    const bool enable_multithreading = d_enable_multithreading.getValue();
 
-    sofa::helper::AdvancedTimer::stepBegin("TetrahedronElasticForce::addForce");
-    const auto number_of_elements = topology->getNbTetrahedra();
-    for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
-        Tetrahedron tetra = tetrahedron(element_id, x);
+    // The tetrahedra are read concurrently, make sure they are built by the topology beforehand
+    const auto & tetrahedra = topology->getTetrahedra();
 
-        const Rotation &R0 = initial_rotation[element_id];
-        const Rotation R0t = R0.transpose();
+    sofa::helper::AdvancedTimer::stepBegin("TetrahedronElasticForce::addForce");
+    const auto number_of_elements = static_cast<std::size_t>(topology->getNbTetrahedra());
 
-        Rotation &R = current_rotation[element_id];
+    // Extract the tetrahedra's frames
+    if (corotated) {
+        #pragma omp parallel for if (enable_multithreading)
+        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            current_rotation[element_id] = tetrahedron(element_id, x).frame();
+        }
 
+        // The rotations of the elements, and hence their stiffness matrices, changed
+        ++p_stiffness_revision;
+    }
 
-        // Extract the tetrahedron's frame
-        if (corotated)
-            R = tetra.frame();
+    const auto add_element_force = [&](std::size_t element_id) {
+        const Rotation &R0 = initial_rotation[element_id];
+        const Rotation R0t = R0.transpose();
 
+        const Rotation &R = current_rotation[element_id];
         const Rotation Rt = R.transpose();
 
         // Gather the displacement vector
         Vector<12> U;
         size_t i = 0;
-        for (const auto &node_id : topology->getTetrahedron(static_cast<sofa::Index>(element_id))) {
+        for (const auto &node_id : tetrahedra[static_cast<sofa::Index>(element_id)]) {
             const Vec3 r0{x0[node_id][0], x0[node_id][1], x0[node_id][2]};
             const Vec3 r  {x[node_id][0],  x[node_id][1],  x[node_id][2]};
 
@@ -205,12 +288,17 @@ void TetrahedronElasticForce::addForce(
         }
 
         // Compute the force vector
-        const auto &K = p_stiffness_matrices[element_id];
-        Vector<NumberOfNodes * 3> F = K.template selfadjointView<Eigen::Upper>() * U;
+        const auto & stiffness_id = p_stiffness_indices[element_id];
+        Vector<NumberOfNodes * 3> F;
+        if (p_dense_stiffness_matrices.empty()) {
+            F = p_stiffness_matrices[stiffness_id] * U;
+        } else {
+            F = p_dense_stiffness_matrices[stiffness_id] * U;
+        }
 
         // Write the forces into the output vector
         i = 0;
-        for (const auto &node_id : topology->getTetrahedron(static_cast<sofa::Index>(element_id))) {
+        for (const auto &node_id : tetrahedra[static_cast<sofa::Index>(element_id)]) {
             Vec3 force{F[i * 3 + 0], F[i * 3 + 1], F[i * 3 + 2]};
             force = (R * force).eval();
 
@@ -219,7 +307,22 @@ void TetrahedronElasticForce::addForce(
             f[node_id][2] -= force[2];
             ++i;
         }
+    };
+
+    if (enable_multithreading) {
+        // Tetrahedra of the same color do not share any node, their forces can be accumulated concurrently
+        for (const auto & elements : p_element_colors) {
+            #pragma omp parallel for
+            for (std::size_t i = 0; i < elements.size(); ++i) {
+                add_element_force(elements[i]);
+            }
+        }
+    } else {
+        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            add_element_force(element_id);
+        }
     }
+
     sofa::helper::AdvancedTimer::stepEnd("TetrahedronElasticForce::addForce");
 }
 
@@ -234,25 +337,29 @@ void TetrahedronElasticForce::addDForce(
     if (!topology or !state)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbTetrahedra())
+    if (p_stiffness_indices.size() != topology->getNbTetrahedra())
         return;
 
     auto kFactor = (Real)mparams->kFactorIncludingRayleighDamping(this->rayleighStiffness.getValue());
     sofa::helper::ReadAccessor<Data<VecDeriv>> dx = d_dx;
     sofa::helper::WriteAccessor<Data<VecDeriv>> df = d_df;
-    std::vector<Mat33> & current_rotation = p_current_rotation;
+    const std::vector<Mat33> & current_rotation = p_current_rotation;
+    const bool enable_multithreading = d_enable_multithreading.getValue();
+
+    // The tetrahedra are read concurrently, make sure they are built by the topology beforehand
+    const auto & tetrahedra = topology->getTetrahedra();
 
     sofa::helper::AdvancedTimer::stepBegin("TetrahedronElasticForce::addDForce");
-    const auto number_of_elements = topology->getNbTetrahedra();
-    for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+    const auto number_of_elements = static_cast<std::size_t>(topology->getNbTetrahedra());
 
+    const auto add_element_dforce = [&](std::size_t element_id) {
         const Rotation & R  = current_rotation[element_id];
         const Rotation   Rt = R.transpose();
 
         // Gather the displacement vector
         Vector<NumberOfNodes*3> U;
         size_t i = 0;
-        for (const auto & node_id : topology->getTetrahedron(static_cast<sofa::Index>(element_id))) {
+        for (const auto & node_id : tetrahedra[static_cast<sofa::Index>(element_id)]) {
             const Vec3 v = {dx[node_id][0], dx[node_id][1], dx[node_id][2]};
             const Vec3 u = Rt*v;
 
@@ -262,12 +369,17 @@ void TetrahedronElasticForce::addDForce(
         }
 
         // Compute the force vector
-        const auto & K = p_stiffness_matrices[element_id];
-        Vector<NumberOfNodes*3> F = K.template selfadjointView<Eigen::Upper>()*U*kFactor;
+        const auto & stiffness_id = p_stiffness_indices[element_id];
+        Vector<NumberOfNodes*3> F;
+        if (p_dense_stiffness_matrices.empty()) {
+            F = p_stiffness_matrices[stiffness_id]*U*kFactor;
+        } else {
+            F = p_dense_stiffness_matrices[stiffness_id]*U*kFactor;
+        }
 
         // Write the forces into the output vector
         i = 0;
-        for (const auto & node_id : topology->getTetrahedron(static_cast<sofa::Index>(element_id))) {
+        for (const auto & node_id : tetrahedra[static_cast<sofa::Index>(element_id)]) {
             Vec3 force {F[i*3+0], F[i*3+1], F[i*3+2]};
             force = R*force;
 
@@ -277,6 +389,20 @@ void TetrahedronElasticForce::addDForce(
 
             ++i;
         }
+    };
+
+    if (enable_multithreading) {
+        // Tetrahedra of the same color do not share any node, their forces can be accumulated concurrently
+        for (const auto & elements : p_element_colors) {
+            #pragma omp parallel for
+            for (std::size_t i = 0; i < elements.size(); ++i) {
+                add_element_dforce(elements[i]);
+            }
+        }
+    } else {
+        for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
+            add_element_dforce(element_id);
+        }
     }
     sofa::helper::AdvancedTimer::stepEnd("TetrahedronElasticForce::addDForce");
 }
@@ -308,7 +434,7 @@ void TetrahedronElasticForce::addKToMatrix(
 
         // Since the matrix K is block symmetric, we only kept the DxD blocks on the upper-triangle the matrix.
         // Here we need to accumulate the full matrix into Sofa's BaseMatrix.
-        const auto & K = p_stiffness_matrices[element_id];
+        const auto & K = p_stiffness_matrices[p_stiffness_indices[element_id]];
 
         // Blocks on the diagonal
         for (sofa::Index i = 0; i < NumberOfNodes; ++i) {
@@ -446,7 +572,7 @@ void TetrahedronElasticForce::compute_K()
     if (!topology)
         return;
 
-    if (p_stiffness_matrices.size() != topology->getNbTetrahedra())
+    if (p_stiffness_indices.size() != topology->getNbTetrahedra())
         return;
 
     const Real youngModulus = d_youngModulus.getValue();
@@ -466,10 +592,13 @@ void TetrahedronElasticForce::compute_K()
 
     sofa::helper::AdvancedTimer::stepBegin("TetrahedronElasticForce::compute_k");
 
-    const auto number_of_elements = topology->getNbTetrahedra();
-    for (std::size_t element_id = 0; element_id < number_of_elements; ++element_id) {
-        auto & K = p_stiffness_matrices[element_id];
-        K.fill(0.);
+    // Tetrahedra sharing the same stiffness matrix are only computed once
+    const auto number_of_stiffness_matrices = p_stiffness_matrices.size();
+    const bool enable_multithreading = d_enable_multithreading.getValue();
+    #pragma omp parallel for if (enable_multithreading)
+    for (std::size_t stiffness_id = 0; stiffness_id < number_of_stiffness_matrices; ++stiffness_id) {
+        const auto & element_id = p_stiffness_representatives[stiffness_id];
+        Matrix<NumberOfNodes*3, NumberOfNodes*3> K = Matrix<NumberOfNodes*3, NumberOfNodes*3>::Zero();
 
         const auto & gauss_node = p_quadrature_nodes[element_id];
         const auto detJ = gauss_node.jacobian_determinant;
@@ -504,7 +633,21 @@ void TetrahedronElasticForce::compute_K()
                 K.template block<3, 3>(i*3, j*3).noalias() += (Bi.transpose()*C*Bj) * detJ * w;
             }
         }
+
+        p_stiffness_matrices[stiffness_id] = StiffnessMatrix(K);
+    }
+
+    // The few shared matrices stay in cache, where Eigen's dense product is several times faster than the packed one.
+    // The packed product only pays off when the matrices are read from memory (see the PackedSymmetricMatrix
+    // benchmark).
+    p_dense_stiffness_matrices.clear();
+    if (d_share_stiffness_matrices.getValue()) {
+        p_dense_stiffness_matrices.reserve(p_stiffness_matrices.size());
+        for (const auto & K : p_stiffness_matrices) {
+            p_dense_stiffness_matrices.emplace_back(K.matrix());
+        }
     }
+    ++p_stiffness_revision;
     sofa::helper::AdvancedTimer::stepEnd("TetrahedronElasticForce::compute_k");
 }
 
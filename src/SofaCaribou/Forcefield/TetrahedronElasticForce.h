@@ -11,6 +11,7 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/behavior/ForceField.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <Caribou/Algebra/PackedSymmetricMatrix.h>
 #include <Caribou/Geometry/Tetrahedron.h>
 
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
@@ -62,6 +63,7 @@ public:
     using Vec3   =   Vector<3>;
     static constexpr INTEGER_TYPE Dimension = 3;
     static constexpr INTEGER_TYPE NumberOfNodes = Tetrahedron::NumberOfNodesAtCompileTime;
+    using StiffnessMatrix = caribou::algebra::PackedSymmetricMatrix<NumberOfNodes*Dimension, Real>;
 
     template <typename ObjectType>
     using Link = SingleLink<TetrahedronElasticForce, ObjectType, BaseLink::FLAG_STRONGLINK>;
@@ -104,6 +106,23 @@ public:
 
     void computeBBox(const sofa::core::ExecParams* params, bool onlyVisible) override;
 
+    /**
+     * Revision number of the tangent stiffness matrix added by addKToMatrix. It is incremented every time this matrix
+     * may have changed, i.e. when the elementary stiffness matrices are recomputed, or when the rotations of corotated
+     * elements are updated.
+     */
+    UNSIGNED_INTEGER_TYPE stiffness_revision() const {
+        return p_stiffness_revision;
+    }
+
+    /**
+     * Get the number of elementary stiffness matrices stored. This is the number of tetrahedra, unless congruent
+     * tetrahedra share their stiffness matrix (see the share_stiffness_matrices option).
+     */
+    std::size_t number_of_stiffness_matrices() const {
+        return p_stiffness_matrices.size();
+    }
+
 private:
     /** (Re)Compute the tangent stiffness matrix */
     void compute_K();
@@ -128,13 +147,20 @@ private:
     Data< Real > d_youngModulus;
     Data< Real > d_poissonRatio;
     Data< bool > d_corotated;
+    Data< bool > d_enable_multithreading;
+    Data< bool > d_share_stiffness_matrices;
     Link<BaseMeshTopology>   d_topology_container;
 
 private:
-    std::vector<Matrix<12, 12>> p_stiffness_matrices;
+    std::vector<StiffnessMatrix> p_stiffness_matrices; ///< Upper triangles of the distinct elementary stiffness matrices
+    std::vector<StiffnessMatrix::Matrix> p_dense_stiffness_matrices; ///< Dense copies of the shared stiffness matrices (empty when not shared)
+    std::vector<UNSIGNED_INTEGER_TYPE> p_stiffness_indices; ///< Index of the stiffness matrix of each tetrahedron
+    std::vector<UNSIGNED_INTEGER_TYPE> p_stiffness_representatives; ///< Tetrahedron from which each stiffness matrix is computed
     std::vector<GaussNode> p_quadrature_nodes; // Linear tetrahedrons only have 1 gauss node per element
     std::vector<Rotation> p_initial_rotation;
     std::vector<Rotation> p_current_rotation;
+    std::vector<std::vector<UNSIGNED_INTEGER_TYPE>> p_element_colors; ///< Tetrahedra grouped such that two tetrahedra of a same group never share a node
+    UNSIGNED_INTEGER_TYPE p_stiffness_revision = 0;
 };
 
 } // namespace SofaCaribou::forcefield
@@ -2,10 +2,12 @@
 
 #include <Caribou/constants.h>
 #include <SofaCaribou/config.h>
+#include <SofaCaribou/Algebra/MappedMatrices.h>
 #include <SofaCaribou/Topology/CaribouTopology.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/Mapping.h>
+#include <sofa/helper/OptionsGroup.h>
 DISABLE_ALL_WARNINGS_END
 
 namespace SofaCaribou::mapping {
@@ -57,6 +59,16 @@ public:
      void applyJT (const sofa::core::ConstraintParams* cparams, DataMapMapSparseMatrix & output_jacobian, const MappedDataMapMapSparseMatrix & input_jacobian) override;
      void draw    (const sofa::core::visual::VisualParams* vparams) override;
 
+    /**
+     * Jacobian of the mapping w.r.t. the parent degrees of freedom, with one row per mapped degree of freedom and one
+     * column per parent degree of freedom. Since it is a SofaCaribou::Algebra::SparseJacobian, the matrices assembled
+     * on the mapped nodes are projected onto the parent nodes with sparse products (see
+     * SofaCaribou::Algebra::add_mapped_matrices).
+     *
+     * @note The mapping is linear w.r.t. the parent positions, hence it doesn't add any geometric stiffness.
+     */
+    auto getJ() -> const SofaCaribou::Algebra::BaseMatrix * override;
+
     static auto
     GetCustomTemplateName() -> std::string {
         return templateName();
@@ -71,13 +83,26 @@ public:
     static auto canCreate(Derived * o, sofa::core::objectmodel::BaseContext* context, sofa::core::objectmodel::BaseObjectDescription* arg) -> bool;
 
 private:
+    /**
+     * Computes the sparse product y = A x (or y += A x when accumulate is true), where x and y have one node per row.
+     *
+     * Each row of y only depends on its own row of A, hence the rows are distributed among the threads without any
+     * write conflict when enable_multithreading is true.
+     */
+    template <typename SparseMatrix, typename Input, typename Output>
+    void row_product(const SparseMatrix & A, const Input & x, Output & y, bool accumulate) const;
+
     // Data members
     Link<SofaCaribou::topology::CaribouTopology<Element>> d_topology;
+    sofa::core::objectmodel::Data<sofa::helper::OptionsGroup> d_locator;
+    sofa::core::objectmodel::Data<bool> d_enable_multithreading;
 
     // Private members
     std::unique_ptr<caribou::topology::BarycentricContainer<Domain>> p_barycentric_container;
 
-    Eigen::SparseMatrix<Scalar> p_J; ///< Mapping matrix
+    Eigen::SparseMatrix<Scalar, Eigen::RowMajor> p_J; ///< Mapping matrix (one row per mapped node)
+    Eigen::SparseMatrix<Scalar, Eigen::RowMajor> p_Jt; ///< Transposed mapping matrix (one row per parent node)
+    SofaCaribou::Algebra::SparseJacobian p_dofs_J; ///< Mapping matrix expanded to the degrees of freedom (one row per mapped DOF)
 };
 
 } // namespace SofaCaribou::mapping
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <SofaCaribou/Mapping/CaribouBarycentricMapping.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
@@ -5,8 +9,13 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/Mapping.inl>
 #include <sofa/simulation/Node.h>
 #include <sofa/core/visual/VisualParams.h>
+#include <sofa/helper/AdvancedTimer.h>
 DISABLE_ALL_WARNINGS_END
 
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
+
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
 namespace sofa { using Index = unsigned int; }
 #endif
@@ -23,7 +32,25 @@ namespace SofaCaribou::mapping {
 template<typename Element, typename MappedDataTypes>
 CaribouBarycentricMapping<Element, MappedDataTypes>::CaribouBarycentricMapping()
 : d_topology(initLink("topology", "Topology that contains the embedding (parent) elements."))
+, d_locator(initData(&d_locator,
+    "locator",
+    "Spatial index used to find the parent elements containing the mapped nodes. HashGrid uses a regular grid of "
+    "cells having the mean size of the parent elements. BoundingVolumeHierarchy uses a tree of bounding boxes, which "
+    "should be preferred when the sizes of the parent elements vary a lot (for example, a mesh refined locally)."))
+, d_enable_multithreading(initData(&d_enable_multithreading,
+    false,
+    "enable_multithreading",
+    "Map the positions, velocities and forces of the nodes in parallel. The positions and velocities are gathered "
+    "from the parent nodes one mapped node at a time, and the forces are gathered from the mapped nodes one parent "
+    "node at a time, which avoids any write conflict. The rows of the constraint matrix are also mapped in parallel. "
+    "When enabled, use the environment variable OMP_NUM_THREADS=N to use N threads."))
 {
+    d_locator.setValue(sofa::helper::OptionsGroup(std::vector<std::string> {
+        "HashGrid", "BoundingVolumeHierarchy"
+    }));
+
+    sofa::helper::WriteAccessor<sofa::core::objectmodel::Data<sofa::helper::OptionsGroup>> locator = d_locator;
+    locator->setSelectedItem(static_cast<unsigned int>(caribou::topology::ElementLocator::HashGrid));
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -92,7 +119,8 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::init() {
             this->getToModel()->readRestPositions().size(),
             Dimension
         );
-    p_barycentric_container.reset(new caribou::topology::BarycentricContainer<Domain>(d_topology->domain()->embed(mapped_rest_positions)));
+    const auto locator = static_cast<caribou::topology::ElementLocator>(d_locator.getValue().getSelectedId());
+    p_barycentric_container.reset(new caribou::topology::BarycentricContainer<Domain>(d_topology->domain()->embed(mapped_rest_positions, locator)));
 
     if (not p_barycentric_container->outside_nodes().empty()) {
         const auto n = p_barycentric_container->outside_nodes().size();
@@ -120,6 +148,20 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::init() {
         }
     }
     p_J.setFromTriplets(entries.begin(), entries.end());
+    p_Jt = p_J.transpose();
+
+    // Expand the mapping matrix to the degrees of freedom, which is the Jacobian used to project the matrices of the
+    // mapped nodes onto the parent nodes
+    constexpr auto number_of_mapped_dofs = std::min<Eigen::Index>(Dimension, MappedDimension);
+    p_dofs_J = SofaCaribou::Algebra::SparseJacobian(p_J.rows()*MappedDimension, p_J.cols()*Dimension);
+    for (Eigen::Index i = 0; i < p_J.outerSize(); ++i) {
+        for (typename decltype(p_J)::InnerIterator it(p_J, i); it; ++it) {
+            for (Eigen::Index k = 0; k < number_of_mapped_dofs; ++k) {
+                p_dofs_J.add(it.row()*MappedDimension + k, it.col()*Dimension + k, it.value());
+            }
+        }
+    }
+    p_dofs_J.compress();
 
     // This is needed to map the initial nodal positions and velocities (and, optionally, rest positions).
     Inherit1 ::init();
@@ -152,8 +194,15 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::apply(const sofa::core
                     MappedDimension
             );
 
-    // Interpolate the parent positions onto the mapped nodes
-    p_barycentric_container->interpolate(positions, mapped_positions);
+    sofa::helper::AdvancedTimer::stepBegin("CaribouBarycentricMapping::apply");
+    if (d_enable_multithreading.getValue()) {
+        // Gather the parent positions of each mapped node using the mapping matrix
+        row_product(p_J, positions, mapped_positions, false);
+    } else {
+        // Interpolate the parent positions onto the mapped nodes
+        p_barycentric_container->interpolate(positions, mapped_positions);
+    }
+    sofa::helper::AdvancedTimer::stepEnd("CaribouBarycentricMapping::apply");
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -183,8 +232,15 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJ(const sofa::cor
                     MappedDimension
             );
 
-    // Interpolate the parent positions onto the mapped nodes
-    p_barycentric_container->interpolate(velocities, mapped_velocities);
+    sofa::helper::AdvancedTimer::stepBegin("CaribouBarycentricMapping::applyJ");
+    if (d_enable_multithreading.getValue()) {
+        // Gather the parent velocities of each mapped node using the mapping matrix
+        row_product(p_J, velocities, mapped_velocities, false);
+    } else {
+        // Interpolate the parent velocities onto the mapped nodes
+        p_barycentric_container->interpolate(velocities, mapped_velocities);
+    }
+    sofa::helper::AdvancedTimer::stepEnd("CaribouBarycentricMapping::applyJ");
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -215,8 +271,14 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJT(const sofa::co
             );
 
     // Inverse mapping using the transposed of the Jacobian matrix
-    forces.noalias() += p_J.transpose() * mapped_forces;
-
+    sofa::helper::AdvancedTimer::stepBegin("CaribouBarycentricMapping::applyJT");
+    if (d_enable_multithreading.getValue()) {
+        // Each parent node gathers the forces of the mapped nodes it contributes to
+        row_product(p_Jt, mapped_forces, forces, true);
+    } else {
+        forces.noalias() += p_Jt * mapped_forces;
+    }
+    sofa::helper::AdvancedTimer::stepEnd("CaribouBarycentricMapping::applyJT");
 }
 
 template<typename Element, typename MappedDataTypes>
@@ -224,8 +286,8 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJT(const sofa::co
                                                                   CaribouBarycentricMapping::DataMapMapSparseMatrix & data_output_jacobian,
                                                                   const CaribouBarycentricMapping::MappedDataMapMapSparseMatrix & data_input_mapped_jacobian) {
     using SparseMatrix = decltype(p_J);
-    using StorageIndex = typename SparseMatrix::StorageIndex;
-    static constexpr auto J_is_row_major = SparseMatrix::IsRowMajor;
+    using MappedDeriv = typename MappedDataTypes::Deriv;
+    static_assert(SparseMatrix::IsRowMajor, "The shape values of a mapped node must be stored contiguously in J.");
 
     // Sanity check
     if (not p_barycentric_container or not p_barycentric_container->outside_nodes().empty()) {
@@ -240,36 +302,92 @@ void CaribouBarycentricMapping<Element, MappedDataTypes>::applyJT(const sofa::co
     auto output_jacobian = sofa::helper::WriteAccessor<DataMapMapSparseMatrix>(data_output_jacobian);
     auto input_mapped_jacobian = sofa::helper::ReadAccessor<MappedDataMapMapSparseMatrix>(data_input_mapped_jacobian);
 
+    sofa::helper::AdvancedTimer::stepBegin("CaribouBarycentricMapping::applyJT(constraints)");
+
+    // Gather the non-empty constraint rows so that they can be mapped independently
+    std::vector<decltype(input_mapped_jacobian->begin())> rows;
     const auto rowEnd = input_mapped_jacobian->end();
     for (auto rowIt = input_mapped_jacobian->begin(); rowIt != rowEnd; ++rowIt) {
-        auto colItEnd = rowIt.end();
-        auto colIt = rowIt.begin();
-        if (colIt == colItEnd) continue;
-
-        auto output_row = output_jacobian->writeLine(rowIt.index());
-        for ( ; colIt != colItEnd; ++colIt) {
-            auto mapped_node_index  =  colIt.index();
-            auto mapped_value = colIt.val();
-
-            if constexpr (J_is_row_major) {
-                for (typename SparseMatrix::InnerIterator it(p_J, mapped_node_index); it; ++it) {
-                    const auto node_index = it.col();
-                    const auto shape_value = it.value();
-                    output_row.addCol(node_index, mapped_value*shape_value);
-                }
+        if (rowIt.begin() != rowIt.end()) {
+            rows.emplace_back(rowIt);
+        }
+    }
+
+    // Map every constraint row. Since J is row major, the shape values of a mapped node are read in O(nnz) and a
+    // constraint row is mapped in O(nnz of its mapped nodes). Contributions of mapped nodes sharing the same parent
+    // node are merged in the order they are found, such that each parent node is written only once in the output row.
+    const auto number_of_rows = static_cast<std::ptrdiff_t>(rows.size());
+    std::vector<std::vector<std::pair<Eigen::Index, MappedDeriv>>> mapped_rows (rows.size());
+    const bool enable_multithreading = d_enable_multithreading.getValue();
+    #pragma omp parallel for if (enable_multithreading)
+    for (std::ptrdiff_t row_id = 0; row_id < number_of_rows; ++row_id) {
+        auto & entries = mapped_rows[static_cast<std::size_t>(row_id)];
+        const auto & rowIt = rows[static_cast<std::size_t>(row_id)];
+        const auto colItEnd = rowIt.end();
+        for (auto colIt = rowIt.begin(); colIt != colItEnd; ++colIt) {
+            const auto mapped_node_index = static_cast<Eigen::Index>(colIt.index());
+            const auto & mapped_value = colIt.val();
+            for (typename SparseMatrix::InnerIterator it(p_J, mapped_node_index); it; ++it) {
+                entries.emplace_back(it.col(), mapped_value*it.value());
+            }
+        }
+
+        std::stable_sort(entries.begin(), entries.end(), [](const auto & lhs, const auto & rhs) {
+            return lhs.first < rhs.first;
+        });
+
+        std::size_t number_of_entries = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (number_of_entries > 0 and entries[number_of_entries-1].first == entries[i].first) {
+                entries[number_of_entries-1].second += entries[i].second;
             } else {
-                // J is column major
-                for (int node_index=0; node_index<p_J.outerSize(); ++node_index) {
-                    const auto & start = p_J.outerIndexPtr()[node_index];
-                    const auto & end   = p_J.outerIndexPtr()[node_index+1];
-                    const auto id = p_J.data().searchLowerIndex(start, end, static_cast<StorageIndex>(mapped_node_index));
-                    if ((id<end) && (p_J.data().index(id)==static_cast<StorageIndex>(mapped_node_index))) {
-                        const auto shape_value = p_J.data().value(id);
-                        output_row.addCol(node_index, mapped_value*shape_value);
-                    }
-                }
+                entries[number_of_entries++] = entries[i];
             }
         }
+        entries.resize(number_of_entries);
+    }
+
+    // Write the mapped rows into the constraint matrix of the parent DOFs
+    for (std::size_t row_id = 0; row_id < rows.size(); ++row_id) {
+        auto output_row = output_jacobian->writeLine(rows[row_id].index());
+        for (const auto & entry : mapped_rows[row_id]) {
+            output_row.addCol(entry.first, entry.second);
+        }
+    }
+
+    sofa::helper::AdvancedTimer::stepEnd("CaribouBarycentricMapping::applyJT(constraints)");
+}
+
+template<typename Element, typename MappedDataTypes>
+auto CaribouBarycentricMapping<Element, MappedDataTypes>::getJ() -> const SofaCaribou::Algebra::BaseMatrix * {
+    // Sanity check
+    if (not p_barycentric_container or not p_barycentric_container->outside_nodes().empty()) {
+        return nullptr;
+    }
+
+    return &p_dofs_J;
+}
+
+template<typename Element, typename MappedDataTypes>
+template <typename SparseMatrix, typename Input, typename Output>
+void CaribouBarycentricMapping<Element, MappedDataTypes>::row_product(const SparseMatrix & A, const Input & x, Output & y, bool accumulate) const {
+    using OutputScalar = typename Output::Scalar;
+    using Row = Eigen::Matrix<OutputScalar, 1, Output::ColsAtCompileTime>;
+
+    const auto number_of_rows = static_cast<Eigen::Index>(A.outerSize());
+    const bool enable_multithreading = d_enable_multithreading.getValue();
+    #pragma omp parallel for if (enable_multithreading)
+    for (Eigen::Index i = 0; i < number_of_rows; ++i) {
+        Row value = Row::Zero(1, y.cols());
+        for (typename SparseMatrix::InnerIterator it(A, i); it; ++it) {
+            value.noalias() += static_cast<OutputScalar>(it.value()) * x.row(it.col()).template cast<OutputScalar>();
+        }
+
+        if (accumulate) {
+            y.row(i) += value;
+        } else {
+            y.row(i) = value;
+        }
     }
 }
 
@@ -11,6 +11,8 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/behavior/Mass.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <Eigen/SparseCholesky>
+
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
 namespace sofa { using Index = unsigned int; }
 #endif
@@ -107,6 +109,9 @@ public:
 
     void init() override;
 
+
+    void reinit() override;
+
     template <typename Derived>
 
     static auto canCreate(Derived * o, sofa::core::objectmodel::BaseContext* context, sofa::core::objectmodel::BaseObjectDescription* arg) -> bool;
@@ -155,6 +160,18 @@ public:
         return p_topology;
     }
 
+    /** Get the mass density of the material */
+    [[nodiscard]] inline
+    auto density() const -> Real {
+        return d_density.getValue();
+    }
+
+    /** Revision number of the mass matrix, incremented every time the mass matrix is (re)assembled */
+    [[nodiscard]] inline
+    auto mass_revision() const noexcept -> UNSIGNED_INTEGER_TYPE {
+        return p_mass_revision;
+    }
+
 
     void addForce(const sofa::core::MechanicalParams * mparams, DataVecDeriv & f, const DataVecCoord & x, const DataVecDeriv & v) override;
 
@@ -226,6 +243,19 @@ public:
 
     void assemble_mass_matrix(const Eigen::MatrixBase<Derived> & x0);
 
+    /**
+     * Factorize the consistent mass matrix M.
+     *
+     * Since every 3x3 sub-matrix M_IK of the consistent mass matrix is diagonal, M is the Kronecker product of a
+     * scalar (nodal) mass matrix of size n x n with the identity. Only this scalar matrix is factorized (using a
+     * sparse Cholesky decomposition), and the factorization is reused by accFromF() to solve the nx3 right-hand
+     * side column by column.
+     *
+     * It is called automatically after each assembly (see init() and reinit()) when the mass is not lumped. The
+     * factorization is also refreshed by accFromF() if the density or the topology changed since the last assembly.
+     */
+    void factorize_mass_matrix();
+
     /** Get the set of Gauss integration nodes of an element */
 
     inline auto gauss_nodes_of(std::size_t element_id) const -> const auto & {
@@ -253,6 +283,9 @@ private:
     /// Mass density of the material.
     sofa::core::objectmodel::Data<Real> d_density;
 
+    /// Solve the columns of the right-hand side in parallel when computing the acceleration a = M^-1 f.
+    sofa::core::objectmodel::Data<bool> d_enable_multithreading;
+
     // Private variables
     /// Pointer to a CaribouTopology. This pointer will be null if a CaribouTopology
     /// is found within the scene graph and linked using the d_topology_container data
@@ -267,6 +300,19 @@ private:
     /// Diagonal mass matrix (only filled when d_lumped == true)
     Eigen::DiagonalMatrix<Real, Eigen::Dynamic> p_Mdiag;
 
+    /// Cholesky factorization of the scalar (nodal) consistent mass matrix
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<Real>, Eigen::Upper> p_M_factorization;
+
+    /// Whether or not p_M_factorization matches the current mass matrix p_M
+    bool p_M_is_factorized = false;
+
+    /// Density and number of elements used during the last assembly of p_M
+    Real p_assembled_density = 0;
+    std::size_t p_assembled_number_of_elements = 0;
+
+    /// Number of times the mass matrix was (re)assembled
+    UNSIGNED_INTEGER_TYPE p_mass_revision = 0;
+
     /// Integration points of each elements
     std::vector<GaussContainer> p_elements_quadrature_nodes;
 
@@ -3,6 +3,7 @@
 #include <SofaCaribou/Mass/CaribouMass.h>
 #include <SofaCaribou/Topology/CaribouTopology.inl>
 #include <Eigen/Cholesky>
+#include <Eigen/SparseCholesky>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/helper/AdvancedTimer.h>
@@ -13,6 +14,10 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/behavior/Mass.inl>
 DISABLE_ALL_WARNINGS_END
 
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
+
 namespace SofaCaribou::mass {
 
 template<typename Element>
@@ -32,6 +37,12 @@ CaribouMass<Element>::CaribouMass()
         Real(1),
         "density",
         "Mass density of the material."))
+, d_enable_multithreading(initData(
+        &d_enable_multithreading,
+        false,
+        "enable_multithreading",
+        "Solve the acceleration a = M^(-1).f of the consistent (non-lumped) mass matrix using one thread per "
+        "dimension. When enabled, use the environment variable OMP_NUM_THREADS=N to use N threads."))
 {}
 
 template<typename Element>
@@ -110,6 +121,24 @@ void CaribouMass<Element>::init() {
 
     initialize_elements();
     assemble_mass_matrix();
+
+    if (not d_lumped.getValue()) {
+        factorize_mass_matrix();
+    }
+}
+
+template<typename Element>
+void CaribouMass<Element>::reinit() {
+    if (not this->mstate) {
+        return;
+    }
+
+    initialize_elements();
+    assemble_mass_matrix();
+
+    if (not d_lumped.getValue()) {
+        factorize_mass_matrix();
+    }
 }
 
 template<typename Element>
@@ -199,6 +228,13 @@ template<typename Element>
 template<typename Derived>
 void CaribouMass<Element>::assemble_mass_matrix(const Eigen::MatrixBase<Derived> & x0) {
     const auto density = d_density.getValue();
+
+    // Any previous factorization is now outdated
+    p_M_is_factorized = false;
+    p_assembled_density = density;
+    p_assembled_number_of_elements = this->number_of_elements();
+    ++p_mass_revision;
+
     if (density < std::numeric_limits<Real>::epsilon()) {
         return;
     }
@@ -289,6 +325,37 @@ void CaribouMass<Element>::assemble_mass_matrix(const Eigen::MatrixBase<Derived>
     sofa::helper::AdvancedTimer::stepEnd("CaribouMass::update_mass_matrix");
 }
 
+template<typename Element>
+void CaribouMass<Element>::factorize_mass_matrix() {
+    sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::factorize_mass_matrix");
+
+    // Extract the scalar (nodal) mass matrix from the upper part of M. Since every sub-matrix M_IK is
+    // diagonal, the entry (I, K) of the nodal matrix is found on the first row of the block M_IK.
+    const auto nb_nodes = p_M.rows() / Dimension;
+    std::vector<Eigen::Triplet<Real>> triplets;
+    triplets.reserve(static_cast<std::size_t>(p_M.nonZeros() / Dimension));
+    for (int k = 0; k < p_M.outerSize(); ++k) {
+        if (k % Dimension != 0) {
+            continue;
+        }
+        for (typename Eigen::SparseMatrix<Real>::InnerIterator it(p_M, k); it; ++it) {
+            if (it.row() % Dimension == 0) {
+                triplets.emplace_back(it.row() / Dimension, it.col() / Dimension, it.value());
+            }
+        }
+    }
+
+    Eigen::SparseMatrix<Real> M (nb_nodes, nb_nodes);
+    M.setFromTriplets(triplets.begin(), triplets.end());
+
+    p_M_factorization.compute(M);
+    p_M_is_factorized = (p_M_factorization.info() == Eigen::Success);
+
+    if (not p_M_is_factorized) {
+        msg_error() << "Failed to factorize the consistent mass matrix.";
+    }
+}
+
 template <typename Element>
 auto CaribouMass<Element>::get_gauss_nodes(const std::size_t & /*element_id*/, const Element & element) const -> GaussContainer {
     GaussContainer gauss_nodes {};
@@ -480,9 +547,29 @@ void CaribouMass<Element>::accFromF(const sofa::core::MechanicalParams * /*mpara
             a.row(i) = f.row(i) / p_Mdiag.diagonal()[i*Dimension];
         }
     } else {
-        Eigen::SimplicialCholesky<decltype(p_M), Eigen::Upper> solver;
-        const Eigen::Matrix<Real, Eigen::Dynamic, Dimension, Eigen::RowMajor> r = solver.compute(p_M).solve(f);
-        a = r;
+        // Refresh the mass matrix if its density or its topology changed since the last assembly
+        if (p_assembled_density != d_density.getValue() or p_assembled_number_of_elements != number_of_elements()) {
+            if (p_elements_quadrature_nodes.size() != number_of_elements()) {
+                initialize_elements();
+            }
+            assemble_mass_matrix();
+        }
+
+        if (not p_M_is_factorized) {
+            factorize_mass_matrix();
+            if (not p_M_is_factorized) {
+                return;
+            }
+        }
+
+        // The nodal mass matrix is shared by every dimension: solve each column of f independently
+        sofa::helper::ScopedAdvancedTimer _t_ ("CaribouMass::accFromF");
+        const auto enable_multithreading = d_enable_multithreading.getValue();
+        #pragma omp parallel for if (enable_multithreading)
+        for (int d = 0; d < static_cast<int>(Dimension); ++d) {
+            const Eigen::Matrix<Real, Eigen::Dynamic, 1> f_d = f.col(d);
+            a.col(d) = p_M_factorization.solve(f_d);
+        }
     }
 }
 
@@ -56,6 +56,16 @@ public:
     virtual Eigen::Matrix<Real, 6, 6>
     PK2_stress_jacobian(const Real & J, const Eigen::Matrix<Real, Dimension, Dimension>  & C) const = 0;
 
+    /**
+     * Get the dilatational (P-wave) modulus lambda + 2 mu of the material at rest.
+     *
+     * The speed at which a compression wave travels in the material of density rho is sqrt((lambda + 2 mu) / rho).
+     * It is used by explicit time integration schemes to estimate their critical time step.
+     * A value of zero means that the modulus is unknown for this material.
+     */
+    virtual Real
+    dilatational_modulus() const { return 0; }
+
 
     // Sofa's scene methods
 
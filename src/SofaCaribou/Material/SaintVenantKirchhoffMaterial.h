@@ -75,6 +75,14 @@ public:
         return C;
     }
 
+    /** Get the dilatational (P-wave) modulus lambda + 2 mu from the young modulus and poisson ratio. */
+    Real
+    dilatational_modulus() const override {
+        const Real young_modulus = d_young_modulus.getValue();
+        const Real poisson_ratio = d_poisson_ratio.getValue();
+        return young_modulus * (1.0 - poisson_ratio) / ((1.0 + poisson_ratio) * (1.0 - 2.0 * poisson_ratio));
+    }
+
 private:
     // Private members
     Real mu; // Lame's mu parameter
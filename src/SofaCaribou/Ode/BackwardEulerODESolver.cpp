@@ -1,14 +1,21 @@
 #include <SofaCaribou/Ode/BackwardEulerODESolver.h>
 
+#include <SofaCaribou/Algebra/MappedMatrices.h>
 #include <SofaCaribou/Visitor/AssembleGlobalMatrix.h>
 #include <SofaCaribou/Visitor/ConstrainGlobalMatrix.h>
 
+#include <algorithm>
+#include <cmath>
+
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #include <sofa/core/ConstraintParams.h>
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/core/behavior/ConstraintSolver.h>
 #include <sofa/helper/AdvancedTimer.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 210600)
+#include <sofa/helper/ScopedAdvancedTimer.h>
+#endif
 #include <sofa/simulation/MechanicalVisitor.h>
 #include <sofa/simulation/VectorOperations.h>
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
@@ -48,11 +55,58 @@ BackwardEulerODESolver::BackwardEulerODESolver()
     (double) 0.0,
     "rayleigh_mass",
     "The mass factor 'r_m' used in the Rayleigh's damping matrix `D = r_m M + r_k K`."))
+, d_adaptive_time_stepping(initData(&d_adaptive_time_stepping,
+    false,
+    "adaptive_time_stepping",
+    "Integrate each time step of the scene using internal steps of variable size. The size of the internal steps "
+    "is controlled by an estimate of the local truncation error, and a step is retried with a smaller size when "
+    "the error is too large or when the Newton iterations do not converge."))
+, d_absolute_error_tolerance(initData(&d_absolute_error_tolerance,
+    (double) 1e-3,
+    "absolute_error_tolerance",
+    "Absolute tolerance (in velocity units) on the norm of the local error estimate of an internal step. "
+    "Only used with adaptive time stepping."))
+, d_relative_error_tolerance(initData(&d_relative_error_tolerance,
+    (double) 1e-2,
+    "relative_error_tolerance",
+    "Tolerance on the norm of the local error estimate of an internal step relative to the norm of the velocities. "
+    "Only used with adaptive time stepping."))
+, d_minimum_time_step(initData(&d_minimum_time_step,
+    (double) 1e-6,
+    "minimum_time_step",
+    "Minimum size of an internal step. A step of this size is always accepted. Only used with adaptive time stepping."))
+, d_number_of_accepted_steps(initData(&d_number_of_accepted_steps,
+    (unsigned) 0,
+    "number_of_accepted_steps",
+    "Number of internal steps accepted since the beginning of the simulation (adaptive time stepping only).",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+, d_number_of_rejected_steps(initData(&d_number_of_rejected_steps,
+    (unsigned) 0,
+    "number_of_rejected_steps",
+    "Number of internal steps rejected since the beginning of the simulation (adaptive time stepping only).",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
 {}
 
+void BackwardEulerODESolver::reset() {
+    NewtonRaphsonSolver::reset();
+    p_has_previous_acceleration = false;
+    p_next_step_size = 0;
+    d_number_of_accepted_steps.setValue(0);
+    d_number_of_rejected_steps.setValue(0);
+}
+
 
 void BackwardEulerODESolver::solve(const sofa::core::ExecParams *params, SReal dt, sofa::core::MultiVecCoordId x_id,
                                    sofa::core::MultiVecDerivId v_id) {
+    if (d_adaptive_time_stepping.getValue()) {
+        integrate_adaptive_steps(params, dt, x_id, v_id);
+    } else {
+        integrate_step(params, dt, x_id, v_id);
+    }
+}
+
+void BackwardEulerODESolver::integrate_step(const sofa::core::ExecParams *params, SReal h, MultiVecCoordId x_id,
+                                            MultiVecDerivId v_id) {
     // Save up the current position and velocity multi vectors in order to reuse it during the time stepping part
     sofa::core::MechanicalParams mechanical_parameters (*params);
     sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
@@ -67,7 +121,107 @@ void BackwardEulerODESolver::solve(const sofa::core::ExecParams *params, SReal d
     vop.v_clear(p_a_id);
 
     // Let the NR do its job
-    NewtonRaphsonSolver::solve(params, dt, x_id, v_id);
+    NewtonRaphsonSolver::solve(params, h, x_id, v_id);
+}
+
+void BackwardEulerODESolver::integrate_adaptive_steps(const sofa::core::ExecParams *params, SReal dt,
+                                                      MultiVecCoordId x_id, MultiVecDerivId v_id) {
+    using namespace sofa::helper::logging;
+
+    sofa::helper::ScopedAdvancedTimer _t_ ("BackwardEulerODESolver::AdaptiveSteps");
+
+    sofa::core::MechanicalParams mechanical_parameters (*params);
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+    vop.v_realloc(p_previous_a_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    vop.v_realloc(p_error_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+
+    const auto absolute_tolerance = d_absolute_error_tolerance.getValue();
+    const auto relative_tolerance = d_relative_error_tolerance.getValue();
+    const auto minimum_step_size = std::min<SReal>(d_minimum_time_step.getValue(), dt);
+    const auto print_log = f_printLog.getValue();
+
+    // Step size controller bounds (backward Euler is a first order method, its local error is O(h^2))
+    constexpr SReal safety_factor = 0.9;
+    constexpr SReal maximum_growth = 2.0;
+    constexpr SReal maximum_shrink = 0.2;
+
+    SReal t = 0;
+    SReal h = (p_next_step_size > 0) ? std::min(p_next_step_size, dt) : dt;
+    unsigned int accepted = 0, rejected = 0;
+    bool converged = true;
+
+    while (t < dt) {
+        // Do not overshoot the end of the time step, and avoid leaving a tiny step at the end
+        const SReal remaining = dt - t;
+        if (h >= remaining or remaining - h < minimum_step_size) {
+            h = remaining;
+        }
+
+        integrate_step(params, h, x_id, v_id);
+
+        const bool step_has_converged = d_converged.getValue();
+        SReal error_ratio = 0;
+        if (step_has_converged and p_has_previous_acceleration) {
+            // e = h/2 (a_{n+1} - a_n)
+            vop.v_op(p_error_id, p_a_id, p_previous_a_id, -1.);
+            vop.v_dot(p_error_id, p_error_id);
+            const SReal error_norm = h / 2. * std::sqrt(vop.finish());
+
+            vop.v_dot(v_id, v_id);
+            const SReal velocity_norm = std::sqrt(vop.finish());
+
+            error_ratio = error_norm / (absolute_tolerance + relative_tolerance * velocity_norm);
+        }
+
+        const bool accept = (step_has_converged and error_ratio <= 1) or h <= minimum_step_size;
+        if (accept) {
+            if (not step_has_converged or error_ratio > 1) {
+                msg_warning() << "Accepting an internal step of the minimum size (" << h << ") "
+                              << (step_has_converged ? "with a local error larger than the tolerance." : "that did not converge.");
+                converged = converged and step_has_converged;
+            }
+
+            vop.v_eq(p_previous_a_id, p_a_id);
+            p_has_previous_acceleration = true;
+            t += h;
+            ++accepted;
+        } else {
+            // Roll back to the beginning of the internal step
+            vop.v_eq(x_id, p_previous_x_id);
+            vop.v_eq(v_id, p_previous_v_id);
+            MechanicalPropagateOnlyPositionAndVelocityVisitor(&mechanical_parameters).execute(this->getContext());
+            ++rejected;
+        }
+
+        if (print_log) {
+            msg_info() << (accept ? "Accepted" : "Rejected") << " internal step of size " << h
+                       << " (error ratio = " << error_ratio << ", converged = " << (step_has_converged ? "yes" : "no") << ")";
+        }
+
+        // Predict the size of the next step
+        SReal factor = maximum_growth;
+        if (not step_has_converged) {
+            factor = 0.5;
+        } else if (error_ratio > 0) {
+            factor = std::clamp(safety_factor / std::sqrt(error_ratio), maximum_shrink, maximum_growth);
+        }
+        if (not accept) {
+            factor = std::min<SReal>(factor, 1.);
+        }
+
+        // The last step may have been truncated to reach the end of the time step, keep the previous prediction then
+        if (not (accept and t >= dt and factor * h < p_next_step_size)) {
+            p_next_step_size = std::max(minimum_step_size, factor * h);
+        }
+        h = p_next_step_size;
+    }
+
+    d_converged.setValue(converged);
+    d_number_of_accepted_steps.setValue(d_number_of_accepted_steps.getValue() + accepted);
+    d_number_of_rejected_steps.setValue(d_number_of_rejected_steps.getValue() + rejected);
+
+    Timer::valSet("nb_accepted_steps", accepted);
+    Timer::valSet("nb_rejected_steps", rejected);
 }
 
 
@@ -150,8 +304,8 @@ void BackwardEulerODESolver::assemble_rhs_vector(const MechanicalParams &    mec
     .execute(this->getContext());
 
     // 5. Copy force vectors from every top level (unmapped) mechanical objects into the given system vector f
-    MechanicalMultiVectorToBaseVectorVisitor(&mechanical_parameters, f_id /* source */, f /* destination */, &matrix_accessor)
-    .execute(this->getContext());
+    //    (nothing is copied when f is a view over the force vector of a single mechanical object)
+    this->copy_to_system_vector(mechanical_parameters, matrix_accessor, f_id, f);
 }
 
 // Assemble A in A [da] = F
@@ -160,8 +314,6 @@ void BackwardEulerODESolver::assemble_system_matrix(const MechanicalParams & mec
                                                     DefaultMultiMatrixAccessor & matrix_accessor,
                                                     SofaCaribou::Algebra::BaseMatrix * A)
 {
-    const auto h = mechanical_parameters.dt();
-
     // Step 1. Building stage:
     //         Here we go down on the current context sub-graph and call :
     //           1. ff->addKToMatrix(&K) and f->addBToMatrix() for every force field "ff" found.
@@ -170,9 +322,10 @@ void BackwardEulerODESolver::assemble_system_matrix(const MechanicalParams & mec
     //         traversal stops in the subgraph of the mapping.
     matrix_accessor.setGlobalMatrix(A);
     auto m_params = mechanical_parameters;
-    m_params.setMFactor(1 + h*d_rayleigh_mass.getValue());
-    m_params.setBFactor(h);
-    m_params.setKFactor(-h*(h+d_rayleigh_stiffness.getValue())); // Here we multiply by -1 since K is in fact -K by SOFA's convention
+    const auto coefficients = system_matrix_coefficients(mechanical_parameters);
+    m_params.setMFactor(coefficients[0]);
+    m_params.setBFactor(coefficients[1]);
+    m_params.setKFactor(coefficients[2]);
     Timer::stepBegin("AssembleGlobalMatrix");
     visitor::AssembleGlobalMatrix(&m_params, &matrix_accessor).execute(this->getContext());
     Timer::stepEnd("AssembleGlobalMatrix");
@@ -186,9 +339,10 @@ void BackwardEulerODESolver::assemble_system_matrix(const MechanicalParams & mec
     //         contribution to the global system matrix with:
     //           [A]ij += Jt * [A']ij * J
     //         where A is the master mechanical object's matrix, A' is the slave mechanical object matrix and J=m.getJ()
-    //         is the mapping relation between the slave and its master.
+    //         is the mapping relation between the slave and its master. When J is given as a sparse matrix, the
+    //         product is computed with sparse matrix products instead of entry by entry.
     Timer::stepBegin("MappedMatrices");
-    matrix_accessor.computeGlobalMatrix();
+    SofaCaribou::Algebra::add_mapped_matrices(matrix_accessor, this->getContext());
     Timer::stepEnd("MappedMatrices");
 
     // Step 3. Convert the system matrix to a compressed sparse matrix
@@ -197,6 +351,16 @@ void BackwardEulerODESolver::assemble_system_matrix(const MechanicalParams & mec
     Timer::stepEnd("ConvertToSparse");
 }
 
+// A = (1 + h*r_m) M   +   h C  +  [h * (h + r_k)] K
+auto BackwardEulerODESolver::system_matrix_coefficients(const MechanicalParams & mechanical_parameters) const -> std::array<SReal, 3> {
+    const auto h = mechanical_parameters.dt();
+    return {
+        1 + h*d_rayleigh_mass.getValue(),
+        h,
+        -h*(h+d_rayleigh_stiffness.getValue()) // Here we multiply by -1 since K is in fact -K by SOFA's convention
+    };
+}
+
 // Propagate dv that was previously solved in A [dv] = F
 void BackwardEulerODESolver::propagate_solution_increment(const MechanicalParams & mechanical_parameters,
                                                           const MultiMatrixAccessor & matrix_accessor,
@@ -211,7 +375,8 @@ void BackwardEulerODESolver::propagate_solution_increment(const MechanicalParams
 
 
     // 2. Copy vectors from the global system vector into every top level (unmapped) mechanical objects.
-    MechanicalMultiVectorFromBaseVectorVisitor(&mechanical_parameters, dx_id, dx, &matrix_accessor).execute(this->getContext());
+    //    (nothing is copied when dx is a view over the increment vector of a single mechanical object)
+    this->copy_from_system_vector(mechanical_parameters, matrix_accessor, dx, dx_id);
 
     // 3. a_{i+1}^n = a_{i}^n + da
     MechanicalVOpVisitor(&mechanical_parameters, p_a_id, p_a_id, dx_id).execute(this->getContext());
@@ -91,7 +91,18 @@ namespace SofaCaribou::ode {
  *     \mat{J} = \frac{\partial \vect{F}}{\partial \vect{a}_{n+1}} \bigg\rvert_{\vect{a}_{n+1}^i} &= (1 + hr_m)\mat{M} + h \mat{C} + h(h+r_k) \mat{K}(\vect{a}_{n+1}^i)
  * \f}
  *
+ * When the adaptive_time_stepping option is enabled, the time step of the scene is integrated using one or more
+ * internal steps of variable size \f$h\f$. The local truncation error of each internal step is estimated from the
+ * difference between the backward Euler and the trapezoidal rule velocities
  *
+ * \f{eqnarray*}{
+ *     \vect{e}_{n+1} = \frac{h}{2} \left[ \vect{a}_{n+1} - \vect{a}_{n} \right]
+ * \f}
+ *
+ * and the step is accepted when \f$|\vect{e}_{n+1}| \leq \epsilon_a + \epsilon_r |\vect{v}_{n+1}|\f$. Otherwise, or if
+ * the Newton iterations did not converge, the positions and velocities are rolled back to the beginning of the internal
+ * step and the step is retried with a smaller size. The size of the next step is predicted from the ratio between the
+ * tolerance and the error estimate.
  *
  */
 class BackwardEulerODESolver : public NewtonRaphsonSolver {
@@ -105,9 +116,25 @@ public:
     BackwardEulerODESolver();
 
 
+    void reset() override;
+
+
     void solve (const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) override;
 private:
 
+    /**
+     * Integrate a single step of size h from the current positions and velocities using the Newton-Raphson solver.
+     * The positions and velocities at the beginning of the step are saved into p_previous_x_id and p_previous_v_id.
+     */
+    void integrate_step(const sofa::core::ExecParams* params, SReal h,
+                        sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id);
+
+    /**
+     * Integrate the time step dt using internal steps of variable size controlled by the local error estimate.
+     */
+    void integrate_adaptive_steps(const sofa::core::ExecParams* params, SReal dt,
+                                  sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id);
+
     /** @see NewtonRaphsonSolver::assemble_rhs_vector */
 
     void assemble_rhs_vector(const sofa::core::MechanicalParams & mechanical_parameters,
@@ -121,6 +148,10 @@ private:
                                 sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
                                 SofaCaribou::Algebra::BaseMatrix * A) final;
 
+    /** @see NewtonRaphsonSolver::system_matrix_coefficients */
+
+    auto system_matrix_coefficients(const sofa::core::MechanicalParams & mechanical_parameters) const -> std::array<SReal, 3> final;
+
     /** @see NewtonRaphsonSolver::propagate_position_increment */
 
     void propagate_solution_increment(const sofa::core::MechanicalParams & mechanical_parameters,
@@ -133,6 +164,14 @@ private:
     /// INPUTS
     Data<double> d_rayleigh_stiffness;
     Data<double> d_rayleigh_mass;
+    Data<bool> d_adaptive_time_stepping;
+    Data<double> d_absolute_error_tolerance;
+    Data<double> d_relative_error_tolerance;
+    Data<double> d_minimum_time_step;
+
+    /// OUTPUTS
+    Data<unsigned> d_number_of_accepted_steps;
+    Data<unsigned> d_number_of_rejected_steps;
 
     /// Private members
 
@@ -144,6 +183,18 @@ private:
 
     /// Multi-vector identifier of the acceleration at the current newton iteration
     sofa::core::MultiVecDerivId p_a_id;
+
+    /// Multi-vector identifier of the acceleration at the end of the last accepted step (adaptive time stepping only)
+    sofa::core::MultiVecDerivId p_previous_a_id;
+
+    /// Multi-vector identifier of the local error estimate (adaptive time stepping only)
+    sofa::core::MultiVecDerivId p_error_id;
+
+    /// Whether or not p_previous_a_id holds the acceleration of a previously accepted step
+    bool p_has_previous_acceleration = false;
+
+    /// Size of the next internal step (adaptive time stepping only), zero to start with the scene time step
+    SReal p_next_step_size = 0;
 };
 
 } // namespace SofaCaribou::ode
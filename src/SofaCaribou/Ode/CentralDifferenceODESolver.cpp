@@ -0,0 +1,300 @@
+#include <SofaCaribou/Ode/CentralDifferenceODESolver.h>
+
+#include <cmath>
+#include <limits>
+
+#include <SofaCaribou/Forcefield/HyperelasticForcefield[Hexahedron].h>
+#include <SofaCaribou/Forcefield/HyperelasticForcefield[Hexahedron20].h>
+#include <SofaCaribou/Forcefield/HyperelasticForcefield[Tetrahedron].h>
+#include <SofaCaribou/Forcefield/HyperelasticForcefield[Tetrahedron10].h>
+#include <SofaCaribou/Mass/CaribouMass[Hexahedron].h>
+#include <SofaCaribou/Mass/CaribouMass[Hexahedron20].h>
+#include <SofaCaribou/Mass/CaribouMass[Tetrahedron].h>
+#include <SofaCaribou/Mass/CaribouMass[Tetrahedron10].h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/core/ConstraintParams.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/MechanicalState.h>
+#include <sofa/defaulttype/VecTypes.h>
+#include <sofa/helper/AdvancedTimer.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 210600)
+#include <sofa/helper/ScopedAdvancedTimer.h>
+#endif
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/simulation/VectorOperations.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
+#include <sofa/simulation/MechanicalMatrixVisitor.h>
+#else
+#include <sofa/simulation/mechanicalvisitor/MechanicalPropagateOnlyPositionAndVelocityVisitor.h>
+#include <sofa/simulation/mechanicalvisitor/MechanicalVOpVisitor.h>
+using namespace sofa::simulation::mechanicalvisitor;
+#endif
+DISABLE_ALL_WARNINGS_END
+
+#ifdef CARIBOU_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace SofaCaribou::ode {
+
+int CentralDifferenceClass = sofa::core::RegisterObject("Explicit central difference ODE Solver").add< CentralDifferenceODESolver >();
+
+using namespace sofa::simulation;
+using sofa::core::MechanicalParams;
+using sofa::core::MultiVecCoordId;
+using sofa::core::MultiVecDerivId;
+using sofa::core::objectmodel::BaseContext;
+
+namespace {
+
+// Critical time step L_min / c of every hyperelastic force fields of the given element type, or infinity if none
+template <typename Element>
+auto critical_time_step_of(BaseContext * context, bool enable_multithreading) -> SReal {
+    using Forcefield = SofaCaribou::forcefield::HyperelasticForcefield<Element>;
+    using Mass = SofaCaribou::mass::CaribouMass<Element>;
+    using Real = typename Forcefield::Real;
+
+    SReal critical_time_step = std::numeric_limits<SReal>::infinity();
+
+    const auto forcefields = context->template getObjects<Forcefield>(BaseContext::SearchDown);
+    for (const auto * forcefield : forcefields) {
+        const auto * material = forcefield->material();
+        const auto topology = forcefield->topology();
+        const auto * mass = forcefield->getContext()->template get<Mass>(BaseContext::Local);
+        if (not material or not topology or not mass) {
+            continue;
+        }
+
+        const auto modulus = material->dilatational_modulus();
+        const auto density = mass->density();
+        if (not (modulus > 0) or not (density > 0)) {
+            continue;
+        }
+
+        // Speed of the dilatational waves
+        const auto wave_speed = std::sqrt(modulus / density);
+
+        // Smallest distance between two nodes of the same element
+        const auto nb_elements = static_cast<int>(topology->number_of_elements());
+        Real length = std::numeric_limits<Real>::max();
+        #pragma omp parallel for reduction(min : length) if (enable_multithreading)
+        for (int element_id = 0; element_id < nb_elements; ++element_id) {
+            const auto nodes = topology->element(static_cast<UNSIGNED_INTEGER_TYPE>(element_id)).nodes();
+            for (Eigen::Index i = 0; i < nodes.rows(); ++i) {
+                for (Eigen::Index j = i+1; j < nodes.rows(); ++j) {
+                    length = std::min(length, static_cast<Real>((nodes.row(i) - nodes.row(j)).norm()));
+                }
+            }
+        }
+
+        critical_time_step = std::min(critical_time_step, static_cast<SReal>(length / wave_speed));
+    }
+
+    return critical_time_step;
+}
+
+} // namespace
+
+// Constructor
+CentralDifferenceODESolver::CentralDifferenceODESolver()
+: d_safety_factor(initData(&d_safety_factor,
+    (double) 0.9,
+    "safety_factor",
+    "Factor applied to the estimated critical time step L_min / c, where L_min is the smallest distance between "
+    "two nodes of an element and c is the speed of the dilatational waves in the material."))
+, d_subcycling(initData(&d_subcycling,
+    true,
+    "subcycling",
+    "Subdivide the time step of the simulation into sub-steps when it is larger than the critical time step."))
+, d_enable_multithreading(initData(&d_enable_multithreading,
+    false,
+    "enable_multithreading",
+    "Enable the multithreading update of the velocity and position vectors. Only use this if you have a "
+    "very large number of nodes, otherwise performance might be worse than single threading. "
+    "When enabled, use the environment variable OMP_NUM_THREADS=N to use N threads."))
+, d_critical_time_step(initData(&d_critical_time_step,
+    (double) 0,
+    "critical_time_step",
+    "Estimated critical time step (already scaled by the safety factor). Zero if it could not be estimated.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+, d_number_of_substeps(initData(&d_number_of_substeps,
+    (unsigned) 1,
+    "number_of_substeps",
+    "Number of sub-steps computed during the last time step.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+{}
+
+void CentralDifferenceODESolver::init() {
+    gather_states();
+}
+
+void CentralDifferenceODESolver::reinit() {
+    gather_states();
+
+    // The elements or the materials may have changed, estimate the critical time step again at the next step
+    p_critical_time_step_is_estimated = false;
+    p_unstable_time_step_was_reported = false;
+}
+
+void CentralDifferenceODESolver::reset() {
+    // The velocities are no longer at mid-step, restart with a half step
+    p_previous_h = 0;
+
+    // Estimate the critical time step again at the next step
+    p_critical_time_step_is_estimated = false;
+    p_unstable_time_step_was_reported = false;
+}
+
+void CentralDifferenceODESolver::gather_states() {
+    using sofa::core::behavior::BaseMechanicalState;
+
+    const auto states = this->getContext()->getObjects<BaseMechanicalState>(BaseContext::Local);
+    p_vec3_states.clear();
+    p_vec3_states.reserve(states.size());
+    for (auto * state : states) {
+        if (auto * vec3_state = dynamic_cast<Vec3State *>(state)) {
+            p_vec3_states.emplace_back(vec3_state);
+        }
+    }
+
+    if (p_vec3_states.size() != states.size()) {
+        p_vec3_states.clear();
+    }
+}
+
+auto CentralDifferenceODESolver::estimate_critical_time_step() -> SReal {
+    sofa::helper::ScopedAdvancedTimer _t_ ("CentralDifferenceODESolver::estimate_critical_time_step");
+
+    auto * context = this->getContext();
+    const auto enable_multithreading = d_enable_multithreading.getValue();
+
+    SReal critical_time_step = std::numeric_limits<SReal>::infinity();
+    critical_time_step = std::min(critical_time_step, critical_time_step_of<caribou::geometry::Hexahedron>(context, enable_multithreading));
+    critical_time_step = std::min(critical_time_step, critical_time_step_of<caribou::geometry::Hexahedron20>(context, enable_multithreading));
+    critical_time_step = std::min(critical_time_step, critical_time_step_of<caribou::geometry::Tetrahedron>(context, enable_multithreading));
+    critical_time_step = std::min(critical_time_step, critical_time_step_of<caribou::geometry::Tetrahedron10>(context, enable_multithreading));
+
+    if (std::isinf(critical_time_step)) {
+        msg_warning() << "Could not estimate the critical time step. It requires at least one HyperelasticForcefield "
+                      << "with a material and a CaribouMass in the same node.";
+        critical_time_step = 0;
+    } else {
+        critical_time_step *= d_safety_factor.getValue();
+        msg_info() << "Estimated critical time step: " << critical_time_step;
+    }
+
+    d_critical_time_step.setValue(critical_time_step);
+    p_critical_time_step_is_estimated = true;
+
+    return critical_time_step;
+}
+
+void CentralDifferenceODESolver::solve(const sofa::core::ExecParams *params, SReal dt, MultiVecCoordId x_id,
+                                       MultiVecDerivId v_id) {
+    sofa::helper::ScopedAdvancedTimer _t_ ("CentralDifferenceODESolver::Solve");
+
+    sofa::core::MechanicalParams mechanical_parameters (*params);
+    mechanical_parameters.setX(x_id);
+    mechanical_parameters.setV(v_id);
+
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+    sofa::simulation::common::MechanicalOperations mop( &mechanical_parameters, this->getContext() );
+    mop->setImplicit(false); // The stiffness matrix is never needed
+
+    // Allocate the acceleration vector
+    vop.v_realloc(p_a_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+
+    // Subdivide the time step if it is larger than the critical time step
+    if (not p_critical_time_step_is_estimated) {
+        estimate_critical_time_step();
+    }
+
+    unsigned int number_of_substeps = 1;
+    const SReal critical_time_step = d_critical_time_step.getValue();
+    if (critical_time_step > 0 and dt > critical_time_step) {
+        if (d_subcycling.getValue()) {
+            number_of_substeps = static_cast<unsigned int>(std::ceil(dt / critical_time_step));
+        } else if (not p_unstable_time_step_was_reported) {
+            msg_warning() << "The time step (" << dt << ") is larger than the estimated critical time step ("
+                          << critical_time_step << "). The simulation will likely be unstable. Reduce the time "
+                          << "step or enable the subcycling.";
+            p_unstable_time_step_was_reported = true;
+        }
+    }
+    d_number_of_substeps.setValue(number_of_substeps);
+
+    const SReal h = dt / number_of_substeps;
+    MultiVecDerivId f_id = sofa::core::VecDerivId::force();
+
+    for (unsigned int step = 0; step < number_of_substeps; ++step) {
+        // 1. Add the gravity directly to the velocities for masses having the separateGravity option set
+        mop.addSeparateGravity(h, v_id);
+
+        // 2. f = P - R(x_n, v_{n-1/2})
+        //    Go down in the current context tree calling `addForce` on every force field components,
+        //    then go up from the leaves calling `applyJT` on every mechanical mappings
+        sofa::helper::AdvancedTimer::stepBegin("ComputeForce");
+        mop.computeForce(f_id);
+        sofa::helper::AdvancedTimer::stepEnd("ComputeForce");
+
+        // 3. a_n = M^-1 f
+        sofa::helper::AdvancedTimer::stepBegin("AccFromF");
+        mop.accFromF(p_a_id, f_id);
+
+        // Calls the "projectResponse" method of every `BaseProjectiveConstraintSet` objects found in the current
+        // context tree. For example, the `FixedConstraints` component will set entries of fixed nodes to zero.
+        mop.projectResponse(p_a_id);
+        sofa::helper::AdvancedTimer::stepEnd("AccFromF");
+
+        // 4. v_{n+1/2} = v_{n-1/2} + (h_{n-1} + h_n)/2 a_n
+        //    x_{n+1}   = x_n + h_n v_{n+1/2}
+        sofa::helper::AdvancedTimer::stepBegin("Integrate");
+        integrate(mechanical_parameters, x_id, v_id, (p_previous_h + h) / 2., h);
+        p_previous_h = h;
+        sofa::helper::AdvancedTimer::stepEnd("Integrate");
+
+        // 5. Solve the velocity and position constraints
+        mop.solveConstraint(v_id, sofa::core::ConstraintParams::VEL);
+        mop.solveConstraint(x_id, sofa::core::ConstraintParams::POS);
+
+        // 6. Propagate positions to mapped mechanical objects, for example, identity mappings, barycentric mappings, etc.
+        //    This will call the methods apply and applyJ on every mechanical mappings.
+        MechanicalPropagateOnlyPositionAndVelocityVisitor(&mechanical_parameters).execute(this->getContext());
+    }
+}
+
+void CentralDifferenceODESolver::integrate(const MechanicalParams & mechanical_parameters,
+                                           MultiVecCoordId & x_id, MultiVecDerivId & v_id,
+                                           SReal kick, SReal h) {
+    // Fused update is only done when every top level mechanical objects are Vec3 (gathered at init)
+    if (p_vec3_states.empty()) {
+        // v := v + kick a
+        MechanicalVOpVisitor(&mechanical_parameters, v_id, v_id, p_a_id, kick).execute(this->getContext());
+
+        // x := x + h v
+        MechanicalVOpVisitor(&mechanical_parameters, x_id, x_id, v_id, h).execute(this->getContext());
+        return;
+    }
+
+    const auto enable_multithreading = d_enable_multithreading.getValue();
+    for (auto * state : p_vec3_states) {
+        sofa::helper::WriteAccessor<sofa::core::objectmodel::Data<Vec3State::VecCoord>> x = *state->write(x_id.getId(state));
+        sofa::helper::WriteAccessor<sofa::core::objectmodel::Data<Vec3State::VecDeriv>> v = *state->write(v_id.getId(state));
+        sofa::helper::ReadAccessor<sofa::core::objectmodel::Data<Vec3State::VecDeriv>> a = *state->read(sofa::core::ConstVecDerivId(p_a_id.getId(state)));
+
+        auto & x_ref = x.wref();
+        auto & v_ref = v.wref();
+        const auto & a_ref = a.ref();
+
+        const auto nb_nodes = static_cast<int>(x_ref.size());
+        #pragma omp parallel for if (enable_multithreading)
+        for (int i = 0; i < nb_nodes; ++i) {
+            v_ref[i] += a_ref[i] * kick;
+            x_ref[i] += v_ref[i] * h;
+        }
+    }
+}
+
+} // namespace SofaCaribou::ode
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/core/behavior/MechanicalState.h>
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/MultiVecId.h>
+#include <sofa/core/objectmodel/Data.h>
+#include <sofa/defaulttype/VecTypes.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <vector>
+
+namespace SofaCaribou::ode {
+
+/**
+ * Implementation of an explicit central difference (leapfrog) ODE solver.
+ *
+ * We are trying to solve to following
+ * \f{eqnarray*}{
+ *     \mat{M} \ddot{\vect{x}} + \vect{R}(\vect{x}, \dot{\vect{x}}) = \vect{P}
+ * \f}
+ *
+ * Where \f$\mat{M}\f$ is the mass matrix, \f$\vect{R}\f$ is the (possibly non-linear) internal force residual and
+ * \f$\vect{P}\f$ is the external force vector. Using the central difference scheme, the velocities are evaluated at
+ * half time steps, and each step of size \f$h\f$ is computed as
+ *
+ * \f{align*}{
+ *     \vect{a}_{n} &= \mat{M}^{-1} \left[ \vect{P}_n - \vect{R}(\vect{x}_{n}, \vect{v}_{n-\frac{1}{2}}) \right] \\
+ *     \vect{v}_{n+\frac{1}{2}} &= \vect{v}_{n-\frac{1}{2}} + \frac{h_{n-1} + h_{n}}{2} \vect{a}_{n} \\
+ *     \vect{x}_{n+1} &= \vect{x}_{n} + h_n \vect{v}_{n+\frac{1}{2}}
+ * \f}
+ *
+ * where \f$h_{n-1}\f$ is the size of the previous step (zero at the first step). Hence, the velocity vector of the
+ * mechanical objects holds the velocities at mid-step.
+ *
+ * No system matrix is ever assembled: each step only requires the force vector (addForce) of the force fields and
+ * the acceleration \f$\mat{M}^{-1} \vect{f}\f$ (accFromF) of the mass. The scheme is only cheap when the inverse of
+ * the mass is cheap, i.e. when the mass matrix is lumped (diagonal).
+ *
+ * The scheme is only conditionally stable. The critical time step is estimated as
+ *
+ * \f{eqnarray*}{
+ *     h_{c} = \alpha \min_e \frac{L_e}{c} ~\text{, }~ c = \sqrt{\frac{\lambda + 2\mu}{\rho}}
+ * \f}
+ *
+ * where \f$L_e\f$ is the smallest distance between two nodes of the element \f$e\f$, \f$c\f$ is the speed of the
+ * dilatational waves in the material and \f$\alpha\f$ is a safety factor. If the time step of the simulation is
+ * larger than \f$h_{c}\f$, it can be subdivided into sub-steps (subcycling).
+ */
+class CentralDifferenceODESolver : public sofa::core::behavior::OdeSolver {
+public:
+    SOFA_CLASS(CentralDifferenceODESolver, sofa::core::behavior::OdeSolver);
+
+    template <typename T>
+    using Data = sofa::core::objectmodel::Data<T>;
+
+    CentralDifferenceODESolver();
+
+    void init() override;
+
+    void reinit() override;
+
+    void reset() override;
+
+    void solve (const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) override;
+
+    /**
+     * Estimate the critical time step from the smallest element size and the dilatational wave speed of every
+     * hyperelastic force field found in the current context sub-graph.
+     *
+     * It is called automatically at the first time step. The estimate (already scaled by the safety factor) is
+     * stored in the "critical_time_step" data. A value of zero means that no estimate could be done.
+     */
+    auto estimate_critical_time_step() -> SReal;
+
+    /** The critical time step estimated by the last call to estimate_critical_time_step(), or zero if unknown. */
+    auto critical_time_step() const -> SReal {
+        return d_critical_time_step.getValue();
+    }
+
+    /// Given an input derivative order (0 for position, 1 for velocity, 2 for acceleration),
+    /// how much will it affect the output derivative of the given order.
+    SReal getIntegrationFactor(int inputDerivative, int outputDerivative) const override {
+        const SReal dt = getContext()->getDt();
+        const SReal matrix[3][3] = {
+            { 1, dt, dt*dt},
+            { 0, 1,  dt},
+            { 0, 0,  1}
+        };
+        if (inputDerivative >= 3 || outputDerivative >= 3)
+            return 0;
+        else
+            return matrix[outputDerivative][inputDerivative];
+    }
+
+    /// Given a solution of the system (here, the acceleration),
+    /// how much will it affect the output derivative of the given order.
+    SReal getSolutionIntegrationFactor(int outputDerivative) const override {
+        const SReal dt = getContext()->getDt();
+        const SReal vect[3] = { dt*dt, dt, 1};
+        if (outputDerivative >= 3)
+            return 0;
+        else
+            return vect[outputDerivative];
+    }
+
+private:
+    using Vec3State = sofa::core::behavior::MechanicalState<sofa::defaulttype::Vec3Types>;
+
+    /**
+     * Gather the mechanical states of the current context. The fused update of integrate() is only done when all of
+     * them are Vec3 states.
+     */
+    void gather_states();
+
+    /**
+     * Update the velocities and positions from the current acceleration with
+     *     v := v + kick * a
+     *     x := x + h * v
+     * For Vec3 mechanical objects, both updates are fused into a single (possibly multithreaded) loop over the nodes.
+     */
+    void integrate(const sofa::core::MechanicalParams & mechanical_parameters,
+                   sofa::core::MultiVecCoordId & x_id, sofa::core::MultiVecDerivId & v_id,
+                   SReal kick, SReal h);
+
+    /// INPUTS
+    Data<double> d_safety_factor;
+    Data<bool> d_subcycling;
+    Data<bool> d_enable_multithreading;
+
+    /// OUTPUTS
+    Data<double> d_critical_time_step;
+    Data<unsigned> d_number_of_substeps;
+
+    /// Private members
+
+    /// Multi-vector identifier of the acceleration
+    sofa::core::MultiVecDerivId p_a_id;
+
+    /// Size of the previous (sub-)step, zero before the first step
+    SReal p_previous_h = 0;
+
+    /// Whether or not the critical time step was already estimated
+    bool p_critical_time_step_is_estimated = false;
+
+    /// Whether or not the unstable time step warning was already printed
+    bool p_unstable_time_step_was_reported = false;
+
+    /// Mechanical states of the current context, empty if any of them isn't a Vec3 state
+    std::vector<Vec3State *> p_vec3_states;
+};
+
+} // namespace SofaCaribou::ode
@@ -1,7 +1,11 @@
 #include <SofaCaribou/Ode/NewtonRaphsonSolver.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <chrono>
+#include <future>
+#include <map>
+#include <optional>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
@@ -9,13 +13,52 @@ DISABLE_ALL_WARNINGS_BEGIN
 #if (defined(SOFA_VERSION) && SOFA_VERSION >= 210600)
 #include <sofa/helper/ScopedAdvancedTimer.h>
 #endif
+#include <sofa/core/BaseMapping.h>
+#include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/core/behavior/BaseProjectiveConstraintSet.h>
 #include <sofa/simulation/MechanicalOperations.h>
 #include <sofa/simulation/Node.h>
 #include <sofa/simulation/VectorOperations.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
+#include <sofa/simulation/MechanicalMatrixVisitor.h>
+#else
+#include <sofa/simulation/mechanicalvisitor/MechanicalMultiVectorFromBaseVectorVisitor.h>
+#include <sofa/simulation/mechanicalvisitor/MechanicalMultiVectorToBaseVectorVisitor.h>
+using namespace sofa::simulation::mechanicalvisitor;
+#endif
 DISABLE_ALL_WARNINGS_BEGIN
 
 #include <SofaCaribou/Solver/LinearSolver.h>
 #include <SofaCaribou/Algebra/BaseVectorOperations.h>
+#include <SofaCaribou/Algebra/EigenMatrix.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
+#include <SofaCaribou/Algebra/MechanicalStateBuffer.h>
+#include <SofaCaribou/Topology/CaribouTopology[Hexahedron20].h>
+#include <SofaCaribou/Topology/CaribouTopology[Tetrahedron10].h>
+#include <SofaCaribou/Topology/CaribouTopology[Quad8].h>
+#include <SofaCaribou/Topology/CaribouTopology[Triangle6].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Hexahedron].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Hexahedron20].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Tetrahedron].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Tetrahedron10].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Quad].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Quad8].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Triangle].h>
+#include <SofaCaribou/Forcefield/CaribouForcefield[Triangle6].h>
+#include <SofaCaribou/Forcefield/HexahedronElasticForce.h>
+#include <SofaCaribou/Forcefield/TetrahedronElasticForce.h>
+#include <SofaCaribou/Forcefield/TractionForcefield[Quad].h>
+#include <SofaCaribou/Forcefield/TractionForcefield[Quad8].h>
+#include <SofaCaribou/Forcefield/TractionForcefield[Triangle].h>
+#include <SofaCaribou/Forcefield/TractionForcefield[Triangle6].h>
+#include <SofaCaribou/Mass/CaribouMass[Hexahedron].h>
+#include <SofaCaribou/Mass/CaribouMass[Hexahedron20].h>
+#include <SofaCaribou/Mass/CaribouMass[Tetrahedron].h>
+#include <SofaCaribou/Mass/CaribouMass[Tetrahedron10].h>
+#include <Caribou/Geometry/Hexahedron.h>
+#include <Caribou/Geometry/Tetrahedron.h>
+#include <Caribou/Geometry/Quad.h>
+#include <Caribou/Geometry/Triangle.h>
 
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201200)
 namespace sofa { using Size = int; }
@@ -27,6 +70,11 @@ using sofa::core::ExecParams;
 using sofa::core::MultiVecCoordId;
 using sofa::core::MultiVecDerivId;
 
+namespace {
+using EigenDenseVector = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 1>;
+using MappedEigenDenseVector = SofaCaribou::Algebra::EigenVector<Eigen::Map<EigenDenseVector>>;
+} // namespace
+
 NewtonRaphsonSolver::NewtonRaphsonSolver()
 : d_newton_iterations(initData(&d_newton_iterations,
     (unsigned) 1,
@@ -55,6 +103,40 @@ NewtonRaphsonSolver::NewtonRaphsonSolver()
     "be avoided altogether, or computed only one time at the beginning of the simulation. Else, it can be done at the "
     "beginning of the time step, or even at each reformation of the system matrix if necessary. The default is to "
     "analyze the pattern at each time step."))
+, d_static_condensation(initData(&d_static_condensation,
+    false,
+    "static_condensation",
+    "Eliminate the edge-midpoint nodes of quadratic elements (Hexahedron20, Tetrahedron10, Quad8 and Triangle6 "
+    "CaribouTopology found in the current context) from the assembled system using a Schur complement. Only the "
+    "smaller condensed system is factorized by the linear solver, the eliminated increments being recovered "
+    "afterward. Edge nodes coupled to an already condensed patch are kept in the condensed system. This option "
+    "requires an assembled linear solver using Eigen sparse matrices."))
+, d_condensation_patch_size(initData(&d_condensation_patch_size,
+    (unsigned) 1,
+    "condensation_patch_size",
+    "Maximum number of edge-midpoint nodes eliminated together as a single dense block by the static condensation. "
+    "Larger patches eliminate more nodes, at the cost of a denser condensed system."))
+, d_predictor(initData(&d_predictor,
+    "predictor",
+    "Extrapolation used as the initial guess of the Newton iterations. NONE starts from the current solution. LINEAR "
+    "reuses the total increment of the last converged time step, and QUADRATIC extrapolates the increments of the "
+    "last two converged time steps. The prediction is discarded if it gives a larger residual than the current "
+    "solution."))
+, d_symbolic_pattern_analysis(initData(&d_symbolic_pattern_analysis,
+    false,
+    "symbolic_pattern_analysis",
+    "Derive the pattern of the system matrix from the connectivity of the Caribou forcefields and masses, and let the "
+    "linear solver analyze it on a worker thread while the system matrix is assembled. The analysis is only kept if "
+    "the assembled matrix has exactly the same pattern, otherwise the assembled matrix is analyzed as usual. This "
+    "option is ignored when the static condensation is enabled."))
+, d_reuse_factorization(initData(&d_reuse_factorization,
+    false,
+    "reuse_factorization",
+    "Skip the assembly, the analysis and the factorization of the system matrix when none of the components "
+    "contributing to it changed since its last factorization (for example, with non-corotated linear elastic "
+    "forcefields, a Caribou mass and a constant time step). Only the HexahedronElasticForce, TetrahedronElasticForce, "
+    "CaribouMass and TractionForcefield components, and the data of the projective constraints, are tracked. The "
+    "system matrix is assembled at every Newton iteration as soon as another type of forcefield or mass is found."))
 , l_linear_solver(initLink(
     "linear_solver",
     "Linear solver used for the resolution of the system."))
@@ -71,6 +153,11 @@ NewtonRaphsonSolver::NewtonRaphsonSolver()
 
     // Select the default value
     set_pattern_analysis_strategy(PatternAnalysisStrategy::BEGINNING_OF_THE_TIME_STEP);
+
+    d_predictor.setValue(sofa::helper::OptionsGroup(std::vector < std::string > {
+        "NONE", "LINEAR", "QUADRATIC"
+    }));
+    set_predictor(Predictor::NONE);
 }
 
 void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoordId x_id, MultiVecDerivId v_id) {
@@ -123,6 +210,7 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
     const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
     const auto & absolute_residual_tolerance_threshold = d_absolute_residual_tolerance_threshold.getValue();
     const auto & newton_iterations = d_newton_iterations.getValue();
+    const auto & static_condensation = d_static_condensation.getValue();
     const auto & print_log = f_printLog.getValue();
     auto info = MessageDispatcher::info(Message::Runtime, ComponentInfo::SPtr(new ComponentInfo(this->getClassName())), SOFA_FILE_INFO);
 
@@ -155,7 +243,8 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
         info << "Residual tolerance (abs) : " << absolute_residual_tolerance_threshold << "\n";
         info << "Residual tolerance (rel) : " << residual_tolerance_threshold << "\n";
         info << "Correction tolerance     : " << correction_tolerance_threshold << "\n";
-        info << "Linear solver            : " << l_linear_solver->getPathName() << "\n\n";
+        info << "Linear solver            : " << l_linear_solver->getPathName() << "\n";
+        info << "Static condensation      : " << (static_condensation ? "yes" : "no") << "\n\n";
     }
 
     // Local variables used for the iterations
@@ -190,30 +279,13 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
     // accumulate the mechanical objects and mappings. This one will not really
     // compute the mechanical graph (not explicitly at least). Hence the following
     // @todo (jnbrunet2000@gmail.com) Create a CaribouMultiMatrixAccessor for that.
-    sofa::component::linearsolver::DefaultMultiMatrixAccessor accessor;
+    // The accessor and the system buffers are kept between time steps, and only
+    // rebuilt when the mechanical graph changes.
+    update_system_buffers(mop, linear_solver);
+    update_system_vector_views(linear_solver, f_id, dx_id, static_condensation);
+    auto & accessor = *p_accessor;
 
-    // Step 1   Get dimension of each top level mechanical states using
-    //          BaseMechanicalState::getMatrixSize(), and accumulate mechanical
-    //          objects and mapping matrices
-    mop.getMatrixDimension(nullptr, nullptr, &accessor);
-    const auto n = static_cast<sofa::Size>(accessor.getGlobalDimension());
-
-    // Step 2   Does nothing more than to accumulate from the previous step a list of
-    //          "MatrixRef = <MechanicalState*, MatrixIndex>" where MatrixIndex is the
-    //          (i,i) position of the given top level MechanicalState* inside the global
-    //          system matrix. This global matrix hence contains one sub-matrix per top
-    //          level mechanical state.
-    accessor.setupMatrices();
-
-    // Step 3   Let the linear solver create the system matrix and vector buffers
-    //          using the previously computed system size n
-    p_A.reset(linear_solver->create_new_matrix(n, n));
-    p_A->clear();
-
-    p_DX.reset(linear_solver->create_new_vector(n));
     p_DX->clear();
-
-    p_F.reset(linear_solver->create_new_vector(n));
     p_F->clear();
 
 
@@ -231,8 +303,29 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
 
     // Step 2   Compute the initial residual
     R_squared_norm = SofaCaribou::Algebra::dot(p_F.get(), p_F.get());
+
+    // Step 3   Start from the solution predicted by the previous time steps if it is closer to the equilibrium
+    if (predictor() != Predictor::NONE and p_number_of_previous_U > 0) {
+        sofa::helper::ScopedAdvancedTimer _t_("Predictor");
+        const auto unpredicted_squared_norm = R_squared_norm;
+        R_squared_norm = apply_predictor(mechanical_parameters, accessor, x_id, v_id, f_id, dx_id, R_squared_norm);
+        if (print_log) {
+            info << "Predictor                : "
+                 << ((R_squared_norm < unpredicted_squared_norm) ? "accepted" : "rejected")
+                 << std::scientific
+                 << " (|R| = " << sqrt(unpredicted_squared_norm) << " without prediction)\n"
+                 << std::defaultfloat;
+        }
+    }
+
     p_squared_initial_residual = R_squared_norm;
 
+    // Step 4   Gather the total displacement (non-zero only when the prediction was accepted)
+    p_U->clear();
+    if (predictor() != Predictor::NONE and p_number_of_previous_U > 0) {
+        copy_to_system_vector(mechanical_parameters, accessor, p_U_id, p_U.get());
+    }
+
     if (absolute_residual_tolerance_threshold > 0 && R_squared_norm <= squared_absolute_residual_tolerance_threshold) {
         converged = true;
         if (print_log) {
@@ -252,53 +345,129 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
         sofa::helper::ScopedAdvancedTimer step_timer ("NewtonStep");
         t = steady_clock::now();
 
-        // Part 1. Assemble the system matrix.
-        {
-            sofa::helper::ScopedAdvancedTimer _t_("MBKBuild");
-            p_A->clear();
-            this->assemble_system_matrix(mechanical_parameters, accessor, p_A.get());
-            linear_solver->set_system_matrix(p_A.get());
-        }
+        // Reuse the factorization of the previous system matrix if none of the components contributing to it changed
+        // since then, which skips its assembly, its analysis and its factorization.
+        SystemMatrixRevision revision;
+        const bool system_matrix_is_tracked = d_reuse_factorization.getValue() and
+                                              system_matrix_revision(mechanical_parameters, accessor, revision);
+        const bool reuse_factorization = system_matrix_is_tracked and p_factorization_is_reusable and
+                                         revision == p_factorized_revision;
+
+        if (reuse_factorization) {
+            ++p_number_of_reused_factorizations;
+        } else {
+            // The linear solver is about to hold another matrix, its current factorization is lost
+            p_factorization_is_reusable = false;
 
-        // Part 2. Analyze the pattern of the matrix in order to compute a permutation matrix.
-        {
             // Let's see if we should (re)-analyze the pattern of the system matrix
-            if (
-                    pattern_strategy != PatternAnalysisStrategy::NEVER and (
-                        pattern_strategy == PatternAnalysisStrategy::ALWAYS or
-                        (
-                            (pattern_strategy == PatternAnalysisStrategy::BEGINNING_OF_THE_TIME_STEP or pattern_strategy == PatternAnalysisStrategy::BEGINNING_OF_THE_SIMULATION)
-                            and not p_has_already_analyzed_the_pattern
-                        )
-                   )
-                ) {
-
-                sofa::helper::ScopedAdvancedTimer _t_("MBKAnalyze");
-
-                if (not linear_solver->analyze_pattern()) {
-                    info << "[DIVERGED] Failed to analyze the pattern of the system matrix.";
-                    diverged = true;
-                    break;
+            const bool pattern_needs_analysis = (
+                pattern_strategy != PatternAnalysisStrategy::NEVER and (
+                    pattern_strategy == PatternAnalysisStrategy::ALWAYS or
+                    (
+                        (pattern_strategy == PatternAnalysisStrategy::BEGINNING_OF_THE_TIME_STEP or pattern_strategy == PatternAnalysisStrategy::BEGINNING_OF_THE_SIMULATION)
+                        and not p_has_already_analyzed_the_pattern
+                    )
+                )
+            );
+
+            // Part 0. Analyze the symbolic pattern of the system matrix on a worker thread, while the numeric values of
+            //         the matrix are assembled. The worker fills its own pattern matrix from a copy of the cached
+            //         pattern, and uses the linear solver until it is joined. Hence, the main thread must not touch
+            //         the linear solver before the join.
+            std::future<bool> symbolic_analysis;
+            bool symbolic_analysis_succeeded = false;
+            if (pattern_needs_analysis and d_symbolic_pattern_analysis.getValue() and not static_condensation and p_symbolic_pattern_is_complete) {
+                // The symbolic pattern only depends on the structure of the mechanical graph, it is cached until the
+                // system buffers are recreated
+                if (not p_symbolic_pattern_is_cached) {
+                    sofa::helper::ScopedAdvancedTimer _t_pattern_("MBKSymbolicPattern");
+                    p_symbolic_pattern_is_complete = build_symbolic_pattern(accessor, p_symbolic_pattern);
+                    p_symbolic_pattern_is_cached = true;
+                    ++p_number_of_symbolic_pattern_builds;
                 }
 
-                p_has_already_analyzed_the_pattern = true;
+                if (p_symbolic_pattern_is_complete) {
+                    const auto n = static_cast<sofa::Size>(p_system_size);
+                    p_pattern.reset(linear_solver->create_new_matrix(n, n));
+                    symbolic_analysis = std::async(std::launch::async,
+                        [linear_solver, pattern = p_pattern.get(), blocks = p_symbolic_pattern]() {
+                            fill_symbolic_pattern(blocks, pattern);
+                            linear_solver->set_system_matrix(pattern);
+                            return linear_solver->analyze_pattern();
+                        }
+                    );
+                }
             }
-        }
 
-        // Part 3. Factorize the matrix.
-        {
-            sofa::helper::ScopedAdvancedTimer _t_("MBKFactorize");
-            if (not linear_solver->factorize()) {
-                info << "[DIVERGED] Failed to factorize the system matrix.";
-                diverged = true;
-                break;
+            // Part 1. Assemble the system matrix.
+            {
+                sofa::helper::ScopedAdvancedTimer _t_("MBKBuild");
+                p_A->clear();
+                this->assemble_system_matrix(mechanical_parameters, accessor, p_A.get());
+
+                // Join the symbolic analysis before the linear solver is used again by the main thread
+                if (symbolic_analysis.valid()) {
+                    sofa::helper::ScopedAdvancedTimer _t_symbolic_("MBKSymbolicAnalyze");
+                    symbolic_analysis_succeeded = symbolic_analysis.get() and symbolic_pattern_matches(p_A.get());
+                    if (not symbolic_analysis_succeeded) {
+                        p_symbolic_pattern_is_complete = false;
+                        msg_info() << "The pattern of the system matrix cannot be derived from the topologies, it will be "
+                                      "analyzed after its assembly.";
+                    }
+                }
+
+                if (static_condensation) {
+                    sofa::helper::ScopedAdvancedTimer _t_condense_("MBKCondense");
+                    if (not condense_system_matrix(accessor, linear_solver)) {
+                        info << "[DIVERGED] Failed to condense the system matrix.";
+                        diverged = true;
+                        break;
+                    }
+                    linear_solver->set_system_matrix(p_S.get());
+                } else {
+                    linear_solver->set_system_matrix(p_A.get());
+                }
+            }
+
+            // Part 2. Analyze the pattern of the matrix in order to compute a permutation matrix.
+            {
+                if (pattern_needs_analysis and symbolic_analysis_succeeded) {
+                    // The symbolic pattern was already analyzed during the assembly
+                    p_has_already_analyzed_the_pattern = true;
+                    ++p_number_of_symbolic_pattern_analyses;
+                } else if (pattern_needs_analysis) {
+                    sofa::helper::ScopedAdvancedTimer _t_("MBKAnalyze");
+
+                    if (not linear_solver->analyze_pattern()) {
+                        info << "[DIVERGED] Failed to analyze the pattern of the system matrix.";
+                        diverged = true;
+                        break;
+                    }
+
+                    p_has_already_analyzed_the_pattern = true;
+                }
             }
+
+            // Part 3. Factorize the matrix.
+            {
+                sofa::helper::ScopedAdvancedTimer _t_("MBKFactorize");
+                if (not linear_solver->factorize()) {
+                    info << "[DIVERGED] Failed to factorize the system matrix.";
+                    diverged = true;
+                    break;
+                }
+            }
+
+            p_factorized_revision = std::move(revision);
+            p_factorization_is_reusable = system_matrix_is_tracked;
         }
 
         // Part 4. Solve the unknown increment.
         {
             sofa::helper::ScopedAdvancedTimer _t_("MBKSolve");
-            if (not linear_solver->solve(p_F.get(), p_DX.get())) {
+            const bool solved = static_condensation ? solve_condensed_system(linear_solver)
+                                                    : linear_solver->solve(p_F.get(), p_DX.get());
+            if (not solved) {
                 info << "[DIVERGED] The linear solver failed to solve the unknown increment.";
                 diverged = true;
                 break;
@@ -327,12 +496,9 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
 
         // Part 8. Compute the updated displacement residual.
         sofa::helper::AdvancedTimer::stepBegin("UpdateU");
-        vop.v_peq(p_U_id, dx_id); // U += dx
-        vop.v_dot(dx_id, dx_id);  // dx.dot(dx)
-        dx_squared_norm = vop.finish();
-
-        vop.v_dot(p_U_id, p_U_id); // U.dot(U)
-        du_squared_norm = vop.finish();
+        // The norms are computed on the global system vectors, which avoids traversing the scene graph
+        dx_squared_norm = SofaCaribou::Algebra::dot(p_DX.get(), p_DX.get()); // dx.dot(dx)
+        du_squared_norm = SofaCaribou::Algebra::axpy_dot(1., p_DX.get(), p_U.get()); // U += dx, U.dot(U)
         sofa::helper::AdvancedTimer::stepEnd("UpdateU");
 
         // Part 9. Stop timers and print step information.
@@ -415,12 +581,31 @@ void NewtonRaphsonSolver::solve(const ExecParams *params, SReal dt, MultiVecCoor
 
     d_converged.setValue(converged);
 
+    // Keep the total increments of the last converged time steps for the predictor
+    if (predictor() != Predictor::NONE) {
+        if (converged) {
+            copy_from_system_vector(mechanical_parameters, accessor, p_U.get(), p_U_id);
+            vop.v_realloc(p_previous_U_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
+            if (p_number_of_previous_U > 0) {
+                vop.v_realloc(p_second_previous_U_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
+                vop.v_eq(p_second_previous_U_id, p_previous_U_id);
+            }
+            vop.v_eq(p_previous_U_id, p_U_id);
+            p_number_of_previous_U = std::min(p_number_of_previous_U + 1, 2u);
+        } else {
+            // The extrapolation of a diverged step would only be a worse initial guess
+            p_number_of_previous_U = 0;
+        }
+    }
+
     sofa::helper::AdvancedTimer::valSet("has_converged", converged ? 1 : 0);
     sofa::helper::AdvancedTimer::valSet("nb_iterations", n_it+1);
 }
 
 void NewtonRaphsonSolver::init() {
     p_has_already_analyzed_the_pattern = false;
+    p_condensation_needs_analysis = true;
+    invalidate_system_buffers();
 
     if (not has_valid_linear_solver()) {
         // No linear solver specified, let's try to find one in the current node
@@ -474,6 +659,586 @@ void NewtonRaphsonSolver::init() {
 
 void NewtonRaphsonSolver::reset() {
     p_has_already_analyzed_the_pattern = false;
+    p_condensation_needs_analysis = true;
+    p_symbolic_pattern_is_complete = true;
+    p_symbolic_pattern_is_cached = false;
+    p_factorization_is_reusable = false;
+    p_number_of_previous_U = 0;
+}
+
+void NewtonRaphsonSolver::cleanup() {
+    sofa::core::MechanicalParams mechanical_parameters;
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+    vop.v_free(p_U_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
+    vop.v_free(p_previous_U_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
+    vop.v_free(p_second_previous_U_id, false /* interactionForceField */, false /* propagate [to mapped MO] */);
+    p_number_of_previous_U = 0;
+}
+
+bool NewtonRaphsonSolver::mechanical_graph_changed() {
+    using sofa::core::objectmodel::BaseContext;
+    auto * context = this->getContext();
+
+    // The containers keep their capacity between the calls, gathering the components does not allocate in steady-state
+    p_mechanical_states.clear();
+    p_mechanical_mappings.clear();
+    context->template get<sofa::core::behavior::BaseMechanicalState>(&p_mechanical_states, BaseContext::SearchDown);
+    context->template get<sofa::core::BaseMapping>(&p_mechanical_mappings, BaseContext::SearchDown);
+
+    const auto number_of_entries = p_mechanical_states.size() + p_mechanical_mappings.size();
+    bool changed = (number_of_entries != p_mechanical_graph_signature.size());
+    if (changed) {
+        p_mechanical_graph_signature.resize(number_of_entries);
+    }
+
+    std::size_t i = 0;
+    for (const auto * state : p_mechanical_states) {
+        const auto * topology = state->getContext()->getMeshTopology();
+        const MechanicalGraphEntry entry {
+            state,
+            static_cast<std::size_t>(state->getMatrixSize()),
+            topology ? topology->getRevision() : 0
+        };
+        if (not (p_mechanical_graph_signature[i] == entry)) {
+            p_mechanical_graph_signature[i] = entry;
+            changed = true;
+        }
+        ++i;
+    }
+
+    for (const auto * mapping : p_mechanical_mappings) {
+        const MechanicalGraphEntry entry {mapping, static_cast<std::size_t>(mapping->isMechanical()), 0};
+        if (not (p_mechanical_graph_signature[i] == entry)) {
+            p_mechanical_graph_signature[i] = entry;
+            changed = true;
+        }
+        ++i;
+    }
+
+    return changed;
+}
+
+void NewtonRaphsonSolver::update_system_buffers(sofa::simulation::common::MechanicalOperations & mop,
+                                                SofaCaribou::solver::LinearSolver * linear_solver) {
+    // The signature of the mechanical graph is always updated, even when the buffers are rebuilt for another reason
+    const bool graph_changed = mechanical_graph_changed();
+    if (p_accessor and not graph_changed and linear_solver == p_system_buffers_owner) {
+        return;
+    }
+
+    sofa::helper::ScopedAdvancedTimer _t_("SystemSetup");
+    p_accessor = std::make_unique<sofa::component::linearsolver::DefaultMultiMatrixAccessor>();
+
+    // Step 1   Get dimension of each top level mechanical states using
+    //          BaseMechanicalState::getMatrixSize(), and accumulate mechanical
+    //          objects and mapping matrices
+    mop.getMatrixDimension(nullptr, nullptr, p_accessor.get());
+    const auto n = static_cast<sofa::Size>(p_accessor->getGlobalDimension());
+
+    // Step 2   Does nothing more than to accumulate from the previous step a list of
+    //          "MatrixRef = <MechanicalState*, MatrixIndex>" where MatrixIndex is the
+    //          (i,i) position of the given top level MechanicalState* inside the global
+    //          system matrix. This global matrix hence contains one sub-matrix per top
+    //          level mechanical state.
+    p_accessor->setupMatrices();
+
+    // Step 3   Let the linear solver create the system matrix and vector buffers
+    //          using the previously computed system size n
+    p_A.reset(linear_solver->create_new_matrix(n, n));
+    p_DX.reset(linear_solver->create_new_vector(n));
+    p_F.reset(linear_solver->create_new_vector(n));
+    p_U.reset(linear_solver->create_new_vector(n));
+
+    p_system_size = static_cast<std::size_t>(n);
+    p_system_buffers_owner = linear_solver;
+    p_system_vectors_are_mapped = false;
+    p_symbolic_pattern_is_complete = true;
+    p_symbolic_pattern_is_cached = false;
+    p_factorization_is_reusable = false;
+    p_system_vectors_can_be_mapped = (dynamic_cast<SofaCaribou::Algebra::EigenVector<EigenDenseVector> *>(p_F.get()) != nullptr);
+    ++p_number_of_system_setups;
+}
+
+void NewtonRaphsonSolver::update_system_vector_views(SofaCaribou::solver::LinearSolver * linear_solver,
+                                                     const MultiVecDerivId & f_id, const MultiVecDerivId & dx_id,
+                                                     bool static_condensation) {
+    // The system vectors can only be views when the global system vector of the mechanical graph is a single
+    // contiguous buffer (one unmapped mechanical object), and when they are not condensed before being solved.
+    FLOATING_POINT_TYPE * f_buffer = nullptr;
+    FLOATING_POINT_TYPE * dx_buffer = nullptr;
+    if (p_system_vectors_can_be_mapped and not static_condensation and p_mechanical_states.size() == 1) {
+        const auto f = SofaCaribou::Algebra::mechanical_state_buffer(p_mechanical_states[0], f_id);
+        const auto dx = SofaCaribou::Algebra::mechanical_state_buffer(p_mechanical_states[0], dx_id);
+        if (f.second == p_system_size and dx.second == p_system_size) {
+            f_buffer = f.first;
+            dx_buffer = dx.first;
+        }
+    }
+
+    const auto n = static_cast<Eigen::Index>(p_system_size);
+    if (f_buffer and dx_buffer) {
+        // The views are only recreated when the mechanical object reallocated its buffers
+        const auto * F = dynamic_cast<const MappedEigenDenseVector *>(p_F.get());
+        if (not F or F->vector().data() != f_buffer) {
+            Eigen::Map<EigenDenseVector> f(f_buffer, n);
+            p_F = std::make_unique<MappedEigenDenseVector>(f);
+        }
+
+        const auto * DX = dynamic_cast<const MappedEigenDenseVector *>(p_DX.get());
+        if (not DX or DX->vector().data() != dx_buffer) {
+            Eigen::Map<EigenDenseVector> dx(dx_buffer, n);
+            p_DX = std::make_unique<MappedEigenDenseVector>(dx);
+        }
+
+        p_system_vectors_are_mapped = true;
+    } else if (p_system_vectors_are_mapped) {
+        // Fallback to system vectors owning their coefficients, which are copied from and to the mechanical objects
+        p_DX.reset(linear_solver->create_new_vector(static_cast<sofa::Size>(n)));
+        p_F.reset(linear_solver->create_new_vector(static_cast<sofa::Size>(n)));
+        p_system_vectors_are_mapped = false;
+    }
+}
+
+bool NewtonRaphsonSolver::is_mapped_over(const SofaCaribou::Algebra::BaseVector * v, const MultiVecDerivId & id) {
+    if (not p_system_vectors_are_mapped) {
+        return false;
+    }
+
+    const auto * mapped = dynamic_cast<const MappedEigenDenseVector *>(v);
+    return mapped and p_mechanical_states.size() == 1 and
+           mapped->vector().data() == SofaCaribou::Algebra::mechanical_state_buffer(p_mechanical_states[0], id).first;
+}
+
+void NewtonRaphsonSolver::copy_to_system_vector(const sofa::core::MechanicalParams & mechanical_parameters,
+                                                const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
+                                                const MultiVecDerivId & id,
+                                                SofaCaribou::Algebra::BaseVector * v) {
+    if (is_mapped_over(v, id)) {
+        return;
+    }
+
+    MechanicalMultiVectorToBaseVectorVisitor(&mechanical_parameters, id /* source */, v /* destination */, &matrix_accessor)
+    .execute(this->getContext());
+}
+
+void NewtonRaphsonSolver::copy_from_system_vector(const sofa::core::MechanicalParams & mechanical_parameters,
+                                                  const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
+                                                  const SofaCaribou::Algebra::BaseVector * v,
+                                                  MultiVecDerivId & id) {
+    if (is_mapped_over(v, id)) {
+        return;
+    }
+
+    MechanicalMultiVectorFromBaseVectorVisitor(&mechanical_parameters, id /* destination */, v /* source */, &matrix_accessor)
+    .execute(this->getContext());
+}
+
+auto NewtonRaphsonSolver::apply_predictor(const sofa::core::MechanicalParams & mechanical_parameters,
+                                          const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                                          MultiVecCoordId & x_id, MultiVecDerivId & v_id,
+                                          MultiVecDerivId & f_id, MultiVecDerivId & dx_id,
+                                          FLOATING_POINT_TYPE squared_residual) -> FLOATING_POINT_TYPE {
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+
+    // 1. Extrapolate the total increment of the step
+    if (predictor() == Predictor::QUADRATIC and p_number_of_previous_U > 1) {
+        vop.v_op(dx_id, p_previous_U_id, p_second_previous_U_id, -1.); // dx = U_n - U_{n-1}
+        vop.v_peq(dx_id, p_previous_U_id);                             // dx = 2 U_n - U_{n-1}
+    } else {
+        vop.v_eq(dx_id, p_previous_U_id);                              // dx = U_n
+    }
+
+    // 2. Propagate it as if it was the solution of a Newton iteration, and compute the new residual
+    copy_to_system_vector(mechanical_parameters, matrix_accessor, dx_id, p_DX.get());
+    this->propagate_solution_increment(mechanical_parameters, matrix_accessor, p_DX.get(), x_id, v_id, dx_id);
+
+    p_F->clear();
+    this->assemble_rhs_vector(mechanical_parameters, matrix_accessor, f_id, p_F.get());
+    const auto predicted_squared_residual = SofaCaribou::Algebra::dot(p_F.get(), p_F.get());
+
+    if (not std::isnan(predicted_squared_residual) and predicted_squared_residual < squared_residual) {
+        // The prediction is part of the total increment of the step
+        vop.v_eq(p_U_id, dx_id);
+        squared_residual = predicted_squared_residual;
+    } else {
+        // 3. The prediction is worse than the current solution, undo it
+        vop.v_teq(dx_id, -1.);
+        copy_to_system_vector(mechanical_parameters, matrix_accessor, dx_id, p_DX.get());
+        this->propagate_solution_increment(mechanical_parameters, matrix_accessor, p_DX.get(), x_id, v_id, dx_id);
+
+        p_F->clear();
+        this->assemble_rhs_vector(mechanical_parameters, matrix_accessor, f_id, p_F.get());
+        squared_residual = SofaCaribou::Algebra::dot(p_F.get(), p_F.get());
+    }
+
+    p_DX->clear();
+    vop.v_clear(dx_id);
+
+    return squared_residual;
+}
+
+namespace {
+using ColMajorSparseMatrix = Eigen::SparseMatrix<FLOATING_POINT_TYPE, Eigen::ColMajor, int>;
+using RowMajorSparseMatrix = Eigen::SparseMatrix<FLOATING_POINT_TYPE, Eigen::RowMajor, int>;
+
+// Get the complete column major Eigen matrix of a system matrix, copying it into the buffer if it is stored in row
+// major or if only its upper triangular part is stored.
+auto column_major_matrix(const SofaCaribou::Algebra::BaseMatrix * A, ColMajorSparseMatrix & buffer) -> const ColMajorSparseMatrix * {
+    if (const auto * col_major = dynamic_cast<const SofaCaribou::Algebra::EigenMatrix<ColMajorSparseMatrix> *>(A)) {
+        if (col_major->symmetric_storage()) {
+            buffer = col_major->matrix().selfadjointView<Eigen::Upper>();
+            return &buffer;
+        }
+        return &col_major->matrix();
+    }
+
+    if (const auto * row_major = dynamic_cast<const SofaCaribou::Algebra::EigenMatrix<RowMajorSparseMatrix> *>(A)) {
+        if (row_major->symmetric_storage()) {
+            buffer = row_major->matrix().selfadjointView<Eigen::Upper>();
+        } else {
+            buffer = row_major->matrix();
+        }
+        return &buffer;
+    }
+
+    return nullptr;
+}
+
+// Flag the dofs of every edge-midpoint nodes (nodes after the corner nodes) of a quadratic topology
+template <typename Element, typename LinearElement>
+void flag_edge_nodes(sofa::core::objectmodel::BaseContext * context,
+                     const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                     std::vector<bool> & candidates,
+                     std::vector<bool> & corners) {
+    using Topology = SofaCaribou::topology::CaribouTopology<Element>;
+    constexpr auto NumberOfCornerNodes = caribou::geometry::traits<LinearElement>::NumberOfNodesAtCompileTime;
+
+    const auto topologies = context->template getObjects<Topology>(sofa::core::objectmodel::BaseContext::SearchDown);
+    for (auto * topology : topologies) {
+        const auto * domain = topology->domain();
+        const auto * state = topology->getContext()->getMechanicalState();
+        if (not domain or not state) {
+            continue;
+        }
+
+        const auto offset = matrix_accessor.getGlobalOffset(state);
+        if (offset < 0) {
+            continue; // Mapped mechanical state, its nodes aren't part of the global system
+        }
+
+        const auto dofs_per_node = static_cast<std::size_t>(state->getDerivDimension());
+        for (std::size_t element_id = 0; element_id < domain->number_of_elements(); ++element_id) {
+            const auto node_indices = domain->element_indices(element_id);
+            for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(node_indices.size()); ++i) {
+                auto & flags = (i < NumberOfCornerNodes) ? corners : candidates;
+                const auto first_dof = static_cast<std::size_t>(offset) + static_cast<std::size_t>(node_indices[i])*dofs_per_node;
+                for (std::size_t dof = first_dof; dof < first_dof + dofs_per_node and dof < flags.size(); ++dof) {
+                    flags[dof] = true;
+                }
+            }
+        }
+    }
+}
+
+using NodeAdjacency = std::vector<std::vector<UNSIGNED_INTEGER_TYPE>>;
+
+// Accumulate the node adjacency (nodes sharing at least one element) of every component of the given type (forcefield
+// or mass) found in the context sub-graph. The adjacency is kept per mechanical state since two states are only coupled
+// through interaction forcefields. Returns false if one of the components is attached to a mapped mechanical state,
+// since its contribution to the system matrix then depends on the mapping.
+template <typename Component>
+bool accumulate_node_adjacency(sofa::core::objectmodel::BaseContext * context,
+                               const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                               std::map<const sofa::core::behavior::BaseMechanicalState *, NodeAdjacency> & adjacencies) {
+    const auto components = context->template getObjects<Component>(sofa::core::objectmodel::BaseContext::SearchDown);
+    for (auto * component : components) {
+        const auto topology = component->topology();
+        const auto * domain = topology ? topology->domain() : nullptr;
+        const auto * state = component->getMState();
+        if (not domain or not state) {
+            continue;
+        }
+
+        if (matrix_accessor.getGlobalOffset(state) < 0) {
+            return false; // Mapped mechanical state
+        }
+
+        auto & adjacency = adjacencies[state];
+        adjacency.resize(std::max(adjacency.size(), static_cast<std::size_t>(state->getSize())));
+        for (std::size_t element_id = 0; element_id < domain->number_of_elements(); ++element_id) {
+            const auto node_indices = domain->element_indices(element_id);
+            for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(node_indices.size()); ++i) {
+                const auto node_i = static_cast<std::size_t>(node_indices[i]);
+                if (node_i >= adjacency.size()) {
+                    continue;
+                }
+                for (Eigen::Index j = 0; j < static_cast<Eigen::Index>(node_indices.size()); ++j) {
+                    adjacency[node_i].emplace_back(static_cast<UNSIGNED_INTEGER_TYPE>(node_indices[j]));
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// True if the two system matrices are Eigen sparse matrices of the given type storing exactly the same coefficients
+template <typename SparseMatrix>
+bool have_same_pattern(const SofaCaribou::Algebra::BaseMatrix * A, const SofaCaribou::Algebra::BaseMatrix * B) {
+    const auto * a = dynamic_cast<const SofaCaribou::Algebra::EigenMatrix<SparseMatrix> *>(A);
+    const auto * b = dynamic_cast<const SofaCaribou::Algebra::EigenMatrix<SparseMatrix> *>(B);
+    if (not a or not b) {
+        return false;
+    }
+
+    const auto & ma = a->matrix();
+    const auto & mb = b->matrix();
+    if (ma.rows() != mb.rows() or ma.cols() != mb.cols() or ma.nonZeros() != mb.nonZeros()
+        or not ma.isCompressed() or not mb.isCompressed()) {
+        return false;
+    }
+
+    return std::equal(ma.outerIndexPtr(), ma.outerIndexPtr() + ma.outerSize() + 1, mb.outerIndexPtr()) and
+           std::equal(ma.innerIndexPtr(), ma.innerIndexPtr() + ma.nonZeros(), mb.innerIndexPtr());
+}
+
+// True if the forcefield is of one of the given types
+template <typename... Types>
+bool is_one_of(const sofa::core::behavior::BaseForceField * forcefield) {
+    return ((dynamic_cast<const Types *>(forcefield) != nullptr) or ...);
+}
+
+// Revision number of the matrix added to the system by a forcefield or a mass. Only the components keeping track of the
+// changes of their matrix have one, any other component might change its matrix at every assembly.
+auto matrix_revision_of(const sofa::core::behavior::BaseForceField * forcefield) -> std::optional<UNSIGNED_INTEGER_TYPE> {
+    using namespace caribou::geometry;
+    using caribou::_2D;
+    using caribou::_3D;
+    using SofaCaribou::forcefield::HexahedronElasticForce;
+    using SofaCaribou::forcefield::TetrahedronElasticForce;
+    using SofaCaribou::forcefield::TractionForcefield;
+    using SofaCaribou::mass::CaribouMass;
+
+    if (const auto * hexahedron_force = dynamic_cast<const HexahedronElasticForce *>(forcefield)) {
+        return hexahedron_force->stiffness_revision();
+    }
+
+    if (const auto * tetrahedron_force = dynamic_cast<const TetrahedronElasticForce *>(forcefield)) {
+        return tetrahedron_force->stiffness_revision();
+    }
+
+    if (const auto * mass = dynamic_cast<const CaribouMass<Hexahedron> *>(forcefield)) {
+        return mass->mass_revision();
+    }
+
+    if (const auto * mass = dynamic_cast<const CaribouMass<Hexahedron20> *>(forcefield)) {
+        return mass->mass_revision();
+    }
+
+    if (const auto * mass = dynamic_cast<const CaribouMass<Tetrahedron> *>(forcefield)) {
+        return mass->mass_revision();
+    }
+
+    if (const auto * mass = dynamic_cast<const CaribouMass<Tetrahedron10> *>(forcefield)) {
+        return mass->mass_revision();
+    }
+
+    // Traction forcefields do not add any matrix to the system
+    if (is_one_of<TractionForcefield<Triangle<_2D>>, TractionForcefield<Triangle<_3D>>,
+                  TractionForcefield<Triangle6<_2D>>, TractionForcefield<Triangle6<_3D>>,
+                  TractionForcefield<Quad<_2D>>, TractionForcefield<Quad<_3D>>,
+                  TractionForcefield<Quad8<_2D>>, TractionForcefield<Quad8<_3D>>>(forcefield)) {
+        return 0;
+    }
+
+    return {};
+}
+} // namespace
+
+auto NewtonRaphsonSolver::condensable_dofs(const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor) -> std::vector<bool> {
+    const auto n = static_cast<std::size_t>(matrix_accessor.getGlobalDimension());
+    std::vector<bool> candidates (n, false);
+    std::vector<bool> corners (n, false);
+
+    auto * context = this->getContext();
+    flag_edge_nodes<caribou::geometry::Hexahedron20, caribou::geometry::Hexahedron>(context, matrix_accessor, candidates, corners);
+    flag_edge_nodes<caribou::geometry::Tetrahedron10, caribou::geometry::Tetrahedron>(context, matrix_accessor, candidates, corners);
+    flag_edge_nodes<caribou::geometry::Quad8<caribou::_3D>, caribou::geometry::Quad<caribou::_3D>>(context, matrix_accessor, candidates, corners);
+    flag_edge_nodes<caribou::geometry::Triangle6<caribou::_3D>, caribou::geometry::Triangle<caribou::_3D>>(context, matrix_accessor, candidates, corners);
+
+    // A node used as a corner by any element is never condensed
+    for (std::size_t i = 0; i < n; ++i) {
+        candidates[i] = candidates[i] and not corners[i];
+    }
+
+    return candidates;
+}
+
+bool NewtonRaphsonSolver::condense_system_matrix(const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                                                 const SofaCaribou::solver::LinearSolver * linear_solver) {
+    ColMajorSparseMatrix buffer;
+    const auto * A = column_major_matrix(p_A.get(), buffer);
+    if (not A) {
+        msg_error() << "The static condensation requires a linear solver assembling an Eigen sparse matrix.";
+        return false;
+    }
+
+    if (p_condensation_needs_analysis or p_condensation.number_of_dofs() != A->cols()) {
+        const auto candidates = condensable_dofs(matrix_accessor);
+        p_condensation.analyze_pattern(*A, candidates, 3, static_cast<Eigen::Index>(d_condensation_patch_size.getValue()));
+        p_condensation_needs_analysis = false;
+
+        const auto n_kept = static_cast<sofa::Size>(p_condensation.number_of_kept_dofs());
+        p_S.reset(linear_solver->create_new_matrix(n_kept, n_kept));
+        p_F_kept.reset(linear_solver->create_new_vector(n_kept));
+        p_DX_kept.reset(linear_solver->create_new_vector(n_kept));
+
+        msg_info() << "Static condensation of " << p_condensation.number_of_condensed_dofs() << " dofs over "
+                   << p_condensation.number_of_dofs() << " in " << p_condensation.number_of_patches() << " patches.";
+    }
+
+    if (not p_condensation.condense(*A)) {
+        return false;
+    }
+
+    // Copy the Schur complement into the linear solver's matrix
+    const auto & S = p_condensation.S();
+    p_S->clear();
+    for (Eigen::Index j = 0; j < S.outerSize(); ++j) {
+        for (ColMajorSparseMatrix::InnerIterator it(S, j); it; ++it) {
+            p_S->add(static_cast<sofa::Index>(it.row()), static_cast<sofa::Index>(it.col()), it.value());
+        }
+    }
+    p_S->compress();
+
+    return true;
+}
+
+bool NewtonRaphsonSolver::solve_condensed_system(SofaCaribou::solver::LinearSolver * linear_solver) {
+    using SofaCaribou::Algebra::EigenVector;
+    auto * F = dynamic_cast<EigenVector<EigenDenseVector> *>(p_F.get());
+    auto * DX = dynamic_cast<EigenVector<EigenDenseVector> *>(p_DX.get());
+    auto * F_kept = dynamic_cast<EigenVector<EigenDenseVector> *>(p_F_kept.get());
+    auto * DX_kept = dynamic_cast<EigenVector<EigenDenseVector> *>(p_DX_kept.get());
+    if (not F or not DX or not F_kept or not DX_kept) {
+        msg_error() << "The static condensation requires a linear solver using Eigen dense vectors.";
+        return false;
+    }
+
+    p_condensation.condense_rhs(F->vector(), F_kept->vector());
+    if (not linear_solver->solve(F_kept, DX_kept)) {
+        return false;
+    }
+    p_condensation.recover(F->vector(), DX_kept->vector(), DX->vector());
+
+    return true;
+}
+
+bool NewtonRaphsonSolver::build_symbolic_pattern(const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                                                 std::vector<SymbolicPatternBlock> & blocks) const {
+    using namespace caribou::geometry;
+    using SofaCaribou::forcefield::CaribouForcefield;
+    using SofaCaribou::mass::CaribouMass;
+
+    auto * context = this->getContext();
+    std::map<const sofa::core::behavior::BaseMechanicalState *, NodeAdjacency> adjacencies;
+    const bool complete =
+        accumulate_node_adjacency<CaribouForcefield<Hexahedron>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Hexahedron20>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Tetrahedron>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Tetrahedron10>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Quad<caribou::_2D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Quad<caribou::_3D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Quad8<caribou::_2D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Quad8<caribou::_3D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Triangle<caribou::_2D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Triangle<caribou::_3D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Triangle6<caribou::_2D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouForcefield<Triangle6<caribou::_3D>>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouMass<Hexahedron>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouMass<Hexahedron20>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouMass<Tetrahedron>>(context, matrix_accessor, adjacencies) and
+        accumulate_node_adjacency<CaribouMass<Tetrahedron10>>(context, matrix_accessor, adjacencies);
+
+    blocks.clear();
+    if (not complete or adjacencies.empty()) {
+        return false;
+    }
+
+    for (auto & [state, adjacency] : adjacencies) {
+        const auto offset = static_cast<sofa::Index>(matrix_accessor.getGlobalOffset(state));
+        const auto dofs_per_node = static_cast<sofa::Index>(state->getDerivDimension());
+        for (std::size_t node_i = 0; node_i < adjacency.size(); ++node_i) {
+            auto & neighbors = adjacency[node_i];
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+            const auto row = offset + static_cast<sofa::Index>(node_i)*dofs_per_node;
+            for (const auto & node_j : neighbors) {
+                const auto col = offset + static_cast<sofa::Index>(node_j)*dofs_per_node;
+                blocks.push_back({row, col, dofs_per_node});
+            }
+        }
+    }
+
+    return true;
+}
+
+void NewtonRaphsonSolver::fill_symbolic_pattern(const std::vector<SymbolicPatternBlock> & blocks,
+                                                SofaCaribou::Algebra::BaseMatrix * pattern) {
+    for (const auto & block : blocks) {
+        for (sofa::Index k = 0; k < block.size; ++k) {
+            for (sofa::Index l = 0; l < block.size; ++l) {
+                pattern->add(block.row + k, block.col + l, 0.);
+            }
+        }
+    }
+    pattern->compress();
+}
+
+bool NewtonRaphsonSolver::symbolic_pattern_matches(const SofaCaribou::Algebra::BaseMatrix * A) const {
+    return p_pattern and (
+        have_same_pattern<ColMajorSparseMatrix>(p_pattern.get(), A) or
+        have_same_pattern<RowMajorSparseMatrix>(p_pattern.get(), A)
+    );
+}
+
+bool NewtonRaphsonSolver::system_matrix_revision(const sofa::core::MechanicalParams & mechanical_parameters,
+                                                 const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                                                 SystemMatrixRevision & revision) const {
+    using sofa::core::objectmodel::BaseContext;
+    auto * context = this->getContext();
+
+    revision.coefficients = system_matrix_coefficients(mechanical_parameters);
+    revision.entries.clear();
+
+    // Forcefields and masses
+    const auto forcefields = context->template getObjects<sofa::core::behavior::BaseForceField>(BaseContext::SearchDown);
+    for (const auto * forcefield : forcefields) {
+        const auto matrix_revision = matrix_revision_of(forcefield);
+        if (not matrix_revision) {
+            return false;
+        }
+
+        const auto * state = forcefield->getContext()->getMechanicalState();
+        if (state and matrix_accessor.getGlobalOffset(state) < 0) {
+            return false; // Mapped mechanical state, its matrix also depends on the mapping
+        }
+
+        revision.entries.push_back({forcefield, nullptr, static_cast<std::size_t>(*matrix_revision)});
+    }
+
+    // Projective constraints (for example, the constrained indices of a FixedConstraint). Each data is tracked
+    // separately, after pulling the value of its parent (if any) so that a change upstream is seen here.
+    const auto constraints = context->template getObjects<sofa::core::behavior::BaseProjectiveConstraintSet>(BaseContext::SearchDown);
+    for (const auto * constraint : constraints) {
+        for (const auto * data : constraint->getDataFields()) {
+            data->updateIfDirty();
+            revision.entries.push_back({constraint, data, static_cast<std::size_t>(data->getCounter())});
+        }
+    }
+
+    return true;
 }
 
 bool NewtonRaphsonSolver::has_valid_linear_solver() const {
@@ -503,4 +1268,23 @@ void NewtonRaphsonSolver::set_pattern_analysis_strategy(const NewtonRaphsonSolve
     pattern_analysis_strategy->setSelectedItem(static_cast<unsigned int> (strategy));
 }
 
+auto NewtonRaphsonSolver::predictor() const -> NewtonRaphsonSolver::Predictor {
+    const auto v = static_cast<Predictor>(d_predictor.getValue().getSelectedId());
+    switch (v) {
+        case Predictor::NONE:
+        case Predictor::LINEAR:
+        case Predictor::QUADRATIC:
+            return v;
+    }
+
+    // Default value
+    return NewtonRaphsonSolver::Predictor::NONE;
+}
+
+void NewtonRaphsonSolver::set_predictor(const NewtonRaphsonSolver::Predictor & predictor) {
+    using namespace sofa::helper;
+    auto p = WriteOnlyAccessor<Data<OptionsGroup>>(d_predictor);
+    p->setSelectedItem(static_cast<unsigned int> (predictor));
+}
+
 } // namespace SofaCaribou::ode
\ No newline at end of file
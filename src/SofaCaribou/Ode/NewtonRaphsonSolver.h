@@ -11,9 +11,19 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/objectmodel/Link.h>
 #include <sofa/helper/OptionsGroup.h>
 #include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+#include <sofa/simulation/MechanicalOperations.h>
 DISABLE_ALL_WARNINGS_END
 
+#include <SofaCaribou/Algebra/StaticCondensation.h>
+
+#include <array>
 #include <memory>
+#include <utility>
+#include <vector>
+
+namespace SofaCaribou::solver {
+class LinearSolver;
+}
 
 namespace SofaCaribou::ode {
 
@@ -40,6 +50,21 @@ namespace SofaCaribou::ode {
  *     \mat{J} = \frac{\partial \vect{F}}{\partial \vect{x}_{n+1}} \bigg\rvert_{\vect{x}_{n+1}^i}
  * \f}
  *
+ * When the static_condensation option is enabled, the edge-midpoint nodes of the quadratic CaribouTopology found in the
+ * current context (Hexahedron20, Tetrahedron10, Quad8 and Triangle6) are eliminated patch-wise from the assembled system
+ * using a Schur complement (see SofaCaribou::Algebra::StaticCondensation). The linear solver only factorizes the smaller
+ * condensed system, and the eliminated increments are recovered afterward.
+ *
+ * When a predictor is selected, the Newton iterations of a time step do not start from the current solution, but from
+ * an extrapolation of the total solution increments \f$\vect{U}\f$ of the last converged time steps:
+ *
+ * \f{align*}{
+ *     \text{linear:}    && \vect{U}_{n+1}^0 &= \vect{U}_{n} \\
+ *     \text{quadratic:} && \vect{U}_{n+1}^0 &= 2 \vect{U}_{n} - \vect{U}_{n-1}
+ * \f}
+ *
+ * The predicted increment is propagated like any other Newton increment, and is undone if the residual it gives is
+ * larger than the residual at the current solution.
  *
  */
 class NewtonRaphsonSolver : public sofa::core::behavior::OdeSolver {
@@ -63,6 +88,16 @@ public:
         ALWAYS
     };
 
+    /**
+     * Extrapolation used to predict the initial guess of the Newton iterations from the solution increments of the
+     * last converged time steps.
+     */
+    enum class Predictor : unsigned int {
+        NONE = 0,
+        LINEAR,
+        QUADRATIC
+    };
+
 
     NewtonRaphsonSolver();
 
@@ -72,6 +107,9 @@ public:
 
     void reset() override;
 
+    /** Free the multi-vectors allocated by the solver in the mechanical objects. */
+    void cleanup() override;
+
 
     void solve (const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) override;
 
@@ -92,8 +130,89 @@ public:
 
     void set_pattern_analysis_strategy(const PatternAnalysisStrategy & strategy);
 
+    /**
+     * Number of times the mechanical graph accessor and the system buffers (matrix, solution and right-hand side
+     * vectors) were (re)created. They are kept between calls to solve and only rebuilt when the mechanical graph (the
+     * mechanical states, their sizes and topologies, and the mappings) or the linear solver changes.
+     */
+    auto number_of_system_setups() const -> unsigned int { return p_number_of_system_setups; }
+
+    /** Force the mechanical graph accessor and the system buffers to be rebuilt at the next call to solve. */
+    void invalidate_system_buffers() { p_accessor.reset(); }
+
+    /**
+     * Number of times the pattern of the system matrix was analyzed on the symbolic pattern derived from the
+     * connectivity of the Caribou forcefields and masses, concurrently with the assembly of the system matrix
+     * (see the symbolic_pattern_analysis attribute).
+     */
+    auto number_of_symbolic_pattern_analyses() const -> unsigned int { return p_number_of_symbolic_pattern_analyses; }
+
+    /**
+     * Number of times the symbolic pattern was derived from the connectivity of the Caribou forcefields and masses. It
+     * is cached between the time steps, and only rebuilt when the system buffers are recreated.
+     */
+    auto number_of_symbolic_pattern_builds() const -> unsigned int { return p_number_of_symbolic_pattern_builds; }
+
+    /**
+     * Number of Newton iterations that reused the factorization of the previous system matrix instead of assembling,
+     * analyzing and factorizing it again, since none of the components contributing to it changed (see the
+     * reuse_factorization attribute and system_matrix_revision).
+     */
+    auto number_of_reused_factorizations() const -> unsigned int { return p_number_of_reused_factorizations; }
+
+    /**
+     * True if the system vectors (right-hand side and solution) are currently views over the force and increment
+     * buffers of the mechanical object, hence they are not copied from and to the mechanical object at every Newton
+     * iteration. This is only possible when the current context contains a single (unmapped) mechanical object, when
+     * the linear solver uses Eigen dense vectors and when the static condensation is disabled.
+     */
+    auto system_vectors_are_mapped() const -> bool { return p_system_vectors_are_mapped; }
+
+    /** Get the current predictor used for the initial guess of the Newton iterations. */
+
+    auto predictor() const -> Predictor;
+
+    /** Set the current predictor used for the initial guess of the Newton iterations. */
+
+    void set_predictor(const Predictor & predictor);
+
 private:
 
+    /**
+     * Revision of the system matrix, i.e. the coefficients multiplying the mass, damping and stiffness matrices, and the
+     * revision of every source of change of the system matrix. Two revisions are compared entry by entry, and two equal
+     * revisions give the same system matrix.
+     */
+    struct SystemMatrixRevision {
+        /**
+         * Revision of a single source of change: the matrix revision of a forcefield or a mass (data is null), or the
+         * counter of one of the data of a projective constraint.
+         */
+        struct Entry {
+            const sofa::core::objectmodel::Base * component = nullptr;
+            const sofa::core::objectmodel::BaseData * data = nullptr;
+            std::size_t revision = 0;
+
+            bool operator==(const Entry & other) const {
+                return component == other.component and data == other.data and revision == other.revision;
+            }
+        };
+
+        std::array<SReal, 3> coefficients {};
+        std::vector<Entry> entries;
+
+        bool operator==(const SystemMatrixRevision & other) const {
+            return coefficients == other.coefficients and entries == other.entries;
+        }
+    };
+
+    /** Block of size x size coefficients coupling two nodes in the symbolic pattern, starting at (row, col). */
+    struct SymbolicPatternBlock {
+        sofa::Index row = 0;
+        sofa::Index col = 0;
+        sofa::Index size = 0;
+    };
+
     /**
      * Compute the right-hand side (RHS) of the equation to be solved.
      * It will be called by the Newton-Raphson solver just before starting the Newton iterations.
@@ -139,6 +258,13 @@ private:
                                         sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
                                         SofaCaribou::Algebra::BaseMatrix * A) = 0;
 
+    /**
+     * Get the factors (m, b, k) multiplying respectively the mass, damping and stiffness matrices in the system matrix
+     * built by assemble_system_matrix. Together with the revisions of the forcefields and masses, they are used to
+     * detect that the system matrix did not change since its last factorization.
+     */
+    virtual auto system_matrix_coefficients(const sofa::core::MechanicalParams & mechanical_parameters) const -> std::array<SReal, 3> = 0;
+
     /**
      * Propagate the newly solved increment vector.
      *
@@ -164,17 +290,136 @@ private:
                                               sofa::core::MultiVecDerivId & v_id,
                                               sofa::core::MultiVecDerivId & dx_id) = 0;
 
+    /**
+     * Gather the mechanical states and the mappings of the current context sub-graph, and compare them one by one with
+     * the ones of the last call: the same states with the same matrix sizes and topology revisions, and the same
+     * mappings. A mapped state resized, or a topology changed while keeping the global dimension of the system, is
+     * therefore detected.
+     * @return True if the mechanical graph changed since the last call.
+     */
+    bool mechanical_graph_changed();
+
+    /** True if the system vector v is a view over the buffer of the multi-vector id. */
+    bool is_mapped_over(const SofaCaribou::Algebra::BaseVector * v, const sofa::core::MultiVecDerivId & id);
+
+    /**
+     * Build the symbolic pattern of the system matrix from the connectivity of the Caribou forcefields and masses found
+     * in the current context. Every pair of nodes sharing an element couples all their degrees of freedom, which gives
+     * one block of the pattern.
+     *
+     * @return False if the pattern cannot be derived from the topologies (for example, when a forcefield is attached
+     *         to a mapped mechanical state).
+     */
+    bool build_symbolic_pattern(const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                                std::vector<SymbolicPatternBlock> & blocks) const;
+
+    /**
+     * Add the (zero) coefficients of the symbolic pattern blocks to the pattern matrix, and compress it. This is
+     * executed on the worker thread of the symbolic analysis, hence it only touches the given blocks and matrix.
+     */
+    static void fill_symbolic_pattern(const std::vector<SymbolicPatternBlock> & blocks,
+                                      SofaCaribou::Algebra::BaseMatrix * pattern);
+
+    /**
+     * True if the symbolic pattern p_pattern stores exactly the same coefficients as the assembled matrix A. Only then
+     * can the analysis of the symbolic pattern be used to factorize A.
+     */
+    bool symbolic_pattern_matches(const SofaCaribou::Algebra::BaseMatrix * A) const;
+
+    /**
+     * Gather the current revision of the system matrix. The tracked components are:
+     *   - HexahedronElasticForce and TetrahedronElasticForce, through their stiffness revision (incremented when
+     *     their stiffness matrices are recomputed, and at every force evaluation when they are corotated);
+     *   - CaribouMass (Hexahedron, Hexahedron20, Tetrahedron and Tetrahedron10), through their mass revision;
+     *   - TractionForcefield, which do not add any matrix to the system;
+     *   - the projective constraints, through the counter of each one of their data.
+     *
+     * @return False if any other forcefield or mass is found (including interaction forcefields), or if a forcefield is
+     *         attached to a mapped mechanical state. The system matrix must then be assembled at every Newton iteration.
+     */
+    bool system_matrix_revision(const sofa::core::MechanicalParams & mechanical_parameters,
+                                const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                                SystemMatrixRevision & revision) const;
+
+    /**
+     * Flag the degrees of freedom of the global system that can be eliminated by the static condensation, i.e. the
+     * edge-midpoint nodes of the quadratic CaribouTopology found in the current context.
+     */
+    auto condensable_dofs(const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor) -> std::vector<bool>;
+
+    /**
+     * Condense the assembled system matrix p_A into the Schur complement matrix p_S. The condensation pattern is
+     * (re)analyzed when the size of the system changes.
+     * @return False if the system matrix is not an Eigen sparse matrix, or if a condensed block is singular.
+     */
+    bool condense_system_matrix(const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                                const SofaCaribou::solver::LinearSolver * linear_solver);
+
+    /** Solve the condensed system using the current RHS p_F, and recover the complete solution into p_DX. */
+    bool solve_condensed_system(SofaCaribou::solver::LinearSolver * linear_solver);
+
+    /**
+     * Apply the increment predicted from the previous time steps, and keep it only if it reduces the residual.
+     * On return, p_F contains the residual at the (possibly predicted) initial guess.
+     * @return The squared norm of the residual at the initial guess.
+     */
+    auto apply_predictor(const sofa::core::MechanicalParams & mechanical_parameters,
+                         const sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
+                         sofa::core::MultiVecCoordId & x_id, sofa::core::MultiVecDerivId & v_id,
+                         sofa::core::MultiVecDerivId & f_id, sofa::core::MultiVecDerivId & dx_id,
+                         FLOATING_POINT_TYPE squared_residual) -> FLOATING_POINT_TYPE;
+
 protected:
+    /**
+     * Make sure the mechanical graph accessor (p_accessor) and the system buffers (p_A, p_DX and p_F) match the current
+     * mechanical graph. They are only (re)created when the mechanical graph (see mechanical_graph_changed) or the
+     * linear solver changed since the last call. This does not allocate when nothing changed.
+     */
+    void update_system_buffers(sofa::simulation::common::MechanicalOperations & mop,
+                               SofaCaribou::solver::LinearSolver * linear_solver);
+
+    /**
+     * Replace the system vectors p_F and p_DX by views over the force (f_id) and increment (dx_id) buffers of the
+     * mechanical object when it is possible (see system_vectors_are_mapped). Otherwise, make sure p_F and p_DX own their
+     * coefficients, which are then copied from and to the mechanical objects.
+     */
+    void update_system_vector_views(SofaCaribou::solver::LinearSolver * linear_solver,
+                                    const sofa::core::MultiVecDerivId & f_id, const sofa::core::MultiVecDerivId & dx_id,
+                                    bool static_condensation);
+
     /** Check that the linked linear solver is not null and that it implements the SofaCaribou::solver::LinearSolver interface */
 
     bool has_valid_linear_solver () const;
 
+    /**
+     * Copy the multi-vector id of the top level mechanical objects into the global system vector v. Nothing is copied
+     * when v is already a view over the buffer of the multi-vector (see system_vectors_are_mapped).
+     */
+    void copy_to_system_vector(const sofa::core::MechanicalParams & mechanical_parameters,
+                               const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
+                               const sofa::core::MultiVecDerivId & id,
+                               SofaCaribou::Algebra::BaseVector * v);
+
+    /**
+     * Copy the global system vector v into the multi-vector id of the top level mechanical objects. Nothing is copied
+     * when v is already a view over the buffer of the multi-vector (see system_vectors_are_mapped).
+     */
+    void copy_from_system_vector(const sofa::core::MechanicalParams & mechanical_parameters,
+                                 const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
+                                 const SofaCaribou::Algebra::BaseVector * v,
+                                 sofa::core::MultiVecDerivId & id);
+
     /// INPUTS
     Data<unsigned> d_newton_iterations;
     Data<double> d_correction_tolerance_threshold;
     Data<double> d_residual_tolerance_threshold;
     Data<double> d_absolute_residual_tolerance_threshold;
     Data<sofa::helper::OptionsGroup> d_pattern_analysis_strategy;
+    Data<bool> d_static_condensation;
+    Data<unsigned> d_condensation_patch_size;
+    Data<sofa::helper::OptionsGroup> d_predictor;
+    Data<bool> d_symbolic_pattern_analysis;
+    Data<bool> d_reuse_factorization;
 
     Link<sofa::core::behavior::LinearSolver> l_linear_solver;
 
@@ -184,6 +429,42 @@ protected:
 
     /// Private members
 
+    /// Mechanical graph accessor (top level mechanical states, mappings and their offsets in the global system)
+    std::unique_ptr<sofa::component::linearsolver::DefaultMultiMatrixAccessor> p_accessor;
+
+    /// Global dimension of the system when the accessor and the system buffers were created
+    std::size_t p_system_size = 0;
+
+    /// A mechanical state (with its matrix size and the revision of its topology) or a mapping of the mechanical graph
+    struct MechanicalGraphEntry {
+        const sofa::core::objectmodel::Base * component = nullptr;
+        std::size_t size = 0;
+        int topology_revision = 0;
+
+        bool operator==(const MechanicalGraphEntry & other) const {
+            return component == other.component and size == other.size and topology_revision == other.topology_revision;
+        }
+    };
+
+    /// Mechanical states and mappings of the mechanical graph at the last call to update_system_buffers
+    std::vector<MechanicalGraphEntry> p_mechanical_graph_signature;
+
+    /// Mechanical states and mappings found in the current context sub-graph (kept to reuse their capacity)
+    std::vector<sofa::core::behavior::BaseMechanicalState *> p_mechanical_states;
+    std::vector<sofa::core::BaseMapping *> p_mechanical_mappings;
+
+    /// Linear solver that created the system buffers
+    const SofaCaribou::solver::LinearSolver * p_system_buffers_owner = nullptr;
+
+    /// Number of times the accessor and the system buffers were (re)created
+    unsigned int p_number_of_system_setups = 0;
+
+    /// Whether or not the linear solver creates Eigen dense vectors, which can be mapped over the mechanical object
+    bool p_system_vectors_can_be_mapped = false;
+
+    /// Whether or not p_F and p_DX are views over the force and increment buffers of the mechanical object
+    bool p_system_vectors_are_mapped = false;
+
     /// Global system matrix A = mM + bB + kK
     std::unique_ptr<SofaCaribou::Algebra::BaseMatrix> p_A;
 
@@ -196,6 +477,17 @@ protected:
     /// Total displacement since the beginning of the step
     sofa::core::MultiVecDerivId p_U_id;
 
+    /// Total displacement since the beginning of the step, as a global system vector. It is updated in place with the
+    /// solution increment of every Newton iteration, and only copied back into p_U_id at the end of the step.
+    std::unique_ptr<SofaCaribou::Algebra::BaseVector> p_U;
+
+    /// Total displacements of the last two converged time steps (used by the predictor)
+    sofa::core::MultiVecDerivId p_previous_U_id;
+    sofa::core::MultiVecDerivId p_second_previous_U_id;
+
+    /// Number of valid previous total displacements (0, 1 or 2)
+    unsigned int p_number_of_previous_U = 0;
+
     /// List of times (in nanoseconds) took to compute each Newton-Raphson iteration
     std::vector<UNSIGNED_INTEGER_TYPE> p_times;
 
@@ -207,5 +499,49 @@ protected:
 
     /// Either or not the pattern of the system matrix was analyzed at the beginning of the simulation
     bool p_has_already_analyzed_the_pattern = false;
+
+    /// Symbolic pattern of the system matrix derived from the connectivity of the forcefields and masses. It is cached
+    /// until the system buffers are recreated, which happens when the structure of the mechanical graph changes.
+    std::vector<SymbolicPatternBlock> p_symbolic_pattern;
+
+    /// Whether or not p_symbolic_pattern was built for the current system buffers
+    bool p_symbolic_pattern_is_cached = false;
+
+    /// Pattern matrix filled and analyzed by the worker thread of the symbolic analysis
+    std::unique_ptr<SofaCaribou::Algebra::BaseMatrix> p_pattern;
+
+    /// False once the symbolic pattern did not match the assembled system matrix. It is then not built again until the
+    /// system buffers are recreated.
+    bool p_symbolic_pattern_is_complete = true;
+
+    /// Number of pattern analyses done on the symbolic pattern concurrently with the assembly
+    unsigned int p_number_of_symbolic_pattern_analyses = 0;
+
+    /// Number of times the symbolic pattern was built
+    unsigned int p_number_of_symbolic_pattern_builds = 0;
+
+    /// Revision of the system matrix currently factorized by the linear solver
+    SystemMatrixRevision p_factorized_revision;
+
+    /// Whether or not the current factorization can be reused when the system matrix revision did not change
+    bool p_factorization_is_reusable = false;
+
+    /// Number of Newton iterations that reused the current factorization
+    unsigned int p_number_of_reused_factorizations = 0;
+
+    /// Static condensation of the edge-midpoint nodes
+    SofaCaribou::Algebra::StaticCondensation p_condensation;
+
+    /// Either or not the condensation pattern must be analyzed at the next assembly
+    bool p_condensation_needs_analysis = true;
+
+    /// Condensed system matrix S = A_kk - A_kc A_cc^-1 A_ck
+    std::unique_ptr<SofaCaribou::Algebra::BaseMatrix> p_S;
+
+    /// Condensed system RHS vector
+    std::unique_ptr<SofaCaribou::Algebra::BaseVector> p_F_kept;
+
+    /// Condensed system LHS vector
+    std::unique_ptr<SofaCaribou::Algebra::BaseVector> p_DX_kept;
 };
 }
@@ -1,5 +1,6 @@
 #include <SofaCaribou/Ode/StaticODESolver.h>
 
+#include <SofaCaribou/Algebra/MappedMatrices.h>
 #include <SofaCaribou/Visitor/AssembleGlobalMatrix.h>
 #include <SofaCaribou/Visitor/ConstrainGlobalMatrix.h>
 
@@ -9,7 +10,11 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/core/behavior/ConstraintSolver.h>
 #include <sofa/helper/AdvancedTimer.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 210600)
+#include <sofa/helper/ScopedAdvancedTimer.h>
+#endif
 #include <sofa/simulation/MechanicalVisitor.h>
+#include <sofa/simulation/VectorOperations.h>
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 201299)
 #include <sofa/simulation/MechanicalMatrixVisitor.h>
 #else
@@ -24,18 +29,210 @@ using namespace sofa::simulation::mechanicalvisitor;
 #endif
 DISABLE_ALL_WARNINGS_END
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace SofaCaribou::ode {
 
 int StaticOdeSolverClass = sofa::core::RegisterObject("Static ODE Solver").add< StaticODESolver >();
 
 using namespace sofa::simulation;
+using sofa::core::MultiVecCoordId;
+using sofa::core::MultiVecDerivId;
 using Timer = sofa::helper::AdvancedTimer;
 
-// Assemble F in A [dx] = F
-void StaticODESolver::assemble_rhs_vector(const sofa::core::MechanicalParams &mechanical_parameters,
-                                          const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
-                                          sofa::core::MultiVecDerivId & f_id,
-                                          SofaCaribou::Algebra::BaseVector *f) {
+StaticODESolver::StaticODESolver()
+: d_adaptive_load_stepping(initData(&d_adaptive_load_stepping,
+    false,
+    "adaptive_load_stepping",
+    "Apply the load of each time step gradually using a global load factor. The size of the load increments grows "
+    "when the Newton iterations converge quickly, and is bisected (from the last converged state) when they diverge."))
+, d_initial_load_increment(initData(&d_initial_load_increment,
+    (double) 1,
+    "initial_load_increment",
+    "Size of the first load increment (between 0 and 1) when the adaptive load stepping is enabled. The following "
+    "time steps start with the last load increment size that converged."))
+, d_minimum_load_increment(initData(&d_minimum_load_increment,
+    (double) 1e-3,
+    "minimum_load_increment",
+    "Smallest load increment size allowed by the bisection. If the Newton iterations still diverge at this size, the "
+    "time step is stopped at the last converged load factor."))
+, d_target_newton_iterations(initData(&d_target_newton_iterations,
+    (unsigned) 4,
+    "target_newton_iterations",
+    "Desired number of Newton iterations per load increment. Load increments converging in fewer iterations are "
+    "followed by larger ones, and inversely."))
+, d_load_factor(initData(&d_load_factor,
+    (double) 1,
+    "load_factor",
+    "Load factor reached at the end of the last time step (1 if the complete load has been applied).",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+, d_number_of_load_increments(initData(&d_number_of_load_increments,
+    (unsigned) 0,
+    "number_of_load_increments",
+    "Number of converged load increments computed during the last time step.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+, d_number_of_bisections(initData(&d_number_of_bisections,
+    (unsigned) 0,
+    "number_of_bisections",
+    "Number of load increments that diverged and were bisected during the last time step.",
+    true /*is_displayed_in_gui*/, true /*is_read_only*/))
+{}
+
+void StaticODESolver::reset() {
+    NewtonRaphsonSolver::reset();
+    p_load_factor = 1;
+    p_next_load_increment = 0;
+    d_load_factor.setValue(1);
+    d_number_of_load_increments.setValue(0);
+    d_number_of_bisections.setValue(0);
+}
+
+void StaticODESolver::cleanup() {
+    sofa::core::MechanicalParams mechanical_parameters;
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+    vop.v_free(p_F0_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    vop.v_free(p_converged_x_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    NewtonRaphsonSolver::cleanup();
+}
+
+void StaticODESolver::solve(const sofa::core::ExecParams *params, SReal dt, MultiVecCoordId x_id, MultiVecDerivId v_id) {
+    if (d_adaptive_load_stepping.getValue()) {
+        solve_adaptive_load_increments(params, dt, x_id, v_id);
+    } else {
+        p_load_factor = 1;
+        NewtonRaphsonSolver::solve(params, dt, x_id, v_id);
+    }
+}
+
+void StaticODESolver::solve_adaptive_load_increments(const sofa::core::ExecParams *params, SReal dt,
+                                                     MultiVecCoordId x_id, MultiVecDerivId v_id) {
+    using namespace sofa::helper::logging;
+
+    if (not has_valid_linear_solver()) {
+        // Let the Newton-Raphson report the error
+        NewtonRaphsonSolver::solve(params, dt, x_id, v_id);
+        return;
+    }
+
+    sofa::helper::ScopedAdvancedTimer _t_ ("StaticODESolver::AdaptiveLoadStepping");
+
+    sofa::core::MechanicalParams mechanical_parameters (*params);
+    mechanical_parameters.setX(x_id);
+    mechanical_parameters.setV(v_id);
+    mechanical_parameters.setDt(dt);
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+
+    // Residual at the beginning of the time step, F(x_n) = P_n - R(x_n)
+    vop.v_realloc(p_F0_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+    MechanicalResetForceVisitor(&mechanical_parameters, p_F0_id, false /* onlyMapped */).execute(this->getContext());
+    MechanicalComputeForceVisitor(&mechanical_parameters, p_F0_id, true /* accumulate (to mapped node) */, true /*neglectingCompliance*/).execute(this->getContext());
+    MechanicalApplyConstraintsVisitor(&mechanical_parameters, p_F0_id, nullptr /*W*/).execute(this->getContext());
+
+    vop.v_realloc(p_converged_x_id, false /* interactionForceField */, true /* propagate [to mapped MO] */);
+
+    const auto minimum_increment = std::clamp<SReal>(d_minimum_load_increment.getValue(), std::numeric_limits<SReal>::epsilon(), 1);
+    const auto target_iterations = static_cast<SReal>(std::max(1u, d_target_newton_iterations.getValue()));
+    const auto print_log = f_printLog.getValue();
+
+    SReal lambda = 0;
+    SReal increment = (p_next_load_increment > 0) ? p_next_load_increment : d_initial_load_increment.getValue();
+    increment = std::clamp<SReal>(increment, minimum_increment, 1);
+
+    unsigned int number_of_increments = 0, number_of_bisections = 0;
+    bool converged = true;
+
+    while (lambda < 1) {
+        increment = std::min<SReal>(increment, 1 - lambda);
+        p_load_factor = lambda + increment;
+
+        // Save the last converged state
+        vop.v_eq(p_converged_x_id, x_id);
+
+        NewtonRaphsonSolver::solve(params, dt, x_id, v_id);
+
+        // With a single Newton iteration, the residual is not evaluated after the update and the correction ratio
+        // |du|/|U| is always one, hence the Newton-Raphson cannot report a convergence. Check the residual of the
+        // updated state against the one at the beginning of the increment instead.
+        if (not d_converged.getValue() and d_newton_iterations.getValue() == 1 and squared_residuals().size() == 1) {
+            d_converged.setValue(residual_has_converged(mechanical_parameters));
+        }
+
+        if (d_converged.getValue()) {
+            const auto iterations = static_cast<SReal>(std::max<std::size_t>(1, squared_residuals().size()));
+            lambda = p_load_factor;
+            ++number_of_increments;
+
+            if (print_log) {
+                msg_info() << "Load increment #" << number_of_increments << " converged in " << iterations
+                           << " Newton iterations (load factor = " << lambda << ")";
+            }
+
+            // Fast convergence (few Newton iterations) grows the next increment, slow convergence shrinks it
+            const SReal factor = std::clamp<SReal>(std::sqrt(target_iterations / iterations), 0.5, 2.);
+
+            // The last increment may have been truncated to reach a load factor of one, keep the largest size then
+            if (lambda < 1 or factor * increment > p_next_load_increment) {
+                p_next_load_increment = std::min<SReal>(1, factor * increment);
+            }
+            increment = p_next_load_increment;
+        } else {
+            // Restore the last converged state, and bisect the increment
+            vop.v_eq(x_id, p_converged_x_id);
+            MechanicalPropagateOnlyPositionAndVelocityVisitor(&mechanical_parameters).execute(this->getContext());
+
+            if (increment <= minimum_increment) {
+                msg_warning() << "The Newton iterations diverged with the minimum load increment of "
+                              << minimum_increment << ". The time step is stopped at the load factor " << lambda << ".";
+                converged = false;
+                break;
+            }
+
+            ++number_of_bisections;
+            increment = std::max(minimum_increment, increment / 2.);
+            p_next_load_increment = increment;
+
+            if (print_log) {
+                msg_info() << "Load increment diverged, bisecting it to " << increment;
+            }
+        }
+    }
+
+    p_load_factor = 1;
+    d_converged.setValue(converged);
+    d_load_factor.setValue(lambda);
+    d_number_of_load_increments.setValue(number_of_increments);
+    d_number_of_bisections.setValue(number_of_bisections);
+
+    Timer::valSet("nb_load_increments", number_of_increments);
+    Timer::valSet("nb_bisections", number_of_bisections);
+}
+
+bool StaticODESolver::residual_has_converged(const sofa::core::MechanicalParams & mechanical_parameters) {
+    auto f_id = MultiVecDerivId(sofa::core::VecDerivId::force());
+    compute_residual(mechanical_parameters, f_id);
+
+    sofa::simulation::common::VectorOperations vop( &mechanical_parameters, this->getContext() );
+    vop.v_dot(f_id, f_id);
+    const SReal R_squared_norm = vop.finish();
+    if (std::isnan(R_squared_norm)) {
+        return false;
+    }
+
+    const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
+    const auto & absolute_residual_tolerance_threshold = d_absolute_residual_tolerance_threshold.getValue();
+
+    return (
+        (residual_tolerance_threshold > 0 and
+         R_squared_norm < residual_tolerance_threshold*residual_tolerance_threshold*squared_initial_residual()) or
+        (absolute_residual_tolerance_threshold > 0 and
+         R_squared_norm < absolute_residual_tolerance_threshold*absolute_residual_tolerance_threshold)
+    );
+}
+
+void StaticODESolver::compute_residual(const sofa::core::MechanicalParams &mechanical_parameters,
+                                       sofa::core::MultiVecDerivId & f_id) {
     // 1. Clear the force vector (F := 0)
     MechanicalResetForceVisitor(&mechanical_parameters, f_id,
                                 false /* onlyMapped */)
@@ -53,9 +250,24 @@ void StaticODESolver::assemble_rhs_vector(const sofa::core::MechanicalParams &me
                                       nullptr /*W (also project the given compliance matrix) */)
     .execute(this->getContext());
 
+    // 3.b With the adaptive load stepping, only apply the fraction lambda of the load of the time step:
+    //     F := F - (1 - lambda) F_0, where F_0 is the residual at the beginning of the time step.
+    if (p_load_factor < 1) {
+        MechanicalVOpVisitor(&mechanical_parameters, f_id, f_id, p_F0_id, -(1 - p_load_factor)).execute(this->getContext());
+    }
+}
+
+// Assemble F in A [dx] = F
+void StaticODESolver::assemble_rhs_vector(const sofa::core::MechanicalParams &mechanical_parameters,
+                                          const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
+                                          sofa::core::MultiVecDerivId & f_id,
+                                          SofaCaribou::Algebra::BaseVector *f) {
+    // 1-3. Compute the residual F := P - R(x) of the current load increment
+    compute_residual(mechanical_parameters, f_id);
+
     // 4. Copy force vectors from every top level (unmapped) mechanical objects into the given system vector f
-    MechanicalMultiVectorToBaseVectorVisitor(&mechanical_parameters, f_id /* source */, f /* destination */, &matrix_accessor)
-    .execute(this->getContext());
+    //    (nothing is copied when f is a view over the force vector of a single mechanical object)
+    this->copy_to_system_vector(mechanical_parameters, matrix_accessor, f_id, f);
 }
 
 // Assemble A in A [dx] = F
@@ -70,7 +282,8 @@ void StaticODESolver::assemble_system_matrix(const sofa::core::MechanicalParams
     //         traversal stops in the subgraph of the mapping.
     matrix_accessor.setGlobalMatrix(A);
     sofa::core::MechanicalParams m_params (mechanical_parameters);
-    m_params.setKFactor(-1.0);
+    const auto coefficients = system_matrix_coefficients(mechanical_parameters);
+    m_params.setKFactor(coefficients[2]);
     Timer::stepBegin("AssembleGlobalMatrix");
     visitor::AssembleGlobalMatrix(&m_params, &matrix_accessor).execute(this->getContext());
     Timer::stepEnd("AssembleGlobalMatrix");
@@ -84,9 +297,10 @@ void StaticODESolver::assemble_system_matrix(const sofa::core::MechanicalParams
     //         contribution to the global system matrix with:
     //           [A]ij += Jt * [A']ij * J
     //         where A is the master mechanical object's matrix, A' is the slave mechanical object matrix and J=m.getJ()
-    //         is the mapping relation between the slave and its master.
+    //         is the mapping relation between the slave and its master. When J is given as a sparse matrix, the
+    //         product is computed with sparse matrix products instead of entry by entry.
     Timer::stepBegin("MappedMatrices");
-    matrix_accessor.computeGlobalMatrix();
+    SofaCaribou::Algebra::add_mapped_matrices(matrix_accessor, this->getContext());
     Timer::stepEnd("MappedMatrices");
 
     // Step 3. Convert the system matrix to a compressed sparse matrix
@@ -96,6 +310,11 @@ void StaticODESolver::assemble_system_matrix(const sofa::core::MechanicalParams
 
 }
 
+// A = -K (K is in fact -K by SOFA's convention)
+auto StaticODESolver::system_matrix_coefficients(const sofa::core::MechanicalParams & mechanical_parameters) const -> std::array<SReal, 3> {
+    return {mechanical_parameters.mFactor(), mechanical_parameters.bFactor(), -1.0};
+}
+
 // Propagate Dx that was previously solved in A [dx] = F
 void StaticODESolver::propagate_solution_increment(const sofa::core::MechanicalParams &mechanical_parameters,
                                                    const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
@@ -105,7 +324,8 @@ void StaticODESolver::propagate_solution_increment(const sofa::core::MechanicalP
                                                    sofa::core::MultiVecDerivId & dx_id) {
 
     // 1. Copy vectors from the global system vector into every top level (unmapped) mechanical objects.
-    MechanicalMultiVectorFromBaseVectorVisitor(&mechanical_parameters, dx_id, dx, &matrix_accessor).execute(this->getContext());
+    //    (nothing is copied when dx is a view over the increment vector of a single mechanical object)
+    this->copy_from_system_vector(mechanical_parameters, matrix_accessor, dx, dx_id);
 
     // 2. x += dx
     MechanicalVOpVisitor(&mechanical_parameters, x_id, x_id, dx_id).execute(this->getContext());
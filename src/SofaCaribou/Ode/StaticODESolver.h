@@ -36,6 +36,20 @@ namespace SofaCaribou::ode {
  *     \vect{x}_{n+1}^{i+1} &= \vect{x}_{n+1}^{i} + \Delta \vect{x}_{n+1}^{i+1}
  * \f}
  *
+ * When the adaptive load stepping is enabled, the load of the time step is applied gradually by scaling it with a
+ * global load factor \f$\lambda \in [0, 1]\f$. Since the external forces are not known separately from the internal
+ * ones, the residual of the time step is interpolated from the one at the beginning of the time step \f$\vect{x}_n\f$:
+ *
+ * \f{align*}{
+ *     \vect{F}_\lambda(\vect{x}_{n+1}) &= \vect{F}(\vect{x}_{n+1}) - (1 - \lambda) \vect{F}(\vect{x}_{n})
+ *                                   = \vect{R}(\vect{x}_{n+1}) - \left[ (1-\lambda) \vect{R}(\vect{x}_{n}) + \lambda \vect{P}_n \right]
+ * \f}
+ *
+ * such that \f$\vect{x}_{n}\f$ is the solution at \f$\lambda = 0\f$ (when it was at equilibrium) and the complete
+ * problem is recovered at \f$\lambda = 1\f$. The load increment \f$\Delta\lambda\f$ grows when the Newton iterations
+ * converge quickly, and is bisected when they diverge, in which case the positions are restored to the last converged
+ * load increment before retrying. When a single Newton iteration is allowed, the convergence of a load increment is
+ * checked on the residual of its updated positions.
  */
 class StaticODESolver : public NewtonRaphsonSolver {
 public:
@@ -44,6 +58,18 @@ public:
     template <typename T>
     using Data = sofa::core::objectmodel::Data<T>;
 
+    StaticODESolver();
+
+    void reset() override;
+
+    /** @see NewtonRaphsonSolver::cleanup */
+    void cleanup() override;
+
+    void solve (const sofa::core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id) override;
+
+    /** The load factor reached at the end of the last time step (1 if the complete load has been applied). */
+    auto load_factor() const -> SReal { return d_load_factor.getValue(); }
+
 protected:
 
     /** @see NewtonRaphsonSolver::assemble_rhs_vector */
@@ -57,6 +83,9 @@ protected:
                                 sofa::component::linearsolver::DefaultMultiMatrixAccessor & matrix_accessor,
                                 SofaCaribou::Algebra::BaseMatrix * A) final;
 
+    /** @see NewtonRaphsonSolver::system_matrix_coefficients */
+    auto system_matrix_coefficients(const sofa::core::MechanicalParams & mechanical_parameters) const -> std::array<SReal, 3> final;
+
     /** @see NewtonRaphsonSolver::propagate_solution_increment */
     void propagate_solution_increment(const sofa::core::MechanicalParams & mechanical_parameters,
                                       const sofa::core::behavior::MultiMatrixAccessor & matrix_accessor,
@@ -64,6 +93,52 @@ protected:
                                       sofa::core::MultiVecCoordId & x_id,
                                       sofa::core::MultiVecDerivId & v_id,
                                       sofa::core::MultiVecDerivId & dx_id) final;
+
+private:
+    /**
+     * Apply the load of the time step in a series of load increments of adaptive sizes. Each increment is solved by
+     * the Newton-Raphson iterations, and bisected on divergence.
+     */
+    void solve_adaptive_load_increments(const sofa::core::ExecParams* params, SReal dt,
+                                        sofa::core::MultiVecCoordId x_id, sofa::core::MultiVecDerivId v_id);
+
+    /**
+     * Compute the residual F := P - R(x) at the current positions into the multi-vector f_id, keeping only the
+     * fraction of the load given by the current load factor, and apply the projective constraints on it.
+     */
+    void compute_residual(const sofa::core::MechanicalParams & mechanical_parameters, sofa::core::MultiVecDerivId & f_id);
+
+    /**
+     * True if the residual at the current positions satisfies the residual (relative to the initial residual of the
+     * last call to solve) or the absolute residual convergence criterion. Used to check the convergence of a load
+     * increment solved with a single Newton iteration.
+     */
+    bool residual_has_converged(const sofa::core::MechanicalParams & mechanical_parameters);
+
+    /// INPUTS
+    Data<bool> d_adaptive_load_stepping;
+    Data<double> d_initial_load_increment;
+    Data<double> d_minimum_load_increment;
+    Data<unsigned> d_target_newton_iterations;
+
+    /// OUTPUTS
+    Data<double> d_load_factor;
+    Data<unsigned> d_number_of_load_increments;
+    Data<unsigned> d_number_of_bisections;
+
+    /// Private members
+
+    /// Multi-vector identifier of the residual at the beginning of the time step (lambda = 0)
+    sofa::core::MultiVecDerivId p_F0_id;
+
+    /// Multi-vector identifier of the positions at the last converged load increment
+    sofa::core::MultiVecCoordId p_converged_x_id;
+
+    /// Current load factor used in the assembly of the right-hand side. Equal to one when the load stepping is disabled.
+    SReal p_load_factor = 1;
+
+    /// Size of the next load increment, zero before the first time step
+    SReal p_next_load_increment = 0;
 };
 
 } // namespace SofaCaribou::ode
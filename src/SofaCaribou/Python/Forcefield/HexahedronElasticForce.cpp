@@ -27,7 +27,8 @@ void addHexahedronElasticForce(py::module &m) {
 
     py::class_<HexahedronElasticForce, sofa::core::objectmodel::BaseObject, sofapython3::py_shared_ptr<HexahedronElasticForce>> c(m, "HexahedronElasticForce");
     c.def("gauss_nodes_of", &HexahedronElasticForce::gauss_nodes_of, py::arg("hexahedron_id"), py::return_value_policy::reference_internal);
-    c.def("stiffness_matrix_of", &HexahedronElasticForce::stiffness_matrix_of, py::arg("hexahedron_id"), py::return_value_policy::reference_internal);
+    c.def("stiffness_matrix_of", &HexahedronElasticForce::stiffness_matrix_of, py::arg("hexahedron_id"));
+    c.def("number_of_stiffness_matrices", &HexahedronElasticForce::number_of_stiffness_matrices);
     c.def("K", &HexahedronElasticForce::K);
     c.def("cond", &HexahedronElasticForce::cond);
     c.def("eigenvalues", &HexahedronElasticForce::eigenvalues);
@@ -17,11 +17,17 @@ namespace SofaCaribou::solver::python {
         using SolverType = SofaCaribou::solver::LDLTSolver<EigenSolver>;
         py::class_<SolverType, sofa::core::objectmodel::BaseObject, sofapython3::py_shared_ptr<SolverType>> c(m, "LDLTSolver");
 
-        c.def("A", [](const SolverType & solver){return solver.A()->matrix();});
+        c.def("A", [](const SolverType & solver) -> typename SolverType::Matrix {
+            // Always return the complete matrix, even when only its upper triangular part is stored
+            if (solver.A()->symmetric_storage()) {
+                return solver.A()->matrix().template selfadjointView<Eigen::Upper>();
+            }
+            return solver.A()->matrix();
+        });
 
-        c.def("x", [](const SolverType & solver){return solver.x()->vector();});
+        c.def("x", [](const SolverType & solver){return SolverType::Vector(solver.x_view());});
 
-        c.def("b", [](const SolverType & solver){return solver.b()->vector();});
+        c.def("b", [](const SolverType & solver){return SolverType::Vector(solver.b_view());});
 
 
         c.def("assemble", [](SolverType & solver, double m, double b, double k) {
@@ -19,9 +19,9 @@ namespace SofaCaribou::solver::python {
 
         c.def("A", [](const SolverType & solver){return solver.A()->matrix();});
 
-        c.def("x", [](const SolverType & solver){return solver.x()->vector();});
+        c.def("x", [](const SolverType & solver){return SolverType::Vector(solver.x_view());});
 
-        c.def("b", [](const SolverType & solver){return solver.b()->vector();});
+        c.def("b", [](const SolverType & solver){return SolverType::Vector(solver.b_view());});
 
         c.def("assemble", [](SolverType & solver, double m, double b, double k) {
             sofa::core::MechanicalParams mparams;
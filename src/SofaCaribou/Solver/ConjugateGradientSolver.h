@@ -10,6 +10,7 @@ DISABLE_ALL_WARNINGS_BEGIN
 DISABLE_ALL_WARNINGS_END
 
 #include <Eigen/Core>
+#include <Eigen/Dense>
 #include <Eigen/IterativeLinearSolvers>
 
 namespace SofaCaribou::solver {
@@ -32,6 +33,14 @@ using namespace sofa::core::behavior;
  * to factorize it. In this case, the complete system matrix A and dense vector b are first
  * accumulated from the mechanical objects of the current scene context graph. Once the dense
  * vector x is found, it is propagated back to the mechanical object's vectors.
+ *
+ * When the system is assembled, the CG can be deflated by a small subspace W of approximate eigenvectors
+ * associated to the lowest eigenvalues of A (see deflation_subspace_size). These vectors are harvested with a
+ * Rayleigh-Ritz procedure from the search directions of a previous solve, and recycled for the subsequent solves.
+ * The initial guess is corrected by x0 = x + W (W^T A W)^-1 W^T r0, and every search direction is kept A-orthogonal
+ * to W, which removes the slow converging modes from the Krylov space. See:
+ *   Y. Saad, M. Yeung, J. Erhel and F. Guyomarc'h, A deflated version of the conjugate gradient algorithm (2000),
+ *   DOI: 10.1137/S1064829598339761
  */
 template <class EigenMatrix_t>
 class ConjugateGradientSolver : public EigenSolver<EigenMatrix_t> {
@@ -62,6 +71,18 @@ public:
         IncompleteLU = 5
     };
 
+    /// Strategies determining when the deflation subspace is harvested again from the last CG search directions
+    enum class DeflationRefreshStrategy : unsigned int {
+        /// The subspace is harvested once (first solve) and recycled for every subsequent solves.
+        NEVER = 0,
+
+        /// The subspace is harvested again at the first solve following a new factorization of the system matrix.
+        EVERY_FACTORIZATION = 1,
+
+        /// The subspace is harvested again at the end of every solve.
+        EVERY_SOLVE = 2
+    };
+
     /**
      * Set the linear system matrix A = (mM + bB + kK), storing the coefficients m, b and k of
      * the mechanical M,B,K matrices.
@@ -128,6 +149,31 @@ public:
         return p_squared_initial_residual;
     }
 
+    /**
+     * The current deflation subspace W (n x k) of approximate eigenvectors of A, where k is lower or equal to
+     * the deflation_subspace_size data attribute. This matrix is empty if the deflation is disabled or if no
+     * vectors have been harvested yet.
+     */
+    auto deflation_subspace() const -> const Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic> & {
+        return p_W;
+    }
+
+    /**
+     * Replace the deflation subspace W (n x k) by a known one, for example the rigid body modes of the system. It is
+     * used from the next solve, as long as the deflation is enabled (deflation_subspace_size > 0), and is kept until it
+     * is harvested again (see deflation_refresh_strategy, use NEVER to keep it).
+     */
+    void set_deflation_subspace(const Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic> & W) {
+        p_W = W;
+        p_deflation_subspace_needs_refresh = false;
+    }
+
+    /** Get the current strategy that determine when the deflation subspace is harvested again. */
+    auto deflation_refresh_strategy() const -> DeflationRefreshStrategy;
+
+    /** Set the current strategy that determine when the deflation subspace is harvested again. */
+    void set_deflation_refresh_strategy(const DeflationRefreshStrategy & strategy);
+
     template<typename Derived>
     static auto canCreate(Derived*, sofa::core::objectmodel::BaseContext*, sofa::core::objectmodel::BaseObjectDescription*) -> bool {
         return true;
@@ -150,6 +196,19 @@ protected:
      */
     void solve(sofa::core::behavior::MultiVecDeriv & b, sofa::core::behavior::MultiVecDeriv & x);
 
+    /**
+     * Solve the linear system Ax = b using Sofa's graph scene, but running the CG recurrences on flat vectors.
+     *
+     * The degrees of freedom of the top level mechanical objects are gathered once into contiguous vectors, and every
+     * dot products and vector updates of the CG iterations are done on these vectors. Only the matrix-vector product
+     * Ap (addMBKdx followed by projectResponse) goes down in the subgraph of the current context. When the context
+     * contains a single mechanical object, the contiguous vectors are directly its buffers and nothing is copied.
+     *
+     * @param b The right-hand side vector of the system
+     * @param x The solution vector of the system. It should be filled with an initial guess or the previous solution.
+     */
+    void solve_flat(sofa::core::behavior::MultiVecDeriv & b, sofa::core::behavior::MultiVecDeriv & x);
+
     /** @see LinearSolver::analyze_pattern */
     
     bool analyze_pattern() override;
@@ -175,13 +234,23 @@ protected:
      * @return True if the CG converged, false otherwise.
      */
     template <typename Preconditioner>
-    bool solve(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x);
+    bool solve(const Preconditioner & precond, const Matrix & A, const Eigen::Ref<const Vector> & b, Eigen::Ref<Vector> x);
+
+    /**
+     * Harvest a new deflation subspace from the current one and the given search directions P using a
+     * Rayleigh-Ritz procedure: the approximate eigenvectors of A associated to its lowest eigenvalues
+     * are extracted from the space spanned by [W P].
+     */
+    void harvest_deflation_subspace(const Matrix & A, const Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic> & P);
 
     /// INPUTS
     Data<bool> d_verbose;
     Data<unsigned int> d_maximum_number_of_iterations;
     Data<FLOATING_POINT_TYPE> d_residual_tolerance_threshold;
     Data< sofa::helper::OptionsGroup > d_preconditioning_method;
+    Data<unsigned int> d_deflation_subspace_size;
+    Data< sofa::helper::OptionsGroup > d_deflation_refresh_strategy;
+    Data<bool> d_flat_vectors;
 
 private:
     /// Private methods
@@ -222,6 +291,16 @@ private:
 
     ///< Squared residual norm (||r||^2) of the last right-hand side term (b in Ax=b) of the last solve call.
     FLOATING_POINT_TYPE p_squared_initial_residual;
+
+    ///< Deflation subspace (n x k) of approximate eigenvectors recycled between solves.
+    Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic> p_W;
+
+    ///< Whether or not the deflation subspace should be harvested again at the end of the next solve.
+    bool p_deflation_subspace_needs_refresh = true;
+
+    ///< Storage of the flat x, b, r, p and q vectors of the matrix-free CG (see solve_flat). The x, b, p and q vectors
+    ///< are only used when they cannot be mapped over the buffers of a single mechanical object.
+    Vector p_flat_x, p_flat_b, p_flat_r, p_flat_p, p_flat_q;
 };
 
 extern template class ConjugateGradientSolver<Eigen::SparseMatrix<FLOATING_POINT_TYPE, Eigen::RowMajor, int>>;
@@ -3,6 +3,7 @@
 #include<SofaCaribou/Algebra/EigenMatrix.h>
 #include <SofaCaribou/Visitor/AssembleGlobalMatrix.h>
 #include <SofaCaribou/Visitor/ConstrainGlobalMatrix.h>
+#include <SofaCaribou/Algebra/MechanicalStateBuffer.h>
 #include <Caribou/macros.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
@@ -60,6 +61,25 @@ ConjugateGradientSolver<EigenMatrix_t>::ConjugateGradientSolver()
             IncompleteLU:        Preconditioning based on the incomplete LU factorization.
     )",
     true /*displayed_in_GUI*/, false /*read_only_in_GUI*/))
+, d_deflation_subspace_size(initData(&d_deflation_subspace_size,
+    (unsigned int) 0,
+    "deflation_subspace_size",
+    "Number of approximate eigenvectors, associated to the lowest eigenvalues of the system matrix, kept between "
+    "solves to deflate the CG iterations. These vectors are harvested from the search directions of previous solves. "
+    "This only applies when a preconditioning method other than None is used (the system matrix must be assembled). "
+    "Use 0 to disable the deflation (default)."))
+, d_deflation_refresh_strategy(initData(&d_deflation_refresh_strategy,
+    "deflation_refresh_strategy",
+    "Define when the deflation subspace should be harvested again from the CG search directions. "
+    "NEVER: the subspace is harvested at the first solve only and is recycled afterward. "
+    "EVERY_FACTORIZATION: the subspace is harvested again at the first solve following a new factorization of the "
+    "system matrix (default). EVERY_SOLVE: the subspace is harvested again at the end of every solve."))
+, d_flat_vectors(initData(&d_flat_vectors,
+    false,
+    "flat_vectors",
+    "When no preconditioning method is used, gather the degrees of freedom of the top level mechanical objects once "
+    "into contiguous vectors and run the CG iterations on them. Only the matrix-vector product goes through the scene "
+    "graph, instead of every dot products and vector updates."))
 {
     // Explicitly state the available preconditioning methods
     p_preconditioners.emplace_back("None", PreconditioningMethod::None);
@@ -79,6 +99,13 @@ ConjugateGradientSolver<EigenMatrix_t>::ConjugateGradientSolver()
     d_preconditioning_method.setValue(sofa::helper::OptionsGroup(preconditioner_names));
     sofa::helper::WriteAccessor<Data< sofa::helper::OptionsGroup >> preconditioning_method = d_preconditioning_method;
     preconditioning_method->setSelectedItem((unsigned int) 1);
+
+    d_deflation_refresh_strategy.setValue(sofa::helper::OptionsGroup(std::vector < std::string > {
+        "NEVER", "EVERY_FACTORIZATION", "EVERY_SOLVE"
+    }));
+
+    // Select the default value
+    set_deflation_refresh_strategy(DeflationRefreshStrategy::EVERY_FACTORIZATION);
 }
 
 template <class EigenMatrix_t>
@@ -166,7 +193,11 @@ void ConjugateGradientSolver<EigenMatrix_t>::solveSystem() {
         MultiVecDeriv b(&vop, p_b_id);
 
         // Solve without having assembled the global matrix A (not needed since no preconditioning)
-        solve(b, x);
+        if (d_flat_vectors.getValue()) {
+            solve_flat(b, x);
+        } else {
+            solve(b, x);
+        }
     } else {
         // Solve using a preconditioning method. Here the global matrix A and the vectors x and b have been assembled.
         Base::solveSystem();
@@ -298,13 +329,207 @@ void ConjugateGradientSolver<EigenMatrix_t>::solve(sofa::core::behavior::MultiVe
     sofa::helper::AdvancedTimer::valSet("nb_iterations", static_cast<float>(iteration_number+1));
 }
 
+template <class EigenMatrix_t>
+void ConjugateGradientSolver<EigenMatrix_t>::solve_flat(sofa::core::behavior::MultiVecDeriv & b_id, sofa::core::behavior::MultiVecDeriv & x_id) {
+    using MappedVector = Eigen::Map<Vector>;
+    sofa::simulation::common::VectorOperations vop( &p_mechanical_params, this->getContext() );
+    sofa::simulation::common::MechanicalOperations mop( &p_mechanical_params, this->getContext() );
+
+    // Create temporary vectors needed for the matrix-vector product q = A*p, which goes through the scene graph
+    sofa::core::behavior::MultiVecDeriv p_id(&vop);
+    sofa::core::behavior::MultiVecDeriv q_id(&vop);
+
+    // Get the method parameters
+    const auto & maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
+    const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
+    const auto & verbose = d_verbose.getValue();
+
+    p_squared_residuals.clear();
+    p_squared_residuals.reserve(maximum_number_of_iterations);
+
+    // Get the matrices coefficient m, b and k : A = (mM + bB + kK)
+    const auto  m_coef = p_mechanical_params.mFactor();
+    const auto  b_coef = p_mechanical_params.bFactor();
+    const auto  k_coef = p_mechanical_params.kFactor();
+
+    // Gather the top level mechanical objects and the offsets of their degrees of freedom in the flat vectors
+    sofa::component::linearsolver::DefaultMultiMatrixAccessor accessor;
+    mop.getMatrixDimension(nullptr, nullptr, &accessor);
+    accessor.setupMatrices();
+    const auto n = static_cast<Eigen::Index>(accessor.getGlobalDimension());
+
+    // Flat vector of a multi-vector: either directly the buffer of the single mechanical object, or the given storage
+    const auto flat_vector = [this, n](const sofa::core::MultiVecDerivId & id, Vector & storage) {
+        const auto buffer = SofaCaribou::Algebra::mechanical_state_buffer(this->getContext(), id);
+        if (buffer.first and static_cast<Eigen::Index>(buffer.second) == n) {
+            return std::make_pair(MappedVector(buffer.first, n), true);
+        }
+        storage.resize(n);
+        return std::make_pair(MappedVector(storage.data(), n), false);
+    };
+
+    const auto gather = [&mop, &accessor](const sofa::core::MultiVecDerivId & id, MappedVector & v) {
+        SofaCaribou::Algebra::EigenVector<MappedVector> vector(v);
+        mop.multiVector2BaseVector(id, &vector, &accessor);
+    };
+
+    const auto scatter = [&mop, &accessor](MappedVector & v, const sofa::core::MultiVecDerivId & id) {
+        SofaCaribou::Algebra::EigenVector<MappedVector> vector(v);
+        mop.baseVector2MultiVector(&vector, id, &accessor);
+    };
+
+    auto x_flat = flat_vector(x_id.id(), p_flat_x);
+    auto b_flat = flat_vector(b_id.id(), p_flat_b);
+    auto p_flat = flat_vector(p_id.id(), p_flat_p);
+    auto q_flat = flat_vector(q_id.id(), p_flat_q);
+    auto & x = x_flat.first;
+    auto & b = b_flat.first;
+    auto & p = p_flat.first;
+    auto & q = q_flat.first;
+    const bool x_is_mapped = x_flat.second;
+    const bool p_is_mapped = p_flat.second;
+    const bool q_is_mapped = q_flat.second;
+    p_flat_r.resize(n);
+    auto & r = p_flat_r;
+
+    if (not x_is_mapped) {
+        gather(x_id.id(), x);
+    }
+
+    if (not b_flat.second) {
+        gather(b_id.id(), b);
+    }
+
+    // Computes q = A*v with visitors since we did not construct the matrix A. This is the only operation of the
+    // iterations that goes through the scene graph.
+    const auto multiply = [&](sofa::core::behavior::MultiVecDeriv & v_id) {
+        mop.propagateDxAndResetDf(v_id, q_id); // Set q = 0 and calls applyJ(v) on every mechanical mappings
+        mop.addMBKdx(q_id, m_coef, b_coef, k_coef, false); // q = (m M + b B + k K) v
+
+        // We need to project the result in the constrained space since the constraints haven't been added to the
+        // matrix (the matrix is never constructed) and addMBKdx of the forcefields do not take constraints into account.
+        mop.projectResponse(q_id); // BaseProjectiveConstraintSet::projectResponse(q)
+
+        if (not q_is_mapped) {
+            gather(q_id.id(), q);
+        }
+    };
+
+    // Declare the method variables
+    FLOATING_POINT_TYPE b_norm_2 = 0., r_norm_2 = 0.; // RHS and residual squared norms
+    FLOATING_POINT_TYPE rho0, rho1 = 0.; // Stores r*r as it is used two times per iterations
+    FLOATING_POINT_TYPE alpha, beta; // Alpha and Beta coefficients
+    FLOATING_POINT_TYPE threshold; // Residual threshold
+    UNSIGNED_INTEGER_TYPE iteration_number = 0; // Current iteration number
+    bool converged = false;
+    const auto zero = (std::numeric_limits<FLOATING_POINT_TYPE>::min)(); // A numerical floating point zero
+
+    // Make sure that the right hand side isn't zero
+    b_norm_2 = b.squaredNorm();
+    p_squared_initial_residual = b_norm_2;
+    if (b_norm_2 < EPSILON) {
+        msg_info() << "Right-hand side of the system is zero, hence x = 0.";
+        x.setZero();
+        goto end; // The goto is important to catch the last timer call before ending the function
+    }
+
+    // Compute the tolerance w.r.t |b| since |r|/|b| < threshold is equivalent to  r^2 < b^2 * threshold^2
+    // threshold = b^2 * residual_tolerance_threshold^2
+    threshold = std::max(residual_tolerance_threshold*residual_tolerance_threshold*b_norm_2, zero);
+
+    // INITIAL RESIDUAL r = b - A*x (the x multi-vector already holds the initial guess)
+    multiply(x_id);
+    r.noalias() = b - q;
+
+    // Check for initial convergence: |r0|/|b| < threshold
+    r_norm_2 = r.squaredNorm();
+    if (r_norm_2 < threshold) {
+        msg_info() << "The linear system has already reached an equilibrium state";
+        msg_info() << "|r|/|b| = " << sqrt(r_norm_2/b_norm_2) << ", threshold = " << residual_tolerance_threshold;
+        goto end; // The goto is important to catch the last timer call before ending the function
+    }
+
+    // Compute the initial search direction
+    rho0 = r_norm_2;
+    p = r; // p(0) = r(0)
+
+    // ITERATIONS
+    while (not converged and iteration_number < maximum_number_of_iterations) {
+        Timer::stepBegin("cg_iteration");
+        // 1. Computes q(k+1) = A*p(k)
+        if (not p_is_mapped) {
+            scatter(p, p_id.id());
+        }
+        multiply(p_id);
+
+        // 2. Computes x(k+1), r(k+1) and the new residual norm in a single pass over the vectors
+        alpha = rho0 / p.dot(q);
+        r_norm_2 = 0.;
+        {
+            auto * x_data = x.data();
+            auto * r_data = r.data();
+            const auto * p_data = p.data();
+            const auto * q_data = q.data();
+            #pragma omp simd reduction(+:r_norm_2)
+            for (Eigen::Index i = 0; i < n; ++i) {
+                x_data[i] += alpha*p_data[i]; // x = x + alpha*p
+                r_data[i] -= alpha*q_data[i]; // r = r - alpha*q
+                r_norm_2 += r_data[i]*r_data[i];
+            }
+        }
+        p_squared_residuals.emplace_back(r_norm_2);
+
+        // 3. Print information on the current iteration
+        msg_info_when(verbose) << "CG iteration #" << iteration_number+1
+                               << ": |r|/|b| = "   << sqrt(r_norm_2/b_norm_2)
+                               << "(threshold is " << residual_tolerance_threshold << ")";
+
+        // 4. Check for convergence: |r|/|b| < threshold
+        if (r_norm_2 < threshold) {
+            converged = true;
+        } else {
+            // 5. Compute the next search direction
+            rho1 = r_norm_2;
+            beta = rho1 / rho0;
+            p = r + beta*p; // p = r + beta*p
+
+            rho0 = rho1;
+        }
+
+        ++iteration_number;
+        Timer::stepEnd("cg_iteration");
+    }
+
+    iteration_number--; // Reset to the actual index of the last iteration completed
+
+    if (converged) {
+        msg_info() << "CG converged in " << (iteration_number+1)
+                   << " iterations with a residual of |r|/|b| = " << sqrt(r_norm_2/b_norm_2)
+                   << " (threshold was " << residual_tolerance_threshold << ")";
+    } else {
+        msg_info() << "CG diverged with a residual of |r|/|b| = " << sqrt(r_norm_2/b_norm_2)
+                   << " (threshold was " << residual_tolerance_threshold << ")";
+    }
+
+    end:
+    // Copy the solution back into the mechanical objects
+    if (not x_is_mapped) {
+        scatter(x, x_id.id());
+    }
+
+    sofa::helper::AdvancedTimer::valSet("nb_iterations", static_cast<float>(iteration_number+1));
+}
+
 template <class EigenMatrix_t>
 template <typename Preconditioner>
-bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precond, const Matrix & A, const Vector & b, Vector & x) {
+bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precond, const Matrix & A, const Eigen::Ref<const Vector> & b, Eigen::Ref<Vector> x) {
+    using DenseMatrix = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic>;
+
     // Get the method parameters
     const auto & maximum_number_of_iterations = d_maximum_number_of_iterations.getValue();
     const auto & residual_tolerance_threshold = d_residual_tolerance_threshold.getValue();
     const auto & verbose = d_verbose.getValue();
+    const auto & deflation_subspace_size = d_deflation_subspace_size.getValue();
 
     p_squared_residuals.clear();
     p_squared_residuals.reserve(maximum_number_of_iterations);
@@ -321,6 +546,40 @@ bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precon
     Vector r(n), q(n); // Residual
     const auto zero = (std::numeric_limits<FLOATING_POINT_TYPE>::min)(); // A numerical floating point zero
 
+    // Deflation variables
+    DenseMatrix AW; // A*W
+    Eigen::LLT<DenseMatrix> E; // Factorization of the k x k matrix W^T A W
+    DenseMatrix P; // Search directions harvested during this solve
+    Eigen::Index number_of_harvested_directions = 0;
+    bool deflated = false;
+    bool harvest = false;
+
+    if (deflation_subspace_size > 0) {
+        // Drop the recycled subspace if the size of the system changed (for example, after a topological change)
+        if (p_W.rows() != A.rows()) {
+            p_W.resize(0, 0);
+        }
+
+        if (p_W.cols() > 0) {
+            sofa::helper::ScopedAdvancedTimer _t_("ConjugateGradient::deflation");
+            AW.noalias() = A * p_W;
+            E.compute(p_W.transpose() * AW);
+            deflated = (E.info() == Eigen::Success);
+            msg_warning_when(not deflated) << "The deflation subspace is not positive definite w.r.t. the system matrix "
+                                              "and will be harvested again.";
+        }
+
+        const auto strategy = deflation_refresh_strategy();
+        harvest = (not deflated) or
+                  (strategy == DeflationRefreshStrategy::EVERY_SOLVE) or
+                  (strategy == DeflationRefreshStrategy::EVERY_FACTORIZATION and p_deflation_subspace_needs_refresh);
+        if (harvest) {
+            P.resize(n, 2*deflation_subspace_size);
+        }
+    } else if (p_W.size() > 0) {
+        p_W.resize(0, 0);
+    }
+
     // Make sure that the right hand side isn't zero
     b_norm_2 = b.squaredNorm();
     p_squared_initial_residual = b_norm_2;
@@ -337,6 +596,13 @@ bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precon
     // INITIAL RESIDUAL
     r.noalias() = b - A*x;
 
+    // Project the initial guess onto the deflation subspace: x0 = x + W (W^T A W)^-1 W^T r, r0 = r - AW (W^T A W)^-1 W^T r
+    if (deflated) {
+        const Vector mu = E.solve(p_W.transpose() * r);
+        x.noalias() += p_W * mu;
+        r.noalias() -= AW * mu;
+    }
+
     // Check for initial convergence
     r_norm_2 = r.squaredNorm();
     if (r_norm_2 < threshold) {
@@ -346,8 +612,12 @@ bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precon
     }
 
     // Compute the initial search direction
-    p = precond.solve(r);
-    rho0 = r.dot(p); // |M-1 * r|^2
+    z = precond.solve(r);
+    rho0 = r.dot(z); // |M-1 * r|^2
+    p = z;
+    if (deflated) {
+        p.noalias() -= p_W * E.solve(AW.transpose() * z); // p(0) = z(0) - W (W^T A W)^-1 (AW)^T z(0)
+    }
 
     // ITERATIONS
     while (not converged and iteration_number < maximum_number_of_iterations) {
@@ -355,6 +625,11 @@ bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precon
         // 1. Computes q(k+1) = A*p(k)
         q.noalias() = A * p;
 
+        // Keep the search direction for the harvesting of the next deflation subspace
+        if (harvest and number_of_harvested_directions < P.cols()) {
+            P.col(number_of_harvested_directions++) = p;
+        }
+
         // 2. Computes x(k+1) and r(k+1)
         alpha = rho0 / p.dot(q); // the amount we travel on the search direction
         x += alpha * p; // Updated solution x(k+1)
@@ -379,6 +654,11 @@ bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precon
             beta = rho1 / rho0;
             p = z + beta*p;
 
+            // Keep the search direction A-orthogonal to the deflation subspace
+            if (deflated) {
+                p.noalias() -= p_W * E.solve(AW.transpose() * z);
+            }
+
             rho0 = rho1;
         }
 
@@ -397,11 +677,53 @@ bool ConjugateGradientSolver<EigenMatrix_t>::solve(const Preconditioner & precon
                    << " (threshold was " << residual_tolerance_threshold << ")";
     }
 
+    if (harvest and number_of_harvested_directions > 0) {
+        harvest_deflation_subspace(A, P.leftCols(number_of_harvested_directions));
+    }
+
     end:
     sofa::helper::AdvancedTimer::valSet("nb_iterations", static_cast<float>(iteration_number+1));
     return converged;
 }
 
+template <class EigenMatrix_t>
+void ConjugateGradientSolver<EigenMatrix_t>::harvest_deflation_subspace(const Matrix & A, const Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic> & P) {
+    using DenseMatrix = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic>;
+    sofa::helper::ScopedAdvancedTimer _t_("ConjugateGradient::harvest_deflation_subspace");
+
+    const auto k = static_cast<Eigen::Index>(d_deflation_subspace_size.getValue());
+
+    // Basis Z = [W P] of the search space
+    DenseMatrix Z (P.rows(), p_W.cols() + P.cols());
+    if (p_W.cols() > 0) {
+        Z.leftCols(p_W.cols()) = p_W;
+    }
+    Z.rightCols(P.cols()) = P;
+
+    // Orthonormalize the basis, dropping the directions that are (numerically) linearly dependent
+    Eigen::ColPivHouseholderQR<DenseMatrix> qr(Z);
+    const auto rank = qr.rank();
+    if (rank == 0) {
+        return;
+    }
+    const DenseMatrix Q = qr.householderQ() * DenseMatrix::Identity(Z.rows(), rank);
+
+    // Rayleigh-Ritz: the eigenpairs of the small matrix Q^T A Q gives approximate eigenpairs of A
+    const DenseMatrix H = Q.transpose() * (A * Q);
+    Eigen::SelfAdjointEigenSolver<DenseMatrix> eigen_solver(H);
+    if (eigen_solver.info() != Eigen::Success) {
+        msg_warning() << "Failed to compute the Ritz vectors of the deflation subspace.";
+        return;
+    }
+
+    // Eigen values are sorted in increasing order
+    p_W.noalias() = Q * eigen_solver.eigenvectors().leftCols(std::min(k, rank));
+    p_deflation_subspace_needs_refresh = false;
+
+    msg_info() << "Harvested a deflation subspace of " << p_W.cols() << " vectors with Ritz values in ["
+               << eigen_solver.eigenvalues()[0] << ", " << eigen_solver.eigenvalues()[p_W.cols()-1] << "]";
+}
+
 template <class EigenMatrix_t>
 bool ConjugateGradientSolver<EigenMatrix_t>::analyze_pattern() {
     auto A_ = this->A();
@@ -459,13 +781,16 @@ bool ConjugateGradientSolver<EigenMatrix_t>::factorize() {
         success = p_iLU.info() == Eigen::Success;
     }
 
+    // The system matrix changed, the deflation subspace might need to be harvested again
+    p_deflation_subspace_needs_refresh = true;
+
     return success;
 }
 
 template <class EigenMatrix_t>
 bool ConjugateGradientSolver<EigenMatrix_t>::solve(const SofaCaribou::Algebra::BaseVector * F_, SofaCaribou::Algebra::BaseVector *X_) {
-    const auto & F = dynamic_cast<const SofaCaribou::Algebra::EigenVector<Vector> *>(F_)->vector();
-    auto & X = dynamic_cast<SofaCaribou::Algebra::EigenVector<Vector> *>(X_)->vector();
+    const auto F = SofaCaribou::Algebra::eigen_vector_map<Vector>(F_);
+    auto X = SofaCaribou::Algebra::eigen_vector_map<Vector>(X_);
     const PreconditioningMethod preconditioning_method = get_preconditioning_method_from_string(d_preconditioning_method.getValue().getSelectedItem());
 
     bool converged = true;
@@ -485,4 +810,25 @@ bool ConjugateGradientSolver<EigenMatrix_t>::solve(const SofaCaribou::Algebra::B
     return converged;
 }
 
+template <class EigenMatrix_t>
+auto ConjugateGradientSolver<EigenMatrix_t>::deflation_refresh_strategy() const -> DeflationRefreshStrategy {
+    const auto v = static_cast<DeflationRefreshStrategy>(d_deflation_refresh_strategy.getValue().getSelectedId());
+    switch (v) {
+        case DeflationRefreshStrategy::NEVER:
+        case DeflationRefreshStrategy::EVERY_FACTORIZATION:
+        case DeflationRefreshStrategy::EVERY_SOLVE:
+            return v;
+    }
+
+    // Default value
+    return DeflationRefreshStrategy::EVERY_FACTORIZATION;
+}
+
+template <class EigenMatrix_t>
+void ConjugateGradientSolver<EigenMatrix_t>::set_deflation_refresh_strategy(const DeflationRefreshStrategy & strategy) {
+    using namespace sofa::helper;
+    auto deflation_refresh_strategy = WriteOnlyAccessor<Data<OptionsGroup>>(d_deflation_refresh_strategy);
+    deflation_refresh_strategy->setSelectedItem(static_cast<unsigned int> (strategy));
+}
+
 } // namespace SofaCaribou::solver
@@ -5,6 +5,8 @@
 #include <SofaCaribou/Algebra/EigenVector.h>
 #include <SofaCaribou/Solver/LinearSolver.h>
 
+#include <memory>
+
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #include <sofa/core/MechanicalParams.h>
@@ -37,6 +39,7 @@ public:
     using Scalar = typename Eigen::MatrixBase<EigenMatrix_t>::Scalar;
     using Matrix = EigenMatrix_t;
     using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using MappedVector = SofaCaribou::Algebra::EigenVector<Eigen::Map<Vector>>;
 
     EigenSolver() = default;
 
@@ -93,6 +96,13 @@ public:
     /** Explicitly states if this matrix is symmetric. */
     inline virtual void set_symmetric(bool is_symmetric) { p_is_symmetric = is_symmetric; }
 
+    /**
+     * States if only the upper triangular part of the (symmetric) system matrix is assembled and stored. This is only
+     * the case for solvers that directly consume the upper triangular part of the matrix (see
+     * SofaCaribou::Algebra::EigenMatrix::set_symmetric_storage).
+     */
+    inline virtual auto symmetric_storage() const -> bool {return false;}
+
     /** Get a readonly reference to the mechanical parameters */
     auto mechanical_params() const -> const sofa::core::MechanicalParams & { return p_mechanical_params; }
 
@@ -109,14 +119,46 @@ public:
     /** Get a readonly reference to the global assembled system matrix. */
     auto A() const -> const SofaCaribou::Algebra::EigenMatrix<Matrix> * { return p_A_ptr; }
 
-    /** Get a readonly reference to the right-hand side vector. */
-    auto b() const -> const SofaCaribou::Algebra::EigenVector<Vector> * { return &p_b;}
+    /**
+     * Get a readonly reference to the right-hand side vector. When the right-hand side is a view over the buffer of
+     * the mechanical object (see b_view), its coefficients are first copied into the returned vector.
+     */
+    auto b() const -> const SofaCaribou::Algebra::EigenVector<Vector> * {
+        if (p_b_view) {
+            p_b.vector() = p_b_view->vector();
+        }
+        return &p_b;
+    }
+
+    /**
+     * Get a readonly view over the right-hand side vector. When the context contains a single mechanical object, this
+     * is directly the buffer of the b vector of the mechanical object.
+     */
+    auto b_view() const -> Eigen::Map<const Vector> {
+        return SofaCaribou::Algebra::eigen_vector_map<Vector>(p_b_view ? static_cast<const SofaCaribou::Algebra::BaseVector *>(p_b_view.get()) : &p_b);
+    }
 
     /** Get a readonly reference to the right-hand side vector identifier */
     auto b_id() const -> const sofa::core::MultiVecDerivId & { return p_b_id; }
 
-    /** Get a readonly reference to the left-hand side unknown vector. */
-    auto x() const -> const SofaCaribou::Algebra::EigenVector<Vector> * { return &p_x;}
+    /**
+     * Get a readonly reference to the left-hand side unknown vector. When the unknown vector is a view over the buffer
+     * of the mechanical object (see x_view), its coefficients are first copied into the returned vector.
+     */
+    auto x() const -> const SofaCaribou::Algebra::EigenVector<Vector> * {
+        if (p_x_view) {
+            p_x.vector() = p_x_view->vector();
+        }
+        return &p_x;
+    }
+
+    /**
+     * Get a readonly view over the left-hand side unknown vector. When the context contains a single mechanical object,
+     * this is directly the buffer of the x vector of the mechanical object.
+     */
+    auto x_view() const -> Eigen::Map<const Vector> {
+        return SofaCaribou::Algebra::eigen_vector_map<Vector>(p_x_view ? static_cast<const SofaCaribou::Algebra::BaseVector *>(p_x_view.get()) : &p_x);
+    }
 
     /** Get a readonly reference to the left-hand side unknown vector identifier */
     auto x_id() const -> const sofa::core::MultiVecDerivId & { return p_x_id; }
@@ -155,6 +197,9 @@ private:
         if (symmetric()) {
             matrix->set_symmetric(symmetric());
         }
+        if (symmetric_storage()) {
+            matrix->set_symmetric_storage(true);
+        }
         return matrix;
     }
 
@@ -165,6 +210,14 @@ private:
         return new SofaCaribou::Algebra::EigenVector<Vector>(n);
     }
 
+    /**
+     * Update the view over the buffer of the multi-vector id. The view is only kept when the current context contains a
+     * single mechanical object whose vector size matches the system size, otherwise it is released and the vector
+     * must be copied.
+     * @return True if the view is valid.
+     */
+    bool update_view(const sofa::core::MultiVecDerivId & id, std::unique_ptr<MappedVector> & view);
+
 private:
     /// Private members
 
@@ -188,11 +241,18 @@ private:
     /// points to the system matrix assembled by the ODE itself.
     const SofaCaribou::Algebra::EigenMatrix<Matrix> * p_A_ptr;
 
-    /// Global system solution vector (usually filled with an initial guess or the previous solution)
-    SofaCaribou::Algebra::EigenVector<Vector> p_x;
+    /// Global system solution vector (usually filled with an initial guess or the previous solution). When p_x_view is
+    /// used, it is only filled on demand by x().
+    mutable SofaCaribou::Algebra::EigenVector<Vector> p_x;
+
+    /// Global system right-hand side vector. When p_b_view is used, it is only filled on demand by b().
+    mutable SofaCaribou::Algebra::EigenVector<Vector> p_b;
+
+    /// View over the buffer of the solution vector of the mechanical object (null when p_x is used instead)
+    std::unique_ptr<MappedVector> p_x_view;
 
-    /// Global system right-hand side vector
-    SofaCaribou::Algebra::EigenVector<Vector> p_b;
+    /// View over the buffer of the right-hand side vector of the mechanical object (null when p_b is used instead)
+    std::unique_ptr<MappedVector> p_b_view;
 
     /// True if the solver has successfully factorize the system matrix
     bool p_A_is_factorized {};
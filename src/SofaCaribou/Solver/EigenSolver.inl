@@ -2,6 +2,8 @@
 
 #include <SofaCaribou/Solver/EigenSolver.h>
 #include <SofaCaribou/Algebra/EigenMatrix.h>
+#include <SofaCaribou/Algebra/MappedMatrices.h>
+#include <SofaCaribou/Algebra/MechanicalStateBuffer.h>
 #include <SofaCaribou/Visitor/AssembleGlobalMatrix.h>
 #include <SofaCaribou/Visitor/ConstrainGlobalMatrix.h>
 
@@ -24,6 +26,8 @@ void EigenSolver<EigenMatrix_t>::resetSystem() {
     p_A.resize(0, 0);
     p_x.resize(0);
     p_b.resize(0);
+    p_x_view.reset();
+    p_b_view.reset();
     p_accessor.clear();
 }
 
@@ -63,6 +67,7 @@ auto EigenSolver<EigenMatrix_t>::assemble (const sofa::core::MechanicalParams* m
     Timer::stepBegin("Clear");
     p_A.resize(n, n);
     p_A.set_symmetric(symmetric()); // Enables some optimization when the system matrix is symmetric
+    p_A.set_symmetric_storage(symmetric_storage()); // Only assemble the upper triangular part if the solver reads it
     accessor.setGlobalMatrix(&p_A);
     Timer::stepEnd("Clear");
 
@@ -91,9 +96,10 @@ auto EigenSolver<EigenMatrix_t>::assemble (const sofa::core::MechanicalParams* m
     //         contribution to the global system matrix with:
     //           [A]ij += Jt * [A']ij * J
     //         where A is the master mechanical object's matrix, A' is the slave mechanical object matrix and J=m.getJ()
-    //         is the mapping relation between the slave and its master.
+    //         is the mapping relation between the slave and its master. When J is given as a sparse matrix, the
+    //         product is computed with sparse matrix products instead of entry by entry.
     Timer::stepBegin("MappedMatrices");
-    accessor.computeGlobalMatrix();
+    SofaCaribou::Algebra::add_mapped_matrices(accessor, context);
     Timer::stepEnd("MappedMatrices");
 
     // Step 4. Convert the system matrix to a compressed sparse matrix
@@ -160,9 +166,12 @@ void EigenSolver<EigenMatrix_t>::setSystemRHVector(sofa::core::MultiVecDerivId b
     sofa::simulation::common::MechanicalOperations mop(&p_mechanical_params, this->getContext());
     p_b_id = b_id;
 
-    // Copy the vectors of the mechanical objects into a global eigen vector.
-    p_b.resize(p_A.rowSize());
-    mop.multiVector2BaseVector(p_b_id, &p_b, &p_accessor);
+    // Copy the vectors of the mechanical objects into a global eigen vector, unless the vector can directly be
+    // mapped over the buffer of a single mechanical object.
+    if (not update_view(p_b_id, p_b_view)) {
+        p_b.resize(p_A.rowSize());
+        mop.multiVector2BaseVector(p_b_id, &p_b, &p_accessor);
+    }
 
     Timer::stepEnd("EigenSolver::AssembleResidualVector");
 }
@@ -179,9 +188,12 @@ void EigenSolver<EigenMatrix_t>::setSystemLHVector(sofa::core::MultiVecDerivId x
     p_x_id = x_id;
 
 
-    // Copy the vectors of the mechanical objects into a global eigen vector.
-    p_x.resize(p_A.rowSize());
-    mop.multiVector2BaseVector(p_x_id, &p_x, &p_accessor);
+    // Copy the vectors of the mechanical objects into a global eigen vector, unless the vector can directly be
+    // mapped over the buffer of a single mechanical object.
+    if (not update_view(p_x_id, p_x_view)) {
+        p_x.resize(p_A.rowSize());
+        mop.multiVector2BaseVector(p_x_id, &p_x, &p_accessor);
+    }
 
     Timer::stepEnd("EigenSolver::AssembleSolutionVector");
 }
@@ -195,8 +207,10 @@ void EigenSolver<EigenMatrix_t>::solveSystem() {
     sofa::simulation::common::MechanicalOperations mop( &p_mechanical_params, this->getContext() );
 
     Timer::stepBegin("EigenSolver::solve");
-    bool success = this->solve(&p_b, &p_x);
-    if (success) {
+    const SofaCaribou::Algebra::BaseVector * b = p_b_view ? static_cast<SofaCaribou::Algebra::BaseVector *>(p_b_view.get()) : &p_b;
+    SofaCaribou::Algebra::BaseVector * x = p_x_view ? static_cast<SofaCaribou::Algebra::BaseVector *>(p_x_view.get()) : &p_x;
+    bool success = this->solve(b, x);
+    if (success and not p_x_view) {
         // Copy the solution into the mechanical objects of the current context sub-graph.
         mop.baseVector2MultiVector(&p_x, p_x_id, &p_accessor);
     }
@@ -204,6 +218,24 @@ void EigenSolver<EigenMatrix_t>::solveSystem() {
     Timer::stepEnd("EigenSolver::solve");
 }
 
+template <class EigenMatrix_t>
+bool EigenSolver<EigenMatrix_t>::update_view(const sofa::core::MultiVecDerivId & id, std::unique_ptr<MappedVector> & view) {
+    if constexpr (std::is_same_v<Scalar, FLOATING_POINT_TYPE>) {
+        const auto buffer = SofaCaribou::Algebra::mechanical_state_buffer(this->getContext(), id);
+        if (buffer.first and buffer.second == static_cast<std::size_t>(p_A.rowSize())) {
+            // The view is only recreated when the mechanical object reallocated its buffer
+            if (not view or view->vector().data() != buffer.first) {
+                Eigen::Map<Vector> v(buffer.first, static_cast<Eigen::Index>(buffer.second));
+                view = std::make_unique<MappedVector>(v);
+            }
+            return true;
+        }
+    }
+
+    view.reset();
+    return false;
+}
+
 template<typename EigenMatrix_t>
 std::string EigenSolver<EigenMatrix_t>::GetCustomTemplateName() {
     std::string namestring;
@@ -49,6 +49,14 @@ public:
     
     bool solve(const SofaCaribou::Algebra::BaseVector * F, SofaCaribou::Algebra::BaseVector * X) override;
 
+    /**
+     * The backend only reads one triangular part of the system matrix. When it is the upper one, only this part is
+     * assembled and stored.
+     */
+    auto symmetric_storage() const -> bool override {
+        return static_cast<int>(EigenSolver_t::UpLo) == static_cast<int>(Eigen::Upper);
+    }
+
     // Get the backend name of the class derived from the EigenSolver template parameter
     
     static std::string BackendName();
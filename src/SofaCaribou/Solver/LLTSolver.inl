@@ -65,10 +65,10 @@ bool LLTSolver<EigenSolver_t>::factorize() {
 template<class EigenSolver_t>
 bool LLTSolver<EigenSolver_t>::solve(const SofaCaribou::Algebra::BaseVector * F,
                                       SofaCaribou::Algebra::BaseVector *X) {
-    auto F_ = dynamic_cast<const SofaCaribou::Algebra::EigenVector<Vector> *>(F);
-    auto X_ = dynamic_cast<SofaCaribou::Algebra::EigenVector<Vector> *>(X);
+    const auto F_ = SofaCaribou::Algebra::eigen_vector_map<Vector>(F);
+    auto X_ = SofaCaribou::Algebra::eigen_vector_map<Vector>(X);
 
-    X_->vector() = p_solver.solve(F_->vector());
+    X_ = p_solver.solve(F_);
     return (p_solver.info() == Eigen::Success);
 }
 
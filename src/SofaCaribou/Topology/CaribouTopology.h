@@ -3,6 +3,7 @@
 #include <SofaCaribou/config.h>
 #include <Caribou/Geometry/Element.h>
 #include <Caribou/Topology/Mesh.h>
+#include <Caribou/Topology/Reordering.h>
 
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
@@ -10,6 +11,7 @@ DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/core/State.h>
 #include <sofa/core/topology/Topology.h>
 #include <sofa/defaulttype/VecTypes.h>
+#include <sofa/helper/OptionsGroup.h>
 DISABLE_ALL_WARNINGS_END
 
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
@@ -45,6 +47,15 @@ template <> struct SofaVecType<3> { using Type = sofa::defaulttype::Vec3Types; }
  *    the topology, i.e. the pointer to the Domain must remain valid until this component is
  *    destroyed.
  *
+ * When the topology is created from the 'indices' data parameter, its nodes and elements can be reordered to
+ * improve the memory locality of the nodes of an element (see the 'node_ordering' and 'reorder_elements' data
+ * parameters). The input 'position' and 'indices' are left untouched (and linked), the domain is created from the
+ * 'reordered_position' and 'reordered_indices' output data parameters, and the permutations are given in the
+ * 'node_permutation' and 'element_permutation' output data parameters. Since the nodes of a mechanical state can't be
+ * reordered, the positions must then be given from a loader, and the mechanical state created from the
+ * 'reordered_position' of this topology. Reordering the nodes of a mechanical state is unsupported and reported as
+ * an error.
+ *
  * @tparam Element The element type of this topology. Will be used to determine the structure
  *                 type that will hold the indices of the nodes. It must inherits from
  *                 caribou::geometry::Element.
@@ -139,6 +150,22 @@ public:
      */
     void initializeFromIndices();
 
+    /**
+     * Reorder the position vector and the indices vector following the 'node_ordering' and 'reorder_elements' data
+     * attributes (see caribou::topology::compute_reordering) into the 'reordered_position' and 'reordered_indices'
+     * data attributes, and fill in the 'node_permutation' and 'element_permutation' data attributes. The input
+     * position and indices vectors are not modified.
+     *
+     * The nodes can't be reordered if the position vector is the one of a mechanical state, since the latter would
+     * not follow the new ordering. The position vector must then be given from a loader, and the mechanical state
+     * initialized from the reordered positions of this topology.
+     *
+     * \note This is called on init, before the Domain is created from the indices. Hence, the mechanical state
+     *       linked to the reordered positions must be placed after this topology in the scene graph.
+     * @return False if the nodes of a mechanical state were asked to be reordered.
+     */
+    bool reorder();
+
     /**
      * Return true if the SOFA mesh topology is compatible with the type Element of this component.
      *
@@ -172,6 +199,24 @@ private:
     /// Node indices (w.r.t the position vector) of each elements.
     Data<sofa::type::vector<sofa::type::fixed_array<PointID, NumberOfNodes>>> d_indices;
 
+    /// Ordering of the nodes (None, ReverseCuthillMcKee or Morton).
+    Data<sofa::helper::OptionsGroup> d_node_ordering;
+
+    /// Sort the elements by their minimum node index.
+    Data<bool> d_reorder_elements;
+
+    /// Output: position vector of the reordered nodes.
+    Data<VecCoord> d_reordered_position;
+
+    /// Output: node indices (w.r.t the reordered position vector) of each reordered elements.
+    Data<sofa::type::vector<sofa::type::fixed_array<PointID, NumberOfNodes>>> d_reordered_indices;
+
+    /// Output: original index of each reordered node.
+    Data<sofa::type::vector<UNSIGNED_INTEGER_TYPE>> d_node_permutation;
+
+    /// Output: original index of each reordered element.
+    Data<sofa::type::vector<UNSIGNED_INTEGER_TYPE>> d_element_permutation;
+
     /// Pointer to the Domain representing this topology of elements.
     const Domain * p_domain {nullptr};
 
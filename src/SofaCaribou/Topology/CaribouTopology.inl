@@ -20,7 +20,45 @@ CaribouTopology<Element>::CaribouTopology ()
 , d_indices(initData(&d_indices,
     "indices",
     "Node indices (w.r.t the position vector) of each elements."))
-{}
+, d_node_ordering(initData(&d_node_ordering,
+    "node_ordering",
+    "Ordering of the nodes applied on init to the position and indices vectors, giving the reordered_position and "
+    "reordered_indices vectors. ReverseCuthillMcKee minimizes the bandwidth of the system matrix, while Morton "
+    "sorts the nodes along a space-filling curve of their positions. The nodes of a mechanical state can't be "
+    "reordered: give the positions from a loader, and create the mechanical state (after this topology) from the "
+    "reordered_position vector."))
+, d_reorder_elements(initData(&d_reorder_elements,
+    false,
+    "reorder_elements",
+    "Sort the elements by their minimum node index on init, such that the elements are visited in the same order "
+    "as their nodes."))
+, d_reordered_position(initData(&d_reordered_position,
+    "reordered_position",
+    "Position vector of the reordered nodes (empty if the nodes weren't reordered)."))
+, d_reordered_indices(initData(&d_reordered_indices,
+    "reordered_indices",
+    "Node indices (w.r.t the reordered_position vector, or the position vector if the nodes weren't reordered) of "
+    "each reordered elements (empty if the topology wasn't reordered). The domain is created from these indices."))
+, d_node_permutation(initData(&d_node_permutation,
+    "node_permutation",
+    "Original index of each node after the reordering (empty if the topology wasn't reordered). A nodal field "
+    "computed on the reordered nodes is mapped back with original[node_permutation[i]] = reordered[i]."))
+, d_element_permutation(initData(&d_element_permutation,
+    "element_permutation",
+    "Original index of each element after the reordering (empty if the topology wasn't reordered)."))
+{
+    d_node_ordering.setValue(sofa::helper::OptionsGroup(std::vector<std::string> {
+        "None", "ReverseCuthillMcKee", "Morton"
+    }));
+
+    sofa::helper::WriteAccessor<Data<sofa::helper::OptionsGroup>> node_ordering = d_node_ordering;
+    node_ordering->setSelectedItem(static_cast<unsigned int>(caribou::topology::NodeOrdering::None));
+
+    d_reordered_position.setReadOnly(true);
+    d_reordered_indices.setReadOnly(true);
+    d_node_permutation.setReadOnly(true);
+    d_element_permutation.setReadOnly(true);
+}
 
 template <typename Element>
 void CaribouTopology<Element>::attachDomain(const caribou::topology::Domain<Element, PointID> * domain) {
@@ -44,15 +82,19 @@ template <typename Element>
 void CaribouTopology<Element>::initializeFromIndices() {
     using namespace sofa::helper;
 
+    // When the topology was reordered, the domain is created from the reordered vectors
+    const bool reordered_elements = not d_reordered_indices.getValue().empty();
+    const bool reordered_nodes = not d_reordered_position.getValue().empty();
+
     // Sanity checks
-    auto indices = ReadAccessor<Data<sofa::type::vector<sofa::type::fixed_array<PointID, NumberOfNodes>>>>(d_indices);
+    auto indices = ReadAccessor<Data<sofa::type::vector<sofa::type::fixed_array<PointID, NumberOfNodes>>>>(reordered_elements ? d_reordered_indices : d_indices);
     if (indices.empty()) {
         msg_warning() << "Initializing the topology from an empty set of indices. Make sure you fill the "
                       << "'" << d_indices.getName() << "' data attribute with a vector of node indices.";
         return;
     }
 
-    auto positions = ReadAccessor<Data<VecCoord>>(d_position);
+    auto positions = ReadAccessor<Data<VecCoord>>(reordered_nodes ? d_reordered_position : d_position);
     if (positions.empty()) {
         msg_warning() << "Initializing the topology from a set of indices, but without any node positions "
                       << "vector. Make sure you fill the " << "'" << d_position.getName() << "' data attribute "
@@ -99,6 +141,95 @@ void CaribouTopology<Element>::initializeFromIndices() {
     this->p_domain = this->p_mesh->template add_domain<Element, PointID>(indices_ptr, indices.size(), NumberOfNodes);
 }
 
+template <typename Element>
+bool CaribouTopology<Element>::reorder() {
+    using namespace sofa::helper;
+    using caribou::topology::NodeOrdering;
+
+    // Outputs of a previous reordering
+    WriteOnlyAccessor<Data<VecCoord>>(d_reordered_position).clear();
+    WriteOnlyAccessor<Data<sofa::type::vector<sofa::type::fixed_array<PointID, NumberOfNodes>>>>(d_reordered_indices).clear();
+    WriteOnlyAccessor<Data<sofa::type::vector<UNSIGNED_INTEGER_TYPE>>>(d_node_permutation).clear();
+    WriteOnlyAccessor<Data<sofa::type::vector<UNSIGNED_INTEGER_TYPE>>>(d_element_permutation).clear();
+
+    const auto node_ordering = static_cast<NodeOrdering>(d_node_ordering.getValue().getSelectedId());
+    const bool reorder_elements = d_reorder_elements.getValue();
+    if (node_ordering == NodeOrdering::None and not reorder_elements) {
+        return true;
+    }
+
+    // The positions of a mechanical state can't be reordered from here
+    const auto * position_parent = d_position.getParent();
+    if (node_ordering != NodeOrdering::None and position_parent and dynamic_cast<const sofa::core::BaseState *>(position_parent->getOwner())) {
+        msg_error() << "The nodes can't be reordered since the positions are the ones of the mechanical state '"
+                    << position_parent->getLinkPath() << "'. Give the positions from a loader instead, and create the "
+                    << "mechanical state from the reordered positions of this topology ('"
+                    << d_reordered_position.getLinkPath() << "').";
+        return false;
+    }
+
+    caribou::topology::Reordering reordering;
+    VecCoord reordered_positions;
+    sofa::type::vector<sofa::type::fixed_array<PointID, NumberOfNodes>> reordered_indices;
+    {
+        auto indices = ReadAccessor<Data<sofa::type::vector<sofa::type::fixed_array<PointID, NumberOfNodes>>>>(d_indices);
+        auto positions = ReadAccessor<Data<VecCoord>>(d_position);
+        if (indices.empty() or positions.empty()) {
+            return true; // Will be reported by initializeFromIndices
+        }
+        for (const auto & element_indices : indices) {
+            for (const auto & node_index : element_indices) {
+                if (node_index >= positions.size()) {
+                    return true; // Will be reported by initializeFromIndices
+                }
+            }
+        }
+
+        Eigen::Matrix<Real, Eigen::Dynamic, Dimension, (Dimension > 1 ? Eigen::RowMajor : Eigen::ColMajor)> X (positions.size(), Dimension);
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            for (std::size_t j = 0; j < static_cast<std::size_t>(Dimension); ++j) {
+                X(static_cast<Eigen::Index>(i), static_cast<Eigen::Index>(j)) = positions[i][j];
+            }
+        }
+
+        reordering = caribou::topology::compute_reordering(X, indices.size(), [&indices](const UNSIGNED_INTEGER_TYPE & element_id) -> const auto & {
+            return indices[element_id];
+        }, node_ordering, reorder_elements);
+
+        const auto new_node_indices = caribou::topology::inverse_permutation(reordering.node_order);
+        reordered_indices.resize(indices.size());
+        for (std::size_t element_id = 0; element_id < indices.size(); ++element_id) {
+            const auto & element_indices = indices[reordering.element_order[element_id]];
+            for (std::size_t i = 0; i < static_cast<std::size_t>(NumberOfNodes); ++i) {
+                reordered_indices[element_id][i] = static_cast<PointID>(new_node_indices[element_indices[i]]);
+            }
+        }
+
+        if (node_ordering != NodeOrdering::None) {
+            reordered_positions.resize(positions.size());
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                reordered_positions[i] = positions[reordering.node_order[i]];
+            }
+        }
+    }
+
+    // The input vectors (and their links) are kept, the domain will be created from the reordered ones
+    if (node_ordering != NodeOrdering::None) {
+        d_reordered_position.setValue(reordered_positions);
+        d_node_permutation.setValue(sofa::type::vector<UNSIGNED_INTEGER_TYPE>(reordering.node_order.begin(), reordering.node_order.end()));
+    }
+    d_reordered_indices.setValue(reordered_indices);
+    if (reorder_elements) {
+        d_element_permutation.setValue(sofa::type::vector<UNSIGNED_INTEGER_TYPE>(reordering.element_order.begin(), reordering.element_order.end()));
+    }
+
+    msg_info() << "Reordered " << ((node_ordering != NodeOrdering::None) ? reordered_positions.size() : 0) << " nodes ("
+               << d_node_ordering.getValue().getSelectedItem() << ") and "
+               << (reorder_elements ? reordered_indices.size() : 0) << " elements.";
+
+    return true;
+}
+
 template<typename Element>
 void CaribouTopology<Element>::init() {
     using namespace sofa::core::objectmodel;
@@ -120,7 +251,9 @@ void CaribouTopology<Element>::init() {
             }
         }
 
-        this->initializeFromIndices();
+        if (this->reorder()) {
+            this->initializeFromIndices();
+        }
     }
 
 
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <Caribou/config.h>
+#include <Caribou/Algebra/PackedSymmetricMatrix.h>
+#include <Eigen/Dense>
+#include <limits>
+
+using namespace caribou::algebra;
+
+namespace {
+constexpr int N = 24;
+using Packed = PackedSymmetricMatrix<N, FLOATING_POINT_TYPE>;
+using Dense = Eigen::Matrix<FLOATING_POINT_TYPE, N, N>;
+using Vector = Eigen::Matrix<FLOATING_POINT_TYPE, N, 1>;
+
+auto random_symmetric_matrix() -> Dense {
+    const Dense a = Dense::Random();
+    return a + a.transpose();
+}
+} // namespace
+
+TEST(PackedSymmetricMatrix, Index) {
+    // The entries of the upper triangle are numbered row by row, without any gap nor overlap
+    Eigen::Index expected_index = 0;
+    for (Eigen::Index i = 0; i < N; ++i) {
+        for (Eigen::Index j = i; j < N; ++j) {
+            EXPECT_EQ(Packed::index(i, j), expected_index);
+            ++expected_index;
+        }
+    }
+    EXPECT_EQ(expected_index, Packed::NumberOfEntries);
+    EXPECT_EQ(Packed::NumberOfEntries, N*(N+1)/2);
+
+    // (i, j) and (j, i) are the same entry
+    Packed m;
+    for (Eigen::Index i = 0; i < N; ++i) {
+        for (Eigen::Index j = i; j < N; ++j) {
+            m(i, j) = static_cast<FLOATING_POINT_TYPE>(Packed::index(i, j));
+        }
+    }
+    for (Eigen::Index i = 0; i < N; ++i) {
+        for (Eigen::Index j = 0; j < N; ++j) {
+            EXPECT_EQ(&m(i, j), &m(j, i));
+            EXPECT_EQ(m.entries()[Packed::index(std::min(i, j), std::max(i, j))], m(i, j));
+        }
+    }
+}
+
+TEST(PackedSymmetricMatrix, PackUnpack) {
+    const Dense K = random_symmetric_matrix();
+
+    // Only the upper triangle is read when packing
+    Dense upper = K.triangularView<Eigen::Upper>();
+    const Packed packed (upper);
+
+    EXPECT_EQ(Dense(packed.matrix()), K);
+    EXPECT_EQ(Dense(packed.upper_triangle()), upper);
+    for (Eigen::Index i = 0; i < N; ++i) {
+        for (Eigen::Index j = 0; j < N; ++j) {
+            EXPECT_EQ(packed(i, j), K(i, j));
+        }
+    }
+
+    // Blocks are read from the packed entries, on both sides of the diagonal
+    for (Eigen::Index i = 0; i < N; i += 3) {
+        for (Eigen::Index j = 0; j < N; j += 3) {
+            const Eigen::Matrix<FLOATING_POINT_TYPE, 3, 3> block = packed.block<3, 3>(i, j);
+            EXPECT_EQ(block, (K.block<3, 3>(i, j)));
+        }
+    }
+}
+
+TEST(PackedSymmetricMatrix, Product) {
+    const Dense K = random_symmetric_matrix();
+    const Packed packed (K);
+
+    for (int n = 0; n < 10; ++n) {
+        const Vector u = Vector::Random();
+        const Vector expected = K * u;
+        const Vector f = packed * u;
+        EXPECT_LT((f - expected).cwiseAbs().maxCoeff(), 100*std::numeric_limits<FLOATING_POINT_TYPE>::epsilon() * expected.cwiseAbs().maxCoeff());
+    }
+
+    // Expressions are accepted as the right-hand side
+    const Vector u = Vector::Random();
+    const Vector f = packed * (2*u);
+    EXPECT_LT((f - K*(2*u)).cwiseAbs().maxCoeff(), 100*std::numeric_limits<FLOATING_POINT_TYPE>::epsilon() * f.cwiseAbs().maxCoeff());
+}
@@ -183,4 +183,145 @@ TEST(BarycentricContainer, _2D) {
 
     const auto outside_nodes = barycentric_container.outside_nodes();
     EXPECT_EQ(outside_nodes, std::vector<UNSIGNED_INTEGER_TYPE>({0, 3, 6, 7, 8}));
-}
\ No newline at end of file
+}
+
+TEST(BarycentricContainer, BoundingVolumeHierarchy) {
+    using Mesh = Mesh<_2D>;
+    using Quad = Quad<_2D>;
+    using Domain = Domain<Quad>;
+
+    // A 4x4 grid of quads, with columns of increasing width
+    std::vector<Mesh::WorldCoordinates> positions;
+    const std::array<FLOATING_POINT_TYPE, 5> xs {0., 0.1, 0.5, 2., 10.};
+    for (UNSIGNED_INTEGER_TYPE j = 0; j < 5; ++j) {
+        for (const auto & x : xs) {
+            positions.push_back({x, static_cast<FLOATING_POINT_TYPE>(j)});
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices quad_indices(16, 4);
+    for (int j = 0; j < 4; ++j) {
+        for (int i = 0; i < 4; ++i) {
+            quad_indices.row(j*4 + i) << j*5 + i, j*5 + i + 1, (j+1)*5 + i + 1, (j+1)*5 + i;
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Quad>("quads", quad_indices);
+
+    Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2> embedded_positions (positions.size() + 2, 2);
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        embedded_positions.row(static_cast<Eigen::Index>(i)) = positions[i].transpose();
+    }
+    embedded_positions.row(static_cast<Eigen::Index>(positions.size())) << 0.05, 3.5;
+    embedded_positions.row(static_cast<Eigen::Index>(positions.size()+1)) << 11., 2.; // Outside
+
+    // The hierarchy must find the same barycentric points as the hash grid
+    const auto hash_grid_container = container_domain->embed(embedded_positions, ElementLocator::HashGrid);
+    const auto bvh_container = container_domain->embed(embedded_positions, ElementLocator::BoundingVolumeHierarchy);
+    ASSERT_EQ(bvh_container.barycentric_points().size(), hash_grid_container.barycentric_points().size());
+    for (std::size_t i = 0; i < bvh_container.barycentric_points().size(); ++i) {
+        const auto & bp = bvh_container.barycentric_points()[i];
+        EXPECT_EQ(bp.element_index, hash_grid_container.barycentric_points()[i].element_index);
+        EXPECT_MATRIX_NEAR(bp.local_coordinates, hash_grid_container.barycentric_points()[i].local_coordinates, 1e-10);
+    }
+    EXPECT_EQ(bvh_container.outside_nodes(), std::vector<UNSIGNED_INTEGER_TYPE>({positions.size()+1}));
+}
+
+TEST(BarycentricContainer, BatchEmbedding) {
+    using Mesh = Mesh<_2D>;
+    using Quad = Quad<_2D>;
+    using Domain = Domain<Quad>;
+
+    // A 10x10 grid of unit quads
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (int j = 0; j <= 10; ++j) {
+        for (int i = 0; i <= 10; ++i) {
+            positions.push_back({static_cast<FLOATING_POINT_TYPE>(i), static_cast<FLOATING_POINT_TYPE>(j)});
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices quad_indices(100, 4);
+    for (int j = 0; j < 10; ++j) {
+        for (int i = 0; i < 10; ++i) {
+            quad_indices.row(j*10 + i) << j*11 + i, j*11 + i + 1, (j+1)*11 + i + 1, (j+1)*11 + i;
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Quad>("quads", quad_indices);
+
+    // Random points in [-1, 11]^2 (some of them outside), followed by the nodes of the grid (shared by many quads)
+    std::srand(0);
+    Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2> embedded_positions (1000 + positions.size(), 2);
+    embedded_positions.topRows(1000) = (Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2>::Random(1000, 2).array() + 1) * 6 - 1;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        embedded_positions.row(static_cast<Eigen::Index>(1000 + i)) = positions[i].transpose();
+    }
+
+    // The batch embedding must give the same barycentric points as locating the points one by one
+    for (const auto & locator : {ElementLocator::HashGrid, ElementLocator::BoundingVolumeHierarchy}) {
+        const auto container = container_domain->embed(embedded_positions, locator);
+        std::vector<UNSIGNED_INTEGER_TYPE> outside_nodes;
+        for (Eigen::Index i = 0; i < embedded_positions.rows(); ++i) {
+            const auto bp = container.barycentric_point(embedded_positions.row(i).transpose());
+            EXPECT_EQ(container.barycentric_points()[static_cast<std::size_t>(i)].element_index, bp.element_index);
+            EXPECT_MATRIX_EQUAL(container.barycentric_points()[static_cast<std::size_t>(i)].local_coordinates, bp.local_coordinates);
+            if (bp.element_index < 0) {
+                outside_nodes.emplace_back(static_cast<UNSIGNED_INTEGER_TYPE>(i));
+            }
+        }
+        EXPECT_FALSE(outside_nodes.empty());
+        EXPECT_EQ(container.outside_nodes(), outside_nodes);
+    }
+}
+
+TEST(BarycentricContainer, UpdateEmbeddedPoints) {
+    using Mesh = Mesh<_2D>;
+    using Quad = Quad<_2D>;
+    using Domain = Domain<Quad>;
+
+    // A 10x10 grid of unit quads
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (int j = 0; j <= 10; ++j) {
+        for (int i = 0; i <= 10; ++i) {
+            positions.push_back({static_cast<FLOATING_POINT_TYPE>(i), static_cast<FLOATING_POINT_TYPE>(j)});
+        }
+    }
+    Mesh container_mesh (positions);
+
+    Domain::ElementsIndices quad_indices(100, 4);
+    for (int j = 0; j < 10; ++j) {
+        for (int i = 0; i < 10; ++i) {
+            quad_indices.row(j*10 + i) << j*11 + i, j*11 + i + 1, (j+1)*11 + i + 1, (j+1)*11 + i;
+        }
+    }
+    const Domain * container_domain = container_mesh.add_domain<Quad>("quads", quad_indices);
+
+    // Random points in [0, 10]^2, then moved (some of them outside of the domain, and some of them far away)
+    std::srand(0);
+    Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2> embedded_positions = (Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2>::Random(1000, 2).array() + 1) * 5;
+    auto container = container_domain->embed(embedded_positions);
+    EXPECT_TRUE(container.outside_nodes().empty());
+
+    for (const auto & displacement : {0.3, 1.5, 8.}) {
+        embedded_positions.col(0).array() += displacement;
+        embedded_positions.col(1).array() -= displacement/2;
+        container.update_embedded_points(embedded_positions);
+
+        // Same barycentric points as when embedding the points from scratch
+        const auto expected_container = container_domain->embed(embedded_positions);
+        ASSERT_EQ(container.barycentric_points().size(), expected_container.barycentric_points().size());
+        for (std::size_t i = 0; i < container.barycentric_points().size(); ++i) {
+            const auto & bp = container.barycentric_points()[i];
+            EXPECT_EQ(bp.element_index, expected_container.barycentric_points()[i].element_index);
+            if (bp.element_index >= 0) {
+                EXPECT_MATRIX_NEAR(bp.local_coordinates, expected_container.barycentric_points()[i].local_coordinates, 1e-10);
+            }
+        }
+        EXPECT_EQ(container.outside_nodes(), expected_container.outside_nodes());
+    }
+    EXPECT_FALSE(container.outside_nodes().empty());
+
+    // The number of points can't change
+    Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2> other_positions = embedded_positions.topRows(10);
+    EXPECT_THROW(container.update_embedded_points(other_positions), std::runtime_error);
+}
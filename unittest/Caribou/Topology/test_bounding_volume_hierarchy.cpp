@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "topology_test.h"
+#include <Caribou/Geometry/Quad.h>
+#include <Caribou/Topology/Mesh.h>
+#include <Caribou/Topology/Domain.h>
+#include <Caribou/Topology/BoundingVolumeHierarchy.h>
+
+using namespace caribou::topology;
+using namespace caribou::geometry;
+using namespace caribou;
+
+TEST(BoundingVolumeHierarchy, _2D) {
+    using Mesh = Mesh<_2D>;
+    using Quad = Quad<_2D>;
+    using Domain = Domain<Quad>;
+    using BVH = BoundingVolumeHierarchy<Quad>;
+
+    // Let's create a strongly graded grid of 20x10 quads, the width of the columns doubling from left to right
+    constexpr UNSIGNED_INTEGER_TYPE nx = 20, ny = 10;
+    std::vector<FLOATING_POINT_TYPE> xs {0.};
+    for (UNSIGNED_INTEGER_TYPE i = 0; i < nx; ++i) {
+        xs.emplace_back(xs.back() + std::pow(2., static_cast<FLOATING_POINT_TYPE>(i) / 2.));
+    }
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (UNSIGNED_INTEGER_TYPE j = 0; j <= ny; ++j) {
+        for (UNSIGNED_INTEGER_TYPE i = 0; i <= nx; ++i) {
+            positions.push_back({xs[i], static_cast<FLOATING_POINT_TYPE>(j)});
+        }
+    }
+    Mesh mesh (positions);
+
+    Domain::ElementsIndices quad_indices(nx*ny, 4);
+    for (UNSIGNED_INTEGER_TYPE j = 0; j < ny; ++j) {
+        for (UNSIGNED_INTEGER_TYPE i = 0; i < nx; ++i) {
+            const auto n0 = static_cast<int>(j*(nx+1) + i);
+            quad_indices.row(j*nx + i) << n0, n0+1, n0+static_cast<int>(nx)+2, n0+static_cast<int>(nx)+1;
+        }
+    }
+    const Domain * domain = mesh.add_domain<Quad>("quads", quad_indices);
+
+    // Elements whose bounding box contains p, found by brute force
+    const auto brute_force = [&domain](const BVH::WorldCoordinates & p, const BVH::WorldCoordinates & translation) {
+        std::vector<UNSIGNED_INTEGER_TYPE> elements;
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < domain->number_of_elements(); ++element_id) {
+            const auto nodes = domain->element(element_id).nodes();
+            const BVH::WorldCoordinates min = nodes.colwise().minCoeff().transpose() + translation;
+            const BVH::WorldCoordinates max = nodes.colwise().maxCoeff().transpose() + translation;
+            if ((p.array() >= min.array() - EPSILON).all() and (p.array() <= max.array() + EPSILON).all()) {
+                elements.emplace_back(element_id);
+            }
+        }
+        return elements;
+    };
+
+    for (const auto & split_method : {BVH::SplitMethod::Median, BVH::SplitMethod::SAH}) {
+        BVH bvh (domain, split_method);
+
+        // Every leaf holds a few elements
+        for (const auto & node : bvh.nodes()) {
+            EXPECT_LE(node.number_of_elements, BVH::MaximumNumberOfElementsPerLeaf);
+        }
+        EXPECT_LT(bvh.nodes().size(), 2*domain->number_of_elements());
+
+        // Centers, nodes and points outside of the domain
+        std::vector<BVH::WorldCoordinates> points;
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < domain->number_of_elements(); ++element_id) {
+            points.emplace_back(domain->element(element_id).center());
+        }
+        for (const auto & p : positions) {
+            points.emplace_back(p.transpose());
+        }
+        points.emplace_back(-1., 5.);
+        points.emplace_back(xs.back() + 1., 5.);
+
+        std::vector<UNSIGNED_INTEGER_TYPE> candidates;
+        for (const auto & p : points) {
+            bvh.get(p, candidates);
+            EXPECT_EQ(candidates, brute_force(p, BVH::WorldCoordinates::Zero()));
+        }
+
+        // Batch queries give the same candidates
+        Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2> batch (points.size(), 2);
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            batch.row(static_cast<Eigen::Index>(i)) = points[i].transpose();
+        }
+        const auto batch_candidates = bvh.get_batch(batch);
+        ASSERT_EQ(batch_candidates.size(), points.size());
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            EXPECT_EQ(batch_candidates[i], bvh.get(points[i]));
+        }
+
+        // Refit the hierarchy after a translation of the nodes
+        const BVH::WorldCoordinates translation {3., -2.};
+        Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 2> translated_positions (positions.size(), 2);
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            translated_positions.row(static_cast<Eigen::Index>(i)) = positions[i] + translation.transpose();
+        }
+        bvh.refit(domain, translated_positions);
+        for (const auto & p : points) {
+            const BVH::WorldCoordinates q = p + translation;
+            bvh.get(q, candidates);
+            EXPECT_EQ(candidates, brute_force(q, translation));
+        }
+    }
+}
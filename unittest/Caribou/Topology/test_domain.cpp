@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include "topology_test.h"
 #include <Caribou/Topology/Mesh.h>
+#include <Caribou/Geometry/Quad.h>
 #include <Caribou/Geometry/Segment.h>
+#include <Caribou/Geometry/Tetrahedron.h>
 
 TEST(Domain, Segment) {
     using namespace caribou;
@@ -74,4 +76,70 @@ TEST(Domain, Segment) {
         EXPECT_EQ(domain->element_indices(3)[0], indices[21]);
         EXPECT_EQ(domain->element_indices(3)[1], indices[24]);
     }
-}
\ No newline at end of file
+}
+
+TEST(Domain, Adjacency) {
+    using namespace caribou;
+    using namespace caribou::geometry;
+    using namespace caribou::topology;
+
+    using Mesh = Mesh<_3D>;
+    using Domain = Mesh::Domain<Tetrahedron>;
+
+    // Three tetrahedrons around the edge (0, 1), each of them sharing a face with the two others
+    Mesh mesh ({{0, 0, 0}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}, {-1, 0, 0}});
+    Domain::ElementsIndices indices(3, 4);
+    indices << 0, 2, 3, 1,
+               0, 3, 4, 1,
+               1, 4, 2, 0;
+    const Domain * domain = mesh.add_domain<Tetrahedron>(indices);
+
+    // Faces of a tetrahedron: (0, 2, 1), (0, 1, 3), (0, 3, 2), (3, 1, 2)
+    EXPECT_MATRIX_EQUAL(domain->face_neighbors(0), (Eigen::Matrix<INTEGER_TYPE, 4, 1>() << -1, 2, 1, -1).finished());
+    EXPECT_MATRIX_EQUAL(domain->face_neighbors(1), (Eigen::Matrix<INTEGER_TYPE, 4, 1>() << -1, 0, 2, -1).finished());
+    EXPECT_MATRIX_EQUAL(domain->face_neighbors(2), (Eigen::Matrix<INTEGER_TYPE, 4, 1>() << -1, 1, 0, -1).finished());
+
+    EXPECT_MATRIX_EQUAL(domain->node_elements(0), (Eigen::Matrix<UNSIGNED_INTEGER_TYPE, 3, 1>() << 0, 1, 2).finished());
+    EXPECT_MATRIX_EQUAL(domain->node_elements(1), (Eigen::Matrix<UNSIGNED_INTEGER_TYPE, 3, 1>() << 0, 1, 2).finished());
+    EXPECT_MATRIX_EQUAL(domain->node_elements(2), (Eigen::Matrix<UNSIGNED_INTEGER_TYPE, 2, 1>() << 0, 2).finished());
+    EXPECT_MATRIX_EQUAL(domain->node_elements(3), (Eigen::Matrix<UNSIGNED_INTEGER_TYPE, 2, 1>() << 0, 1).finished());
+    EXPECT_MATRIX_EQUAL(domain->node_elements(4), (Eigen::Matrix<UNSIGNED_INTEGER_TYPE, 2, 1>() << 1, 2).finished());
+    EXPECT_EQ(domain->node_elements(5).size(), 0);
+
+    Domain::BoundaryFaces boundary_faces (6, 2);
+    boundary_faces << 0, 0,
+                      0, 3,
+                      1, 0,
+                      1, 3,
+                      2, 0,
+                      2, 3;
+    EXPECT_MATRIX_EQUAL(domain->boundary_faces(), boundary_faces);
+
+    { // 4x4 grid of quads
+        using Quad = Quad<_2D>;
+        using QuadDomain = topology::Mesh<_2D>::Domain<Quad>;
+
+        std::vector<topology::Mesh<_2D>::WorldCoordinates> positions;
+        for (int j = 0; j <= 4; ++j) {
+            for (int i = 0; i <= 4; ++i) {
+                positions.push_back({static_cast<FLOATING_POINT_TYPE>(i), static_cast<FLOATING_POINT_TYPE>(j)});
+            }
+        }
+        topology::Mesh<_2D> quad_mesh (positions);
+
+        QuadDomain::ElementsIndices quad_indices(16, 4);
+        for (int j = 0; j < 4; ++j) {
+            for (int i = 0; i < 4; ++i) {
+                quad_indices.row(j*4 + i) << j*5 + i, j*5 + i + 1, (j+1)*5 + i + 1, (j+1)*5 + i;
+            }
+        }
+        const QuadDomain * quad_domain = quad_mesh.add_domain<Quad>(quad_indices);
+
+        // Edges of a quad: (0, 1), (1, 2), (2, 3), (3, 0)
+        EXPECT_MATRIX_EQUAL(quad_domain->face_neighbors(5), (Eigen::Matrix<INTEGER_TYPE, 4, 1>() << 1, 6, 9, 4).finished());
+        EXPECT_MATRIX_EQUAL(quad_domain->face_neighbors(0), (Eigen::Matrix<INTEGER_TYPE, 4, 1>() << -1, 1, 4, -1).finished());
+        EXPECT_MATRIX_EQUAL(quad_domain->node_elements(12), (Eigen::Matrix<UNSIGNED_INTEGER_TYPE, 4, 1>() << 5, 6, 9, 10).finished());
+        EXPECT_EQ(quad_domain->node_elements(0).size(), 1);
+        EXPECT_EQ(quad_domain->boundary_faces().rows(), 16);
+    }
+}
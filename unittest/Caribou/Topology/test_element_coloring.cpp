@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "topology_test.h"
+#include <Caribou/Topology/ElementColoring.h>
+
+#include <array>
+#include <set>
+
+using namespace caribou::topology;
+using namespace caribou;
+
+TEST(ElementColoring, Grid) {
+    // Let's color a 4x3 grid of quads
+    //
+    //   15 --- 16 --- 17 --- 18 --- 19
+    //    |  8   |  9   |  10  |  11  |
+    //   10 --- 11 --- 12 --- 13 --- 14
+    //    |  4   |  5   |  6   |  7   |
+    //    5 ---- 6 ---- 7 ---- 8 ---- 9
+    //    |  0   |  1   |  2   |  3   |
+    //    0 ---- 1 ---- 2 ---- 3 ---- 4
+    constexpr UNSIGNED_INTEGER_TYPE nx = 4, ny = 3;
+    std::vector<std::array<UNSIGNED_INTEGER_TYPE, 4>> quads;
+    for (UNSIGNED_INTEGER_TYPE j = 0; j < ny; ++j) {
+        for (UNSIGNED_INTEGER_TYPE i = 0; i < nx; ++i) {
+            const auto n0 = j*(nx+1) + i;
+            quads.push_back({n0, n0+1, n0+nx+2, n0+nx+1});
+        }
+    }
+
+    const auto colors = color_elements(quads.size(), (nx+1)*(ny+1), [&quads](const UNSIGNED_INTEGER_TYPE & element_id) {
+        return quads[element_id];
+    });
+
+    // A structured grid of quads needs exactly four colors
+    EXPECT_EQ(colors.size(), 4);
+
+    // Every element is colored exactly once
+    std::set<UNSIGNED_INTEGER_TYPE> colored_elements;
+    for (const auto & elements : colors) {
+        colored_elements.insert(elements.begin(), elements.end());
+    }
+    EXPECT_EQ(colored_elements.size(), quads.size());
+
+    // Two elements of the same color never share a node
+    for (const auto & elements : colors) {
+        std::set<UNSIGNED_INTEGER_TYPE> nodes;
+        for (const auto & element_id : elements) {
+            for (const auto & node_id : quads[element_id]) {
+                EXPECT_TRUE(nodes.insert(node_id).second) << "Node " << node_id << " is shared by two elements of the same color";
+            }
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "topology_test.h"
+#include <Caribou/Geometry/Quad.h>
+#include <Caribou/Topology/Mesh.h>
+#include <Caribou/Topology/Domain.h>
+#include <Caribou/Topology/HashGrid.h>
+#include <thread>
+
+using namespace caribou::topology;
+using namespace caribou::geometry;
+using namespace caribou;
+
+TEST(HashGrid, _2D) {
+    using Mesh = Mesh<_2D>;
+    using Quad = Quad<_2D>;
+    using Domain = Domain<Quad>;
+
+    // Let's create a 4x3 grid of 1x1 quads with its lower left corner at (-2, -1)
+    constexpr UNSIGNED_INTEGER_TYPE nx = 4, ny = 3;
+    std::vector<Mesh::WorldCoordinates> positions;
+    for (UNSIGNED_INTEGER_TYPE j = 0; j <= ny; ++j) {
+        for (UNSIGNED_INTEGER_TYPE i = 0; i <= nx; ++i) {
+            positions.push_back({static_cast<FLOATING_POINT_TYPE>(i) - 2., static_cast<FLOATING_POINT_TYPE>(j) - 1.});
+        }
+    }
+    Mesh mesh (positions);
+
+    Domain::ElementsIndices quad_indices(nx*ny, 4);
+    for (UNSIGNED_INTEGER_TYPE j = 0; j < ny; ++j) {
+        for (UNSIGNED_INTEGER_TYPE i = 0; i < nx; ++i) {
+            const auto n0 = static_cast<int>(j*(nx+1) + i);
+            quad_indices.row(j*nx + i) << n0, n0+1, n0+static_cast<int>(nx)+2, n0+static_cast<int>(nx)+1;
+        }
+    }
+    const Domain * domain = mesh.add_domain<Quad>("quads", quad_indices);
+
+    // The bulk build uses the mean element size as cell size
+    HashGrid<Quad> grid (domain);
+    EXPECT_DOUBLE_EQ(grid.cell_size(), 1.);
+    EXPECT_EQ(grid.number_of_cells(), 20); // Each quad also touches the cells of its upper and right sides
+
+    // Adding the elements one by one gives the same candidates
+    HashGrid<Quad> incremental_grid (1.);
+    for (UNSIGNED_INTEGER_TYPE element_id = domain->number_of_elements(); element_id > 0; --element_id) {
+        incremental_grid.add(domain->element(element_id-1), element_id-1);
+    }
+    incremental_grid.build();
+    EXPECT_EQ(incremental_grid.number_of_cells(), grid.number_of_cells());
+
+    std::vector<UNSIGNED_INTEGER_TYPE> candidates;
+    for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < domain->number_of_elements(); ++element_id) {
+        const auto center = domain->element(element_id).center();
+        grid.get(center, candidates);
+        EXPECT_NE(std::find(candidates.begin(), candidates.end(), element_id), candidates.end());
+        EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+        EXPECT_EQ(candidates, incremental_grid.get(center));
+    }
+
+    // A point on a node shared by four quads is found in each of them, once
+    grid.get({0., 1.}, candidates);
+    for (const UNSIGNED_INTEGER_TYPE element_id : {5u, 6u, 9u, 10u}) {
+        EXPECT_EQ(std::count(candidates.begin(), candidates.end(), element_id), 1);
+    }
+
+    // Nothing far away from the domain
+    grid.get({100., -100.}, candidates);
+    EXPECT_TRUE(candidates.empty());
+}
+
+TEST(HashGrid, ConcurrentLazyBuild) {
+    using Quad = Quad<_2D>;
+    using WorldCoordinates = Quad::WorldCoordinates;
+
+    // A row of 100 unit quads added one by one, without building the grid
+    constexpr UNSIGNED_INTEGER_TYPE number_of_elements = 100;
+    HashGrid<Quad> grid (1.);
+    for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+        const auto x = static_cast<FLOATING_POINT_TYPE>(element_id);
+        grid.add(Quad(WorldCoordinates(x, 0), WorldCoordinates(x+1, 0), WorldCoordinates(x+1, 1), WorldCoordinates(x, 1)), element_id);
+    }
+
+    // The first queries are made concurrently, the grid is built only once by one of them
+    std::vector<std::vector<UNSIGNED_INTEGER_TYPE>> candidates (8*number_of_elements);
+    std::vector<std::thread> threads;
+    for (UNSIGNED_INTEGER_TYPE t = 0; t < 8; ++t) {
+        threads.emplace_back([&grid, &candidates, t]() {
+            for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+                const auto x = static_cast<FLOATING_POINT_TYPE>(element_id);
+                grid.get({x + 0.5, 0.5}, candidates[t*number_of_elements + element_id]);
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+
+    // The cell of a quad also contains the quad at its left, since they share a side
+    const auto expected_candidates = [](const UNSIGNED_INTEGER_TYPE & element_id) {
+        return (element_id == 0) ? std::vector<UNSIGNED_INTEGER_TYPE>({0}) : std::vector<UNSIGNED_INTEGER_TYPE>({element_id-1, element_id});
+    };
+
+    EXPECT_EQ(grid.number_of_cells(), 2*(number_of_elements+1));
+    for (UNSIGNED_INTEGER_TYPE t = 0; t < 8; ++t) {
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < number_of_elements; ++element_id) {
+            EXPECT_EQ(candidates[t*number_of_elements + element_id], expected_candidates(element_id));
+        }
+    }
+
+    // Copies and moves keep the indexed elements
+    HashGrid<Quad> copy (grid);
+    HashGrid<Quad> moved (std::move(copy));
+    EXPECT_EQ(moved.get({10.5, 0.5}), expected_candidates(10));
+}
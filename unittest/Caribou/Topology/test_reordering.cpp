@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "topology_test.h"
+#include <Caribou/Geometry/Hexahedron.h>
+#include <Caribou/Topology/Mesh.h>
+#include <Caribou/Topology/Reordering.h>
+
+#include <random>
+
+using namespace caribou;
+using namespace caribou::geometry;
+using namespace caribou::topology;
+
+namespace {
+
+// Maximum distance between the indices of two nodes of a same element
+template <typename Domain>
+auto bandwidth(const Domain & domain) -> UNSIGNED_INTEGER_TYPE {
+    UNSIGNED_INTEGER_TYPE b = 0;
+    for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < domain.number_of_elements(); ++element_id) {
+        const auto indices = domain.element_indices(element_id);
+        b = std::max(b, static_cast<UNSIGNED_INTEGER_TYPE>(indices.maxCoeff() - indices.minCoeff()));
+    }
+    return b;
+}
+
+auto is_permutation(const std::vector<UNSIGNED_INTEGER_TYPE> & order, const std::size_t & size) -> bool {
+    std::vector<UNSIGNED_INTEGER_TYPE> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        if (sorted[i] != i) {
+            return false;
+        }
+    }
+    return sorted.size() == size;
+}
+
+} // namespace
+
+TEST(Reordering, Hexahedrons) {
+    using Mesh = Mesh<_3D>;
+    using Domain = Domain<Hexahedron>;
+
+    // A 8x4x2 grid of hexahedrons, with its nodes and elements shuffled
+    const int nx = 8, ny = 4, nz = 2;
+    const auto number_of_nodes = static_cast<std::size_t>((nx+1)*(ny+1)*(nz+1));
+    std::vector<UNSIGNED_INTEGER_TYPE> shuffled_nodes (number_of_nodes);
+    std::iota(shuffled_nodes.begin(), shuffled_nodes.end(), 0);
+    std::mt19937 generator (0);
+    std::shuffle(shuffled_nodes.begin(), shuffled_nodes.end(), generator);
+
+    std::vector<Mesh::WorldCoordinates> positions (number_of_nodes);
+    const auto id = [&](int i, int j, int k) {
+        return shuffled_nodes[static_cast<std::size_t>(k*(nx+1)*(ny+1) + j*(nx+1) + i)];
+    };
+    for (int k = 0; k <= nz; ++k) {
+        for (int j = 0; j <= ny; ++j) {
+            for (int i = 0; i <= nx; ++i) {
+                positions[id(i, j, k)] = {static_cast<FLOATING_POINT_TYPE>(i), static_cast<FLOATING_POINT_TYPE>(j), static_cast<FLOATING_POINT_TYPE>(k)};
+            }
+        }
+    }
+    Mesh mesh (positions);
+
+    Domain::ElementsIndices indices (nx*ny*nz, 8);
+    std::vector<int> shuffled_elements (static_cast<std::size_t>(nx*ny*nz));
+    std::iota(shuffled_elements.begin(), shuffled_elements.end(), 0);
+    std::shuffle(shuffled_elements.begin(), shuffled_elements.end(), generator);
+    for (int k = 0, e = 0; k < nz; ++k) {
+        for (int j = 0; j < ny; ++j) {
+            for (int i = 0; i < nx; ++i, ++e) {
+                indices.row(shuffled_elements[static_cast<std::size_t>(e)]) << id(i, j, k), id(i+1, j, k), id(i+1, j+1, k), id(i, j+1, k),
+                                                                               id(i, j, k+1), id(i+1, j, k+1), id(i+1, j+1, k+1), id(i, j+1, k+1);
+            }
+        }
+    }
+    const Domain * domain = mesh.add_domain<Hexahedron>("hexahedrons", indices);
+
+    for (const auto & ordering : {NodeOrdering::None, NodeOrdering::ReverseCuthillMcKee, NodeOrdering::Morton}) {
+        const auto [reordered_mesh, reordering] = reorder(mesh, *domain, ordering);
+        ASSERT_TRUE(is_permutation(reordering.node_order, mesh.number_of_nodes()));
+        ASSERT_TRUE(is_permutation(reordering.element_order, domain->number_of_elements()));
+        ASSERT_EQ(reordered_mesh->number_of_domains(), 1);
+
+        const auto * reordered_domain = dynamic_cast<const Domain *>(reordered_mesh->domain("hexahedrons"));
+        ASSERT_NE(reordered_domain, nullptr);
+
+        // The reordered elements are the same as the original ones
+        for (UNSIGNED_INTEGER_TYPE element_id = 0; element_id < reordered_domain->number_of_elements(); ++element_id) {
+            EXPECT_MATRIX_EQUAL(reordered_domain->element(element_id).nodes(), domain->element(reordering.element_order[element_id]).nodes());
+        }
+
+        // The elements are sorted by their minimum node
+        for (UNSIGNED_INTEGER_TYPE element_id = 1; element_id < reordered_domain->number_of_elements(); ++element_id) {
+            EXPECT_LE(reordered_domain->element_indices(element_id-1).minCoeff(), reordered_domain->element_indices(element_id).minCoeff());
+        }
+
+        if (ordering == NodeOrdering::None) {
+            EXPECT_EQ(bandwidth(*reordered_domain), bandwidth(*domain));
+        } else {
+            EXPECT_LT(bandwidth(*reordered_domain), bandwidth(*domain));
+        }
+
+        if (ordering == NodeOrdering::ReverseCuthillMcKee) {
+            // Optimal bandwidth of a structured grid numbered along its longest axis last
+            EXPECT_LE(bandwidth(*reordered_domain), static_cast<UNSIGNED_INTEGER_TYPE>(2*(nz+1)*(ny+1)));
+        }
+    }
+}
@@ -5,6 +5,7 @@
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #include <SofaCaribou/Algebra/BaseVectorOperations.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
 
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 211299)
 #include <SofaBaseLinearSolver/FullVector.h>
@@ -70,3 +71,59 @@ TEST(Algebra, SofaFullFFullDDotProduct) {
 
     EXPECT_NEAR(SofaCaribou::Algebra::dot(&sofa_v1, &sofa_v2), v1.cast<double>().dot(v2), 1e-10);
 }
+
+TEST(Algebra, SofaFullDEigenFDotProduct) {
+    const auto n = 100;
+    const Eigen::VectorXd v1 = Eigen::VectorXd::Random(n);
+    Eigen::VectorXf v2 = Eigen::VectorXf::Random(n);
+
+    FullVector<double> sofa_v1 (n);
+    for (sofa::Index i = 0; i < n; ++i) {
+        sofa_v1[i] = v1[static_cast<Eigen::Index>(i)];
+    }
+
+    Eigen::Map<Eigen::VectorXf> v2_map (v2.data(), n);
+    SofaCaribou::Algebra::EigenVector<Eigen::Map<Eigen::VectorXf>> eigen_v2 (v2_map);
+
+    EXPECT_NEAR(SofaCaribou::Algebra::dot(&sofa_v1, &eigen_v2), v1.dot(v2.cast<double>()), 1e-10);
+    EXPECT_NEAR(SofaCaribou::Algebra::norm(&sofa_v1), v1.norm(), 1e-10);
+}
+
+TEST(Algebra, EigenDEigenDAxpy) {
+    const auto n = 100;
+    Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+    Eigen::VectorXd y = Eigen::VectorXd::Random(n);
+
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> eigen_x (x);
+    SofaCaribou::Algebra::EigenVector<Eigen::VectorXd> eigen_y (y);
+
+    SofaCaribou::Algebra::axpy(2., &eigen_x, &eigen_y);
+    EXPECT_NEAR((eigen_y.vector() - (2.*x + y)).norm(), 0., 1e-10);
+
+    SofaCaribou::Algebra::axpby(2., &eigen_x, -1., &eigen_y);
+    EXPECT_NEAR((eigen_y.vector() - (-y)).norm(), 0., 1e-10);
+
+    const auto squared_norm = SofaCaribou::Algebra::axpy_dot(1., &eigen_x, &eigen_y);
+    EXPECT_NEAR((eigen_y.vector() - (x - y)).norm(), 0., 1e-10);
+    EXPECT_NEAR(squared_norm, (x - y).squaredNorm(), 1e-10);
+}
+
+TEST(Algebra, SofaFullDFullFAxpyDot) {
+    const auto n = 100;
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+    const Eigen::VectorXf y = Eigen::VectorXf::Random(n);
+
+    FullVector<double> sofa_x (n);
+    FullVector<float> sofa_y (n);
+
+    for (sofa::Index i = 0; i < n; ++i) {
+        sofa_x[i] = x[static_cast<Eigen::Index>(i)];
+        sofa_y[i] = y[static_cast<Eigen::Index>(i)];
+    }
+
+    const Eigen::VectorXd expected = (x + y.cast<double>());
+    EXPECT_NEAR(SofaCaribou::Algebra::axpy_dot(1., &sofa_x, &sofa_y), expected.squaredNorm(), 1e-4);
+    for (sofa::Index i = 0; i < n; ++i) {
+        EXPECT_NEAR(sofa_y[i], expected[static_cast<Eigen::Index>(i)], 1e-6);
+    }
+}
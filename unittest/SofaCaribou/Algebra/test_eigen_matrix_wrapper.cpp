@@ -196,3 +196,87 @@ TEST(Algebra, SparseMatrixByReference) {
     EXPECT_EQ(mm(30, 30), 200);
     EXPECT_EQ(m.coeff(30, 30), 200);
 }
+
+template <typename EigenSparse>
+void test_symmetric_storage() {
+    using EigenMatrix = SofaCaribou::Algebra::EigenMatrix<EigenSparse>;
+    using Index = typename EigenMatrix::Index;
+
+    // Random symmetric matrix with a sparse pattern
+    const Index N = 30;
+    Eigen::MatrixXd dense = Eigen::MatrixXd::Random(N, N);
+    dense = (dense + dense.transpose()).eval();
+    for (Index i=0;i<N;++i) for (Index j=0;j<N;++j)
+        if ((i+j) % 4 == 1) dense(i, j) = 0;
+
+    // Assemble both the full and the symmetric storage matrices with the same (complete) contributions
+    EigenMatrix full(N, N), upper(N, N);
+    upper.set_symmetric_storage(true);
+    EXPECT_TRUE(upper.symmetric());
+    for (Index i=0;i<N;++i) for (Index j=0;j<N;++j) {
+        if (dense(i, j) != 0) {
+            full.add(i, j, dense(i, j));
+            upper.add(i, j, dense(i, j));
+        }
+    }
+    full.add(3, 3, Mat3x3d(5));
+    upper.add(3, 3, Mat3x3d(5));
+    full.compress();
+    upper.compress();
+
+    // Only the upper triangular part is stored
+    EXPECT_EQ(upper.matrix().nonZeros(), EigenSparse(full.matrix().template triangularView<Eigen::Upper>()).nonZeros());
+    EXPECT_NEAR((EigenSparse(upper.matrix().template selfadjointView<Eigen::Upper>()) - full.matrix()).norm(), 0, 1e-12);
+
+    // Lower triangular entries are folded
+    int nb_not_equal = 0;
+    for (Index i=0;i<N;++i) for (Index j=0;j<N;++j)
+        if (upper(i,j) != full(i,j)) nb_not_equal++;
+    EXPECT_EQ(nb_not_equal, 0) << "There are " << nb_not_equal << " values that are not equal to the full matrix (and they should).";
+
+    upper.set(10, 2, 42.);
+    EXPECT_EQ(upper(2, 10), 42.);
+    full.set(10, 2, 42.);
+    full.set(2, 10, 42.);
+
+    // Clearing a row and a column (as done by the projective constraints)
+    full.clearRowCol(7);
+    upper.clearRowCol(7);
+    full.clearRowCol(21);
+    upper.clearRow(21);
+    full.clearRowCol(0); full.clearRowCol(1); full.clearRowCol(2);
+    upper.clearCols(0, 2);
+    EXPECT_NEAR((EigenSparse(upper.matrix().template selfadjointView<Eigen::Upper>()) - full.matrix()).norm(), 0, 1e-12);
+
+    // Adding a new coefficient changes the sparsity pattern, and the coefficients found when clearing a row and column
+    full.add(25, 7, 3.); full.add(7, 25, 3.);
+    upper.add(25, 7, 3.); upper.add(7, 25, 3.);
+    full.compress();
+    upper.compress();
+    EXPECT_EQ(upper(25, 7), 3.);
+    full.clearRowCol(25);
+    upper.clearRowCol(25);
+    EXPECT_NEAR((EigenSparse(upper.matrix().template selfadjointView<Eigen::Upper>()) - full.matrix()).norm(), 0, 1e-12);
+
+    // Contributions on both sides of the diagonal are folded to the upper entry, which stores their mean
+    EigenMatrix folded(N, N);
+    folded.set_symmetric_storage(true);
+    folded.add(9, 5, 2.);
+    folded.add(5, 9, 4.);
+    folded.add(6, 6, 1.);
+    Mat3x3d ones;
+    for (unsigned int k = 0; k < 3; ++k) for (unsigned int l = 0; l < 3; ++l) ones[k][l] = 1;
+    folded.add(12, 11, ones);
+    folded.compress();
+    EXPECT_EQ(folded(5, 9), 3.);
+    EXPECT_EQ(folded(9, 5), 3.);
+    EXPECT_EQ(folded(6, 6), 1.);
+    EXPECT_EQ(folded(11, 12), 0.5);
+    EXPECT_EQ(folded(12, 13), 1.);
+    EXPECT_EQ(folded(13, 14), 0.5);
+}
+
+TEST(Algebra, SparseMatrixSymmetricStorage) {
+    test_symmetric_storage<Eigen::SparseMatrix<double, Eigen::ColMajor>>();
+    test_symmetric_storage<Eigen::SparseMatrix<double, Eigen::RowMajor>>();
+}
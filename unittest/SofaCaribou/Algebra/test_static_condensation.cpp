@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Algebra/StaticCondensation.h>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+using SofaCaribou::Algebra::StaticCondensation;
+
+TEST(Algebra, StaticCondensation) {
+    // Block (3 dofs per node) system of a N x N x N grid where each node is coupled to its 26 neighbors
+    const int N = 6;
+    const int number_of_nodes = N*N*N;
+    const int n = 3*number_of_nodes;
+    auto node_index = [N](int i, int j, int k) { return (i*N + j)*N + k; };
+
+    std::vector<Eigen::Triplet<FLOATING_POINT_TYPE>> triplets;
+    for (int i = 0; i < N; ++i) for (int j = 0; j < N; ++j) for (int k = 0; k < N; ++k) {
+        const auto a = node_index(i, j, k);
+        for (int di = -1; di <= 1; ++di) for (int dj = -1; dj <= 1; ++dj) for (int dk = -1; dk <= 1; ++dk) {
+            const int ii = i+di, jj = j+dj, kk = k+dk;
+            if (ii < 0 or jj < 0 or kk < 0 or ii >= N or jj >= N or kk >= N) continue;
+            const auto b = node_index(ii, jj, kk);
+            for (int c = 0; c < 3; ++c) for (int d = 0; d < 3; ++d) {
+                const FLOATING_POINT_TYPE v = (a == b) ? (c == d ? 30. : 0.5) : -0.3 - 0.01*(c+d);
+                triplets.emplace_back(3*a+c, 3*b+d, v);
+            }
+        }
+    }
+    StaticCondensation::SparseMatrix A (n, n);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+
+    // Two nodes over three are candidates
+    std::vector<bool> candidates (static_cast<std::size_t>(n), false);
+    for (int a = 0; a < number_of_nodes; ++a) {
+        if (a % 3 != 0) {
+            candidates[static_cast<std::size_t>(3*a)] = candidates[static_cast<std::size_t>(3*a+1)] = candidates[static_cast<std::size_t>(3*a+2)] = true;
+        }
+    }
+
+    const StaticCondensation::Vector F = StaticCondensation::Vector::Random(n);
+    Eigen::SparseLU<StaticCondensation::SparseMatrix> full_solver (A);
+    const StaticCondensation::Vector X_ref = full_solver.solve(F);
+
+    for (const Eigen::Index patch_size : {1, 4, 12}) {
+        StaticCondensation condensation;
+        condensation.analyze_pattern(A, candidates, 3, patch_size);
+        EXPECT_EQ(condensation.number_of_dofs(), n);
+        EXPECT_GT(condensation.number_of_condensed_dofs(), 0);
+        EXPECT_EQ(condensation.number_of_condensed_dofs() % 3, 0);
+        ASSERT_TRUE(condensation.condense(A));
+        EXPECT_EQ(condensation.S().rows(), condensation.number_of_kept_dofs());
+
+        StaticCondensation::Vector F_kept, X;
+        condensation.condense_rhs(F, F_kept);
+        Eigen::SparseLU<StaticCondensation::SparseMatrix> condensed_solver (condensation.S());
+        const StaticCondensation::Vector X_kept = condensed_solver.solve(F_kept);
+        condensation.recover(F, X_kept, X);
+
+        EXPECT_NEAR((X - X_ref).norm() / X_ref.norm(), 0, 1e-10);
+    }
+}
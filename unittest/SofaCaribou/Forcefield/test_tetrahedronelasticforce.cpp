@@ -0,0 +1,231 @@
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+#include <sofa/helper/testing/BaseTest.h>
+#else
+#include <sofa/testing/BaseTest.h>
+#endif
+#include <sofa/simulation/Node.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <SofaCaribou/Forcefield/TetrahedronElasticForce.h>
+#include <SofaCaribou/Algebra/EigenMatrix.h>
+
+#include <array>
+#include <cmath>
+#include <sstream>
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+using namespace SofaCaribou::forcefield;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
+using namespace sofa::helper::testing;
+#else
+using namespace sofa::testing;
+#endif
+
+namespace {
+
+using MechanicalObject = sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types>;
+using Real = TetrahedronElasticForce::Real;
+using VecCoord = TetrahedronElasticForce::VecCoord;
+using VecDeriv = TetrahedronElasticForce::VecDeriv;
+
+struct Scene {
+    Node::SPtr root;
+    MechanicalObject * mo;
+    TetrahedronElasticForce * forcefield;
+};
+
+/**
+ * Create a 3x3x3 grid of unit cubes, each of them being split into six tetrahedra around its diagonal. The first node
+ * of the grid is slightly moved, such that only the six tetrahedra of the first cube differ from the others.
+ */
+Scene create_scene(const std::string & share_stiffness_matrices, const std::string & enable_multithreading) {
+    constexpr int n = 4; // Number of nodes in each direction
+    const auto node = [](int i, int j, int k) {return i + n*j + n*n*k;};
+
+    std::ostringstream positions;
+    for (int k = 0; k < n; ++k) {
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                if (node(i, j, k) == 0) {
+                    positions << 1e-1 << " " << -2e-1 << " " << 1.5e-1 << " ";
+                } else {
+                    positions << i << " " << j << " " << k << " ";
+                }
+            }
+        }
+    }
+
+    // Each tetrahedron of a cube goes from its first to its last corner by moving along the axes in a given order. The
+    // two middle nodes are swapped for odd permutations of the axes to keep a positive volume.
+    const std::array<std::array<int, 3>, 6> axes_orders {{{0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {0, 2, 1}, {2, 1, 0}, {1, 0, 2}}};
+    std::ostringstream tetrahedra;
+    for (int k = 0; k < n-1; ++k) {
+        for (int j = 0; j < n-1; ++j) {
+            for (int i = 0; i < n-1; ++i) {
+                for (std::size_t t = 0; t < axes_orders.size(); ++t) {
+                    std::array<int, 3> corner {i, j, k};
+                    std::array<int, 4> tetrahedron {};
+                    tetrahedron[0] = node(corner[0], corner[1], corner[2]);
+                    for (std::size_t a = 0; a < 3; ++a) {
+                        ++corner[static_cast<std::size_t>(axes_orders[t][a])];
+                        tetrahedron[a+1] = node(corner[0], corner[1], corner[2]);
+                    }
+                    if (t >= 3) {
+                        std::swap(tetrahedron[1], tetrahedron[2]);
+                    }
+                    tetrahedra << tetrahedron[0] << " " << tetrahedron[1] << " " << tetrahedron[2] << " " << tetrahedron[3] << " ";
+                }
+            }
+        }
+    }
+
+    Scene scene;
+    scene.root = getSimulation()->createNewNode("root");
+    createObject(scene.root, "DefaultAnimationLoop");
+    createObject(scene.root, "DefaultVisualManagerLoop");
+    scene.mo = dynamic_cast<MechanicalObject *>(
+        createObject(scene.root, "MechanicalObject", {{"name", "mo"}, {"position", positions.str()}}).get()
+    );
+    createObject(scene.root, "TetrahedronSetTopologyContainer", {{"name", "topology"}, {"tetrahedra", tetrahedra.str()}});
+    scene.forcefield = dynamic_cast<TetrahedronElasticForce *>(
+        createObject(scene.root, "TetrahedronElasticForce", {
+            {"topology_container", "@topology"},
+            {"youngModulus", "3000"},
+            {"poissonRatio", "0.3"},
+            {"corotated", "true"},
+            {"share_stiffness_matrices", share_stiffness_matrices},
+            {"enable_multithreading", enable_multithreading}
+        }).get()
+    );
+    getSimulation()->init(scene.root.get());
+
+    return scene;
+}
+
+/** Rotate the nodes of the scene around the z axis and add a small deformation */
+void deform(Scene & scene) {
+    sofa::helper::WriteAccessor<sofa::core::objectmodel::Data<VecCoord>> x = scene.mo->x;
+    const Real c = std::cos(Real(0.3)), s = std::sin(Real(0.3));
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        const auto p = x[i];
+        const Real d = Real(0.05)*std::sin(static_cast<Real>(i));
+        x[i][0] = c*p[0] - s*p[1] + d;
+        x[i][1] = s*p[0] + c*p[1] - d;
+        x[i][2] = p[2] + d*p[2];
+    }
+}
+
+/** Compute the internal force vector at the current positions of the scene */
+Eigen::Matrix<Real, Eigen::Dynamic, 1> force(Scene & scene) {
+    sofa::core::MechanicalParams mechanical_parameters;
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+    sofa::core::objectmodel::Data<VecDeriv> d_f (VecDeriv(static_cast<int>(scene.mo->getSize()), {0, 0, 0}));
+#else
+    sofa::core::objectmodel::Data<VecDeriv> d_f (VecDeriv(scene.mo->getSize(), {0, 0, 0}));
+#endif
+    scene.forcefield->addForce(&mechanical_parameters, d_f, scene.mo->x, scene.mo->v);
+    return Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>>(d_f.getValue().data()->data(), scene.mo->getSize()*3);
+}
+
+/** Compute the force differential for a given displacement */
+Eigen::Matrix<Real, Eigen::Dynamic, 1> dforce(Scene & scene) {
+    sofa::core::MechanicalParams mechanical_parameters;
+    mechanical_parameters.setKFactor(1);
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+    VecDeriv dx (static_cast<int>(scene.mo->getSize()), {0, 0, 0});
+    sofa::core::objectmodel::Data<VecDeriv> d_df (VecDeriv(static_cast<int>(scene.mo->getSize()), {0, 0, 0}));
+#else
+    VecDeriv dx (scene.mo->getSize(), {0, 0, 0});
+    sofa::core::objectmodel::Data<VecDeriv> d_df (VecDeriv(scene.mo->getSize(), {0, 0, 0}));
+#endif
+    for (std::size_t i = 0; i < dx.size(); ++i) {
+        dx[i] = {std::cos(static_cast<Real>(i)), Real(0.5), std::sin(static_cast<Real>(2*i))};
+    }
+    sofa::core::objectmodel::Data<VecDeriv> d_dx (dx);
+    scene.forcefield->addDForce(&mechanical_parameters, d_df, d_dx);
+    return Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>>(d_df.getValue().data()->data(), scene.mo->getSize()*3);
+}
+
+/** Assemble the complete tangent stiffness matrix */
+Eigen::SparseMatrix<Real> stiffness_matrix(Scene & scene) {
+    SofaCaribou::Algebra::EigenMatrix<Eigen::SparseMatrix<Real>> K;
+    K.resize(static_cast<int>(scene.mo->getSize()*3), static_cast<int>(scene.mo->getSize()*3));
+    unsigned int offset = 0;
+    scene.forcefield->addKToMatrix(&K, 1, offset);
+    K.compress();
+    return K.matrix();
+}
+
+} // namespace
+
+TEST(TetrahedronElasticForce, SharedStiffnessMatrices) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto distinct = create_scene("false", "false");
+    auto shared = create_scene("true", "false");
+
+    // The tetrahedra of the perturbed cube get their own stiffness matrices, the others share the six of a cube
+    EXPECT_EQ(distinct.forcefield->number_of_stiffness_matrices(), 27*6);
+    EXPECT_EQ(shared.forcefield->number_of_stiffness_matrices(), 2*6);
+
+    EXPECT_NEAR((stiffness_matrix(shared) - stiffness_matrix(distinct)).norm() / stiffness_matrix(distinct).norm(), 0, 1e-10);
+
+    // Same forces and tangent stiffness matrix on the rotated and deformed grid
+    deform(distinct);
+    deform(shared);
+
+    const auto f_distinct = force(distinct);
+    const auto f_shared = force(shared);
+    EXPECT_GT(f_distinct.norm(), 0);
+    EXPECT_NEAR((f_shared - f_distinct).norm() / f_distinct.norm(), 0, 1e-10);
+
+    const auto df_distinct = dforce(distinct);
+    const auto df_shared = dforce(shared);
+    EXPECT_GT(df_distinct.norm(), 0);
+    EXPECT_NEAR((df_shared - df_distinct).norm() / df_distinct.norm(), 0, 1e-10);
+
+    const Eigen::SparseMatrix<Real> K_distinct = stiffness_matrix(distinct);
+    const Eigen::SparseMatrix<Real> K_shared = stiffness_matrix(shared);
+    EXPECT_NEAR((K_shared - K_distinct).norm() / K_distinct.norm(), 0, 1e-10);
+}
+
+TEST(TetrahedronElasticForce, Multithreading) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto serial = create_scene("false", "false");
+    auto parallel = create_scene("false", "true");
+
+    EXPECT_NEAR((stiffness_matrix(parallel) - stiffness_matrix(serial)).norm() / stiffness_matrix(serial).norm(), 0, 1e-10);
+
+    // Same forces and tangent stiffness matrix on the rotated and deformed grid
+    deform(serial);
+    deform(parallel);
+
+    const auto f_serial = force(serial);
+    const auto f_parallel = force(parallel);
+    EXPECT_GT(f_serial.norm(), 0);
+    EXPECT_NEAR((f_parallel - f_serial).norm() / f_serial.norm(), 0, 1e-10);
+
+    const auto df_serial = dforce(serial);
+    const auto df_parallel = dforce(parallel);
+    EXPECT_GT(df_serial.norm(), 0);
+    EXPECT_NEAR((df_parallel - df_serial).norm() / df_serial.norm(), 0, 1e-10);
+
+    const Eigen::SparseMatrix<Real> K_serial = stiffness_matrix(serial);
+    const Eigen::SparseMatrix<Real> K_parallel = stiffness_matrix(parallel);
+    EXPECT_NEAR((K_parallel - K_serial).norm() / K_serial.norm(), 0, 1e-10);
+}
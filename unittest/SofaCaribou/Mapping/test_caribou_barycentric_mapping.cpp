@@ -0,0 +1,324 @@
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+#include <sofa/helper/testing/BaseTest.h>
+#else
+#include <sofa/testing/BaseTest.h>
+#endif
+#include <sofa/core/ConstraintParams.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <SofaBaseLinearSolver/DefaultMultiMatrixAccessor.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+DISABLE_ALL_WARNINGS_END
+
+#include <SofaCaribou/Algebra/EigenMatrix.h>
+#include <SofaCaribou/Algebra/MappedMatrices.h>
+#include <SofaCaribou/Mapping/CaribouBarycentricMapping[Hexahedron].h>
+
+#include <cmath>
+#include <map>
+#include <sstream>
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
+using namespace sofa::helper::testing;
+#else
+using namespace sofa::testing;
+#endif
+
+namespace {
+
+using MechanicalObject = sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types>;
+using Mapping = SofaCaribou::mapping::CaribouBarycentricMapping<caribou::geometry::Hexahedron, sofa::defaulttype::Vec3Types>;
+using VecCoord = sofa::defaulttype::Vec3Types::VecCoord;
+using VecDeriv = sofa::defaulttype::Vec3Types::VecDeriv;
+using MatrixDeriv = sofa::defaulttype::Vec3Types::MatrixDeriv;
+using Deriv = sofa::defaulttype::Vec3Types::Deriv;
+using Dense = Eigen::Matrix<SReal, Eigen::Dynamic, Eigen::Dynamic>;
+using Vector = Eigen::Matrix<SReal, Eigen::Dynamic, 1>;
+
+struct Scene {
+    Node::SPtr root;
+    MechanicalObject * other;
+    MechanicalObject * parent;
+    MechanicalObject * mapped;
+    Mapping * mapping;
+};
+
+/**
+ * Create a 2x2x2 grid of unit hexahedra, its middle node being slightly moved, in which a few nodes are embedded.
+ * Another mechanical object is added before the grid, such that the parent nodes are not at the beginning of the
+ * global system.
+ */
+Scene create_scene(const std::string & enable_multithreading) {
+    constexpr int n = 3; // Number of nodes in each direction
+    const auto node = [](int i, int j, int k) {return i + n*j + n*n*k;};
+
+    std::ostringstream positions;
+    for (int k = 0; k < n; ++k) {
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                if (node(i, j, k) == node(1, 1, 1)) {
+                    positions << 1.1 << " " << 0.95 << " " << 1.08 << " ";
+                } else {
+                    positions << i << " " << j << " " << k << " ";
+                }
+            }
+        }
+    }
+
+    std::ostringstream hexahedra;
+    for (int k = 0; k < n-1; ++k) {
+        for (int j = 0; j < n-1; ++j) {
+            for (int i = 0; i < n-1; ++i) {
+                hexahedra << node(i, j, k)   << " " << node(i+1, j, k)   << " " << node(i+1, j+1, k)   << " " << node(i, j+1, k)   << " "
+                          << node(i, j, k+1) << " " << node(i+1, j, k+1) << " " << node(i+1, j+1, k+1) << " " << node(i, j+1, k+1) << " ";
+            }
+        }
+    }
+
+    const std::string mapped_positions =
+        "0.5 0.5 0.5  1.2 0.3 1.7  1.9 1.1 0.4  0.25 1.75 1.5  1.5 1.5 1.5  0.1 0.9 0.2  1.6 0.6 0.6  0.7 1.3 1.9";
+
+    Scene scene;
+    scene.root = getSimulation()->createNewNode("root");
+    createObject(scene.root, "DefaultAnimationLoop");
+    createObject(scene.root, "DefaultVisualManagerLoop");
+
+    auto other = createChild(scene.root, "other");
+    scene.other = dynamic_cast<MechanicalObject *>(
+        createObject(other, "MechanicalObject", {{"position", "5 5 5  6 6 6"}}).get()
+    );
+
+    auto parent = createChild(scene.root, "parent");
+    scene.parent = dynamic_cast<MechanicalObject *>(
+        createObject(parent, "MechanicalObject", {{"name", "mo"}, {"position", positions.str()}}).get()
+    );
+    createObject(parent, "CaribouTopology", {{"name", "topology"}, {"template", "Hexahedron"}, {"indices", hexahedra.str()}, {"position", "@mo.position"}});
+
+    auto mapped = createChild(parent, "mapped");
+    scene.mapped = dynamic_cast<MechanicalObject *>(
+        createObject(mapped, "MechanicalObject", {{"position", mapped_positions}}).get()
+    );
+    scene.mapping = dynamic_cast<Mapping *>(
+        createObject(mapped, "CaribouBarycentricMapping", {
+            {"topology", "@../topology"},
+            {"mapMatrices", "true"},
+            {"enable_multithreading", enable_multithreading}
+        }).get()
+    );
+
+    getSimulation()->init(scene.root.get());
+
+    return scene;
+}
+
+/** Dense copy of the Jacobian of the mapping */
+Dense jacobian(Mapping * mapping) {
+    const auto * J = dynamic_cast<const SofaCaribou::Algebra::SparseJacobian *>(mapping->getJ());
+    if (not J) {
+        return {};
+    }
+    return Dense(J->matrix());
+}
+
+/** Vector of n nodes, the node i being f(i) */
+template <typename VecType, typename Function>
+VecType make_nodes(std::size_t n, Function f) {
+    VecType v;
+    v.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = f(static_cast<SReal>(i));
+    }
+    return v;
+}
+
+/** Entries of each row of a constraint matrix, indexed by row and column */
+std::map<std::pair<int, int>, Deriv> constraint_entries(const MatrixDeriv & H) {
+    std::map<std::pair<int, int>, Deriv> entries;
+    for (auto row = H.begin(); row != H.end(); ++row) {
+        for (auto col = row.begin(); col != row.end(); ++col) {
+            const auto key = std::make_pair(static_cast<int>(row.index()), static_cast<int>(col.index()));
+            EXPECT_EQ(entries.count(key), 0) << "Node " << col.index() << " is written more than once in row " << row.index();
+            entries[key] += col.val();
+        }
+    }
+    return entries;
+}
+
+/** Flatten a vector of nodes into a vector of degrees of freedom */
+template <typename VecType>
+Vector flatten(const VecType & v) {
+    return Eigen::Map<const Vector>(v.data()->data(), static_cast<Eigen::Index>(v.size()*3));
+}
+
+} // namespace
+
+TEST(CaribouBarycentricMapping, MappedMatrices) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto scene = create_scene("false");
+
+    // The Jacobian interpolates the rest positions of the mapped nodes from the ones of the parent nodes
+    const Dense J = jacobian(scene.mapping);
+    ASSERT_EQ(J.rows(), static_cast<Eigen::Index>(scene.mapped->getSize()*3));
+    ASSERT_EQ(J.cols(), static_cast<Eigen::Index>(scene.parent->getSize()*3));
+    const Vector X = flatten(scene.parent->readRestPositions().ref());
+    const Vector X_mapped = flatten(scene.mapped->readRestPositions().ref());
+    EXPECT_NEAR((J*X - X_mapped).norm(), 0, 1e-10);
+
+    // Each mapped degree of freedom only depends on the same degree of freedom of the parent nodes
+    for (Eigen::Index i = 0; i < J.rows(); ++i) {
+        for (Eigen::Index j = 0; j < J.cols(); ++j) {
+            if (i % 3 != j % 3) {
+                EXPECT_EQ(J(i, j), 0);
+            }
+        }
+        EXPECT_NEAR(J.row(i).sum(), 1, 1e-10);
+    }
+
+    // Setup the global system
+    sofa::core::MechanicalParams mechanical_parameters;
+    sofa::simulation::common::MechanicalOperations mop (&mechanical_parameters, scene.root.get());
+    sofa::component::linearsolver::DefaultMultiMatrixAccessor accessor;
+    mop.getMatrixDimension(nullptr, nullptr, &accessor);
+    accessor.setupMatrices();
+
+    const auto n = static_cast<Eigen::Index>(accessor.getGlobalDimension());
+    SofaCaribou::Algebra::EigenMatrix<Eigen::SparseMatrix<SReal>> A;
+    A.resize(n, n);
+    accessor.setGlobalMatrix(&A);
+
+    const auto offset = static_cast<Eigen::Index>(accessor.getMatrix(scene.parent).offset);
+    EXPECT_EQ(offset, static_cast<Eigen::Index>(scene.other->getSize()*3));
+
+    // Assemble a dense symmetric matrix on the mapped nodes
+    const auto m = J.rows();
+    Dense K (m, m);
+    for (Eigen::Index i = 0; i < m; ++i) {
+        for (Eigen::Index j = 0; j < m; ++j) {
+            K(i, j) = std::cos(static_cast<SReal>(i*m + j)) + std::cos(static_cast<SReal>(j*m + i));
+        }
+    }
+
+    auto mapped_matrix = accessor.getMatrix(scene.mapped);
+    ASSERT_NE(mapped_matrix.matrix, nullptr);
+    for (Eigen::Index i = 0; i < m; ++i) {
+        for (Eigen::Index j = 0; j < m; ++j) {
+            mapped_matrix.matrix->add(mapped_matrix.offset + i, mapped_matrix.offset + j, K(i, j));
+        }
+    }
+
+    // Project it onto the parent nodes
+    SofaCaribou::Algebra::add_mapped_matrices(accessor, scene.root.get());
+    A.compress();
+
+    Dense expected = Dense::Zero(n, n);
+    expected.block(offset, offset, J.cols(), J.cols()) = J.transpose()*K*J;
+    EXPECT_NEAR((Dense(A.matrix()) - expected).norm() / expected.norm(), 0, 1e-10);
+}
+
+TEST(CaribouBarycentricMapping, Multithreading) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto serial = create_scene("false");
+    auto parallel = create_scene("true");
+
+    const Dense J = jacobian(serial.mapping);
+    EXPECT_NEAR((jacobian(parallel.mapping) - J).norm(), 0, 1e-12);
+
+    const auto number_of_parent_nodes = serial.parent->getSize();
+    const auto number_of_mapped_nodes = serial.mapped->getSize();
+    sofa::core::MechanicalParams mechanical_parameters;
+
+    // Positions
+    const sofa::core::objectmodel::Data<VecCoord> x (make_nodes<VecCoord>(number_of_parent_nodes, [](SReal i) {
+        return sofa::defaulttype::Vec3Types::Coord(i + std::sin(i), 2*i, std::cos(3*i));
+    }));
+    sofa::core::objectmodel::Data<VecCoord> x_serial (make_nodes<VecCoord>(number_of_mapped_nodes, [](SReal) {return sofa::defaulttype::Vec3Types::Coord();}));
+    sofa::core::objectmodel::Data<VecCoord> x_parallel (x_serial.getValue());
+    serial.mapping->apply(&mechanical_parameters, x_serial, x);
+    parallel.mapping->apply(&mechanical_parameters, x_parallel, x);
+    EXPECT_NEAR((flatten(x_serial.getValue()) - J*flatten(x.getValue())).norm(), 0, 1e-10);
+    EXPECT_NEAR((flatten(x_parallel.getValue()) - flatten(x_serial.getValue())).norm(), 0, 1e-10);
+
+    // Velocities
+    const sofa::core::objectmodel::Data<VecDeriv> v (make_nodes<VecDeriv>(number_of_parent_nodes, [](SReal i) {
+        return Deriv(std::cos(i), -i, 0.5*i);
+    }));
+    sofa::core::objectmodel::Data<VecDeriv> v_serial (make_nodes<VecDeriv>(number_of_mapped_nodes, [](SReal) {return Deriv();}));
+    sofa::core::objectmodel::Data<VecDeriv> v_parallel (v_serial.getValue());
+    serial.mapping->applyJ(&mechanical_parameters, v_serial, v);
+    parallel.mapping->applyJ(&mechanical_parameters, v_parallel, v);
+    EXPECT_NEAR((flatten(v_serial.getValue()) - J*flatten(v.getValue())).norm(), 0, 1e-10);
+    EXPECT_NEAR((flatten(v_parallel.getValue()) - flatten(v_serial.getValue())).norm(), 0, 1e-10);
+
+    // Forces, which are accumulated into the parent forces
+    const sofa::core::objectmodel::Data<VecDeriv> f_mapped (make_nodes<VecDeriv>(number_of_mapped_nodes, [](SReal i) {
+        return Deriv(1 + i, std::sin(2*i), -i);
+    }));
+    const VecDeriv f0 = make_nodes<VecDeriv>(number_of_parent_nodes, [](SReal i) {return Deriv(i, 1, -1);});
+    sofa::core::objectmodel::Data<VecDeriv> f_serial (f0);
+    sofa::core::objectmodel::Data<VecDeriv> f_parallel (f0);
+    serial.mapping->applyJT(&mechanical_parameters, f_serial, f_mapped);
+    parallel.mapping->applyJT(&mechanical_parameters, f_parallel, f_mapped);
+    EXPECT_NEAR((flatten(f_serial.getValue()) - (flatten(f0) + J.transpose()*flatten(f_mapped.getValue()))).norm(), 0, 1e-10);
+    EXPECT_NEAR((flatten(f_parallel.getValue()) - flatten(f_serial.getValue())).norm(), 0, 1e-10);
+
+    // Constraints. Every hexahedron contains the middle node of the grid, hence the mapped nodes of a row having
+    // several nodes share some of their parent nodes, whose contributions are merged.
+    const std::vector<std::pair<int, std::vector<std::size_t>>> rows {
+        {0, {0, 4}}, {2, {3}}, {5, {1, 2, 3, 5}}, {6, {7, 6, 0}}
+    };
+    sofa::core::objectmodel::Data<MatrixDeriv> H_mapped;
+    {
+        auto H = sofa::helper::WriteAccessor<sofa::core::objectmodel::Data<MatrixDeriv>>(H_mapped);
+        for (const auto & row : rows) {
+            auto line = H->writeLine(row.first);
+            for (const auto & mapped_node : row.second) {
+                const auto value = static_cast<SReal>(row.first + mapped_node);
+                line.addCol(mapped_node, Deriv(1 + value, -value, std::cos(value)));
+            }
+        }
+    }
+
+    sofa::core::ConstraintParams constraint_parameters;
+    sofa::core::objectmodel::Data<MatrixDeriv> H_serial, H_parallel;
+    serial.mapping->applyJT(&constraint_parameters, H_serial, H_mapped);
+    parallel.mapping->applyJT(&constraint_parameters, H_parallel, H_mapped);
+
+    // Dense reference, every mapped node contributing to a parent node through its shape value J(3i, 3j)
+    std::map<std::pair<int, int>, Deriv> expected_entries;
+    for (const auto & [row_and_mapped_node, value] : constraint_entries(H_mapped.getValue())) {
+        const auto & [row, mapped_node] = row_and_mapped_node;
+        for (Eigen::Index parent_node = 0; parent_node < static_cast<Eigen::Index>(number_of_parent_nodes); ++parent_node) {
+            const auto shape_value = J(3*mapped_node, 3*parent_node);
+            if (shape_value != 0) {
+                expected_entries[{row, static_cast<int>(parent_node)}] += value*shape_value;
+            }
+        }
+    }
+
+    const auto entries_serial = constraint_entries(H_serial.getValue());
+    const auto entries_parallel = constraint_entries(H_parallel.getValue());
+    ASSERT_EQ(entries_serial.size(), expected_entries.size());
+    ASSERT_EQ(entries_parallel.size(), expected_entries.size());
+    for (const auto & [key, value] : expected_entries) {
+        ASSERT_EQ(entries_serial.count(key), 1) << "Missing node " << key.second << " in row " << key.first;
+        ASSERT_EQ(entries_parallel.count(key), 1) << "Missing node " << key.second << " in row " << key.first;
+        EXPECT_NEAR((entries_serial.at(key) - value).norm(), 0, 1e-10);
+        EXPECT_NEAR((entries_parallel.at(key) - entries_serial.at(key)).norm(), 0, 1e-10);
+    }
+}
@@ -161,6 +161,25 @@ TEST(CaribouMass, LinearTetrahedron) {
 
     EXPECT_DOUBLE_EQ(f_caribou.norm(), f_caribou_dia.norm());
     EXPECT_DOUBLE_EQ(f_caribou_dia.norm(), f_sofa_dia.norm());
+
+    // AccFromF using the cached factorization of the consistent mass matrix
+    caribou_mass->findData("lumped")->read("false");
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+    DataVecDeriv d_a (VecDeriv(static_cast<int>(mo->getSize()), {0, 0, 0}));
+#else
+    DataVecDeriv d_a (VecDeriv(mo->getSize(), {0, 0, 0}));
+#endif
+    caribou_mass->accFromF(&mechanical_parameters, d_a, d_f_caribou);
+
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> a ((d_a.getValue().data()->data()),  mo->getSize()*3);
+    Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> f ((d_f_caribou.getValue().data()->data()),  mo->getSize()*3);
+    EXPECT_NEAR((M*a - f).norm() / f.norm(), 0, 1e-10);
+
+    // Changing the density must refresh the factorization
+    const Eigen::Matrix<Real, Eigen::Dynamic, 1> a_density_2 = a;
+    caribou_mass->findData("density")->read("4");
+    caribou_mass->accFromF(&mechanical_parameters, d_a, d_f_caribou);
+    EXPECT_NEAR((2*a - a_density_2).norm() / a_density_2.norm(), 0, 1e-10);
 }
 
 TEST(CaribouMass, LinearHexahedron) {
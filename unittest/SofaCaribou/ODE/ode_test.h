@@ -0,0 +1,139 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <SofaCaribou/config.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#include <sofa/simulation/Node.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+DISABLE_ALL_WARNINGS_END
+
+namespace ode_test {
+
+using Attributes = std::map<std::string, std::string>;
+using MechanicalObject = sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types>;
+
+/** Parameters of the cantilever beam scene shared by the ODE solver tests. */
+struct BeamParameters {
+    /// Attributes of the ODE solver
+    Attributes solver {};
+
+    /// Attributes of the LDLTSolver
+    Attributes linear_solver {};
+
+    /// Material of the beam
+    std::string young_modulus = "3000";
+    std::string poisson_ratio = "0.499";
+
+    /// Use a non-corotated HexahedronElasticForce instead of an HyperelasticForcefield (Saint-Venant-Kirchhoff)
+    bool linear_elasticity = false;
+
+    /// Mass of the beam ("DiagonalMass", "CaribouMass" or empty for none), with a density of 0.2
+    std::string mass {};
+
+    /// Fix the nodes of the clamped end (z = 0)
+    bool fixed_end = true;
+
+    /// Slope of the traction (0, -30, 0) applied on the faces of the free end (z = 80), empty for none
+    std::string traction_slope {};
+
+    /// Total force applied on the nodes of the free end (z = 80), empty for none
+    std::string end_force {};
+};
+
+/** Cantilever beam scene, with its ODE solver of type Solver. */
+template <typename Solver>
+struct Beam {
+    sofa::simulation::Node::SPtr root;
+    sofa::simulation::Node::SPtr meca;
+    Solver * solver = nullptr;
+    MechanicalObject * mo = nullptr;
+
+    /** Current position of the node at the center of the free end of the beam */
+    auto middle_point() const -> sofa::defaulttype::Vec3Types::Coord {
+        return mo->read(sofa::core::ConstVecCoordId::position())->getValue()[76];
+    }
+};
+
+/**
+ * Create a new simulation containing a 15x15x80 beam made of 2x2x8 hexahedrons, solved by an ODE solver of the given
+ * type and a LDLTSolver. The scene is not initialized, hence the caller can still add components to it.
+ */
+template <typename Solver>
+auto create_beam(const std::string & solver_type, const BeamParameters & parameters) -> Beam<Solver> {
+    using namespace sofa::simpleapi;
+    using sofa::simulation::getSimulation;
+
+    sofa::simulation::setSimulation(new sofa::simulation::graph::DAGSimulation());
+
+    Beam<Solver> beam;
+    beam.root = getSimulation()->createNewNode("root");
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201200)
+    createObject(beam.root, "RequiredPlugin", {{"pluginName", "SofaBoundaryCondition SofaEngine SofaBaseMechanics"}});
+#else
+    createObject(beam.root, "RequiredPlugin", {{"pluginName", "SofaComponentAll"}});
+#endif
+
+    // Some component to avoid warnings
+    createObject(beam.root, "DefaultAnimationLoop");
+    createObject(beam.root, "DefaultVisualManagerLoop");
+
+    createObject(beam.root, "RegularGridTopology", {{"name", "grid"}, {"min", "-7.5 -7.5 0"}, {"max", "7.5 7.5 80"}, {"n", "3 3 9"}});
+
+    beam.meca = createChild(beam.root, "meca");
+    beam.solver = dynamic_cast<Solver *>(createObject(beam.meca, solver_type, parameters.solver).get());
+    createObject(beam.meca, "LDLTSolver", parameters.linear_solver);
+    beam.mo = dynamic_cast<MechanicalObject *>(
+        createObject(beam.meca, "MechanicalObject", {{"name", "mo"}, {"src", "@../grid"}}).get()
+    );
+
+    createObject(beam.meca, "HexahedronSetTopologyContainer", {{"name", "mechanical_topology"}, {"src", "@../grid"}});
+
+    // Mechanics
+    if (parameters.linear_elasticity) {
+        createObject(beam.meca, "HexahedronElasticForce", {
+            {"youngModulus", parameters.young_modulus}, {"poissonRatio", parameters.poisson_ratio}, {"corotated", "0"}
+        });
+    } else {
+        createObject(beam.meca, "SaintVenantKirchhoffMaterial", {
+            {"young_modulus", parameters.young_modulus}, {"poisson_ratio", parameters.poisson_ratio}
+        });
+        createObject(beam.meca, "HyperelasticForcefield");
+    }
+
+    if (parameters.mass == "DiagonalMass") {
+        createObject(beam.meca, "HexahedronSetGeometryAlgorithms");
+        createObject(beam.meca, "DiagonalMass", {{"massDensity", "0.2"}});
+    } else if (parameters.mass == "CaribouMass") {
+        createObject(beam.meca, "CaribouMass", {{"density", "0.2"}});
+    }
+
+    // Fix the left side of the beam
+    if (parameters.fixed_end) {
+        createObject(beam.meca, "BoxROI", {{"name", "fixed_roi"}, {"box", "-7.5 -7.5 -0.9 7.5 7.5 0.1"}});
+        createObject(beam.meca, "FixedConstraint", {{"name", "fixed_constraint"}, {"indices", "@fixed_roi.indices"}});
+    }
+
+    // Load the right side of the beam
+    if (not parameters.traction_slope.empty()) {
+        createObject(beam.meca, "BoxROI", {{"name", "traction_roi"}, {"box", "-7.5 -7.5 79.9 7.5 7.5 80.1"}});
+        createObject(beam.meca, "QuadSetTopologyContainer", {{"name", "traction_container"}, {"quads", "@traction_roi.quadInROI"}});
+        createObject(beam.meca, "TractionForcefield", {
+            {"traction", "0 -30 0"}, {"slope", parameters.traction_slope}, {"topology", "@traction_container"}
+        });
+    }
+
+    if (not parameters.end_force.empty()) {
+        createObject(beam.meca, "BoxROI", {{"name", "force_roi"}, {"box", "-7.5 -7.5 79.9 7.5 7.5 80.1"}});
+        createObject(beam.meca, "ConstantForceField", {{"indices", "@force_roi.indices"}, {"totalForce", parameters.end_force}});
+    }
+
+    return beam;
+}
+
+} // namespace ode_test
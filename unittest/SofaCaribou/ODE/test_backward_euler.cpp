@@ -1,8 +1,13 @@
 #include <array>
+#include <cmath>
+#include <string>
+#include <tuple>
 
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Ode/BackwardEulerODESolver.h>
 
+#include "ode_test.h"
+
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
@@ -183,3 +188,93 @@ TEST(BackwardEulerODESolver, Beam) {
 
     getSimulation()->unload(root);
 }
+
+/** Make sure the adaptive time stepping subdivides the time steps and keeps the simulation stable */
+TEST(BackwardEulerODESolver, AdaptiveBeam) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    ode_test::BeamParameters parameters;
+    parameters.solver = {
+        {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-5"}, {"residual_tolerance_threshold", "1e-5"},
+        {"adaptive_time_stepping", "1"}, {"absolute_error_tolerance", "1e-1"}, {"relative_error_tolerance", "1e-2"}
+    };
+    parameters.linear_solver = {{"backend", "Eigen"}};
+    parameters.young_modulus = "15000";
+    parameters.poisson_ratio = "0.3";
+    parameters.mass = "DiagonalMass";
+    auto beam = ode_test::create_beam<SofaCaribou::ode::BackwardEulerODESolver>("BackwardEulerODESolver", parameters);
+    auto * solver = beam.solver;
+
+    getSimulation()->init(beam.root.get());
+
+    const unsigned int number_of_steps = 10;
+    for (unsigned int step_id = 0; step_id < number_of_steps; ++step_id) {
+        getSimulation()->animate(beam.root.get(), 1);
+        EXPECT_EQ(solver->findData("converged")->getValueString(), "1") << "Time step # "<< step_id;
+    }
+
+    // A time step of 1 is way too large for the requested accuracy, it must have been subdivided
+    const auto number_of_accepted_steps = std::stoul(solver->findData("number_of_accepted_steps")->getValueString());
+    EXPECT_GT(number_of_accepted_steps, number_of_steps);
+
+    // The free end of the beam is falling under the gravity
+    const auto middle_point = beam.middle_point();
+    EXPECT_TRUE(std::isfinite(middle_point[1]));
+    EXPECT_LT(middle_point[1], 0);
+
+    // Resetting the simulation also resets the step counters
+    getSimulation()->reset(beam.root.get());
+    EXPECT_EQ(solver->findData("number_of_accepted_steps")->getValueString(), "0");
+    EXPECT_EQ(solver->findData("number_of_rejected_steps")->getValueString(), "0");
+
+    getSimulation()->unload(beam.root);
+}
+
+/** Make sure the factorization of a constant system matrix (linear elasticity) is reused between the time steps */
+TEST(BackwardEulerODESolver, LinearElasticFactorizationReuse) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    const auto simulate = [](bool reuse_factorization) {
+        ode_test::BeamParameters parameters;
+        parameters.solver = {
+            {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-5"}, {"residual_tolerance_threshold", "1e-5"},
+            {"reuse_factorization", reuse_factorization ? "1" : "0"}
+        };
+        parameters.linear_solver = {{"backend", "Eigen"}};
+        parameters.young_modulus = "15000";
+        parameters.poisson_ratio = "0.3";
+        parameters.linear_elasticity = true;
+        parameters.mass = "CaribouMass";
+        auto beam = ode_test::create_beam<SofaCaribou::ode::BackwardEulerODESolver>("BackwardEulerODESolver", parameters);
+
+        getSimulation()->init(beam.root.get());
+
+        std::size_t number_of_iterations = 0;
+        for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+            getSimulation()->animate(beam.root.get(), 0.1);
+            EXPECT_EQ(beam.solver->findData("converged")->getValueString(), "1") << "Time step # "<< step_id;
+            number_of_iterations += beam.solver->iteration_times().size();
+        }
+
+        const auto number_of_reused_factorizations = beam.solver->number_of_reused_factorizations();
+        const auto middle_point = beam.middle_point();
+
+        getSimulation()->unload(beam.root);
+
+        return std::make_tuple(number_of_iterations, number_of_reused_factorizations, middle_point);
+    };
+
+    const auto [reused_iterations, reused_factorizations, reused_middle_point] = simulate(true);
+    const auto [assembled_iterations, assembled_factorizations, assembled_middle_point] = simulate(false);
+
+    // Only the first Newton iteration of the simulation assembles and factorizes the system matrix
+    EXPECT_EQ(reused_factorizations, reused_iterations - 1);
+    EXPECT_EQ(assembled_factorizations, 0u);
+    EXPECT_EQ(reused_iterations, assembled_iterations);
+
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        EXPECT_NEAR(reused_middle_point[axis], assembled_middle_point[axis], 1e-10);
+    }
+}
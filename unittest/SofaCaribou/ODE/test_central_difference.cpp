@@ -0,0 +1,97 @@
+#include <cmath>
+#include <string>
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Ode/CentralDifferenceODESolver.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+#include <sofa/helper/testing/BaseTest.h>
+#else
+#include <sofa/testing/BaseTest.h>
+#endif
+#include <sofa/simulation/Node.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+DISABLE_ALL_WARNINGS_END
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
+using namespace sofa::helper::testing;
+#else
+using namespace sofa::testing;
+#endif
+
+/** Make sure the critical time step is estimated from the smallest element size and the wave speed */
+TEST(CentralDifferenceODESolver, Beam) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto root = getSimulation()->createNewNode("root");
+#if (defined(SOFA_VERSION) && SOFA_VERSION >= 201200)
+    createObject(root, "RequiredPlugin", {{"pluginName", "SofaBoundaryCondition SofaEngine"}});
+#else
+    createObject(root, "RequiredPlugin", {{"pluginName", "SofaComponentAll"}});
+#endif
+
+    // Some component to avoid warnings
+    createObject(root, "DefaultAnimationLoop");
+    createObject(root, "DefaultVisualManagerLoop");
+    root->setDt(0.1);
+
+    // Smallest distance between two nodes is 7.5
+    createObject(root, "RegularGridTopology", {{"name", "grid"}, {"min", "-7.5 -7.5 0"}, {"max", "7.5 7.5 80"}, {"n", "3 3 9"}});
+
+    auto meca = createChild(root, "meca");
+    auto solver = dynamic_cast<SofaCaribou::ode::CentralDifferenceODESolver *>(
+            createObject(meca, "CentralDifferenceODESolver", {{"safety_factor", "0.9"}, {"subcycling", "1"}}).get()
+    );
+    auto mo = dynamic_cast<sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types> *>(
+            createObject(meca, "MechanicalObject", {{"name", "mo"}, {"src", "@../grid"}}).get()
+    );
+
+    createObject(meca, "HexahedronSetTopologyContainer", {{"name", "mechanical_topology"}, {"src", "@../grid"}});
+    createObject(meca, "HexahedronSetGeometryAlgorithms");
+
+    createObject(meca, "SaintVenantKirchhoffMaterial", {{"young_modulus", "15000"}, {"poisson_ratio", "0.3"}});
+    createObject(meca, "HyperelasticForcefield");
+    auto mass = createObject(meca, "CaribouMass", {{"density", "0.2"}, {"lumped", "true"}});
+
+    createObject(meca, "BoxROI", {{"name", "fixed_roi"}, {"box", "-7.5 -7.5 -0.9 7.5 7.5 0.1"}});
+    createObject(meca, "FixedConstraint", {{"indices", "@fixed_roi.indices"}});
+
+    getSimulation()->init(root.get());
+
+    // c = sqrt((lambda + 2 mu) / rho)
+    const double E = 15000, nu = 0.3, rho = 0.2;
+    const double c = std::sqrt(E * (1 - nu) / ((1 + nu) * (1 - 2 * nu)) / rho);
+    const double expected_critical_time_step = 0.9 * 7.5 / c;
+
+    EXPECT_NEAR(solver->estimate_critical_time_step(), expected_critical_time_step, 1e-12);
+
+    for (unsigned int step_id = 0; step_id < 10; ++step_id) {
+        getSimulation()->animate(root.get(), 0.1);
+    }
+
+    EXPECT_EQ(solver->findData("number_of_substeps")->getValueString(),
+              std::to_string(static_cast<unsigned int>(std::ceil(0.1 / expected_critical_time_step))));
+
+    // The free end of the beam is falling under the gravity
+    const auto & middle_point = mo->read(sofa::core::ConstVecCoordId::position())->getValue()[76];
+    EXPECT_TRUE(std::isfinite(middle_point[1]));
+    EXPECT_LT(middle_point[1], 0);
+
+    // The critical time step is estimated again after a reset, here with a density four times larger
+    mass->findData("density")->read("0.8");
+    getSimulation()->reset(root.get());
+    getSimulation()->animate(root.get(), 0.1);
+    EXPECT_NEAR(solver->critical_time_step(), 2*expected_critical_time_step, 1e-12);
+
+    getSimulation()->unload(root);
+}
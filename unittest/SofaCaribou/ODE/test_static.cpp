@@ -1,8 +1,12 @@
 #include <array>
+#include <string>
+#include <tuple>
 
 #include <SofaCaribou/config.h>
 #include <SofaCaribou/Ode/StaticODESolver.h>
 
+#include "ode_test.h"
+
 DISABLE_ALL_WARNINGS_BEGIN
 #include <sofa/version.h>
 #if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
@@ -170,4 +174,193 @@ TEST(StaticODESolver, Beam) {
     EXPECT_NEAR(middle_point[2],  76.190, 1e-3); // z
 
     getSimulation()->unload(root);
-}
\ No newline at end of file
+}
+/** Make sure the adaptive load stepping reaches the complete load, and the same equilibrium, in a single time step */
+TEST(StaticODESolver, AdaptiveLoadBeam) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    // The complete traction is applied at the first time step
+    ode_test::BeamParameters parameters;
+    parameters.solver = {
+        {"newton_iterations", "5"}, {"correction_tolerance_threshold", "1e-5"}, {"residual_tolerance_threshold", "1e-5"},
+        {"adaptive_load_stepping", "1"}, {"initial_load_increment", "1"}
+    };
+    parameters.traction_slope = "1";
+    auto beam = ode_test::create_beam<SofaCaribou::ode::StaticODESolver>("StaticODESolver", parameters);
+
+    getSimulation()->init(beam.root.get());
+    getSimulation()->animate(beam.root.get(), 1);
+
+    EXPECT_EQ(beam.solver->findData("converged")->getValueString(), "1");
+    EXPECT_DOUBLE_EQ(beam.solver->load_factor(), 1.);
+    EXPECT_GE(std::stoi(beam.solver->findData("number_of_load_increments")->getValueString()), 1);
+
+    // Same equilibrium as the one reached with 5 manual load increments (see the Beam test above)
+    const auto middle_point = beam.middle_point();
+    EXPECT_NEAR(middle_point[0],   0.000, 1e-2); // x
+    EXPECT_NEAR(middle_point[1], -21.016, 1e-2); // y
+    EXPECT_NEAR(middle_point[2],  76.190, 1e-2); // z
+
+    getSimulation()->unload(beam.root);
+}
+
+/** Make sure a load increment solved with a single Newton iteration (the default) converges on its residual */
+TEST(StaticODESolver, AdaptiveLoadDefaultNewtonIterations) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    const auto simulate = [](bool adaptive_load_stepping) {
+        ode_test::BeamParameters parameters;
+        parameters.solver = {{"adaptive_load_stepping", adaptive_load_stepping ? "1" : "0"}};
+        parameters.poisson_ratio = "0.3";
+        parameters.linear_elasticity = true;
+        parameters.traction_slope = "1";
+        auto beam = ode_test::create_beam<SofaCaribou::ode::StaticODESolver>("StaticODESolver", parameters);
+
+        getSimulation()->init(beam.root.get());
+        getSimulation()->animate(beam.root.get(), 1);
+
+        const auto converged = (beam.solver->findData("converged")->getValueString() == "1");
+        const auto load_factor = beam.solver->load_factor();
+        const auto number_of_bisections = beam.solver->findData("number_of_bisections")->getValueString();
+        const auto middle_point = beam.middle_point();
+
+        getSimulation()->unload(beam.root);
+
+        return std::make_tuple(converged, load_factor, number_of_bisections, middle_point);
+    };
+
+    const auto [adaptive_converged, adaptive_load_factor, adaptive_bisections, adaptive_middle_point] = simulate(true);
+    const auto direct_middle_point = std::get<3>(simulate(false));
+
+    // A linear problem is solved exactly by the single Newton iteration of the first (complete) load increment
+    EXPECT_TRUE(adaptive_converged);
+    EXPECT_DOUBLE_EQ(adaptive_load_factor, 1.);
+    EXPECT_EQ(adaptive_bisections, "0");
+
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        EXPECT_NEAR(adaptive_middle_point[axis], direct_middle_point[axis], 1e-8);
+    }
+}
+
+/** Make sure the linear predictor saves Newton iterations on a smooth load path without changing the solution */
+TEST(StaticODESolver, LinearPredictorBeam) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    ode_test::BeamParameters parameters;
+    parameters.solver = {
+        {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-5"}, {"residual_tolerance_threshold", "1e-5"},
+        {"predictor", "LINEAR"}
+    };
+    parameters.traction_slope = "0.2";
+    auto beam = ode_test::create_beam<SofaCaribou::ode::StaticODESolver>("StaticODESolver", parameters);
+
+    getSimulation()->init(beam.root.get());
+
+    // Without predictor, the 5 load increments take 4 + 5 + 5 + 5 + 5 Newton iterations (see the Beam test above)
+    std::size_t number_of_newton_iterations = 0;
+    for (unsigned int step_id = 0; step_id < 5; ++step_id) {
+        getSimulation()->animate(beam.root.get(), 1);
+        EXPECT_EQ(beam.solver->findData("converged")->getValueString(), "1") << "Time step # "<< step_id;
+        number_of_newton_iterations += beam.solver->squared_residuals().size();
+    }
+    EXPECT_LT(number_of_newton_iterations, 24u);
+
+    const auto middle_point = beam.middle_point();
+    EXPECT_NEAR(middle_point[0],   0.000, 1e-2); // x
+    EXPECT_NEAR(middle_point[1], -21.016, 1e-2); // y
+    EXPECT_NEAR(middle_point[2],  76.190, 1e-2); // z
+
+    getSimulation()->unload(beam.root);
+}
+
+/** Make sure the system vectors are mapped over a single mechanical object, and copied when there are mapped ones */
+TEST(StaticODESolver, MappedSystemVectors) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    const auto simulate = [](bool with_mapped_state) {
+        ode_test::BeamParameters parameters;
+        parameters.solver = {{"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-5"}, {"residual_tolerance_threshold", "1e-5"}};
+        parameters.end_force = "0 -10 0";
+        auto beam = ode_test::create_beam<SofaCaribou::ode::StaticODESolver>("StaticODESolver", parameters);
+
+        if (with_mapped_state) {
+            auto mapped = createChild(beam.meca, "mapped");
+            createObject(mapped, "MechanicalObject", {{"name", "mapped_mo"}});
+            createObject(mapped, "IdentityMapping");
+        }
+
+        getSimulation()->init(beam.root.get());
+        getSimulation()->animate(beam.root.get(), 1);
+
+        const auto is_mapped = beam.solver->system_vectors_are_mapped();
+        const auto converged = (beam.solver->findData("converged")->getValueString() == "1");
+        const auto middle_point = beam.middle_point();
+
+        getSimulation()->unload(beam.root);
+
+        return std::make_tuple(is_mapped, converged, middle_point);
+    };
+
+    const auto [single_state_is_mapped, single_state_converged, single_state_middle_point] = simulate(false);
+    const auto [mapped_states_is_mapped, mapped_states_converged, mapped_states_middle_point] = simulate(true);
+
+    EXPECT_TRUE(single_state_is_mapped);
+    EXPECT_FALSE(mapped_states_is_mapped);
+
+    EXPECT_TRUE(single_state_converged);
+    EXPECT_TRUE(mapped_states_converged);
+
+    // Both paths must give the same solution
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        EXPECT_NEAR(single_state_middle_point[axis], mapped_states_middle_point[axis], 1e-10);
+    }
+}
+
+/** Make sure the symbolic pattern analysis done during the assembly gives the same solution */
+TEST(StaticODESolver, SymbolicPatternAnalysis) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    const auto simulate = [](bool symbolic_pattern_analysis) {
+        ode_test::BeamParameters parameters;
+        parameters.solver = {
+            {"newton_iterations", "10"}, {"correction_tolerance_threshold", "1e-5"}, {"residual_tolerance_threshold", "1e-5"},
+            {"symbolic_pattern_analysis", symbolic_pattern_analysis ? "1" : "0"}
+        };
+        parameters.end_force = "0 -10 0";
+        auto beam = ode_test::create_beam<SofaCaribou::ode::StaticODESolver>("StaticODESolver", parameters);
+
+        getSimulation()->init(beam.root.get());
+        getSimulation()->animate(beam.root.get(), 1);
+        getSimulation()->animate(beam.root.get(), 1);
+
+        const auto number_of_symbolic_analyses = beam.solver->number_of_symbolic_pattern_analyses();
+        const auto number_of_symbolic_builds = beam.solver->number_of_symbolic_pattern_builds();
+        const auto converged = (beam.solver->findData("converged")->getValueString() == "1");
+        const auto middle_point = beam.middle_point();
+
+        getSimulation()->unload(beam.root);
+
+        return std::make_tuple(number_of_symbolic_analyses, number_of_symbolic_builds, converged, middle_point);
+    };
+
+    const auto [symbolic_analyses, symbolic_builds, symbolic_converged, symbolic_middle_point] = simulate(true);
+    const auto [numeric_analyses, numeric_builds, numeric_converged, numeric_middle_point] = simulate(false);
+
+    // The pattern is analyzed once per time step, but only built once since the mechanical graph does not change
+    EXPECT_EQ(symbolic_analyses, 2u);
+    EXPECT_EQ(symbolic_builds, 1u);
+    EXPECT_EQ(numeric_analyses, 0u);
+    EXPECT_EQ(numeric_builds, 0u);
+
+    EXPECT_TRUE(symbolic_converged);
+    EXPECT_TRUE(numeric_converged);
+
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        EXPECT_NEAR(symbolic_middle_point[axis], numeric_middle_point[axis], 1e-10);
+    }
+}
@@ -0,0 +1,165 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Ode/StaticODESolver.h>
+#include <SofaCaribou/Solver/LinearSolver.h>
+
+#include "ode_test.h"
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+#include <sofa/helper/testing/BaseTest.h>
+#else
+#include <sofa/testing/BaseTest.h>
+#endif
+#include <sofa/core/behavior/LinearSolver.h>
+#include <sofa/simulation/MechanicalOperations.h>
+DISABLE_ALL_WARNINGS_END
+
+// This executable replaces the global operator new to count the heap allocations. It is kept apart from the other
+// SofaCaribou tests, which should not run with this allocator.
+
+using namespace sofa::simulation;
+using namespace sofa::simpleapi;
+using namespace sofa::helper::logging;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
+using namespace sofa::helper::testing;
+#else
+using namespace sofa::testing;
+#endif
+
+namespace {
+// Number of heap allocations done while the counter is enabled
+std::atomic<bool> count_allocations {false};
+std::atomic<std::size_t> number_of_allocations {0};
+
+// Number of heap allocations done during the execution of f
+template <typename F>
+auto allocations_of(F && f) -> std::size_t {
+    number_of_allocations = 0;
+    count_allocations = true;
+    f();
+    count_allocations = false;
+    return number_of_allocations.load();
+}
+
+// Gives the test access to the protected setup methods of the Newton-Raphson solver. It is never instantiated, the
+// solvers of the scenes are created by the object factory.
+struct NewtonRaphsonSolverAccess : public SofaCaribou::ode::NewtonRaphsonSolver {
+    using NewtonRaphsonSolver::update_system_buffers;
+    using NewtonRaphsonSolver::update_system_vector_views;
+};
+
+// Setup path of the Newton-Raphson solver done at the beginning of every time step
+struct SystemSetup {
+    explicit SystemSetup(SofaCaribou::ode::NewtonRaphsonSolver * solver)
+    : solver(solver)
+    , linear_solver(dynamic_cast<SofaCaribou::solver::LinearSolver *>(
+          solver->getContext()->get<sofa::core::behavior::LinearSolver>()))
+    , mop(&mechanical_parameters, solver->getContext())
+    {}
+
+    void operator()() {
+        (solver->*(&NewtonRaphsonSolverAccess::update_system_buffers))(mop, linear_solver);
+        (solver->*(&NewtonRaphsonSolverAccess::update_system_vector_views))(
+            linear_solver, f_id, dx_id, false /* static_condensation */
+        );
+    }
+
+    SofaCaribou::ode::NewtonRaphsonSolver * solver;
+    SofaCaribou::solver::LinearSolver * linear_solver;
+    sofa::core::MechanicalParams mechanical_parameters;
+    sofa::simulation::common::MechanicalOperations mop;
+    sofa::core::MultiVecDerivId f_id = sofa::core::VecDerivId::force();
+    sofa::core::MultiVecDerivId dx_id = sofa::core::VecDerivId::dx();
+};
+} // namespace
+
+void * operator new(std::size_t size) {
+    if (count_allocations) {
+        ++number_of_allocations;
+    }
+    if (void * p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept {
+    std::free(p);
+}
+
+/** Make sure the system buffers are only created once, and that the setup path does not allocate in steady-state */
+TEST(NewtonRaphsonSolver, SteadyStateSystemSetup) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    ode_test::BeamParameters parameters;
+    parameters.solver = {{"newton_iterations", "10"}};
+    parameters.poisson_ratio = "0.3";
+    parameters.end_force = "0 -10 0";
+    auto beam = ode_test::create_beam<SofaCaribou::ode::StaticODESolver>("StaticODESolver", parameters);
+
+    getSimulation()->init(beam.root.get());
+
+    // The first time step sets the system up (and allocates the increment vector of the mechanical object)
+    getSimulation()->animate(beam.root.get(), 1);
+    getSimulation()->animate(beam.root.get(), 1);
+    EXPECT_EQ(beam.solver->number_of_system_setups(), 1u);
+    EXPECT_TRUE(beam.solver->system_vectors_are_mapped());
+
+    SystemSetup setup (beam.solver);
+    ASSERT_NE(setup.linear_solver, nullptr);
+    EXPECT_EQ(allocations_of(setup), 0u);
+    EXPECT_EQ(allocations_of(setup), 0u);
+    EXPECT_EQ(beam.solver->number_of_system_setups(), 1u);
+
+    // Forcing a rebuild creates the buffers again
+    beam.solver->invalidate_system_buffers();
+    EXPECT_GT(allocations_of(setup), 0u);
+    EXPECT_EQ(beam.solver->number_of_system_setups(), 2u);
+    EXPECT_EQ(allocations_of(setup), 0u);
+
+    getSimulation()->unload(beam.root);
+}
+
+/** Make sure the system is set up again when a mapped state is resized, even if the global dimension is unchanged */
+TEST(NewtonRaphsonSolver, MappedStateResize) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    ode_test::BeamParameters parameters;
+    parameters.solver = {{"newton_iterations", "10"}};
+    parameters.poisson_ratio = "0.3";
+    auto beam = ode_test::create_beam<SofaCaribou::ode::StaticODESolver>("StaticODESolver", parameters);
+
+    auto mapped = createChild(beam.meca, "mapped");
+    auto mapped_mo = dynamic_cast<ode_test::MechanicalObject *>(
+        createObject(mapped, "MechanicalObject", {{"name", "mapped_mo"}}).get()
+    );
+    createObject(mapped, "IdentityMapping");
+
+    getSimulation()->init(beam.root.get());
+
+    SystemSetup setup (beam.solver);
+    ASSERT_NE(setup.linear_solver, nullptr);
+    setup();
+    EXPECT_EQ(beam.solver->number_of_system_setups(), 1u);
+    EXPECT_EQ(allocations_of(setup), 0u);
+
+    // The global system only contains the top level state, its dimension does not change
+    mapped_mo->resize(mapped_mo->getSize() + 1);
+    setup();
+    EXPECT_EQ(beam.solver->number_of_system_setups(), 2u);
+    EXPECT_EQ(allocations_of(setup), 0u);
+
+    getSimulation()->unload(beam.root);
+}
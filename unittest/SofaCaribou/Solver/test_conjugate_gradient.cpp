@@ -0,0 +1,206 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <SofaCaribou/config.h>
+#include <SofaCaribou/Algebra/EigenMatrix.h>
+#include <SofaCaribou/Algebra/EigenVector.h>
+#include <SofaCaribou/Solver/ConjugateGradientSolver.h>
+
+DISABLE_ALL_WARNINGS_BEGIN
+#include <sofa/version.h>
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 211200)
+#include <sofa/helper/testing/BaseTest.h>
+#else
+#include <sofa/testing/BaseTest.h>
+#endif
+DISABLE_ALL_WARNINGS_END
+
+#include <Eigen/Sparse>
+
+using namespace sofa::helper::logging;
+
+#if (defined(SOFA_VERSION) && SOFA_VERSION < 210600)
+using namespace sofa::helper::testing;
+#else
+using namespace sofa::testing;
+#endif
+
+namespace {
+using SparseMatrix = Eigen::SparseMatrix<FLOATING_POINT_TYPE, Eigen::RowMajor, int>;
+using DenseMatrix = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, Eigen::Dynamic>;
+using Vector = Eigen::Matrix<FLOATING_POINT_TYPE, Eigen::Dynamic, 1>;
+using Solver = SofaCaribou::solver::ConjugateGradientSolver<SparseMatrix>;
+
+// Number of nodes of the beam along its width (x and y) and its length (z)
+constexpr int nx = 3, ny = 3, nz = 9;
+constexpr int number_of_nodes = nx*ny*nz;
+
+// Stiffness of a 3x3x9 beam made of unit springs between the neighbor nodes of a regular grid. The beam is loosely
+// attached to the ground (springs of stiffness epsilon), hence its three rigid translations are eigenvectors of the
+// matrix associated to its lowest eigenvalue (epsilon).
+auto beam_stiffness(FLOATING_POINT_TYPE epsilon) -> SparseMatrix {
+    const auto node = [](int i, int j, int k) { return i + nx*(j + ny*k); };
+
+    std::vector<Eigen::Triplet<FLOATING_POINT_TYPE>> triplets;
+    const auto add_spring = [&triplets](int node_a, int node_b) {
+        for (int axis = 0; axis < 3; ++axis) {
+            const auto a = 3*node_a + axis;
+            const auto b = 3*node_b + axis;
+            triplets.emplace_back(a, a, 1.);
+            triplets.emplace_back(b, b, 1.);
+            triplets.emplace_back(a, b, -1.);
+            triplets.emplace_back(b, a, -1.);
+        }
+    };
+
+    for (int k = 0; k < nz; ++k) {
+        for (int j = 0; j < ny; ++j) {
+            for (int i = 0; i < nx; ++i) {
+                if (i+1 < nx) add_spring(node(i, j, k), node(i+1, j, k));
+                if (j+1 < ny) add_spring(node(i, j, k), node(i, j+1, k));
+                if (k+1 < nz) add_spring(node(i, j, k), node(i, j, k+1));
+            }
+        }
+    }
+
+    for (int i = 0; i < 3*number_of_nodes; ++i) {
+        triplets.emplace_back(i, i, epsilon);
+    }
+
+    SparseMatrix K (3*number_of_nodes, 3*number_of_nodes);
+    K.setFromTriplets(triplets.begin(), triplets.end());
+    return K;
+}
+
+// Rigid translations of the beam along x, y and z
+auto beam_rigid_translations() -> DenseMatrix {
+    DenseMatrix W = DenseMatrix::Zero(3*number_of_nodes, 3);
+    for (int n = 0; n < number_of_nodes; ++n) {
+        for (int axis = 0; axis < 3; ++axis) {
+            W(3*n + axis, axis) = 1.;
+        }
+    }
+    return W;
+}
+
+// Solve Kx = f with a new CG solver, deflated by W when it isn't empty. Returns the solution and the number of iterations.
+auto solve(SparseMatrix K, Vector f, const DenseMatrix & W) -> std::pair<Vector, std::size_t> {
+    auto cg = sofa::core::objectmodel::New<Solver>();
+    cg->findData("preconditioning_method")->read("Identity");
+    cg->findData("maximum_number_of_iterations")->read("1000");
+    cg->findData("residual_tolerance_threshold")->read("1e-10");
+    cg->findData("deflation_subspace_size")->read(W.cols() > 0 ? "3" : "0");
+    cg->set_deflation_refresh_strategy(Solver::DeflationRefreshStrategy::NEVER);
+
+    const SofaCaribou::Algebra::EigenMatrix<SparseMatrix> A (K);
+    const SofaCaribou::Algebra::EigenVector<Vector> F (f);
+    SofaCaribou::Algebra::EigenVector<Vector> X (static_cast<Eigen::Index>(f.size()));
+    X.vector().setZero();
+
+    SofaCaribou::solver::LinearSolver * linear_solver = cg.get();
+    linear_solver->set_system_matrix(&A);
+    EXPECT_TRUE(linear_solver->analyze_pattern());
+    EXPECT_TRUE(linear_solver->factorize());
+
+    if (W.cols() > 0) {
+        cg->set_deflation_subspace(W);
+    }
+
+    EXPECT_TRUE(linear_solver->solve(&F, &X));
+
+    // The known subspace is kept as is
+    EXPECT_EQ(cg->deflation_subspace().cols(), W.cols());
+
+    return {X.vector(), linear_solver->squared_residuals().size()};
+}
+} // namespace
+
+/** Make sure the CG deflated by the rigid modes of a beam gives the same solution in fewer iterations */
+TEST(ConjugateGradientSolver, DeflatedRigidModes) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    const SparseMatrix K = beam_stiffness(1e-6);
+
+    // Forces on both ends of the beam, with a non-zero resultant (it excites the rigid modes)
+    Vector f = Vector::Zero(3*number_of_nodes);
+    f.segment<3>(0) << 0.2, 0., 0.;
+    f.tail<3>() << 0., -1., 0.5;
+
+    const auto [x, iterations] = solve(K, f, DenseMatrix(3*number_of_nodes, 0));
+    const auto [x_deflated, deflated_iterations] = solve(K, f, beam_rigid_translations());
+
+    // Both converge to the exact solution
+    const Eigen::SimplicialLDLT<Eigen::SparseMatrix<FLOATING_POINT_TYPE>> ldlt (K);
+    const Vector x_exact = ldlt.solve(f);
+    EXPECT_LT((x - x_exact).norm() / x_exact.norm(), 1e-8);
+    EXPECT_LT((x_deflated - x_exact).norm() / x_exact.norm(), 1e-8);
+    EXPECT_LT((x_deflated - x).norm() / x.norm(), 1e-8);
+
+    // The deflation removes the lowest eigenvalues from the Krylov space
+    EXPECT_LT(deflated_iterations, iterations);
+}
+
+/** Make sure the deflation subspace harvested from the previous solves is capped, orthonormal and reduces the iterations */
+TEST(ConjugateGradientSolver, HarvestedDeflationSubspace) {
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    constexpr Eigen::Index deflation_subspace_size = 16;
+    constexpr int number_of_solves = 6;
+
+    const SparseMatrix K = beam_stiffness(1e-6);
+    const Eigen::SimplicialLDLT<Eigen::SparseMatrix<FLOATING_POINT_TYPE>> ldlt (K);
+
+    auto cg = sofa::core::objectmodel::New<Solver>();
+    cg->findData("preconditioning_method")->read("Identity");
+    cg->findData("maximum_number_of_iterations")->read("1000");
+    cg->findData("residual_tolerance_threshold")->read("1e-10");
+    cg->findData("deflation_subspace_size")->read(std::to_string(deflation_subspace_size));
+    cg->set_deflation_refresh_strategy(Solver::DeflationRefreshStrategy::EVERY_SOLVE);
+
+    const SofaCaribou::Algebra::EigenMatrix<SparseMatrix> A (K);
+    SofaCaribou::solver::LinearSolver * linear_solver = cg.get();
+    linear_solver->set_system_matrix(&A);
+    EXPECT_TRUE(linear_solver->analyze_pattern());
+    EXPECT_TRUE(linear_solver->factorize());
+
+    // Nothing is harvested before the first solve
+    EXPECT_EQ(cg->deflation_subspace().cols(), 0);
+
+    for (int i = 0; i < number_of_solves; ++i) {
+        // Forces on both ends and at the middle of the beam, changing at every solve
+        Vector f = Vector::Zero(3*number_of_nodes);
+        f.segment<3>(0) << 0.2, 0.1*i, 0.;
+        f.segment<3>(3*(number_of_nodes/2)) << 0., 0.3, -0.2*i;
+        f.tail<3>() << 0.1*i, -1., 0.5;
+
+        const SofaCaribou::Algebra::EigenVector<Vector> F (f);
+        SofaCaribou::Algebra::EigenVector<Vector> X (static_cast<Eigen::Index>(f.size()));
+        X.vector().setZero();
+        EXPECT_TRUE(linear_solver->solve(&F, &X));
+        const auto iterations = linear_solver->squared_residuals().size();
+
+        const Vector x_exact = ldlt.solve(f);
+        EXPECT_LT((X.vector() - x_exact).norm() / x_exact.norm(), 1e-8) << "Solve #" << i;
+
+        // The subspace is filled up to its maximum size at the first solve, and then recycled at the same size
+        const auto & W = cg->deflation_subspace();
+        ASSERT_EQ(W.rows(), 3*number_of_nodes);
+        EXPECT_EQ(W.cols(), deflation_subspace_size) << "Solve #" << i;
+
+        // The Ritz vectors are orthonormal
+        const DenseMatrix I = DenseMatrix::Identity(W.cols(), W.cols());
+        EXPECT_LT((W.transpose()*W - I).norm(), 1e-10) << "Solve #" << i;
+
+        // The first solve isn't deflated. The approximate eigenvectors improve with the solves, until the deflation
+        // removes the lowest eigenvalues from the Krylov space.
+        const auto undeflated_iterations = solve(K, f, DenseMatrix(3*number_of_nodes, 0)).second;
+        if (i == 0) {
+            EXPECT_EQ(iterations, undeflated_iterations);
+        } else if (i >= number_of_solves / 2) {
+            EXPECT_LT(iterations, undeflated_iterations) << "Solve #" << i;
+        }
+    }
+}
@@ -1584,3 +1584,166 @@ TEST(CaribouTopology, HexahedronQuadraticFromIndices) {
     double exact_volume = 10*10*10;
     EXPECT_LE( abs((volume-exact_volume)/exact_volume), 0.001); // 1% error max
 }
+
+TEST(CaribouTopology, HexahedronLinearReordering) {
+    using namespace caribou;
+    using namespace caribou::topology;
+    using namespace caribou::geometry;
+    using namespace sofa::helper;
+    using namespace sofa::core::objectmodel;
+
+    using PointID  = sofa::core::topology::Topology::PointID;
+
+    using Mesh = io::VTKReader<_3D, PointID>::MeshType;
+    auto reader = io::VTKReader<_3D, PointID>::Read(executable_directory_path + "/meshes/3D_hexahedron_linear.vtk");
+    using Domain = Mesh::Domain<Hexahedron, PointID>;
+
+    auto mesh = reader.mesh();
+    const auto * domain = dynamic_cast<const Domain * >(mesh.domain(1));
+
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+    EXPECT_MSG_NOEMIT(Error);
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto root = getSimulation()->createNewNode("root");
+    createObject(root, "DefaultAnimationLoop");
+    createObject(root, "DefaultVisualManagerLoop");
+
+    // Add the CaribouTopology component, with positions that are not the ones of a mechanical state
+    auto topo = dynamic_cast<SofaCaribou::topology::CaribouTopology<Hexahedron> *> (
+            createObject(root, "CaribouTopology", {
+                {"name", "topology"}, {"template", "Hexahedron"},
+                {"node_ordering", "ReverseCuthillMcKee"}, {"reorder_elements", "1"}
+            }).get()
+    );
+    ASSERT_NE(topo, nullptr);
+
+    using DataPositions = Data<sofa::type::vector<sofa::defaulttype::Vec3Types::Coord>>;
+    using DataIndices = Data<sofa::type::vector<sofa::type::fixed_array<PointID, 8>>>;
+    using DataPermutation = Data<sofa::type::vector<UNSIGNED_INTEGER_TYPE>>;
+    {
+        auto positions = WriteOnlyAccessor<DataPositions> (dynamic_cast<DataPositions*>(topo->findData("position")));
+        positions.resize(mesh.number_of_nodes());
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            const auto p = mesh.position(i);
+            positions[i] = {p[0], p[1], p[2]};
+        }
+
+        auto indices = WriteOnlyAccessor<DataIndices> (dynamic_cast<DataIndices*>(topo->findData("indices")));
+        indices.resize(domain->number_of_elements());
+        for (std::size_t element_id = 0; element_id < indices.size(); ++element_id) {
+            for (std::size_t node_id = 0; node_id < 8; ++node_id) {
+                indices[element_id][node_id] = domain->element_indices(element_id)[node_id];
+            }
+        }
+    }
+
+    // The mechanical state is created (after the topology) from the reordered positions
+    createObject(root, "MechanicalObject", {{"name", "mo"}, {"position", "@topology.reordered_position"}});
+
+    getSimulation()->init(root.get());
+
+    const auto positions = ReadAccessor<DataPositions> (dynamic_cast<DataPositions*>(topo->findData("position")));
+    const auto indices = ReadAccessor<DataIndices> (dynamic_cast<DataIndices*>(topo->findData("indices")));
+    const auto reordered_positions = ReadAccessor<DataPositions> (dynamic_cast<DataPositions*>(topo->findData("reordered_position")));
+    const auto reordered_indices = ReadAccessor<DataIndices> (dynamic_cast<DataIndices*>(topo->findData("reordered_indices")));
+    const auto node_permutation = ReadAccessor<DataPermutation> (dynamic_cast<DataPermutation*>(topo->findData("node_permutation")));
+    const auto element_permutation = ReadAccessor<DataPermutation> (dynamic_cast<DataPermutation*>(topo->findData("element_permutation")));
+
+    // The input vectors are untouched
+    ASSERT_EQ(positions.size(), mesh.number_of_nodes());
+    ASSERT_EQ(indices.size(), domain->number_of_elements());
+    EXPECT_EQ(indices[0][0], domain->element_indices(0)[0]);
+
+    // The reordered vectors are the permuted input ones
+    ASSERT_EQ(reordered_positions.size(), positions.size());
+    ASSERT_EQ(reordered_indices.size(), indices.size());
+    ASSERT_EQ(node_permutation.size(), positions.size());
+    ASSERT_EQ(element_permutation.size(), indices.size());
+    for (std::size_t i = 0; i < reordered_positions.size(); ++i) {
+        EXPECT_EQ(reordered_positions[i], positions[node_permutation[i]]);
+    }
+    for (std::size_t element_id = 0; element_id < reordered_indices.size(); ++element_id) {
+        for (std::size_t node_id = 0; node_id < 8; ++node_id) {
+            EXPECT_EQ(node_permutation[reordered_indices[element_id][node_id]], indices[element_permutation[element_id]][node_id]);
+        }
+    }
+
+    // The mechanical state follows the reordered positions
+    auto * mo = root->getMechanicalState();
+    ASSERT_NE(mo, nullptr);
+    EXPECT_EQ(mo->getSize(), reordered_positions.size());
+
+    // The domain is created from the reordered vectors
+    const auto * hexa_domain = topo->domain();
+    ASSERT_NE(hexa_domain, nullptr);
+
+    FLOATING_POINT_TYPE volume = 0;
+    for (UNSIGNED_INTEGER_TYPE hexa_id = 0; hexa_id < hexa_domain->number_of_elements(); ++hexa_id) {
+        auto hexa = hexa_domain->element(hexa_id);
+        for (const auto & g : hexa.gauss_nodes()) {
+            volume += g.weight*abs(hexa.jacobian(g.position).determinant());
+        }
+    }
+    double exact_volume = 10*10*10;
+    EXPECT_LE( abs((volume-exact_volume)/exact_volume), 0.001); // 1% error max
+}
+
+TEST(CaribouTopology, HexahedronLinearReorderingMechanicalState) {
+    using namespace caribou;
+    using namespace caribou::topology;
+    using namespace caribou::geometry;
+    using namespace sofa::helper;
+    using namespace sofa::core::objectmodel;
+
+    using PointID  = sofa::core::topology::Topology::PointID;
+
+    using Mesh = io::VTKReader<_3D, PointID>::MeshType;
+    auto reader = io::VTKReader<_3D, PointID>::Read(executable_directory_path + "/meshes/3D_hexahedron_linear.vtk");
+    using Domain = Mesh::Domain<Hexahedron, PointID>;
+
+    auto mesh = reader.mesh();
+    const auto * domain = dynamic_cast<const Domain * >(mesh.domain(1));
+
+    MessageDispatcher::addHandler( MainGtestMessageHandler::getInstance() ) ;
+
+    setSimulation(new sofa::simulation::graph::DAGSimulation());
+    auto root = getSimulation()->createNewNode("root");
+    createObject(root, "DefaultAnimationLoop");
+    createObject(root, "DefaultVisualManagerLoop");
+
+    auto mo = dynamic_cast<sofa::component::container::MechanicalObject<sofa::defaulttype::Vec3Types> *>(
+            createObject(root, "MechanicalObject", {{"name", "mo"}}).get()
+    );
+    mo->resize(mesh.number_of_nodes());
+    auto positions = mo->writePositions();
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        const auto p = mesh.position(i);
+        positions[i] = {p[0], p[1], p[2]};
+    }
+
+    // The positions of the mechanical state are automatically found, hence its nodes can't be reordered
+    auto topo = dynamic_cast<SofaCaribou::topology::CaribouTopology<Hexahedron> *> (
+            createObject(root, "CaribouTopology", {{"template", "Hexahedron"}, {"node_ordering", "Morton"}}).get()
+    );
+    ASSERT_NE(topo, nullptr);
+
+    using DataIndices = Data<sofa::type::vector<sofa::type::fixed_array<PointID, 8>>>;
+    {
+        auto indices = WriteOnlyAccessor<DataIndices> (dynamic_cast<DataIndices*>(topo->findData("indices")));
+        indices.resize(domain->number_of_elements());
+        for (std::size_t element_id = 0; element_id < indices.size(); ++element_id) {
+            for (std::size_t node_id = 0; node_id < 8; ++node_id) {
+                indices[element_id][node_id] = domain->element_indices(element_id)[node_id];
+            }
+        }
+    }
+
+    {
+        EXPECT_MSG_EMIT(Error);
+        getSimulation()->init(root.get());
+    }
+
+    EXPECT_EQ(topo->domain(), nullptr);
+    EXPECT_NE(topo->findData("position")->getParent(), nullptr);
+}